@@ -0,0 +1,159 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK bulkioInterfaces.
+ *
+ * REDHAWK bulkioInterfaces is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK bulkioInterfaces is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+#ifndef __bulkio_boundedqueue_h
+#define __bulkio_boundedqueue_h
+
+#include <cstddef>
+#include <stdint.h>
+
+namespace bulkio {
+
+    namespace detail {
+
+        inline void cpu_relax()
+        {
+#if defined(__i386__) || defined(__x86_64__)
+            __asm__ __volatile__("pause" ::: "memory");
+#else
+            __sync_synchronize();
+#endif
+        }
+
+        /**
+         * Fixed-capacity lock-free queue.
+         *
+         * Any number of threads may push and pop concurrently; each cell
+         * carries a sequence number that tells producers and consumers whether
+         * it is free or full for the current lap around the ring, so there is
+         * no ABA problem and no locking. Capacity is rounded up to the next
+         * power of two.
+         *
+         * Intended for pointers and other trivially-copyable types.
+         */
+        template <typename T>
+        class BoundedQueue {
+        public:
+            explicit BoundedQueue(size_t capacity) :
+                _buffer(0),
+                _mask(0),
+                _enqueuePos(0),
+                _dequeuePos(0)
+            {
+                size_t size = 2;
+                while (size < capacity) {
+                    size <<= 1;
+                }
+                _buffer = new Cell[size];
+                _mask = size - 1;
+                for (size_t index = 0; index < size; ++index) {
+                    _buffer[index].sequence = index;
+                }
+            }
+
+            ~BoundedQueue()
+            {
+                delete[] _buffer;
+            }
+
+            size_t capacity() const
+            {
+                return _mask + 1;
+            }
+
+            bool push(const T& value)
+            {
+                Cell* cell;
+                size_t pos = _enqueuePos;
+                for (;;) {
+                    cell = &_buffer[pos & _mask];
+                    intptr_t diff = (intptr_t) cell->sequence - (intptr_t) pos;
+                    if (diff == 0) {
+                        if (__sync_bool_compare_and_swap(&_enqueuePos, pos, pos + 1)) {
+                            break;
+                        }
+                    } else if (diff < 0) {
+                        // The cell has not been consumed from the last lap,
+                        // so the queue is full
+                        return false;
+                    }
+                    pos = _enqueuePos;
+                }
+                cell->data = value;
+                __sync_synchronize();
+                cell->sequence = pos + 1;
+                return true;
+            }
+
+            bool pop(T& value)
+            {
+                Cell* cell;
+                size_t pos = _dequeuePos;
+                for (;;) {
+                    cell = &_buffer[pos & _mask];
+                    intptr_t diff = (intptr_t) cell->sequence - (intptr_t) (pos + 1);
+                    if (diff == 0) {
+                        if (__sync_bool_compare_and_swap(&_dequeuePos, pos, pos + 1)) {
+                            break;
+                        }
+                    } else if (diff < 0) {
+                        // No producer has filled this cell yet
+                        return false;
+                    }
+                    pos = _dequeuePos;
+                }
+                value = cell->data;
+                __sync_synchronize();
+                cell->sequence = pos + _mask + 1;
+                return true;
+            }
+
+            // Approximate, as producers may be in the middle of a push
+            bool empty() const
+            {
+                const Cell* cell = &_buffer[_dequeuePos & _mask];
+                return (cell->sequence != (_dequeuePos + 1));
+            }
+
+        private:
+            // Non-copyable, non-assignable
+            BoundedQueue(const BoundedQueue&);
+            BoundedQueue& operator=(const BoundedQueue&);
+
+            struct Cell {
+                volatile size_t sequence;
+                T data;
+            };
+
+            Cell* _buffer;
+            size_t _mask;
+
+            // Keep the producer and consumer positions on separate cache
+            // lines so that the writer and reader threads do not contend
+            char _pad0[64];
+            volatile size_t _enqueuePos;
+            char _pad1[64];
+            volatile size_t _dequeuePos;
+            char _pad2[64];
+        };
+    }
+}
+
+#endif // __bulkio_boundedqueue_h
@@ -18,20 +18,304 @@
  * along with this program.  If not, see http://www.gnu.org/licenses/.
  */
 
+#include <deque>
+
+#include <boost/thread.hpp>
+
 #include <BulkioTransport.h>
 #include "bulkio_typetraits.h"
 #include "bulkio_in_port.h"
 #include "bulkio_out_port.h"
 #include "bulkio_p.h"
+#include "FlowCredit.h"
 
 namespace bulkio {
 
+    namespace {
+        template <typename T>
+        inline redhawk::shared_buffer<T> hold_data(const redhawk::shared_buffer<T>& data)
+        {
+            // Data from a non-shared source (a vector or raw pointer) is only
+            // valid for the duration of the push call, so it must be copied
+            // before it can be queued
+            if (data.transient() && !data.empty()) {
+                return data.copy();
+            }
+            return data;
+        }
+
+        inline redhawk::shared_bitbuffer hold_data(const redhawk::shared_bitbuffer& data)
+        {
+            if (data.transient() && !data.empty()) {
+                return data.copy();
+            }
+            return data;
+        }
+
+        inline const std::string& hold_data(const std::string& data)
+        {
+            return data;
+        }
+    }
+
+    //
+    // AsyncSender
+    //
+    // Per-connection send queue and thread used by OutputTransport in
+    // asynchronous mode. The queue bound applies to data packets only; SRI
+    // updates and end-of-stream packets are always queued (blocking if
+    // necessary) so that the receiver sees a consistent stream. Flow control
+    // credit is charged on the sender thread as each packet is sent, so that
+    // a reader that is slow to return credit backs up this queue rather than
+    // the caller.
+    //
+    template <typename PortType>
+    class AsyncSender {
+    public:
+        typedef typename BufferTraits<PortType>::BufferType BufferType;
+
+        AsyncSender(OutputTransport<PortType>* transport, size_t queueDepth, SendQueuePolicy policy) :
+            _transport(transport),
+            _maxDepth(queueDepth),
+            _policy(policy),
+            _packets(0),
+            _running(true),
+            _drain(false),
+            _dropped(0),
+            _highWater(0),
+            _depthTotal(0.0),
+            _depthSamples(0)
+        {
+            if (_maxDepth == 0) {
+                _maxDepth = 1;
+            }
+            _thread = boost::thread(&AsyncSender::_run, this);
+        }
+
+        ~AsyncSender()
+        {
+            stop(false);
+        }
+
+        void stop(bool drain)
+        {
+            {
+                boost::mutex::scoped_lock lock(_mutex);
+                if (!_running && !_thread.joinable()) {
+                    return;
+                }
+                _running = false;
+                _drain = drain;
+                _notEmpty.notify_all();
+                _notFull.notify_all();
+            }
+            _thread.join();
+
+            boost::mutex::scoped_lock lock(_mutex);
+            _queue.clear();
+            _packets = 0;
+        }
+
+        // Returns true if the sender has been stopped without draining, in
+        // which case a wait for credit should be abandoned
+        bool isCancelled()
+        {
+            boost::mutex::scoped_lock lock(_mutex);
+            return !_running && !_drain;
+        }
+
+        void queueSRI(const BULKIO::StreamSRI& sri)
+        {
+            boost::mutex::scoped_lock lock(_mutex);
+            _queue.push_back(Message(sri));
+            _notEmpty.notify_one();
+        }
+
+        void queuePacket(const BufferType& data, const BULKIO::PrecisionUTCTime& T, bool EOS,
+                         const std::string& streamID, const BULKIO::StreamSRI& sri)
+        {
+            boost::mutex::scoped_lock lock(_mutex);
+            if ((_packets >= _maxDepth) && _running) {
+                if (EOS || (_policy == SEND_QUEUE_BLOCK)) {
+                    while ((_packets >= _maxDepth) && _running) {
+                        _notFull.wait(lock);
+                    }
+                } else if (_policy == SEND_QUEUE_DROP_NEWEST) {
+                    ++_dropped;
+                    return;
+                } else if (!_dropOldest()) {
+                    // Everything queued is SRI or end-of-stream
+                    ++_dropped;
+                    return;
+                }
+            }
+            if (!_running) {
+                return;
+            }
+
+            _queue.push_back(Message(hold_data(data), T, EOS, streamID, sri));
+            ++_packets;
+            if (_packets > _highWater) {
+                _highWater = _packets;
+            }
+            _depthTotal += (double) _packets / _maxDepth;
+            ++_depthSamples;
+            _notEmpty.notify_one();
+        }
+
+        float averageQueueDepth()
+        {
+            boost::mutex::scoped_lock lock(_mutex);
+            if (_depthSamples == 0) {
+                return 0.0;
+            }
+            return _depthTotal / _depthSamples;
+        }
+
+        redhawk::PropertyMap getStatistics()
+        {
+            boost::mutex::scoped_lock lock(_mutex);
+            redhawk::PropertyMap statistics;
+            statistics["async::queue_depth"] = (CORBA::ULong) _packets;
+            statistics["async::queue_capacity"] = (CORBA::ULong) _maxDepth;
+            statistics["async::max_queue_depth"] = (CORBA::ULong) _highWater;
+            statistics["async::dropped"] = (CORBA::ULongLong) _dropped;
+            switch (_policy) {
+            case SEND_QUEUE_BLOCK:
+                statistics["async::policy"] = std::string("block");
+                break;
+            case SEND_QUEUE_DROP_NEWEST:
+                statistics["async::policy"] = std::string("drop_newest");
+                break;
+            case SEND_QUEUE_DROP_OLDEST:
+                statistics["async::policy"] = std::string("drop_oldest");
+                break;
+            }
+            return statistics;
+        }
+
+    private:
+        struct Message {
+            Message(const BULKIO::StreamSRI& sri) :
+                isSRI(true),
+                data(),
+                T(),
+                EOS(false),
+                streamID(),
+                sri(sri)
+            {
+            }
+
+            Message(const BufferType& data, const BULKIO::PrecisionUTCTime& T, bool EOS,
+                    const std::string& streamID, const BULKIO::StreamSRI& sri) :
+                isSRI(false),
+                data(data),
+                T(T),
+                EOS(EOS),
+                streamID(streamID),
+                sri(sri)
+            {
+            }
+
+            bool isSRI;
+            BufferType data;
+            BULKIO::PrecisionUTCTime T;
+            bool EOS;
+            std::string streamID;
+            BULKIO::StreamSRI sri;
+        };
+
+        bool _dropOldest()
+        {
+            for (typename std::deque<Message>::iterator message = _queue.begin(); message != _queue.end(); ++message) {
+                if (!message->isSRI && !message->EOS) {
+                    _queue.erase(message);
+                    --_packets;
+                    ++_dropped;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        void _run()
+        {
+            while (true) {
+                boost::mutex::scoped_lock lock(_mutex);
+                while (_running && _queue.empty()) {
+                    _notEmpty.wait(lock);
+                }
+                if (_queue.empty() || (!_running && !_drain)) {
+                    return;
+                }
+                Message message = _queue.front();
+                _queue.pop_front();
+                if (!message.isSRI) {
+                    --_packets;
+                    _notFull.notify_one();
+                }
+                lock.unlock();
+
+                // Once the connection has failed, discard the rest of the
+                // queue; the port will skip this connection from now on
+                if (!_transport->isAlive()) {
+                    continue;
+                }
+
+                if (!message.isSRI && _transport->_credit) {
+                    const size_t elements = _transport->_dataLength(message.data);
+                    if (!_transport->_acquireCredit(elements, message.EOS, this)) {
+                        continue;
+                    }
+                }
+
+                try {
+                    if (message.isSRI) {
+                        _transport->_pushSRI(message.sri);
+                    } else {
+                        _transport->_sendPacket(message.data, message.T, message.EOS, message.streamID, message.sri);
+                    }
+                } catch (const redhawk::FatalTransportError& err) {
+                    RH_NL_ERROR("BulkioTransport", "Asynchronous push failed on port " << _transport->_port->getName()
+                                << ": " << err.what());
+                    _transport->setAlive(false);
+                } catch (const redhawk::TransportError& err) {
+                    RH_NL_ERROR("BulkioTransport", "Asynchronous push error on port " << _transport->_port->getName()
+                                << ": " << err.what());
+                }
+            }
+        }
+
+        OutputTransport<PortType>* _transport;
+        size_t _maxDepth;
+        SendQueuePolicy _policy;
+
+        boost::mutex _mutex;
+        boost::condition_variable _notEmpty;
+        boost::condition_variable _notFull;
+        std::deque<Message> _queue;
+        size_t _packets;
+        bool _running;
+        bool _drain;
+        boost::thread _thread;
+
+        uint64_t _dropped;
+        size_t _highWater;
+        double _depthTotal;
+        size_t _depthSamples;
+    };
+
     template <typename PortType>
     OutputTransport<PortType>::OutputTransport(OutPortType* port, PtrType objref) :
         redhawk::UsesTransport(port),
         _port(port),
         _objref(PortType::_duplicate(objref)),
-        _stats(port->getName())
+        _stats(port->getName()),
+        _sender(0),
+        _creditPolicy(CREDIT_WAIT),
+        _creditExhausted(0),
+        _creditDropped(0),
+        _creditWaitTime(0.0)
     {
         // Manually set the bit size because the statistics ctor only takes a
         // byte count
@@ -41,11 +325,121 @@ namespace bulkio {
     template <typename PortType>
     OutputTransport<PortType>::~OutputTransport()
     {
+        // The owning port normally stops the sender while the transport is
+        // still fully constructed; this is only a fallback
+        disableAsync(false);
+    }
+
+    template <typename PortType>
+    void OutputTransport<PortType>::enableAsync(size_t queueDepth, SendQueuePolicy policy)
+    {
+        // Replace any existing sender, preserving order by draining it first
+        disableAsync(true);
+        _sender = new AsyncSender<PortType>(this, queueDepth, policy);
+    }
+
+    template <typename PortType>
+    void OutputTransport<PortType>::disableAsync(bool drain)
+    {
+        if (_sender) {
+            _sender->stop(drain);
+            delete _sender;
+            _sender = 0;
+        }
+    }
+
+    template <typename PortType>
+    bool OutputTransport<PortType>::isAsync() const
+    {
+        return (_sender != 0);
+    }
+
+    template <typename PortType>
+    bool OutputTransport<PortType>::hasCredit(size_t count) const
+    {
+        if (!_credit) {
+            return true;
+        }
+        return _credit->canSend(count);
+    }
+
+    template <typename PortType>
+    void OutputTransport<PortType>::setCreditPolicy(CreditPolicy policy)
+    {
+        _creditPolicy = policy;
+    }
+
+    template <typename PortType>
+    void OutputTransport<PortType>::_enableCredit(const boost::shared_ptr<FlowCredit>& credit)
+    {
+        _credit = credit;
+    }
+
+    template <typename PortType>
+    boost::shared_ptr<FlowCredit> OutputTransport<PortType>::creditWait(const BufferType& data, bool EOS, size_t& elements)
+    {
+        // Asynchronous connections wait on their sender thread instead
+        if (!_credit || _sender || EOS || (_creditPolicy != CREDIT_WAIT)) {
+            return boost::shared_ptr<FlowCredit>();
+        }
+        elements = _dataLength(data);
+        if (_credit->canSend(elements) || _credit->isClosed()) {
+            return boost::shared_ptr<FlowCredit>();
+        }
+        return _credit;
+    }
+
+    template <typename PortType>
+    void OutputTransport<PortType>::recordCreditWait(double seconds)
+    {
+        boost::mutex::scoped_lock lock(_statsMutex);
+        ++_creditExhausted;
+        _creditWaitTime += seconds;
+    }
+
+    template <typename PortType>
+    bool OutputTransport<PortType>::_acquireCredit(size_t elements, bool EOS, AsyncSender<PortType>* sender)
+    {
+        if (!EOS && !_credit->canSend(elements)) {
+            if (_creditPolicy == CREDIT_DROP) {
+                boost::mutex::scoped_lock lock(_statsMutex);
+                ++_creditExhausted;
+                ++_creditDropped;
+                return false;
+            } else if (!sender) {
+                // A synchronous push that still lacks credit lost a race with
+                // another writer after the port waited (see creditWait());
+                // the caller holds the port lock, so send the packet anyway
+                // rather than wait here
+                _credit->charge(elements);
+                return true;
+            }
+
+            // Wait in short intervals so that a connection that has died (or
+            // been closed by the reader) does not hold up the sender thread
+            const boost::system_time start = boost::get_system_time();
+            while (!_credit->wait(elements, 0.1)) {
+                if (_credit->isClosed() || !isAlive() || sender->isCancelled()) {
+                    break;
+                }
+            }
+            const boost::posix_time::time_duration waited = boost::get_system_time() - start;
+            recordCreditWait(waited.total_microseconds() * 1e-6);
+            if (sender->isCancelled()) {
+                return false;
+            }
+        }
+        _credit->charge(elements);
+        return true;
     }
 
     template <typename PortType>
     void OutputTransport<PortType>::disconnect()
     {
+        // Flush any pending asynchronous pushes so the end-of-stream packets
+        // below arrive after the data
+        disableAsync(true);
+
         // Send an end-of-stream for all active streams
         for (VersionMap::iterator stream = _sriVersions.begin(); stream != _sriVersions.end(); ++stream) {
             try {
@@ -55,6 +449,14 @@ namespace bulkio {
             }
         }
         _sriVersions.clear();
+
+        // End any wait for credit that the reader will now never return; a
+        // port may still be waiting on the credit without its lock held, so
+        // stop it from using memory the subclass is about to release
+        if (_credit) {
+            _credit->close();
+            _credit->detach();
+        }
     }
 
     template <typename PortType>
@@ -69,7 +471,11 @@ namespace bulkio {
         } else {
             _sriVersions[streamID] = version;
         }
-        this->_pushSRI(sri);
+        if (_sender) {
+            _sender->queueSRI(sri);
+        } else {
+            this->_pushSRI(sri);
+        }
     }
 
     template <typename PortType>
@@ -79,7 +485,11 @@ namespace bulkio {
                                              const std::string& streamID,
                                              const BULKIO::StreamSRI& sri)
     {
-        this->_sendPacket(data, T, EOS, streamID, sri);
+        if (_sender) {
+            _sender->queuePacket(data, T, EOS, streamID, sri);
+        } else if (!_credit || _acquireCredit(_dataLength(data), EOS, 0)) {
+            this->_sendPacket(data, T, EOS, streamID, sri);
+        }
         if (EOS) {
             _sriVersions.erase(streamID);
         }
@@ -88,7 +498,11 @@ namespace bulkio {
     template <typename PortType>
     BULKIO::PortStatistics OutputTransport<PortType>::getStatistics()
     {
-        BULKIO::PortStatistics statistics = _stats.retrieve();
+        BULKIO::PortStatistics statistics;
+        {
+            boost::mutex::scoped_lock lock(_statsMutex);
+            statistics = _stats.retrieve();
+        }
 
         // Use our own stream tracking to fill in the statistics stream IDs
         statistics.streamIDs.length(0);
@@ -99,6 +513,29 @@ namespace bulkio {
         // Add extended statistics from subclasses to the keywords
         ossie::corba::extend(statistics.keywords, _getExtendedStatistics());
 
+        if (_credit) {
+            redhawk::PropertyMap credit;
+            credit["credit::window"] = (CORBA::ULongLong) _credit->window();
+            credit["credit::available"] = (CORBA::ULongLong) _credit->available();
+            {
+                boost::mutex::scoped_lock lock(_statsMutex);
+                credit["credit::exhausted"] = (CORBA::ULongLong) _creditExhausted;
+                credit["credit::dropped"] = (CORBA::ULongLong) _creditDropped;
+                credit["credit::wait_time"] = _creditWaitTime;
+            }
+            if (_creditPolicy == CREDIT_DROP) {
+                credit["credit::policy"] = std::string("drop");
+            } else {
+                credit["credit::policy"] = std::string("wait");
+            }
+            ossie::corba::extend(statistics.keywords, credit);
+        }
+
+        if (_sender) {
+            statistics.averageQueueDepth = _sender->averageQueueDepth();
+            ossie::corba::extend(statistics.keywords, _sender->getStatistics());
+        }
+
         return statistics;
     }
 
@@ -116,6 +553,8 @@ namespace bulkio {
     template <typename PortType>
     void OutputTransport<PortType>::_recordPush(const std::string& streamID, size_t elements, bool endOfStream)
     {
+        // May be called from the asynchronous sender thread
+        boost::mutex::scoped_lock lock(_statsMutex);
         _stats.update(elements, 0.0, endOfStream, streamID);
     }
 
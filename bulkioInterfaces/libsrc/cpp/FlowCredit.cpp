@@ -0,0 +1,118 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK bulkioInterfaces.
+ *
+ * REDHAWK bulkioInterfaces is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK bulkioInterfaces is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+#include "FlowCredit.h"
+
+#include <boost/thread/thread.hpp>
+
+namespace bulkio {
+
+    FlowCredit::FlowCredit(size_t window) :
+        _window(window),
+        _sent(0),
+        _localReturned(0),
+        _localClosed(0),
+        _returned(&_localReturned),
+        _closed(&_localClosed)
+    {
+    }
+
+    FlowCredit::FlowCredit(size_t window, volatile uint64_t* returned, volatile int32_t* closed) :
+        _window(window),
+        _sent(*returned),
+        _localReturned(0),
+        _localClosed(0),
+        _returned(returned),
+        _closed(closed)
+    {
+    }
+
+    size_t FlowCredit::available() const
+    {
+        const size_t pending = outstanding();
+        if (pending >= _window) {
+            return 0;
+        }
+        return _window - pending;
+    }
+
+    bool FlowCredit::canSend(size_t count) const
+    {
+        const size_t pending = outstanding();
+        return (pending == 0) || ((pending + count) <= _window);
+    }
+
+    bool FlowCredit::wait(size_t count, float timeout)
+    {
+        // Credit is returned without any notification, so poll with an
+        // increasing back-off; the shortest interval keeps the latency low
+        // when the reader is only slightly behind
+        const boost::system_time end = boost::get_system_time() + boost::posix_time::microseconds((long) (timeout * 1e6));
+        long delay = 10;
+        while (true) {
+            {
+                // The waiter may not be the thread that owns the connection,
+                // so check under the lock in case it is being detached
+                boost::mutex::scoped_lock lock(_mutex);
+                if (canSend(count)) {
+                    return true;
+                } else if (isClosed()) {
+                    return false;
+                }
+            }
+            if (boost::get_system_time() >= end) {
+                return false;
+            }
+            boost::this_thread::sleep(boost::posix_time::microseconds(delay));
+            if (delay < 1000) {
+                delay *= 2;
+            }
+        }
+    }
+
+    void FlowCredit::release(size_t count)
+    {
+        if (count == 0) {
+            return;
+        }
+        boost::mutex::scoped_lock lock(_mutex);
+        __sync_add_and_fetch(_returned, count);
+    }
+
+    void FlowCredit::detach()
+    {
+        boost::mutex::scoped_lock lock(_mutex);
+        _localReturned = *_returned;
+        _localClosed = *_closed;
+        _returned = &_localReturned;
+        _closed = &_localClosed;
+    }
+
+    void FlowCredit::close()
+    {
+        *_closed = 1;
+        __sync_synchronize();
+    }
+
+    bool FlowCredit::isClosed() const
+    {
+        return *_closed;
+    }
+}
@@ -0,0 +1,114 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK bulkioInterfaces.
+ *
+ * REDHAWK bulkioInterfaces is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK bulkioInterfaces is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+#ifndef __bulkio_flowcredit_h
+#define __bulkio_flowcredit_h
+
+#include <cstddef>
+#include <stdint.h>
+
+#include <boost/thread/mutex.hpp>
+
+namespace bulkio {
+
+    /**
+     * Credit-based flow control state for a single connection.
+     *
+     * The reader advertises a window of elements. The writer charges each
+     * packet against the window as it is sent, and the reader returns the
+     * credit once the packet leaves its input queue (whether it was read,
+     * flushed or discarded). The amount of credit outstanding is therefore
+     * the number of elements between the writer and the reader's consumer.
+     *
+     * The returned-credit counter and closed flag may be supplied by the
+     * caller so that they can live in memory shared between processes; the
+     * writer and reader then each have their own FlowCredit pointing at the
+     * same counters. Within a process, a single instance can serve both
+     * sides. The writer-side methods other than wait() must only be called
+     * from one thread at a time; release() may be called from any thread.
+     */
+    class FlowCredit {
+    public:
+        explicit FlowCredit(size_t window);
+        FlowCredit(size_t window, volatile uint64_t* returned, volatile int32_t* closed);
+
+        size_t window() const
+        {
+            return _window;
+        }
+
+        // Writer: number of elements sent that the reader has not returned
+        size_t outstanding() const
+        {
+            return _sent - *_returned;
+        }
+
+        // Writer: number of elements that may be sent without exceeding the
+        // window
+        size_t available() const;
+
+        // Writer: returns true if a packet of count elements may be sent now;
+        // a packet larger than the whole window is allowed once nothing else
+        // is outstanding, so that it cannot stall forever
+        bool canSend(size_t count) const;
+
+        // Writer: records that count elements have been sent
+        void charge(size_t count)
+        {
+            __sync_add_and_fetch(&_sent, count);
+        }
+
+        // Writer: waits for up to timeout seconds for canSend(count) to become
+        // true, returning false if it did not (including if the connection
+        // was closed). Safe to call from any thread, including after the
+        // connection has been detached.
+        bool wait(size_t count, float timeout);
+
+        // Reader: returns count elements of credit to the writer
+        void release(size_t count);
+
+        // Either side: stops using the shared counters, which must be done
+        // before the memory that holds them is unmapped; on the reader side,
+        // packets still queued may release their credit afterwards
+        void detach();
+
+        // Either side: marks the connection as closed, ending any wait
+        void close();
+        bool isClosed() const;
+
+    private:
+        // Non-copyable, non-assignable
+        FlowCredit(const FlowCredit&);
+        FlowCredit& operator=(const FlowCredit&);
+
+        const size_t _window;
+        volatile uint64_t _sent;
+
+        volatile uint64_t _localReturned;
+        volatile int32_t _localClosed;
+        volatile uint64_t* _returned;
+        volatile int32_t* _closed;
+
+        // Serializes release() and wait() with detach()
+        boost::mutex _mutex;
+    };
+}
+
+#endif // __bulkio_flowcredit_h
@@ -23,6 +23,7 @@
 #include <bulkio_in_port.h>
 
 #include "bulkio_p.h"
+#include "FlowCredit.h"
 
 namespace bulkio {
 
@@ -44,6 +45,13 @@ namespace bulkio {
         _localPort(localPort)
     {
         _localPort->_add_ref();
+
+        // There is no negotiation for local connections, so the receiver's
+        // credit window is read directly; both sides share one credit object
+        const size_t window = _localPort->getCreditWindow();
+        if (window > 0) {
+            this->_enableCredit(boost::make_shared<FlowCredit>(window));
+        }
     }
 
     template <typename PortType>
@@ -61,7 +69,11 @@ namespace bulkio {
     template <typename PortType>
     CF::Properties LocalTransport<PortType>::transportInfo() const
     {
-        return CF::Properties();
+        redhawk::PropertyMap info;
+        if (this->_credit) {
+            info["credit_window"] = (CORBA::ULongLong) this->_credit->window();
+        }
+        return info;
     }
 
     template <typename PortType>
@@ -76,7 +88,7 @@ namespace bulkio {
                              bool EOS,
                              const std::string& streamID)
     {
-        _localPort->queuePacket(data, T, EOS, streamID);
+        _localPort->queuePacket(data, T, EOS, streamID, this->_credit);
     }
 
 #define INSTANTIATE_TEMPLATE(x) template class LocalTransport<x>;
@@ -0,0 +1,101 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK bulkioInterfaces.
+ *
+ * REDHAWK bulkioInterfaces is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK bulkioInterfaces is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+#include "MirroredBuffer.h"
+
+#include <cerrno>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+namespace bulkio {
+
+    namespace detail {
+
+        namespace {
+            std::string make_unique_name(const void* self)
+            {
+                // Same scheme as ShmRing: process ID plus the object address;
+                // the name is unlinked as soon as the file is open
+                std::ostringstream oss;
+                oss << "/bulkio-mirror-" << getpid() << '-' << std::hex << (size_t) self;
+                return oss.str();
+            }
+
+            std::runtime_error mapping_error(const std::string& what)
+            {
+                return std::runtime_error(what + ": " + strerror(errno));
+            }
+        }
+
+        MirroredBuffer::MirroredBuffer(size_t bytes) :
+            _data(0),
+            _size(0)
+        {
+            const size_t page_size = sysconf(_SC_PAGESIZE);
+            if (bytes == 0) {
+                bytes = page_size;
+            }
+            _size = ((bytes + page_size - 1) / page_size) * page_size;
+
+            const std::string name = make_unique_name(this);
+            int fd = shm_open(name.c_str(), O_RDWR|O_CREAT|O_EXCL, 0600);
+            if (fd < 0) {
+                throw mapping_error("cannot create mirrored buffer file");
+            }
+            shm_unlink(name.c_str());
+
+            if (ftruncate(fd, _size) != 0) {
+                ::close(fd);
+                throw mapping_error("cannot size mirrored buffer file");
+            }
+
+            // Reserve enough address space for both copies, then map the file
+            // over each half; MAP_FIXED atomically replaces the reservation,
+            // so no other mapping can land in between
+            void* base = mmap(0, _size * 2, PROT_NONE, MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+            if (base == MAP_FAILED) {
+                ::close(fd);
+                throw mapping_error("cannot reserve mirrored buffer address space");
+            }
+            char* first = static_cast<char*>(base);
+            if ((mmap(first, _size, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_FIXED, fd, 0) == MAP_FAILED) ||
+                (mmap(first + _size, _size, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_FIXED, fd, 0) == MAP_FAILED)) {
+                std::runtime_error error = mapping_error("cannot map mirrored buffer");
+                munmap(base, _size * 2);
+                ::close(fd);
+                throw error;
+            }
+
+            // The mappings keep the file alive
+            ::close(fd);
+            _data = first;
+        }
+
+        MirroredBuffer::~MirroredBuffer()
+        {
+            munmap(_data, _size * 2);
+        }
+    }
+}
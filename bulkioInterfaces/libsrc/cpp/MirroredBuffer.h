@@ -0,0 +1,70 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK bulkioInterfaces.
+ *
+ * REDHAWK bulkioInterfaces is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK bulkioInterfaces is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+#ifndef __bulkio_mirroredbuffer_h
+#define __bulkio_mirroredbuffer_h
+
+#include <cstddef>
+
+namespace bulkio {
+
+    namespace detail {
+
+        /**
+         * Circular buffer memory with a mirrored virtual mapping.
+         *
+         * The same physical pages are mapped twice, back-to-back, so that
+         * any range of up to size() bytes starting anywhere in the first
+         * mapping is contiguous in virtual memory, even if it wraps around
+         * the end of the buffer. The size is rounded up to a multiple of the
+         * system page size.
+         *
+         * Construction throws std::runtime_error if the mapping cannot be
+         * created.
+         */
+        class MirroredBuffer {
+        public:
+            explicit MirroredBuffer(size_t bytes);
+            ~MirroredBuffer();
+
+            // Base address of the first mapping; the mirror begins at
+            // data() + size()
+            char* data() const
+            {
+                return _data;
+            }
+
+            size_t size() const
+            {
+                return _size;
+            }
+
+        private:
+            // Non-copyable, non-assignable
+            MirroredBuffer(const MirroredBuffer&);
+            MirroredBuffer& operator=(const MirroredBuffer&);
+
+            char* _data;
+            size_t _size;
+        };
+    }
+}
+
+#endif // __bulkio_mirroredbuffer_h
@@ -0,0 +1,1128 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK bulkioInterfaces.
+ *
+ * REDHAWK bulkioInterfaces is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK bulkioInterfaces is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+#include "bulkio_convert.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+// Function-level target attributes with x86 intrinsics require GCC 4.9 (see
+// also redhawk/bitops.cpp)
+#if defined(__x86_64__) && defined(__GNUC__) && !defined(__clang__) && ((__GNUC__ > 4) || ((__GNUC__ == 4) && (__GNUC_MINOR__ >= 9)))
+#define CONVERT_X86_KERNELS 1
+#include <immintrin.h>
+#endif
+
+namespace bulkio {
+
+    namespace convert {
+
+        namespace {
+
+            //
+            // Portable implementations, also used to finish off the tail of
+            // the arrays in the SIMD kernels
+            //
+            template <typename In, typename Out>
+            inline void scale_generic(const In* src, Out* dst, size_t count, Out scale)
+            {
+                for (size_t index = 0; index < count; ++index) {
+                    dst[index] = static_cast<Out>(src[index]) * scale;
+                }
+            }
+
+            inline float next_down(float value)
+            {
+                return nextafterf(value, 0.0f);
+            }
+
+            inline double next_down(double value)
+            {
+                return nextafter(value, 0.0);
+            }
+
+            // Largest floating point value of type F that does not exceed the
+            // maximum of the integer type I (e.g., 2^31 is not representable
+            // as an int32_t, and the next float down is 2^31-128)
+            template <typename I, typename F>
+            inline F saturate_max()
+            {
+                F value = static_cast<F>(std::numeric_limits<I>::max());
+                if (static_cast<long double>(value) > static_cast<long double>(std::numeric_limits<I>::max())) {
+                    value = next_down(value);
+                }
+                return value;
+            }
+
+            template <typename In, typename Out>
+            inline void quantize_generic(const In* src, Out* dst, size_t count, In scale)
+            {
+                const In low = static_cast<In>(std::numeric_limits<Out>::min());
+                const In high = saturate_max<Out,In>();
+                for (size_t index = 0; index < count; ++index) {
+                    In value = src[index] * scale;
+                    value = std::max(low, std::min(high, value));
+                    // Round to nearest (even), matching the SIMD conversions
+                    dst[index] = static_cast<Out>(llrint(value));
+                }
+            }
+
+            template <typename T>
+            inline void deinterleave_generic(const T* src, T* real, T* imag, size_t count)
+            {
+                for (size_t index = 0; index < count; ++index) {
+                    real[index] = src[index*2];
+                    imag[index] = src[index*2+1];
+                }
+            }
+
+            template <typename T>
+            inline void interleave_generic(const T* real, const T* imag, T* dst, size_t count)
+            {
+                for (size_t index = 0; index < count; ++index) {
+                    dst[index*2] = real[index];
+                    dst[index*2+1] = imag[index];
+                }
+            }
+
+            inline void bswap16_generic(const void* src, void* dst, size_t count)
+            {
+                const uint16_t* in = static_cast<const uint16_t*>(src);
+                uint16_t* out = static_cast<uint16_t*>(dst);
+                for (size_t index = 0; index < count; ++index) {
+                    out[index] = (in[index] >> 8) | (in[index] << 8);
+                }
+            }
+
+            inline void bswap32_generic(const void* src, void* dst, size_t count)
+            {
+                const uint32_t* in = static_cast<const uint32_t*>(src);
+                uint32_t* out = static_cast<uint32_t*>(dst);
+                for (size_t index = 0; index < count; ++index) {
+                    out[index] = __builtin_bswap32(in[index]);
+                }
+            }
+
+            inline void bswap64_generic(const void* src, void* dst, size_t count)
+            {
+                const uint64_t* in = static_cast<const uint64_t*>(src);
+                uint64_t* out = static_cast<uint64_t*>(dst);
+                for (size_t index = 0; index < count; ++index) {
+                    out[index] = __builtin_bswap64(in[index]);
+                }
+            }
+
+            // Non-inline wrappers for the kernel table
+            template <typename In>
+            void to_float_generic(const In* src, float* dst, size_t count, float scale)
+            {
+                scale_generic(src, dst, count, scale);
+            }
+
+            template <typename Out>
+            void from_float_generic(const float* src, Out* dst, size_t count, float scale)
+            {
+                quantize_generic(src, dst, count, scale);
+            }
+
+            template <typename T>
+            void deinterleave_table_generic(const T* src, T* real, T* imag, size_t count)
+            {
+                deinterleave_generic(src, real, imag, count);
+            }
+
+            template <typename T>
+            void interleave_table_generic(const T* real, const T* imag, T* dst, size_t count)
+            {
+                interleave_generic(real, imag, dst, count);
+            }
+
+            void bswap16_table_generic(const void* src, void* dst, size_t count)
+            {
+                bswap16_generic(src, dst, count);
+            }
+
+            void bswap32_table_generic(const void* src, void* dst, size_t count)
+            {
+                bswap32_generic(src, dst, count);
+            }
+
+            void bswap64_table_generic(const void* src, void* dst, size_t count)
+            {
+                bswap64_generic(src, dst, count);
+            }
+
+#ifdef CONVERT_X86_KERNELS
+            //
+            // SSE4.1 kernels (sign/zero extension, unsigned 32-bit packing and
+            // SSSE3 byte shuffles)
+            //
+            __attribute__((target("sse4.1")))
+            void s8_to_float_sse41(const int8_t* src, float* dst, size_t count, float scale)
+            {
+                const __m128 factor = _mm_set1_ps(scale);
+                size_t index = 0;
+                for (; (index + 16) <= count; index += 16) {
+                    __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + index));
+                    for (int part = 0; part < 4; ++part) {
+                        __m128i words = _mm_cvtepi8_epi32(bytes);
+                        _mm_storeu_ps(dst + index + part*4, _mm_mul_ps(_mm_cvtepi32_ps(words), factor));
+                        bytes = _mm_srli_si128(bytes, 4);
+                    }
+                }
+                scale_generic(src + index, dst + index, count - index, scale);
+            }
+
+            __attribute__((target("sse4.1")))
+            void u8_to_float_sse41(const uint8_t* src, float* dst, size_t count, float scale)
+            {
+                const __m128 factor = _mm_set1_ps(scale);
+                size_t index = 0;
+                for (; (index + 16) <= count; index += 16) {
+                    __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + index));
+                    for (int part = 0; part < 4; ++part) {
+                        __m128i words = _mm_cvtepu8_epi32(bytes);
+                        _mm_storeu_ps(dst + index + part*4, _mm_mul_ps(_mm_cvtepi32_ps(words), factor));
+                        bytes = _mm_srli_si128(bytes, 4);
+                    }
+                }
+                scale_generic(src + index, dst + index, count - index, scale);
+            }
+
+            __attribute__((target("sse4.1")))
+            void s16_to_float_sse41(const int16_t* src, float* dst, size_t count, float scale)
+            {
+                const __m128 factor = _mm_set1_ps(scale);
+                size_t index = 0;
+                for (; (index + 8) <= count; index += 8) {
+                    __m128i shorts = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + index));
+                    __m128i low = _mm_cvtepi16_epi32(shorts);
+                    __m128i high = _mm_cvtepi16_epi32(_mm_srli_si128(shorts, 8));
+                    _mm_storeu_ps(dst + index, _mm_mul_ps(_mm_cvtepi32_ps(low), factor));
+                    _mm_storeu_ps(dst + index + 4, _mm_mul_ps(_mm_cvtepi32_ps(high), factor));
+                }
+                scale_generic(src + index, dst + index, count - index, scale);
+            }
+
+            __attribute__((target("sse4.1")))
+            void u16_to_float_sse41(const uint16_t* src, float* dst, size_t count, float scale)
+            {
+                const __m128 factor = _mm_set1_ps(scale);
+                size_t index = 0;
+                for (; (index + 8) <= count; index += 8) {
+                    __m128i shorts = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + index));
+                    __m128i low = _mm_cvtepu16_epi32(shorts);
+                    __m128i high = _mm_cvtepu16_epi32(_mm_srli_si128(shorts, 8));
+                    _mm_storeu_ps(dst + index, _mm_mul_ps(_mm_cvtepi32_ps(low), factor));
+                    _mm_storeu_ps(dst + index + 4, _mm_mul_ps(_mm_cvtepi32_ps(high), factor));
+                }
+                scale_generic(src + index, dst + index, count - index, scale);
+            }
+
+            __attribute__((target("sse4.1")))
+            void s32_to_float_sse41(const int32_t* src, float* dst, size_t count, float scale)
+            {
+                const __m128 factor = _mm_set1_ps(scale);
+                size_t index = 0;
+                for (; (index + 4) <= count; index += 4) {
+                    __m128i words = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + index));
+                    _mm_storeu_ps(dst + index, _mm_mul_ps(_mm_cvtepi32_ps(words), factor));
+                }
+                scale_generic(src + index, dst + index, count - index, scale);
+            }
+
+            // Scales and clamps 4 floats to [low, high], then converts to
+            // 32-bit integers with the default (nearest-even) rounding
+            __attribute__((target("sse4.1")))
+            inline __m128i quantize_sse41(const float* src, __m128 factor, __m128 low, __m128 high)
+            {
+                __m128 value = _mm_mul_ps(_mm_loadu_ps(src), factor);
+                return _mm_cvtps_epi32(_mm_max_ps(low, _mm_min_ps(high, value)));
+            }
+
+            __attribute__((target("sse4.1")))
+            void float_to_s8_sse41(const float* src, int8_t* dst, size_t count, float scale)
+            {
+                const __m128 factor = _mm_set1_ps(scale);
+                const __m128 low = _mm_set1_ps(-128.0f);
+                const __m128 high = _mm_set1_ps(127.0f);
+                size_t index = 0;
+                for (; (index + 16) <= count; index += 16) {
+                    __m128i a = _mm_packs_epi32(quantize_sse41(src + index, factor, low, high),
+                                                quantize_sse41(src + index + 4, factor, low, high));
+                    __m128i b = _mm_packs_epi32(quantize_sse41(src + index + 8, factor, low, high),
+                                                quantize_sse41(src + index + 12, factor, low, high));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + index), _mm_packs_epi16(a, b));
+                }
+                quantize_generic(src + index, dst + index, count - index, scale);
+            }
+
+            __attribute__((target("sse4.1")))
+            void float_to_u8_sse41(const float* src, uint8_t* dst, size_t count, float scale)
+            {
+                const __m128 factor = _mm_set1_ps(scale);
+                const __m128 low = _mm_set1_ps(0.0f);
+                const __m128 high = _mm_set1_ps(255.0f);
+                size_t index = 0;
+                for (; (index + 16) <= count; index += 16) {
+                    __m128i a = _mm_packs_epi32(quantize_sse41(src + index, factor, low, high),
+                                                quantize_sse41(src + index + 4, factor, low, high));
+                    __m128i b = _mm_packs_epi32(quantize_sse41(src + index + 8, factor, low, high),
+                                                quantize_sse41(src + index + 12, factor, low, high));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + index), _mm_packus_epi16(a, b));
+                }
+                quantize_generic(src + index, dst + index, count - index, scale);
+            }
+
+            __attribute__((target("sse4.1")))
+            void float_to_s16_sse41(const float* src, int16_t* dst, size_t count, float scale)
+            {
+                const __m128 factor = _mm_set1_ps(scale);
+                const __m128 low = _mm_set1_ps(-32768.0f);
+                const __m128 high = _mm_set1_ps(32767.0f);
+                size_t index = 0;
+                for (; (index + 8) <= count; index += 8) {
+                    __m128i shorts = _mm_packs_epi32(quantize_sse41(src + index, factor, low, high),
+                                                     quantize_sse41(src + index + 4, factor, low, high));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + index), shorts);
+                }
+                quantize_generic(src + index, dst + index, count - index, scale);
+            }
+
+            __attribute__((target("sse4.1")))
+            void float_to_u16_sse41(const float* src, uint16_t* dst, size_t count, float scale)
+            {
+                const __m128 factor = _mm_set1_ps(scale);
+                const __m128 low = _mm_set1_ps(0.0f);
+                const __m128 high = _mm_set1_ps(65535.0f);
+                size_t index = 0;
+                for (; (index + 8) <= count; index += 8) {
+                    __m128i shorts = _mm_packus_epi32(quantize_sse41(src + index, factor, low, high),
+                                                      quantize_sse41(src + index + 4, factor, low, high));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + index), shorts);
+                }
+                quantize_generic(src + index, dst + index, count - index, scale);
+            }
+
+            __attribute__((target("sse4.1")))
+            void float_to_s32_sse41(const float* src, int32_t* dst, size_t count, float scale)
+            {
+                const __m128 factor = _mm_set1_ps(scale);
+                const __m128 low = _mm_set1_ps(-2147483648.0f);
+                const __m128 high = _mm_set1_ps(saturate_max<int32_t,float>());
+                size_t index = 0;
+                for (; (index + 4) <= count; index += 4) {
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + index), quantize_sse41(src + index, factor, low, high));
+                }
+                quantize_generic(src + index, dst + index, count - index, scale);
+            }
+
+            __attribute__((target("sse4.1")))
+            void deinterleave_float_sse41(const float* src, float* real, float* imag, size_t count)
+            {
+                size_t index = 0;
+                for (; (index + 4) <= count; index += 4) {
+                    __m128 a = _mm_loadu_ps(src + index*2);
+                    __m128 b = _mm_loadu_ps(src + index*2 + 4);
+                    _mm_storeu_ps(real + index, _mm_shuffle_ps(a, b, _MM_SHUFFLE(2,0,2,0)));
+                    _mm_storeu_ps(imag + index, _mm_shuffle_ps(a, b, _MM_SHUFFLE(3,1,3,1)));
+                }
+                deinterleave_generic(src + index*2, real + index, imag + index, count - index);
+            }
+
+            __attribute__((target("sse4.1")))
+            void interleave_float_sse41(const float* real, const float* imag, float* dst, size_t count)
+            {
+                size_t index = 0;
+                for (; (index + 4) <= count; index += 4) {
+                    __m128 re = _mm_loadu_ps(real + index);
+                    __m128 im = _mm_loadu_ps(imag + index);
+                    _mm_storeu_ps(dst + index*2, _mm_unpacklo_ps(re, im));
+                    _mm_storeu_ps(dst + index*2 + 4, _mm_unpackhi_ps(re, im));
+                }
+                interleave_generic(real + index, imag + index, dst + index*2, count - index);
+            }
+
+            __attribute__((target("sse4.1")))
+            void deinterleave_s16_sse41(const int16_t* src, int16_t* real, int16_t* imag, size_t count)
+            {
+                // Gathers the even (real) shorts into the low half and the odd
+                // (imaginary) shorts into the high half
+                const __m128i split = _mm_setr_epi8(0,1,4,5,8,9,12,13, 2,3,6,7,10,11,14,15);
+                size_t index = 0;
+                for (; (index + 8) <= count; index += 8) {
+                    __m128i a = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + index*2)), split);
+                    __m128i b = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + index*2 + 8)), split);
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(real + index), _mm_unpacklo_epi64(a, b));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(imag + index), _mm_unpackhi_epi64(a, b));
+                }
+                deinterleave_generic(src + index*2, real + index, imag + index, count - index);
+            }
+
+            __attribute__((target("sse4.1")))
+            void interleave_s16_sse41(const int16_t* real, const int16_t* imag, int16_t* dst, size_t count)
+            {
+                size_t index = 0;
+                for (; (index + 8) <= count; index += 8) {
+                    __m128i re = _mm_loadu_si128(reinterpret_cast<const __m128i*>(real + index));
+                    __m128i im = _mm_loadu_si128(reinterpret_cast<const __m128i*>(imag + index));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + index*2), _mm_unpacklo_epi16(re, im));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + index*2 + 8), _mm_unpackhi_epi16(re, im));
+                }
+                interleave_generic(real + index, imag + index, dst + index*2, count - index);
+            }
+
+            // Byte swap with a shuffle mask; processes whole 16-byte vectors
+            // and returns the number of bytes handled
+            __attribute__((target("sse4.1")))
+            inline size_t bswap_sse41(const void* src, void* dst, size_t bytes, __m128i mask)
+            {
+                const char* in = static_cast<const char*>(src);
+                char* out = static_cast<char*>(dst);
+                size_t offset = 0;
+                for (; (offset + 16) <= bytes; offset += 16) {
+                    __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + offset));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + offset), _mm_shuffle_epi8(value, mask));
+                }
+                return offset;
+            }
+
+            __attribute__((target("sse4.1")))
+            void bswap16_sse41(const void* src, void* dst, size_t count)
+            {
+                const __m128i mask = _mm_setr_epi8(1,0,3,2,5,4,7,6,9,8,11,10,13,12,15,14);
+                size_t done = bswap_sse41(src, dst, count * 2, mask) / 2;
+                bswap16_generic(static_cast<const uint16_t*>(src) + done, static_cast<uint16_t*>(dst) + done, count - done);
+            }
+
+            __attribute__((target("sse4.1")))
+            void bswap32_sse41(const void* src, void* dst, size_t count)
+            {
+                const __m128i mask = _mm_setr_epi8(3,2,1,0,7,6,5,4,11,10,9,8,15,14,13,12);
+                size_t done = bswap_sse41(src, dst, count * 4, mask) / 4;
+                bswap32_generic(static_cast<const uint32_t*>(src) + done, static_cast<uint32_t*>(dst) + done, count - done);
+            }
+
+            __attribute__((target("sse4.1")))
+            void bswap64_sse41(const void* src, void* dst, size_t count)
+            {
+                const __m128i mask = _mm_setr_epi8(7,6,5,4,3,2,1,0,15,14,13,12,11,10,9,8);
+                size_t done = bswap_sse41(src, dst, count * 8, mask) / 8;
+                bswap64_generic(static_cast<const uint64_t*>(src) + done, static_cast<uint64_t*>(dst) + done, count - done);
+            }
+
+            //
+            // AVX2 kernels
+            //
+            __attribute__((target("avx2")))
+            void s8_to_float_avx2(const int8_t* src, float* dst, size_t count, float scale)
+            {
+                const __m256 factor = _mm256_set1_ps(scale);
+                size_t index = 0;
+                for (; (index + 8) <= count; index += 8) {
+                    __m128i bytes = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + index));
+                    __m256 value = _mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(bytes));
+                    _mm256_storeu_ps(dst + index, _mm256_mul_ps(value, factor));
+                }
+                scale_generic(src + index, dst + index, count - index, scale);
+            }
+
+            __attribute__((target("avx2")))
+            void u8_to_float_avx2(const uint8_t* src, float* dst, size_t count, float scale)
+            {
+                const __m256 factor = _mm256_set1_ps(scale);
+                size_t index = 0;
+                for (; (index + 8) <= count; index += 8) {
+                    __m128i bytes = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + index));
+                    __m256 value = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(bytes));
+                    _mm256_storeu_ps(dst + index, _mm256_mul_ps(value, factor));
+                }
+                scale_generic(src + index, dst + index, count - index, scale);
+            }
+
+            __attribute__((target("avx2")))
+            void s16_to_float_avx2(const int16_t* src, float* dst, size_t count, float scale)
+            {
+                const __m256 factor = _mm256_set1_ps(scale);
+                size_t index = 0;
+                for (; (index + 8) <= count; index += 8) {
+                    __m128i shorts = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + index));
+                    __m256 value = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(shorts));
+                    _mm256_storeu_ps(dst + index, _mm256_mul_ps(value, factor));
+                }
+                scale_generic(src + index, dst + index, count - index, scale);
+            }
+
+            __attribute__((target("avx2")))
+            void u16_to_float_avx2(const uint16_t* src, float* dst, size_t count, float scale)
+            {
+                const __m256 factor = _mm256_set1_ps(scale);
+                size_t index = 0;
+                for (; (index + 8) <= count; index += 8) {
+                    __m128i shorts = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + index));
+                    __m256 value = _mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(shorts));
+                    _mm256_storeu_ps(dst + index, _mm256_mul_ps(value, factor));
+                }
+                scale_generic(src + index, dst + index, count - index, scale);
+            }
+
+            __attribute__((target("avx2")))
+            void s32_to_float_avx2(const int32_t* src, float* dst, size_t count, float scale)
+            {
+                const __m256 factor = _mm256_set1_ps(scale);
+                size_t index = 0;
+                for (; (index + 8) <= count; index += 8) {
+                    __m256i words = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + index));
+                    _mm256_storeu_ps(dst + index, _mm256_mul_ps(_mm256_cvtepi32_ps(words), factor));
+                }
+                scale_generic(src + index, dst + index, count - index, scale);
+            }
+
+            __attribute__((target("avx2")))
+            inline __m256i quantize_avx2(const float* src, __m256 factor, __m256 low, __m256 high)
+            {
+                __m256 value = _mm256_mul_ps(_mm256_loadu_ps(src), factor);
+                return _mm256_cvtps_epi32(_mm256_max_ps(low, _mm256_min_ps(high, value)));
+            }
+
+            // Narrows 8 clamped 32-bit integers to 16 bits (the clamping
+            // guarantees that saturation never applies)
+            __attribute__((target("avx2")))
+            inline __m128i narrow_avx2(__m256i words)
+            {
+                return _mm_packs_epi32(_mm256_castsi256_si128(words), _mm256_extracti128_si256(words, 1));
+            }
+
+            __attribute__((target("avx2")))
+            void float_to_s8_avx2(const float* src, int8_t* dst, size_t count, float scale)
+            {
+                const __m256 factor = _mm256_set1_ps(scale);
+                const __m256 low = _mm256_set1_ps(-128.0f);
+                const __m256 high = _mm256_set1_ps(127.0f);
+                size_t index = 0;
+                for (; (index + 16) <= count; index += 16) {
+                    __m128i a = narrow_avx2(quantize_avx2(src + index, factor, low, high));
+                    __m128i b = narrow_avx2(quantize_avx2(src + index + 8, factor, low, high));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + index), _mm_packs_epi16(a, b));
+                }
+                quantize_generic(src + index, dst + index, count - index, scale);
+            }
+
+            __attribute__((target("avx2")))
+            void float_to_u8_avx2(const float* src, uint8_t* dst, size_t count, float scale)
+            {
+                const __m256 factor = _mm256_set1_ps(scale);
+                const __m256 low = _mm256_set1_ps(0.0f);
+                const __m256 high = _mm256_set1_ps(255.0f);
+                size_t index = 0;
+                for (; (index + 16) <= count; index += 16) {
+                    __m128i a = narrow_avx2(quantize_avx2(src + index, factor, low, high));
+                    __m128i b = narrow_avx2(quantize_avx2(src + index + 8, factor, low, high));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + index), _mm_packus_epi16(a, b));
+                }
+                quantize_generic(src + index, dst + index, count - index, scale);
+            }
+
+            __attribute__((target("avx2")))
+            void float_to_s16_avx2(const float* src, int16_t* dst, size_t count, float scale)
+            {
+                const __m256 factor = _mm256_set1_ps(scale);
+                const __m256 low = _mm256_set1_ps(-32768.0f);
+                const __m256 high = _mm256_set1_ps(32767.0f);
+                size_t index = 0;
+                for (; (index + 16) <= count; index += 16) {
+                    __m256i a = quantize_avx2(src + index, factor, low, high);
+                    __m256i b = quantize_avx2(src + index + 8, factor, low, high);
+                    // Packing works within 128-bit lanes; restore the order
+                    __m256i shorts = _mm256_permute4x64_epi64(_mm256_packs_epi32(a, b), _MM_SHUFFLE(3,1,2,0));
+                    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + index), shorts);
+                }
+                quantize_generic(src + index, dst + index, count - index, scale);
+            }
+
+            __attribute__((target("avx2")))
+            void float_to_u16_avx2(const float* src, uint16_t* dst, size_t count, float scale)
+            {
+                const __m256 factor = _mm256_set1_ps(scale);
+                const __m256 low = _mm256_set1_ps(0.0f);
+                const __m256 high = _mm256_set1_ps(65535.0f);
+                size_t index = 0;
+                for (; (index + 16) <= count; index += 16) {
+                    __m256i a = quantize_avx2(src + index, factor, low, high);
+                    __m256i b = quantize_avx2(src + index + 8, factor, low, high);
+                    __m256i shorts = _mm256_permute4x64_epi64(_mm256_packus_epi32(a, b), _MM_SHUFFLE(3,1,2,0));
+                    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + index), shorts);
+                }
+                quantize_generic(src + index, dst + index, count - index, scale);
+            }
+
+            __attribute__((target("avx2")))
+            void float_to_s32_avx2(const float* src, int32_t* dst, size_t count, float scale)
+            {
+                const __m256 factor = _mm256_set1_ps(scale);
+                const __m256 low = _mm256_set1_ps(-2147483648.0f);
+                const __m256 high = _mm256_set1_ps(saturate_max<int32_t,float>());
+                size_t index = 0;
+                for (; (index + 8) <= count; index += 8) {
+                    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + index), quantize_avx2(src + index, factor, low, high));
+                }
+                quantize_generic(src + index, dst + index, count - index, scale);
+            }
+
+            __attribute__((target("avx2")))
+            void deinterleave_float_avx2(const float* src, float* real, float* imag, size_t count)
+            {
+                size_t index = 0;
+                for (; (index + 8) <= count; index += 8) {
+                    __m256 a = _mm256_loadu_ps(src + index*2);
+                    __m256 b = _mm256_loadu_ps(src + index*2 + 8);
+                    // Shuffles operate within 128-bit lanes, leaving pairs of
+                    // values out of order
+                    __m256d re = _mm256_castps_pd(_mm256_shuffle_ps(a, b, _MM_SHUFFLE(2,0,2,0)));
+                    __m256d im = _mm256_castps_pd(_mm256_shuffle_ps(a, b, _MM_SHUFFLE(3,1,3,1)));
+                    _mm256_storeu_ps(real + index, _mm256_castpd_ps(_mm256_permute4x64_pd(re, _MM_SHUFFLE(3,1,2,0))));
+                    _mm256_storeu_ps(imag + index, _mm256_castpd_ps(_mm256_permute4x64_pd(im, _MM_SHUFFLE(3,1,2,0))));
+                }
+                deinterleave_generic(src + index*2, real + index, imag + index, count - index);
+            }
+
+            __attribute__((target("avx2")))
+            void interleave_float_avx2(const float* real, const float* imag, float* dst, size_t count)
+            {
+                size_t index = 0;
+                for (; (index + 8) <= count; index += 8) {
+                    __m256 re = _mm256_loadu_ps(real + index);
+                    __m256 im = _mm256_loadu_ps(imag + index);
+                    __m256 low = _mm256_unpacklo_ps(re, im);
+                    __m256 high = _mm256_unpackhi_ps(re, im);
+                    _mm256_storeu_ps(dst + index*2, _mm256_permute2f128_ps(low, high, 0x20));
+                    _mm256_storeu_ps(dst + index*2 + 8, _mm256_permute2f128_ps(low, high, 0x31));
+                }
+                interleave_generic(real + index, imag + index, dst + index*2, count - index);
+            }
+
+            __attribute__((target("avx2")))
+            void deinterleave_s16_avx2(const int16_t* src, int16_t* real, int16_t* imag, size_t count)
+            {
+                const __m256i split = _mm256_setr_epi8(0,1,4,5,8,9,12,13, 2,3,6,7,10,11,14,15,
+                                                       0,1,4,5,8,9,12,13, 2,3,6,7,10,11,14,15);
+                size_t index = 0;
+                for (; (index + 16) <= count; index += 16) {
+                    // Within each lane, gather real values into the low 64 bits
+                    // and imaginary into the high, then group the 64-bit halves
+                    __m256i a = _mm256_shuffle_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + index*2)), split);
+                    __m256i b = _mm256_shuffle_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + index*2 + 16)), split);
+                    a = _mm256_permute4x64_epi64(a, _MM_SHUFFLE(3,1,2,0));
+                    b = _mm256_permute4x64_epi64(b, _MM_SHUFFLE(3,1,2,0));
+                    _mm256_storeu_si256(reinterpret_cast<__m256i*>(real + index), _mm256_permute2x128_si256(a, b, 0x20));
+                    _mm256_storeu_si256(reinterpret_cast<__m256i*>(imag + index), _mm256_permute2x128_si256(a, b, 0x31));
+                }
+                deinterleave_generic(src + index*2, real + index, imag + index, count - index);
+            }
+
+            __attribute__((target("avx2")))
+            void interleave_s16_avx2(const int16_t* real, const int16_t* imag, int16_t* dst, size_t count)
+            {
+                size_t index = 0;
+                for (; (index + 16) <= count; index += 16) {
+                    __m256i re = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(real + index));
+                    __m256i im = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(imag + index));
+                    __m256i low = _mm256_unpacklo_epi16(re, im);
+                    __m256i high = _mm256_unpackhi_epi16(re, im);
+                    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + index*2), _mm256_permute2x128_si256(low, high, 0x20));
+                    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + index*2 + 16), _mm256_permute2x128_si256(low, high, 0x31));
+                }
+                interleave_generic(real + index, imag + index, dst + index*2, count - index);
+            }
+
+            __attribute__((target("avx2")))
+            inline size_t bswap_avx2(const void* src, void* dst, size_t bytes, __m256i mask)
+            {
+                const char* in = static_cast<const char*>(src);
+                char* out = static_cast<char*>(dst);
+                size_t offset = 0;
+                for (; (offset + 32) <= bytes; offset += 32) {
+                    __m256i value = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + offset));
+                    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + offset), _mm256_shuffle_epi8(value, mask));
+                }
+                return offset;
+            }
+
+            __attribute__((target("avx2")))
+            void bswap16_avx2(const void* src, void* dst, size_t count)
+            {
+                const __m256i mask = _mm256_setr_epi8(1,0,3,2,5,4,7,6,9,8,11,10,13,12,15,14,
+                                                      1,0,3,2,5,4,7,6,9,8,11,10,13,12,15,14);
+                size_t done = bswap_avx2(src, dst, count * 2, mask) / 2;
+                bswap16_generic(static_cast<const uint16_t*>(src) + done, static_cast<uint16_t*>(dst) + done, count - done);
+            }
+
+            __attribute__((target("avx2")))
+            void bswap32_avx2(const void* src, void* dst, size_t count)
+            {
+                const __m256i mask = _mm256_setr_epi8(3,2,1,0,7,6,5,4,11,10,9,8,15,14,13,12,
+                                                      3,2,1,0,7,6,5,4,11,10,9,8,15,14,13,12);
+                size_t done = bswap_avx2(src, dst, count * 4, mask) / 4;
+                bswap32_generic(static_cast<const uint32_t*>(src) + done, static_cast<uint32_t*>(dst) + done, count - done);
+            }
+
+            __attribute__((target("avx2")))
+            void bswap64_avx2(const void* src, void* dst, size_t count)
+            {
+                const __m256i mask = _mm256_setr_epi8(7,6,5,4,3,2,1,0,15,14,13,12,11,10,9,8,
+                                                      7,6,5,4,3,2,1,0,15,14,13,12,11,10,9,8);
+                size_t done = bswap_avx2(src, dst, count * 8, mask) / 8;
+                bswap64_generic(static_cast<const uint64_t*>(src) + done, static_cast<uint64_t*>(dst) + done, count - done);
+            }
+#endif // CONVERT_X86_KERNELS
+
+            // Kernel table, selected once based on the capabilities of the
+            // CPU; conversions without SIMD kernels always use the portable
+            // implementations
+            struct kernel_table {
+                const char* name;
+                void (*s8_to_float)(const int8_t*, float*, size_t, float);
+                void (*u8_to_float)(const uint8_t*, float*, size_t, float);
+                void (*s16_to_float)(const int16_t*, float*, size_t, float);
+                void (*u16_to_float)(const uint16_t*, float*, size_t, float);
+                void (*s32_to_float)(const int32_t*, float*, size_t, float);
+                void (*float_to_s8)(const float*, int8_t*, size_t, float);
+                void (*float_to_u8)(const float*, uint8_t*, size_t, float);
+                void (*float_to_s16)(const float*, int16_t*, size_t, float);
+                void (*float_to_u16)(const float*, uint16_t*, size_t, float);
+                void (*float_to_s32)(const float*, int32_t*, size_t, float);
+                void (*deinterleave_float)(const float*, float*, float*, size_t);
+                void (*interleave_float)(const float*, const float*, float*, size_t);
+                void (*deinterleave_s16)(const int16_t*, int16_t*, int16_t*, size_t);
+                void (*interleave_s16)(const int16_t*, const int16_t*, int16_t*, size_t);
+                void (*bswap16)(const void*, void*, size_t);
+                void (*bswap32)(const void*, void*, size_t);
+                void (*bswap64)(const void*, void*, size_t);
+            };
+
+            kernel_table select_kernels()
+            {
+                kernel_table table = {
+                    "generic",
+                    &to_float_generic<int8_t>,
+                    &to_float_generic<uint8_t>,
+                    &to_float_generic<int16_t>,
+                    &to_float_generic<uint16_t>,
+                    &to_float_generic<int32_t>,
+                    &from_float_generic<int8_t>,
+                    &from_float_generic<uint8_t>,
+                    &from_float_generic<int16_t>,
+                    &from_float_generic<uint16_t>,
+                    &from_float_generic<int32_t>,
+                    &deinterleave_table_generic<float>,
+                    &interleave_table_generic<float>,
+                    &deinterleave_table_generic<int16_t>,
+                    &interleave_table_generic<int16_t>,
+                    &bswap16_table_generic,
+                    &bswap32_table_generic,
+                    &bswap64_table_generic
+                };
+#ifdef CONVERT_X86_KERNELS
+                __builtin_cpu_init();
+                if (__builtin_cpu_supports("avx2")) {
+                    kernel_table avx2 = {
+                        "avx2",
+                        &s8_to_float_avx2,
+                        &u8_to_float_avx2,
+                        &s16_to_float_avx2,
+                        &u16_to_float_avx2,
+                        &s32_to_float_avx2,
+                        &float_to_s8_avx2,
+                        &float_to_u8_avx2,
+                        &float_to_s16_avx2,
+                        &float_to_u16_avx2,
+                        &float_to_s32_avx2,
+                        &deinterleave_float_avx2,
+                        &interleave_float_avx2,
+                        &deinterleave_s16_avx2,
+                        &interleave_s16_avx2,
+                        &bswap16_avx2,
+                        &bswap32_avx2,
+                        &bswap64_avx2
+                    };
+                    table = avx2;
+                } else if (__builtin_cpu_supports("sse4.1")) {
+                    kernel_table sse41 = {
+                        "sse4.1",
+                        &s8_to_float_sse41,
+                        &u8_to_float_sse41,
+                        &s16_to_float_sse41,
+                        &u16_to_float_sse41,
+                        &s32_to_float_sse41,
+                        &float_to_s8_sse41,
+                        &float_to_u8_sse41,
+                        &float_to_s16_sse41,
+                        &float_to_u16_sse41,
+                        &float_to_s32_sse41,
+                        &deinterleave_float_sse41,
+                        &interleave_float_sse41,
+                        &deinterleave_s16_sse41,
+                        &interleave_s16_sse41,
+                        &bswap16_sse41,
+                        &bswap32_sse41,
+                        &bswap64_sse41
+                    };
+                    table = sse41;
+                }
+#endif
+                return table;
+            }
+
+            const kernel_table& kernels()
+            {
+                static const kernel_table table = select_kernels();
+                return table;
+            }
+        }
+
+        //
+        // Integer to floating point
+        //
+        void toFloat(const int8_t* src, float* dst, size_t count, float scale)
+        {
+            kernels().s8_to_float(src, dst, count, scale);
+        }
+
+        void toFloat(const uint8_t* src, float* dst, size_t count, float scale)
+        {
+            kernels().u8_to_float(src, dst, count, scale);
+        }
+
+        void toFloat(const int16_t* src, float* dst, size_t count, float scale)
+        {
+            kernels().s16_to_float(src, dst, count, scale);
+        }
+
+        void toFloat(const uint16_t* src, float* dst, size_t count, float scale)
+        {
+            kernels().u16_to_float(src, dst, count, scale);
+        }
+
+        void toFloat(const int32_t* src, float* dst, size_t count, float scale)
+        {
+            kernels().s32_to_float(src, dst, count, scale);
+        }
+
+        void toFloat(const uint32_t* src, float* dst, size_t count, float scale)
+        {
+            scale_generic(src, dst, count, scale);
+        }
+
+        void toFloat(const float* src, float* dst, size_t count, float scale)
+        {
+            scale_generic(src, dst, count, scale);
+        }
+
+        void toFloat(const double* src, float* dst, size_t count, float scale)
+        {
+            for (size_t index = 0; index < count; ++index) {
+                dst[index] = static_cast<float>(src[index] * scale);
+            }
+        }
+
+        void toDouble(const int8_t* src, double* dst, size_t count, double scale)
+        {
+            scale_generic(src, dst, count, scale);
+        }
+
+        void toDouble(const uint8_t* src, double* dst, size_t count, double scale)
+        {
+            scale_generic(src, dst, count, scale);
+        }
+
+        void toDouble(const int16_t* src, double* dst, size_t count, double scale)
+        {
+            scale_generic(src, dst, count, scale);
+        }
+
+        void toDouble(const uint16_t* src, double* dst, size_t count, double scale)
+        {
+            scale_generic(src, dst, count, scale);
+        }
+
+        void toDouble(const int32_t* src, double* dst, size_t count, double scale)
+        {
+            scale_generic(src, dst, count, scale);
+        }
+
+        void toDouble(const uint32_t* src, double* dst, size_t count, double scale)
+        {
+            scale_generic(src, dst, count, scale);
+        }
+
+        void toDouble(const float* src, double* dst, size_t count, double scale)
+        {
+            scale_generic(src, dst, count, scale);
+        }
+
+        void toDouble(const double* src, double* dst, size_t count, double scale)
+        {
+            scale_generic(src, dst, count, scale);
+        }
+
+        //
+        // Floating point to integer
+        //
+        void fromFloat(const float* src, int8_t* dst, size_t count, float scale)
+        {
+            kernels().float_to_s8(src, dst, count, scale);
+        }
+
+        void fromFloat(const float* src, uint8_t* dst, size_t count, float scale)
+        {
+            kernels().float_to_u8(src, dst, count, scale);
+        }
+
+        void fromFloat(const float* src, int16_t* dst, size_t count, float scale)
+        {
+            kernels().float_to_s16(src, dst, count, scale);
+        }
+
+        void fromFloat(const float* src, uint16_t* dst, size_t count, float scale)
+        {
+            kernels().float_to_u16(src, dst, count, scale);
+        }
+
+        void fromFloat(const float* src, int32_t* dst, size_t count, float scale)
+        {
+            kernels().float_to_s32(src, dst, count, scale);
+        }
+
+        void fromFloat(const float* src, uint32_t* dst, size_t count, float scale)
+        {
+            quantize_generic(src, dst, count, scale);
+        }
+
+        void fromDouble(const double* src, int8_t* dst, size_t count, double scale)
+        {
+            quantize_generic(src, dst, count, scale);
+        }
+
+        void fromDouble(const double* src, uint8_t* dst, size_t count, double scale)
+        {
+            quantize_generic(src, dst, count, scale);
+        }
+
+        void fromDouble(const double* src, int16_t* dst, size_t count, double scale)
+        {
+            quantize_generic(src, dst, count, scale);
+        }
+
+        void fromDouble(const double* src, uint16_t* dst, size_t count, double scale)
+        {
+            quantize_generic(src, dst, count, scale);
+        }
+
+        void fromDouble(const double* src, int32_t* dst, size_t count, double scale)
+        {
+            quantize_generic(src, dst, count, scale);
+        }
+
+        void fromDouble(const double* src, uint32_t* dst, size_t count, double scale)
+        {
+            quantize_generic(src, dst, count, scale);
+        }
+
+        //
+        // Complex interleaving
+        //
+        void deinterleave(const int8_t* src, int8_t* real, int8_t* imag, size_t count)
+        {
+            deinterleave_generic(src, real, imag, count);
+        }
+
+        void deinterleave(const uint8_t* src, uint8_t* real, uint8_t* imag, size_t count)
+        {
+            deinterleave_generic(src, real, imag, count);
+        }
+
+        void deinterleave(const int16_t* src, int16_t* real, int16_t* imag, size_t count)
+        {
+            kernels().deinterleave_s16(src, real, imag, count);
+        }
+
+        void deinterleave(const uint16_t* src, uint16_t* real, uint16_t* imag, size_t count)
+        {
+            // Same bit pattern as signed
+            kernels().deinterleave_s16(reinterpret_cast<const int16_t*>(src), reinterpret_cast<int16_t*>(real),
+                                       reinterpret_cast<int16_t*>(imag), count);
+        }
+
+        void deinterleave(const int32_t* src, int32_t* real, int32_t* imag, size_t count)
+        {
+            kernels().deinterleave_float(reinterpret_cast<const float*>(src), reinterpret_cast<float*>(real),
+                                         reinterpret_cast<float*>(imag), count);
+        }
+
+        void deinterleave(const uint32_t* src, uint32_t* real, uint32_t* imag, size_t count)
+        {
+            kernels().deinterleave_float(reinterpret_cast<const float*>(src), reinterpret_cast<float*>(real),
+                                         reinterpret_cast<float*>(imag), count);
+        }
+
+        void deinterleave(const float* src, float* real, float* imag, size_t count)
+        {
+            kernels().deinterleave_float(src, real, imag, count);
+        }
+
+        void deinterleave(const double* src, double* real, double* imag, size_t count)
+        {
+            deinterleave_generic(src, real, imag, count);
+        }
+
+        void interleave(const int8_t* real, const int8_t* imag, int8_t* dst, size_t count)
+        {
+            interleave_generic(real, imag, dst, count);
+        }
+
+        void interleave(const uint8_t* real, const uint8_t* imag, uint8_t* dst, size_t count)
+        {
+            interleave_generic(real, imag, dst, count);
+        }
+
+        void interleave(const int16_t* real, const int16_t* imag, int16_t* dst, size_t count)
+        {
+            kernels().interleave_s16(real, imag, dst, count);
+        }
+
+        void interleave(const uint16_t* real, const uint16_t* imag, uint16_t* dst, size_t count)
+        {
+            kernels().interleave_s16(reinterpret_cast<const int16_t*>(real), reinterpret_cast<const int16_t*>(imag),
+                                     reinterpret_cast<int16_t*>(dst), count);
+        }
+
+        void interleave(const int32_t* real, const int32_t* imag, int32_t* dst, size_t count)
+        {
+            kernels().interleave_float(reinterpret_cast<const float*>(real), reinterpret_cast<const float*>(imag),
+                                       reinterpret_cast<float*>(dst), count);
+        }
+
+        void interleave(const uint32_t* real, const uint32_t* imag, uint32_t* dst, size_t count)
+        {
+            kernels().interleave_float(reinterpret_cast<const float*>(real), reinterpret_cast<const float*>(imag),
+                                       reinterpret_cast<float*>(dst), count);
+        }
+
+        void interleave(const float* real, const float* imag, float* dst, size_t count)
+        {
+            kernels().interleave_float(real, imag, dst, count);
+        }
+
+        void interleave(const double* real, const double* imag, double* dst, size_t count)
+        {
+            interleave_generic(real, imag, dst, count);
+        }
+
+        //
+        // Byte swapping
+        //
+        void byteSwap(int16_t* data, size_t count)
+        {
+            kernels().bswap16(data, data, count);
+        }
+
+        void byteSwap(uint16_t* data, size_t count)
+        {
+            kernels().bswap16(data, data, count);
+        }
+
+        void byteSwap(int32_t* data, size_t count)
+        {
+            kernels().bswap32(data, data, count);
+        }
+
+        void byteSwap(uint32_t* data, size_t count)
+        {
+            kernels().bswap32(data, data, count);
+        }
+
+        void byteSwap(int64_t* data, size_t count)
+        {
+            kernels().bswap64(data, data, count);
+        }
+
+        void byteSwap(uint64_t* data, size_t count)
+        {
+            kernels().bswap64(data, data, count);
+        }
+
+        void byteSwap(float* data, size_t count)
+        {
+            kernels().bswap32(data, data, count);
+        }
+
+        void byteSwap(double* data, size_t count)
+        {
+            kernels().bswap64(data, data, count);
+        }
+
+        void byteSwap(const int16_t* src, int16_t* dst, size_t count)
+        {
+            kernels().bswap16(src, dst, count);
+        }
+
+        void byteSwap(const uint16_t* src, uint16_t* dst, size_t count)
+        {
+            kernels().bswap16(src, dst, count);
+        }
+
+        void byteSwap(const int32_t* src, int32_t* dst, size_t count)
+        {
+            kernels().bswap32(src, dst, count);
+        }
+
+        void byteSwap(const uint32_t* src, uint32_t* dst, size_t count)
+        {
+            kernels().bswap32(src, dst, count);
+        }
+
+        void byteSwap(const int64_t* src, int64_t* dst, size_t count)
+        {
+            kernels().bswap64(src, dst, count);
+        }
+
+        void byteSwap(const uint64_t* src, uint64_t* dst, size_t count)
+        {
+            kernels().bswap64(src, dst, count);
+        }
+
+        void byteSwap(const float* src, float* dst, size_t count)
+        {
+            kernels().bswap32(src, dst, count);
+        }
+
+        void byteSwap(const double* src, double* dst, size_t count)
+        {
+            kernels().bswap64(src, dst, count);
+        }
+
+        const char* kernelName()
+        {
+            return kernels().name;
+        }
+    }
+}
@@ -0,0 +1,1044 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK bulkioInterfaces.
+ *
+ * REDHAWK bulkioInterfaces is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK bulkioInterfaces is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+#include "bulkio_file.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include <ossie/debug.h>
+#include <ossie/Value.h>
+
+#include "bulkio_base.h"
+#include "bulkio_convert.h"
+#include "bulkio_time_operators.h"
+
+namespace bulkio {
+
+    namespace {
+        // BLUE header layout (see ossie/utils/bluefile/bluefile.py)
+        const size_t BLUE_HEADER_SIZE = 512;
+        const size_t BLUE_BLOCK_SIZE = 512;
+        const size_t HDR_VERSION = 0;
+        const size_t HDR_HEAD_REP = 4;
+        const size_t HDR_DATA_REP = 8;
+        const size_t HDR_DETACHED = 12;
+        const size_t HDR_EXT_START = 24;
+        const size_t HDR_EXT_SIZE = 28;
+        const size_t HDR_DATA_START = 32;
+        const size_t HDR_DATA_SIZE = 40;
+        const size_t HDR_TYPE = 48;
+        const size_t HDR_FORMAT = 52;
+        const size_t HDR_TIMECODE = 56;
+        const size_t ADJ_XSTART = 256;
+        const size_t ADJ_XDELTA = 264;
+        const size_t ADJ_XUNITS = 272;
+        const size_t ADJ_SUBSIZE = 276;
+        const size_t ADJ_YSTART = 280;
+        const size_t ADJ_YDELTA = 288;
+        const size_t ADJ_YUNITS = 296;
+
+        // Extended header keyword record: int32 lkey, int16 lextra,
+        // int8 ltag, char format, followed by the value and tag
+        const size_t KEYWORD_HEADER_SIZE = 8;
+
+        // BLUE timecodes are seconds since January 1, 1950
+        const double J1950_OFFSET = 631152000.0;
+
+        const char* const SIDECAR_SUFFIX = ".sri";
+
+        rh_logger::LoggerPtr fileLogger()
+        {
+            return rh_logger::Logger::getLogger("bulkio.FileWriter");
+        }
+
+        std::runtime_error file_error(const std::string& what, const std::string& path)
+        {
+            return std::runtime_error(what + " '" + path + "': " + strerror(errno));
+        }
+
+        bool host_is_little_endian()
+        {
+            const uint16_t value = 1;
+            return *reinterpret_cast<const uint8_t*>(&value) == 1;
+        }
+
+        const char* native_rep()
+        {
+            return host_is_little_endian() ? "EEEI" : "IEEE";
+        }
+
+        size_t type_size(char typeCode)
+        {
+            switch (typeCode) {
+            case 'B': return 1;
+            case 'I': return 2;
+            case 'L': return 4;
+            case 'X': return 8;
+            case 'F': return 4;
+            case 'D': return 8;
+            default: return 0;
+            }
+        }
+
+        void swap_in_place(void* data, size_t count, size_t elementSize)
+        {
+            switch (elementSize) {
+            case 2:
+                convert::byteSwap(static_cast<uint16_t*>(data), count);
+                break;
+            case 4:
+                convert::byteSwap(static_cast<uint32_t*>(data), count);
+                break;
+            case 8:
+                convert::byteSwap(static_cast<uint64_t*>(data), count);
+                break;
+            }
+        }
+
+        template <typename T>
+        void put(char* buffer, size_t offset, T value)
+        {
+            memcpy(buffer + offset, &value, sizeof(T));
+        }
+
+        template <typename T>
+        T get(const char* buffer, size_t offset, bool swap)
+        {
+            T value;
+            memcpy(&value, buffer + offset, sizeof(T));
+            if (swap) {
+                char* bytes = reinterpret_cast<char*>(&value);
+                std::reverse(bytes, bytes + sizeof(T));
+            }
+            return value;
+        }
+
+        std::string base_name(const std::string& path)
+        {
+            std::string name = path.substr(path.find_last_of('/') + 1);
+            std::string::size_type dot = name.find_last_of('.');
+            if ((dot != std::string::npos) && (dot > 0)) {
+                name.erase(dot);
+            }
+            return name;
+        }
+
+        bool file_exists(const std::string& path)
+        {
+            struct stat status;
+            return (stat(path.c_str(), &status) == 0);
+        }
+
+        void pwrite_all(int fd, const char* data, size_t bytes, off_t offset, const std::string& path)
+        {
+            while (bytes > 0) {
+                ssize_t written = pwrite(fd, data, bytes, offset);
+                if (written < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    throw file_error("cannot write to", path);
+                }
+                data += written;
+                bytes -= written;
+                offset += written;
+            }
+        }
+
+        //
+        // Keywords are stored with the X-Midas type character of their value,
+        // so that numeric types survive the trip through either format
+        //
+        char keyword_type(const redhawk::Value& value)
+        {
+            switch (value.getType()) {
+            case redhawk::Value::TYPE_DOUBLE:    return 'D';
+            case redhawk::Value::TYPE_FLOAT:     return 'F';
+            case redhawk::Value::TYPE_OCTET:     return 'B';
+            case redhawk::Value::TYPE_SHORT:
+            case redhawk::Value::TYPE_USHORT:    return 'I';
+            case redhawk::Value::TYPE_LONG:
+            case redhawk::Value::TYPE_ULONG:     return 'L';
+            case redhawk::Value::TYPE_LONGLONG:
+            case redhawk::Value::TYPE_ULONGLONG: return 'X';
+            default:                             return 'A';
+            }
+        }
+
+        void add_keyword(BULKIO::StreamSRI& sri, const std::string& id, const redhawk::Value& value)
+        {
+            CORBA::ULong index = sri.keywords.length();
+            sri.keywords.length(index + 1);
+            sri.keywords[index].id = id.c_str();
+            sri.keywords[index].value = value;
+        }
+
+        std::string pack_keywords(const BULKIO::StreamSRI& sri)
+        {
+            std::string packed;
+            for (CORBA::ULong index = 0; index < sri.keywords.length(); ++index) {
+                std::string tag(sri.keywords[index].id);
+                // The tag length is a single byte
+                tag = tag.substr(0, 127);
+                const redhawk::Value& value = redhawk::Value::cast(sri.keywords[index].value);
+                char type = keyword_type(value);
+                std::string data;
+                switch (type) {
+                case 'D': { double v = value.toDouble(); data.assign(reinterpret_cast<char*>(&v), sizeof(v)); break; }
+                case 'F': { float v = value.toFloat(); data.assign(reinterpret_cast<char*>(&v), sizeof(v)); break; }
+                case 'B': { CORBA::Octet v = value.toOctet(); data.assign(reinterpret_cast<char*>(&v), sizeof(v)); break; }
+                case 'I': { int16_t v = value.toLong(); data.assign(reinterpret_cast<char*>(&v), sizeof(v)); break; }
+                case 'L': { int32_t v = value.toLongLong(); data.assign(reinterpret_cast<char*>(&v), sizeof(v)); break; }
+                case 'X': { int64_t v = value.toLongLong(); data.assign(reinterpret_cast<char*>(&v), sizeof(v)); break; }
+                default: data = value.toString(); break;
+                }
+
+                // Records are padded to a multiple of 8 bytes
+                size_t lkey = ((data.size() + tag.size() + 15) / 8) * 8;
+                char header[KEYWORD_HEADER_SIZE];
+                put<int32_t>(header, 0, lkey);
+                put<int16_t>(header, 4, lkey - data.size());
+                put<int8_t>(header, 6, tag.size());
+                header[7] = type;
+                std::string record(header, KEYWORD_HEADER_SIZE);
+                record += data;
+                record += tag;
+                record.resize(lkey, '\0');
+                packed += record;
+            }
+            return packed;
+        }
+
+        void unpack_keywords(BULKIO::StreamSRI& sri, const char* buffer, size_t size, bool swap)
+        {
+            size_t offset = 0;
+            while ((offset + KEYWORD_HEADER_SIZE) <= size) {
+                size_t lkey = get<int32_t>(buffer, offset, swap);
+                size_t lextra = get<int16_t>(buffer, offset + 4, swap);
+                size_t ltag = get<uint8_t>(buffer, offset + 6, false);
+                char type = buffer[offset + 7];
+                if ((lkey < KEYWORD_HEADER_SIZE) || (lextra > lkey) || ((offset + lkey) > size)) {
+                    // Malformed record; ignore the rest
+                    break;
+                }
+                size_t ldata = lkey - lextra;
+                const char* data = buffer + offset + KEYWORD_HEADER_SIZE;
+                std::string tag(data + ldata, std::min(ltag, lextra - KEYWORD_HEADER_SIZE));
+                offset += lkey;
+
+                // Only scalar numeric values and strings map to SRI keywords
+                if ((type != 'A') && (ldata != type_size(type))) {
+                    continue;
+                }
+                switch (type) {
+                case 'A': add_keyword(sri, tag, std::string(data, ldata).c_str()); break;
+                case 'D': add_keyword(sri, tag, get<double>(data, 0, swap)); break;
+                case 'F': add_keyword(sri, tag, get<float>(data, 0, swap)); break;
+                case 'B': add_keyword(sri, tag, get<CORBA::Octet>(data, 0, false)); break;
+                case 'I': add_keyword(sri, tag, get<CORBA::Short>(data, 0, swap)); break;
+                case 'L': add_keyword(sri, tag, get<CORBA::Long>(data, 0, swap)); break;
+                case 'X': add_keyword(sri, tag, get<CORBA::LongLong>(data, 0, swap)); break;
+                }
+            }
+        }
+
+        // Sidecar values are one per line, so newlines and backslashes in
+        // strings are escaped
+        std::string escape(const std::string& value)
+        {
+            std::string result;
+            for (std::string::const_iterator ch = value.begin(); ch != value.end(); ++ch) {
+                if (*ch == '\\') {
+                    result += "\\\\";
+                } else if (*ch == '\n') {
+                    result += "\\n";
+                } else {
+                    result += *ch;
+                }
+            }
+            return result;
+        }
+
+        std::string unescape(const std::string& value)
+        {
+            std::string result;
+            for (std::string::const_iterator ch = value.begin(); ch != value.end(); ++ch) {
+                if ((*ch == '\\') && ((ch + 1) != value.end())) {
+                    ++ch;
+                    result += (*ch == 'n') ? '\n' : *ch;
+                } else {
+                    result += *ch;
+                }
+            }
+            return result;
+        }
+    }
+
+    namespace detail {
+        /*
+         * Read-only private mapping of an entire file.
+         */
+        class MappedFile {
+        public:
+            explicit MappedFile(const std::string& path) :
+                _data(0),
+                _size(0)
+            {
+                int fd = ::open(path.c_str(), O_RDONLY);
+                if (fd < 0) {
+                    throw file_error("cannot open", path);
+                }
+                struct stat status;
+                if (fstat(fd, &status) != 0) {
+                    std::runtime_error error = file_error("cannot stat", path);
+                    ::close(fd);
+                    throw error;
+                }
+                _size = status.st_size;
+                if (_size > 0) {
+                    void* data = mmap(0, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+                    if (data == MAP_FAILED) {
+                        std::runtime_error error = file_error("cannot map", path);
+                        ::close(fd);
+                        throw error;
+                    }
+                    _data = static_cast<char*>(data);
+                    madvise(_data, _size, MADV_SEQUENTIAL);
+                }
+                // The mapping keeps the file alive
+                ::close(fd);
+            }
+
+            ~MappedFile()
+            {
+                if (_data) {
+                    munmap(_data, _size);
+                }
+            }
+
+            const char* data() const
+            {
+                return _data;
+            }
+
+            size_t size() const
+            {
+                return _size;
+            }
+
+            // Reverses the byte order of a range of elements; the modified
+            // pages become private copies, leaving the file untouched
+            void byteSwap(size_t offset, size_t count, size_t elementSize)
+            {
+                const size_t page_size = sysconf(_SC_PAGESIZE);
+                size_t start = (offset / page_size) * page_size;
+                size_t length = offset + count * elementSize - start;
+                if ((count == 0) || (elementSize < 2)) {
+                    return;
+                }
+                mprotect(_data + start, length, PROT_READ|PROT_WRITE);
+                swap_in_place(_data + offset, count, elementSize);
+                mprotect(_data + start, length, PROT_READ);
+            }
+
+        private:
+            // Non-copyable, non-assignable
+            MappedFile(const MappedFile&);
+            MappedFile& operator=(const MappedFile&);
+
+            char* _data;
+            size_t _size;
+        };
+    }
+
+    /*
+     * Double-buffered writer. The caller fills the active buffer while the
+     * I/O thread writes the other one; each full buffer lands at an offset
+     * that is a multiple of the (page-aligned) buffer size, which satisfies
+     * the O_DIRECT alignment rules. Only the final partial buffer is written
+     * without O_DIRECT.
+     */
+    class FileWriter::Impl {
+    public:
+        Impl(const std::string& path, FileFormat format, size_t bufferSize) :
+            _path(path),
+            _format(format),
+            _fd(-1),
+            _direct(true),
+            _bufferSize(0),
+            _active(0),
+            _fill(0),
+            _fileOffset(0),
+            _headerSize(format == FILE_FORMAT_BLUE ? BLUE_HEADER_SIZE : 0),
+            _count(0),
+            _elementSize(4),
+            _typeCode('F'),
+            _hasSri(false),
+            _open(true),
+            _running(true),
+            _pending(false),
+            _pendingBuffer(0),
+            _pendingSize(0),
+            _pendingOffset(0)
+        {
+            _buffers[0] = _buffers[1] = 0;
+
+            const size_t page_size = sysconf(_SC_PAGESIZE);
+            _bufferSize = std::max(bufferSize, page_size);
+            _bufferSize = ((_bufferSize + page_size - 1) / page_size) * page_size;
+
+            _fd = ::open(path.c_str(), O_WRONLY|O_CREAT|O_TRUNC|O_DIRECT, 0644);
+            if ((_fd < 0) && (errno == EINVAL)) {
+                // The file system (e.g., tmpfs) does not support direct I/O
+                _direct = false;
+                _fd = ::open(path.c_str(), O_WRONLY|O_CREAT|O_TRUNC, 0644);
+            }
+            if (_fd < 0) {
+                throw file_error("cannot create", path);
+            }
+
+            for (int index = 0; index < 2; ++index) {
+                if (posix_memalign(reinterpret_cast<void**>(&_buffers[index]), page_size, _bufferSize) != 0) {
+                    _release();
+                    throw std::runtime_error("cannot allocate file buffers for '" + path + "'");
+                }
+            }
+
+            // Reserve space for the BLUE header, which is written on close
+            memset(_buffers[0], 0, _headerSize);
+            _fill = _headerSize;
+
+            _thread = boost::thread(&Impl::_run, this);
+        }
+
+        ~Impl()
+        {
+            _stopThread();
+            _release();
+        }
+
+        void write(const BULKIO::StreamSRI& sri, const void* data, size_t count, size_t elementSize,
+                   char typeCode, const std::list<SampleTimestamp>& timestamps)
+        {
+            if (!_open) {
+                throw std::logic_error("file writer '" + _path + "' is closed");
+            }
+            if (!_hasSri) {
+                _sri = sri;
+                _elementSize = elementSize;
+                _typeCode = typeCode;
+                _hasSri = true;
+            } else if ((typeCode != _typeCode) || (elementSize != _elementSize)) {
+                throw std::logic_error("sample type changed while recording '" + _path + "'");
+            } else if (sri.mode != _sri.mode) {
+                throw std::logic_error("complex mode changed while recording '" + _path + "'");
+            }
+
+            _recordTimestamps(timestamps);
+
+            const char* source = static_cast<const char*>(data);
+            size_t bytes = count * elementSize;
+            while (bytes > 0) {
+                size_t pass = std::min(bytes, _bufferSize - _fill);
+                memcpy(_buffers[_active] + _fill, source, pass);
+                _fill += pass;
+                source += pass;
+                bytes -= pass;
+                if (_fill == _bufferSize) {
+                    _submit();
+                }
+            }
+            _count += count;
+        }
+
+        void close()
+        {
+            if (!_open) {
+                return;
+            }
+            _open = false;
+
+            // Wait for the I/O thread to finish the last full buffer, then
+            // write the remainder with normal buffered I/O, since its size is
+            // not aligned
+            _waitIdle();
+            _stopThread();
+            _checkError();
+            if (_direct) {
+                int flags = fcntl(_fd, F_GETFL);
+                fcntl(_fd, F_SETFL, flags & ~O_DIRECT);
+            }
+            pwrite_all(_fd, _buffers[_active], _fill, _fileOffset, _path);
+
+            if (!_hasSri) {
+                _sri = bulkio::sri::create(base_name(_path));
+            }
+            if (_format == FILE_FORMAT_BLUE) {
+                _writeBlueHeader();
+            } else {
+                _writeSidecar();
+            }
+            _release();
+        }
+
+        bool isOpen() const
+        {
+            return _open;
+        }
+
+        const std::string& path() const
+        {
+            return _path;
+        }
+
+        FileFormat format() const
+        {
+            return _format;
+        }
+
+        size_t size() const
+        {
+            return _count;
+        }
+
+        bool directIO() const
+        {
+            return _direct;
+        }
+
+    private:
+        void _recordTimestamps(const std::list<SampleTimestamp>& timestamps)
+        {
+            const size_t base = _count / ((_sri.mode != 0) ? 2 : 1);
+            const double xdelta = _sri.xdelta;
+            for (std::list<SampleTimestamp>::const_iterator ts = timestamps.begin(); ts != timestamps.end(); ++ts) {
+                SampleTimestamp stamp(ts->time, base + ts->offset);
+                if (!_timestamps.empty()) {
+                    // Skip time stamps that match the time extrapolated from
+                    // the prior one to within half a sample
+                    const SampleTimestamp& last = _timestamps.back();
+                    BULKIO::PrecisionUTCTime expected = last.time + (stamp.offset - last.offset) * xdelta;
+                    if (std::fabs(stamp.time - expected) <= (xdelta / 2.0)) {
+                        continue;
+                    }
+                }
+                _timestamps.push_back(stamp);
+            }
+        }
+
+        void _submit()
+        {
+            boost::mutex::scoped_lock lock(_mutex);
+            while (_pending) {
+                _cond.wait(lock);
+            }
+            _checkErrorLocked();
+            _pendingBuffer = _buffers[_active];
+            _pendingSize = _fill;
+            _pendingOffset = _fileOffset;
+            _pending = true;
+            _cond.notify_all();
+
+            _active ^= 1;
+            _fileOffset += _fill;
+            _fill = 0;
+        }
+
+        void _run()
+        {
+            boost::mutex::scoped_lock lock(_mutex);
+            while (true) {
+                while (_running && !_pending) {
+                    _cond.wait(lock);
+                }
+                if (!_pending) {
+                    return;
+                }
+                const char* buffer = _pendingBuffer;
+                size_t size = _pendingSize;
+                off_t offset = _pendingOffset;
+                lock.unlock();
+
+                std::string error;
+                try {
+                    pwrite_all(_fd, buffer, size, offset, _path);
+                } catch (const std::exception& exc) {
+                    error = exc.what();
+                }
+
+                lock.lock();
+                if (!error.empty() && _error.empty()) {
+                    _error = error;
+                }
+                _pending = false;
+                _cond.notify_all();
+            }
+        }
+
+        void _waitIdle()
+        {
+            boost::mutex::scoped_lock lock(_mutex);
+            while (_pending) {
+                _cond.wait(lock);
+            }
+        }
+
+        void _stopThread()
+        {
+            {
+                boost::mutex::scoped_lock lock(_mutex);
+                _running = false;
+                _cond.notify_all();
+            }
+            if (_thread.joinable()) {
+                _thread.join();
+            }
+        }
+
+        void _checkError()
+        {
+            boost::mutex::scoped_lock lock(_mutex);
+            _checkErrorLocked();
+        }
+
+        void _checkErrorLocked()
+        {
+            if (!_error.empty()) {
+                _open = false;
+                throw std::runtime_error(_error);
+            }
+        }
+
+        void _writeBlueHeader()
+        {
+            const size_t data_bytes = _count * _elementSize;
+            const std::string keywords = pack_keywords(_sri);
+            const size_t ext_start = (BLUE_HEADER_SIZE + data_bytes + BLUE_BLOCK_SIZE - 1) / BLUE_BLOCK_SIZE;
+            if (!keywords.empty()) {
+                pwrite_all(_fd, keywords.data(), keywords.size(), ext_start * BLUE_BLOCK_SIZE, _path);
+            }
+
+            char header[BLUE_HEADER_SIZE];
+            memset(header, 0, sizeof(header));
+            memcpy(header + HDR_VERSION, "BLUE", 4);
+            memcpy(header + HDR_HEAD_REP, native_rep(), 4);
+            memcpy(header + HDR_DATA_REP, native_rep(), 4);
+            put<int32_t>(header, HDR_DETACHED, 0);
+            put<int32_t>(header, HDR_EXT_START, keywords.empty() ? 0 : ext_start);
+            put<int32_t>(header, HDR_EXT_SIZE, keywords.size());
+            put<double>(header, HDR_DATA_START, BLUE_HEADER_SIZE);
+            put<double>(header, HDR_DATA_SIZE, data_bytes);
+            put<int32_t>(header, HDR_TYPE, (_sri.subsize > 0) ? 2000 : 1000);
+            header[HDR_FORMAT] = (_sri.mode != 0) ? 'C' : 'S';
+            header[HDR_FORMAT + 1] = _typeCode;
+            double timecode = J1950_OFFSET;
+            if (!_timestamps.empty()) {
+                const BULKIO::PrecisionUTCTime& start = _timestamps.front().time;
+                timecode += start.twsec + start.tfsec;
+            }
+            put<double>(header, HDR_TIMECODE, timecode);
+            put<double>(header, ADJ_XSTART, _sri.xstart);
+            put<double>(header, ADJ_XDELTA, _sri.xdelta);
+            put<int32_t>(header, ADJ_XUNITS, _sri.xunits);
+            if (_sri.subsize > 0) {
+                put<int32_t>(header, ADJ_SUBSIZE, _sri.subsize);
+                put<double>(header, ADJ_YSTART, _sri.ystart);
+                put<double>(header, ADJ_YDELTA, _sri.ydelta);
+                put<int32_t>(header, ADJ_YUNITS, _sri.yunits);
+            }
+            pwrite_all(_fd, header, sizeof(header), 0, _path);
+        }
+
+        void _writeSidecar()
+        {
+            const std::string sidecar = _path + SIDECAR_SUFFIX;
+            std::ofstream out(sidecar.c_str());
+            out.precision(17);
+            out << "format=" << ((_sri.mode != 0) ? 'C' : 'S') << _typeCode << std::endl;
+            out << "streamID=" << escape(std::string(_sri.streamID)) << std::endl;
+            out << "hversion=" << _sri.hversion << std::endl;
+            out << "xstart=" << _sri.xstart << std::endl;
+            out << "xdelta=" << _sri.xdelta << std::endl;
+            out << "xunits=" << _sri.xunits << std::endl;
+            out << "subsize=" << _sri.subsize << std::endl;
+            out << "ystart=" << _sri.ystart << std::endl;
+            out << "ydelta=" << _sri.ydelta << std::endl;
+            out << "yunits=" << _sri.yunits << std::endl;
+            out << "mode=" << _sri.mode << std::endl;
+            out << "blocking=" << (_sri.blocking ? 1 : 0) << std::endl;
+            for (CORBA::ULong index = 0; index < _sri.keywords.length(); ++index) {
+                const redhawk::Value& value = redhawk::Value::cast(_sri.keywords[index].value);
+                char type = keyword_type(value);
+                out << "keyword=" << type << '\t' << escape(std::string(_sri.keywords[index].id)) << '\t';
+                switch (type) {
+                case 'D':
+                case 'F':
+                    out << value.toDouble();
+                    break;
+                case 'A':
+                    out << escape(value.toString());
+                    break;
+                default:
+                    out << value.toLongLong();
+                    break;
+                }
+                out << std::endl;
+            }
+            for (std::list<SampleTimestamp>::const_iterator ts = _timestamps.begin(); ts != _timestamps.end(); ++ts) {
+                out << "timestamp=" << ts->offset << ' ' << ts->time.tcmode << ' ' << ts->time.tcstatus << ' '
+                    << ts->time.toff << ' ' << ts->time.twsec << ' ' << ts->time.tfsec << std::endl;
+            }
+            out.close();
+            if (!out) {
+                throw file_error("cannot write sidecar", sidecar);
+            }
+        }
+
+        void _release()
+        {
+            if (_fd >= 0) {
+                ::close(_fd);
+                _fd = -1;
+            }
+            for (int index = 0; index < 2; ++index) {
+                free(_buffers[index]);
+                _buffers[index] = 0;
+            }
+        }
+
+        const std::string _path;
+        const FileFormat _format;
+        int _fd;
+        bool _direct;
+
+        // Caller-side buffer state
+        size_t _bufferSize;
+        char* _buffers[2];
+        int _active;
+        size_t _fill;
+        size_t _fileOffset;
+        const size_t _headerSize;
+
+        size_t _count;
+        size_t _elementSize;
+        char _typeCode;
+        BULKIO::StreamSRI _sri;
+        bool _hasSri;
+        std::list<SampleTimestamp> _timestamps;
+        bool _open;
+
+        // I/O thread state, protected by _mutex
+        boost::thread _thread;
+        boost::mutex _mutex;
+        boost::condition_variable _cond;
+        bool _running;
+        bool _pending;
+        const char* _pendingBuffer;
+        size_t _pendingSize;
+        size_t _pendingOffset;
+        std::string _error;
+    };
+
+    const size_t FileWriter::DEFAULT_BUFFER_SIZE;
+
+    FileWriter::FileWriter(const std::string& path, FileFormat format, size_t bufferSize) :
+        _impl(new Impl(path, format, bufferSize))
+    {
+    }
+
+    FileWriter::~FileWriter()
+    {
+        try {
+            _impl->close();
+        } catch (const std::exception& exc) {
+            RH_ERROR(fileLogger(), "Error closing '" << _impl->path() << "': " << exc.what());
+        }
+    }
+
+    void FileWriter::close()
+    {
+        _impl->close();
+    }
+
+    bool FileWriter::isOpen() const
+    {
+        return _impl->isOpen();
+    }
+
+    const std::string& FileWriter::path() const
+    {
+        return _impl->path();
+    }
+
+    FileFormat FileWriter::format() const
+    {
+        return _impl->format();
+    }
+
+    size_t FileWriter::size() const
+    {
+        return _impl->size();
+    }
+
+    bool FileWriter::directIO() const
+    {
+        return _impl->directIO();
+    }
+
+    void FileWriter::_write(const BULKIO::StreamSRI& sri, const void* data, size_t count, size_t elementSize,
+                            char typeCode, const std::list<SampleTimestamp>& timestamps)
+    {
+        _impl->write(sri, data, count, elementSize, typeCode, timestamps);
+    }
+
+
+    FileReader::FileReader(const std::string& path) :
+        _format(FILE_FORMAT_BLUE),
+        _typeCode('F'),
+        _offset(0),
+        _size(0)
+    {
+        const std::string sidecar = path + SIDECAR_SUFFIX;
+        if (file_exists(sidecar)) {
+            _format = FILE_FORMAT_RAW;
+            _openRaw(path, sidecar);
+        } else {
+            _openBlue(path);
+        }
+        if (_timestamps.empty()) {
+            _timestamps.push_back(SampleTimestamp(bulkio::time::utils::notSet()));
+        }
+    }
+
+    FileFormat FileReader::format() const
+    {
+        return _format;
+    }
+
+    const BULKIO::StreamSRI& FileReader::sri() const
+    {
+        return _sri;
+    }
+
+    const std::list<SampleTimestamp>& FileReader::timestamps() const
+    {
+        return _timestamps;
+    }
+
+    BULKIO::PrecisionUTCTime FileReader::timeAt(size_t offset) const
+    {
+        std::list<SampleTimestamp>::const_iterator ts = _timestamps.begin();
+        std::list<SampleTimestamp>::const_iterator next = ts;
+        while ((++next != _timestamps.end()) && (next->offset <= offset)) {
+            ts = next;
+        }
+        return ts->time + (static_cast<double>(offset) - ts->offset) * _sri.xdelta;
+    }
+
+    bool FileReader::complex() const
+    {
+        return (_sri.mode != 0);
+    }
+
+    char FileReader::typeCode() const
+    {
+        return _typeCode;
+    }
+
+    size_t FileReader::size() const
+    {
+        return _size;
+    }
+
+    void FileReader::_checkType(char typeCode) const
+    {
+        if (typeCode != _typeCode) {
+            std::ostringstream oss;
+            oss << "sample type '" << typeCode << "' does not match file type '" << _typeCode << "'";
+            throw std::logic_error(oss.str());
+        }
+    }
+
+    const void* FileReader::_data() const
+    {
+        return _file->data() + _offset;
+    }
+
+    void FileReader::_openBlue(const std::string& path)
+    {
+        _file.reset(new detail::MappedFile(path));
+        const char* header = _file->data();
+        if ((_file->size() < BLUE_HEADER_SIZE) || (memcmp(header + HDR_VERSION, "BLUE", 4) != 0)) {
+            throw std::runtime_error("'" + path + "' is not a BLUE file");
+        }
+
+        const std::string native(native_rep());
+        const bool swap_header = (native.compare(0, 4, header + HDR_HEAD_REP, 4) != 0);
+        const bool swap_data = (native.compare(0, 4, header + HDR_DATA_REP, 4) != 0);
+
+        if (get<int32_t>(header, HDR_DETACHED, swap_header) != 0) {
+            throw std::runtime_error("detached BLUE file '" + path + "' is not supported");
+        }
+        const int32_t type = get<int32_t>(header, HDR_TYPE, swap_header);
+        const char mode = header[HDR_FORMAT];
+        _typeCode = header[HDR_FORMAT + 1];
+        const size_t element_size = type_size(_typeCode);
+        if (((type != 1000) && (type != 2000)) || ((mode != 'S') && (mode != 'C')) || (element_size == 0)) {
+            std::ostringstream oss;
+            oss << "BLUE file '" << path << "' has unsupported type " << type << " format "
+                << std::string(header + HDR_FORMAT, 2);
+            throw std::runtime_error(oss.str());
+        }
+
+        _offset = get<double>(header, HDR_DATA_START, swap_header);
+        size_t data_bytes = get<double>(header, HDR_DATA_SIZE, swap_header);
+        if ((_offset + data_bytes) > _file->size()) {
+            throw std::runtime_error("BLUE file '" + path + "' is truncated");
+        }
+        _size = data_bytes / element_size;
+
+        _sri = bulkio::sri::create(base_name(path));
+        _sri.mode = (mode == 'C') ? 1 : 0;
+        _sri.xstart = get<double>(header, ADJ_XSTART, swap_header);
+        _sri.xdelta = get<double>(header, ADJ_XDELTA, swap_header);
+        _sri.xunits = get<int32_t>(header, ADJ_XUNITS, swap_header);
+        if (type == 2000) {
+            _sri.subsize = get<int32_t>(header, ADJ_SUBSIZE, swap_header);
+            _sri.ystart = get<double>(header, ADJ_YSTART, swap_header);
+            _sri.ydelta = get<double>(header, ADJ_YDELTA, swap_header);
+            _sri.yunits = get<int32_t>(header, ADJ_YUNITS, swap_header);
+        }
+
+        const double timecode = get<double>(header, HDR_TIMECODE, swap_header) - J1950_OFFSET;
+        if (timecode >= 0.0) {
+            double whole = std::floor(timecode);
+            _timestamps.push_back(SampleTimestamp(bulkio::time::utils::create(whole, timecode - whole)));
+        }
+
+        const size_t ext_start = get<int32_t>(header, HDR_EXT_START, swap_header) * BLUE_BLOCK_SIZE;
+        const size_t ext_size = get<int32_t>(header, HDR_EXT_SIZE, swap_header);
+        if ((ext_start > 0) && ((ext_start + ext_size) <= _file->size())) {
+            unpack_keywords(_sri, _file->data() + ext_start, ext_size, swap_header);
+        }
+
+        if (swap_data) {
+            _file->byteSwap(_offset, _size, element_size);
+        }
+    }
+
+    void FileReader::_openRaw(const std::string& path, const std::string& sidecar)
+    {
+        std::ifstream in(sidecar.c_str());
+        if (!in) {
+            throw file_error("cannot open", sidecar);
+        }
+
+        _sri = bulkio::sri::create(base_name(path));
+        std::string format;
+        std::string line;
+        while (std::getline(in, line)) {
+            std::string::size_type equals = line.find('=');
+            if (line.empty() || (line[0] == '#') || (equals == std::string::npos)) {
+                continue;
+            }
+            const std::string key = line.substr(0, equals);
+            const std::string value = line.substr(equals + 1);
+            std::istringstream iss(value);
+            if (key == "format") {
+                format = value;
+            } else if (key == "streamID") {
+                _sri.streamID = unescape(value).c_str();
+            } else if (key == "hversion") {
+                iss >> _sri.hversion;
+            } else if (key == "xstart") {
+                iss >> _sri.xstart;
+            } else if (key == "xdelta") {
+                iss >> _sri.xdelta;
+            } else if (key == "xunits") {
+                iss >> _sri.xunits;
+            } else if (key == "subsize") {
+                iss >> _sri.subsize;
+            } else if (key == "ystart") {
+                iss >> _sri.ystart;
+            } else if (key == "ydelta") {
+                iss >> _sri.ydelta;
+            } else if (key == "yunits") {
+                iss >> _sri.yunits;
+            } else if (key == "mode") {
+                iss >> _sri.mode;
+            } else if (key == "blocking") {
+                int blocking = 0;
+                iss >> blocking;
+                _sri.blocking = (blocking != 0);
+            } else if (key == "keyword") {
+                std::string::size_type first = value.find('\t');
+                std::string::size_type second = value.find('\t', first + 1);
+                if ((first != 1) || (second == std::string::npos)) {
+                    continue;
+                }
+                const std::string id = unescape(value.substr(first + 1, second - first - 1));
+                const std::string text = value.substr(second + 1);
+                std::istringstream number(text);
+                double real = 0.0;
+                CORBA::LongLong integer = 0;
+                switch (value[0]) {
+                case 'D': number >> real; add_keyword(_sri, id, real); break;
+                case 'F': number >> real; add_keyword(_sri, id, static_cast<CORBA::Float>(real)); break;
+                case 'B': number >> integer; add_keyword(_sri, id, static_cast<CORBA::Octet>(integer)); break;
+                case 'I': number >> integer; add_keyword(_sri, id, static_cast<CORBA::Short>(integer)); break;
+                case 'L': number >> integer; add_keyword(_sri, id, static_cast<CORBA::Long>(integer)); break;
+                case 'X': number >> integer; add_keyword(_sri, id, integer); break;
+                default: add_keyword(_sri, id, unescape(text).c_str()); break;
+                }
+            } else if (key == "timestamp") {
+                size_t offset = 0;
+                BULKIO::PrecisionUTCTime time;
+                iss >> offset >> time.tcmode >> time.tcstatus >> time.toff >> time.twsec >> time.tfsec;
+                if (iss) {
+                    _timestamps.push_back(SampleTimestamp(time, offset));
+                }
+            }
+        }
+
+        if ((format.size() != 2) || (type_size(format[1]) == 0)) {
+            throw std::runtime_error("sidecar '" + sidecar + "' has missing or unsupported format '" + format + "'");
+        }
+        _typeCode = format[1];
+
+        _file.reset(new detail::MappedFile(path));
+        _size = _file->size() / type_size(_typeCode);
+    }
+}
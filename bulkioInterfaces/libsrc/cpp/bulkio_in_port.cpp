@@ -18,6 +18,8 @@
  * along with this program.  If not, see http://www.gnu.org/licenses/.
  */
 
+#include <algorithm>
+
 #include <boost/ref.hpp>
 #include <boost/scoped_ptr.hpp>
 #include <boost/thread.hpp>
@@ -25,8 +27,105 @@
 #include <bulkio_p.h>
 #include <bulkio_in_port.h>
 
+#include "BoundedQueue.h"
+#include "FlowCredit.h"
+
 namespace bulkio {
 
+  namespace {
+    // Number of iterations a reader spins waiting for the lock-free queue
+    // before sleeping on the condition variable
+    const int LOCKFREE_SPIN_COUNT = 2000;
+
+    // Maximum number of free packets retained for reuse, per port type
+    const size_t PACKET_POOL_SIZE = 1024;
+
+    template <class Packet>
+    inline detail::BoundedQueue<void*>& packet_pool()
+    {
+      // The pool is intentionally never destroyed, so that packets can be
+      // safely released during static destruction
+      static detail::BoundedQueue<void*>* pool = new detail::BoundedQueue<void*>(PACKET_POOL_SIZE);
+      return *pool;
+    }
+  }
+
+  template <typename PortType>
+  void* InPort<PortType>::Packet::operator new(size_t bytes)
+  {
+    // The pool only holds blocks of exactly one Packet; anything else (e.g.,
+    // a derived class) comes from the global heap, and operator delete must
+    // be told the size to return it there
+    void* ptr;
+    if ((bytes == sizeof(Packet)) && packet_pool<Packet>().pop(ptr)) {
+      return ptr;
+    }
+    return ::operator new(bytes);
+  }
+
+  template <typename PortType>
+  void InPort<PortType>::Packet::operator delete(void* ptr, size_t bytes)
+  {
+    if (!ptr) {
+      return;
+    }
+    if ((bytes != sizeof(Packet)) || !packet_pool<Packet>().push(ptr)) {
+      ::operator delete(ptr);
+    }
+  }
+
+  template <typename PortType>
+  InPort<PortType>::Packet::~Packet()
+  {
+    if (credit) {
+      credit->release(creditCount);
+    }
+  }
+
+  template <typename PortType>
+  struct InPort<PortType>::LockFreeQueue {
+    LockFreeQueue(size_t capacity) :
+      packets(capacity),
+      depth(0),
+      spinners(0),
+      lockedPushes(0)
+    {
+    }
+
+    detail::BoundedQueue<Packet*> packets;
+
+    // Total number of packets queued, both in the lock-free queue and in
+    // packetQueue; writers reserve space by incrementing this count
+    volatile size_t depth;
+
+    // Number of readers spinning on the ring without dataBufferLock
+    volatile int spinners;
+
+    // Number of packets added directly to packetQueue (i.e., not through the
+    // ring), which only happens under dataBufferLock; a reader that released
+    // the lock to spin uses it to detect a signal it may have missed
+    size_t lockedPushes;
+  };
+
+  template <typename PortType>
+  struct InPort<PortType>::StreamQueue {
+    StreamQueue() :
+      flushes(0),
+      blocks(0)
+    {
+    }
+
+    PacketQueue packets;
+
+    // Signalled when a packet is queued for this stream, or space becomes
+    // available in its queue
+    CONDITION dataAvailable;
+    CONDITION queueAvailable;
+
+    size_t flushes;
+    size_t blocks;
+  };
+
   // ----------------------------------------------------------------------------------------
   //  Source/Input Port Definitions
   // ----------------------------------------------------------------------------------------
@@ -40,6 +139,14 @@ namespace bulkio {
     sri_cmp(sriCmp),
     newStreamCallback(),
     maxQueue(100),
+    creditWindow(0),
+    lockFreeQueue(0),
+    detachedLockFreeQueue(0),
+    lockFreeWriters(0),
+    lockFreeWaiters(0),
+    streamQueuesEnabled(false),
+    streamQueueDepth(0),
+    packetSequence(0),
     breakBlock(false),
     blocking(false),
     stats(new linkStatistics(port_name))
@@ -88,10 +195,13 @@ namespace bulkio {
     LOG_TRACE( _portLog, "PORT:" << name << " DUMP PKTS:" << packetQueue.size() );
 
     // purge the queue...
+    _drainLockFreeQueue();
+    _mergeStreamQueues();
     while (packetQueue.size() != 0) {
       delete packetQueue.front();
       packetQueue.pop_front();
     }
+    delete lockFreeQueue;
 
     // clean up allocated containers
     if ( stats ) delete stats;
@@ -103,7 +213,7 @@ namespace bulkio {
   template <typename PortType>
   BULKIO::PortStatistics * InPort<PortType>::statistics()
   {
-    SCOPED_LOCK lock(dataBufferLock);
+    SCOPED_LOCK lock(statsLock);
     BULKIO::PortStatistics_var recStat = new BULKIO::PortStatistics(stats->retrieve());
     // NOTE: You must delete the object that this function returns!
     return recStat._retn();
@@ -114,9 +224,18 @@ namespace bulkio {
   BULKIO::PortUsageType InPort<PortType>::state()
   {
     SCOPED_LOCK lock(dataBufferLock);
-    if (packetQueue.size() == maxQueue) {
+    const size_t depth = _queueDepth();
+    if (streamQueuesEnabled) {
+      // Each stream has its own maximum depth
+      for (typename StreamQueueMap::iterator queue = streamQueues.begin(); queue != streamQueues.end(); ++queue) {
+        if (queue->second->packets.size() >= maxQueue) {
+          return BULKIO::BUSY;
+        }
+      }
+    } else if (depth >= maxQueue) {
       return BULKIO::BUSY;
-    } else if (packetQueue.empty()) {
+    }
+    if (depth == 0) {
       return BULKIO::IDLE;
     } else {
       return BULKIO::ACTIVE;
@@ -150,7 +269,7 @@ namespace bulkio {
   int  InPort<PortType>::getCurrentQueueDepth()
   {
     SCOPED_LOCK lock(dataBufferLock);
-    return packetQueue.size();
+    return _queueDepth();
   }
 
   template <typename PortType>
@@ -160,6 +279,98 @@ namespace bulkio {
     maxQueue = newDepth;
   }
 
+  template <typename PortType>
+  void InPort<PortType>::setCreditWindow(size_t elements)
+  {
+    SCOPED_LOCK lock(dataBufferLock);
+    creditWindow = elements;
+  }
+
+  template <typename PortType>
+  size_t InPort<PortType>::getCreditWindow()
+  {
+    SCOPED_LOCK lock(dataBufferLock);
+    return creditWindow;
+  }
+
+  template <typename PortType>
+  void InPort<PortType>::enableLockFreeQueue(bool enable)
+  {
+    SCOPED_LOCK lock(dataBufferLock);
+    if (enable == (lockFreeQueue != 0)) {
+      return;
+    }
+
+    if (enable) {
+      // The lock-free queue reserves space against the total depth, which
+      // does not apply to per-stream queues
+      if (streamQueuesEnabled) {
+        _mergeStreamQueues();
+        streamQueuesEnabled = false;
+      }
+
+      // Size the ring to hold a full queue; if the maximum queue depth is
+      // later raised, packets that do not fit go directly to packetQueue
+      lockFreeQueue = new LockFreeQueue(std::max(maxQueue, (size_t) 1));
+      lockFreeQueue->depth = packetQueue.size();
+    } else {
+      _disableLockFreeQueue(lock);
+    }
+  }
+
+  template <typename PortType>
+  bool InPort<PortType>::isLockFreeQueueEnabled()
+  {
+    SCOPED_LOCK lock(dataBufferLock);
+    return (lockFreeQueue != 0);
+  }
+
+  template <typename PortType>
+  void InPort<PortType>::enableStreamQueues(bool enable)
+  {
+    SCOPED_LOCK lock(dataBufferLock);
+    if (enable == streamQueuesEnabled) {
+      return;
+    }
+
+    if (enable) {
+      if (lockFreeQueue) {
+        _disableLockFreeQueue(lock);
+      }
+      streamQueuesEnabled = true;
+      _splitStreamQueues();
+    } else {
+      _mergeStreamQueues();
+      streamQueuesEnabled = false;
+    }
+
+    // Wake up any threads waiting on the previous queue layout so that they
+    // re-check with the new one
+    dataAvailable.notify_all();
+    queueAvailable.notify_all();
+  }
+
+  template <typename PortType>
+  bool InPort<PortType>::isStreamQueuesEnabled()
+  {
+    SCOPED_LOCK lock(dataBufferLock);
+    return streamQueuesEnabled;
+  }
+
+  template <typename PortType>
+  bool InPort<PortType>::getStreamQueueStatus(const std::string& streamID, StreamQueueStatus& status)
+  {
+    SCOPED_LOCK lock(dataBufferLock);
+    typename StreamQueueMap::iterator queue = streamQueues.find(streamID);
+    if (queue == streamQueues.end()) {
+      return false;
+    }
+    status.depth = queue->second->packets.size();
+    status.flushes = queue->second->flushes;
+    status.blocks = queue->second->blocks;
+    return true;
+  }
+
   template <typename PortType>
   void InPort<PortType>::setNewStreamListener(SriListener* newListener) {
       if (newListener) {
@@ -188,8 +399,8 @@ namespace bulkio {
 
     SCOPED_LOCK lock(sriUpdateLock);
     SriTable::iterator currH = currentHs.find(streamID);
-    StreamDescriptor sri(H);
     if (currH == currentHs.end()) {
+      StreamDescriptor sri(H);
       // No need to access the packet queue, release the lock
       data_lock.unlock();
 
@@ -204,9 +415,22 @@ namespace bulkio {
       createStream(streamID, sri);
     } else {
       int eos_count = 0;
-      for (typename PacketQueue::iterator ii = this->packetQueue.begin(); ii != this->packetQueue.end(); ++ii) {
-          if (((*ii)->streamID == streamID) and ((*ii)->EOS)) {
-              eos_count++;
+      _drainLockFreeQueue();
+      if (streamQueuesEnabled) {
+          typename StreamQueueMap::iterator queue = streamQueues.find(streamID);
+          if (queue != streamQueues.end()) {
+              const PacketQueue& packets = queue->second->packets;
+              for (typename PacketQueue::const_iterator ii = packets.begin(); ii != packets.end(); ++ii) {
+                  if ((*ii)->EOS) {
+                      eos_count++;
+                  }
+              }
+          }
+      } else {
+          for (typename PacketQueue::iterator ii = this->packetQueue.begin(); ii != this->packetQueue.end(); ++ii) {
+              if (((*ii)->streamID == streamID) and ((*ii)->EOS)) {
+                  eos_count++;
+              }
           }
       }
       // Finished accessing the packet queue, release the lock
@@ -214,7 +438,7 @@ namespace bulkio {
 
       int additional_streams = 1+pendingStreams.count(streamID); // count current and pending streams
       if (additional_streams == eos_count) { // current and pending streams are all eos
-        createStream(streamID, sri);
+        createStream(streamID, StreamDescriptor(H));
       } else {
         if (sri_cmp && !sri_cmp(H, currH->second.first.sri())) {
             LOG_DEBUG(_portLog,"pushSRI  PORT:" << name << " SAME SRI:" << streamID << " Mode:" << H.mode );
@@ -269,11 +493,22 @@ namespace bulkio {
 
   template <typename PortType>
   void  InPort<PortType>::queuePacket(const BufferType& data, const BULKIO::PrecisionUTCTime& T, CORBA::Boolean EOS, const std::string& streamID)
+  {
+    queuePacket(data, T, EOS, streamID, boost::shared_ptr<FlowCredit>());
+  }
+
+  template <typename PortType>
+  void  InPort<PortType>::queuePacket(const BufferType& data, const BULKIO::PrecisionUTCTime& T, CORBA::Boolean EOS, const std::string& streamID,
+                                      const boost::shared_ptr<FlowCredit>& credit)
   {
     TRACE_ENTER( _portLog, "InPort::pushPacket"  );
 
     // Discard packets for disabled streams
     if (!_acceptPacket(streamID, EOS)) {
+        // The packet is never queued, so its credit is returned immediately
+        if (credit) {
+            credit->release(_getElementLength(data));
+        }
         if (EOS) {
             // If this was the only blocking stream, turn off blocking
             bool turnOffBlocking = _handleEOS(streamID);
@@ -286,13 +521,16 @@ namespace bulkio {
     }
 
     if (maxQueue == 0) {
+      if (credit) {
+        credit->release(_getElementLength(data));
+      }
       TRACE_EXIT( _portLog, "InPort::pushPacket"  );
       return;
     }
 
     // Discard empty packets if EOS is not set, as there is no useful data or
     // metadata to be had--since T applies to the 1st sample (which does not
-    // exist), all we have is a stream ID
+    // exist), all we have is a stream ID (and no credit to return)
     if (data.empty() && !EOS) {
         return;
     }
@@ -326,33 +564,82 @@ namespace bulkio {
     }
 
     const size_t length = _getElementLength(data);
+
+    // Register as a writer before reading the lock-free queue pointer (the
+    // atomic operation is a full barrier), so that the queue cannot be
+    // deleted while this thread is using it
+    __sync_add_and_fetch(&lockFreeWriters, 1);
+    LockFreeQueue* queue = lockFreeQueue;
+    if (queue) {
+      // Try the lock-free path first; it only fails if the queue is full, in
+      // which case the normal path handles blocking or flushing
+      Packet* packet = new Packet(is_copy_required(data) ? copy_data(data) : data, T, EOS, sri, sriChanged, false);
+      packet->credit = credit;
+      packet->creditCount = length;
+      if (_queueLockFree(queue, packet)) {
+        const size_t depth = queue->depth;
+        __sync_sub_and_fetch(&lockFreeWriters, 1);
+        {
+          SCOPED_LOCK lock(statsLock);
+          stats->update(length, (float)depth/(float)maxQueue, EOS, streamID, false);
+        }
+        packetWaiters.notify(streamID);
+        _dataArrived();
+        TRACE_EXIT( _portLog, "InPort::pushPacket"  );
+        return;
+      }
+      // The normal path below creates a new packet to hold the credit
+      packet->credit.reset();
+      delete packet;
+    }
+    __sync_sub_and_fetch(&lockFreeWriters, 1);
+
     {
       bool flushToReport = false;
       SCOPED_LOCK lock(dataBufferLock);
       LOG_DEBUG(_portLog, "bulkio::InPort port blocking:" << blocking);
+      _drainLockFreeQueue();
+
+      // With per-stream queues, the maximum depth, blocking and flushing all
+      // apply only to this stream's queue
+      boost::shared_ptr<StreamQueue> streamQueue;
+      if (streamQueuesEnabled) {
+        streamQueue = _getStreamQueue(streamID);
+      }
+      PacketQueue& queue = streamQueue ? streamQueue->packets : packetQueue;
+      CONDITION& spaceAvailable = streamQueue ? streamQueue->queueAvailable : queueAvailable;
+
       if (blocking) {
-        while (packetQueue.size() >= maxQueue) {
-          queueAvailable.wait(lock);
+        if (streamQueue && (queue.size() >= maxQueue)) {
+          streamQueue->blocks++;
+        }
+        while ((streamQueue ? queue.size() : _queueDepth()) >= maxQueue) {
+          spaceAvailable.wait(lock);
+          _drainLockFreeQueue();
         }
       } else {
-        if (packetQueue.size() >= maxQueue) { // reached maximum queue depth - flush the queue
-          LOG_DEBUG( _portLog, "bulkio::InPort pushPacket PURGE INPUT QUEUE (SIZE" << packetQueue.size() << ")" );
+        if ((streamQueue ? queue.size() : _queueDepth()) >= maxQueue) { // reached maximum queue depth - flush the queue
+          LOG_DEBUG( _portLog, "bulkio::InPort pushPacket PURGE INPUT QUEUE (SIZE" << queue.size() << ")" );
 
           // Need to hold the SRI mutex while flushing the queue because it may
           // update SRI change state
           SCOPED_LOCK lock(sriUpdateLock);
-          _flushQueue();
+          _flushQueue(queue);
+          if (streamQueue) {
+            streamQueue->flushes++;
+          }
 
           //
           // throw away first same stream id if EOS==False, update sriChanged with saved state
           //
-          for (typename PacketQueue::reverse_iterator riter = packetQueue.rbegin(); riter != packetQueue.rend(); ++riter) {
+          for (typename PacketQueue::reverse_iterator riter = queue.rbegin(); riter != queue.rend(); ++riter) {
               Packet* saved_packet = *riter;
               if ( streamID == saved_packet->streamID ) {
                   if ( saved_packet->EOS == false  ) {
                       sriChanged = saved_packet->sriChanged;
                       currentHs[streamID].second = false;
-                      packetQueue.erase( --riter.base());
+                      queue.erase( --riter.base());
+                      _packetsRemoved(1);
                       delete saved_packet;
                       flushToReport = true;
                   }
@@ -363,15 +650,30 @@ namespace bulkio {
         }
       }
 
-      LOG_TRACE(_portLog, "bulkio::InPort pushPacket NEW PACKET (QUEUE" << packetQueue.size()+1 << ")");
-      stats->update(length, (float)(packetQueue.size()+1)/(float)maxQueue, EOS, streamID, flushToReport);
+      const size_t depth = (streamQueue ? queue.size() : _queueDepth()) + 1;
+      LOG_TRACE(_portLog, "bulkio::InPort pushPacket NEW PACKET (QUEUE" << depth << ")");
+      {
+        SCOPED_LOCK lock(statsLock);
+        stats->update(length, (float)depth/(float)maxQueue, EOS, streamID, flushToReport);
+      }
       Packet *tmpIn;
       if (is_copy_required(data)) {
           tmpIn = new Packet(copy_data(data), T, EOS, sri, sriChanged, flushToReport);
       } else {
           tmpIn = new Packet(data, T, EOS, sri, sriChanged, flushToReport);
       }
-      packetQueue.push_back(tmpIn);
+      tmpIn->credit = credit;
+      tmpIn->creditCount = length;
+      queue.push_back(tmpIn);
+      if (lockFreeQueue) {
+        __sync_add_and_fetch(&lockFreeQueue->depth, 1);
+        lockFreeQueue->lockedPushes++;
+      }
+      if (streamQueue) {
+        tmpIn->sequence = packetSequence++;
+        streamQueueDepth++;
+        streamQueue->dataAvailable.notify_all();
+      }
 	
       if (EOS) {
           SCOPED_LOCK lock(sriUpdateLock);
@@ -385,13 +687,14 @@ namespace bulkio {
     }
 
     packetWaiters.notify(streamID);
+    _dataArrived();
 
     TRACE_EXIT( _portLog, "InPort::pushPacket"  );
   }
 
 
   template <typename PortType>
-  void InPort<PortType>::_flushQueue()
+  void InPort<PortType>::_flushQueue(PacketQueue& queue)
   {
       // Work in reverse order to track last packet of each stream. 
       //
@@ -408,7 +711,7 @@ namespace bulkio {
     PacketQueue last_packets;
 
     // iterate through the current packet queue starting from back
-    for (typename PacketQueue::reverse_iterator iter = packetQueue.rbegin(); iter != packetQueue.rend(); ++iter) {
+    for (typename PacketQueue::reverse_iterator iter = queue.rbegin(); iter != queue.rend(); ++iter) {
 
         Packet* packet = *iter;
           
@@ -467,7 +770,8 @@ namespace bulkio {
     }
 
     // swap the queues..
-    packetQueue.swap(last_packets);
+    queue.swap(last_packets);
+    _packetsRemoved(last_packets.size() - queue.size());
 
   }
 
@@ -479,19 +783,29 @@ namespace bulkio {
     uint64_t secs = (unsigned long)(trunc(timeout));
     uint64_t msecs = (unsigned long)((timeout - secs) * 1e6);
     boost::system_time to_time  = boost::get_system_time() + boost::posix_time::seconds(secs) + boost::posix_time::microseconds(msecs);
-    while (!breakBlock && packetQueue.empty()) {
+    _drainLockFreeQueue();
+    while (!breakBlock && (_queueDepth() == 0)) {
       if (timeout == 0) {
         break;
       } else if (timeout > 0) {
-        if (!dataAvailable.timed_wait(lock, to_time)) {
+        if (!_waitForData(lock, std::string(), to_time)) {
           break;
         }
       } else {
-        dataAvailable.wait(lock);
+        _waitForData(lock, std::string());
       }
+      _drainLockFreeQueue();
     }
 
-    if (breakBlock || packetQueue.empty()) {
+    if (breakBlock) {
+      return 0;
+    } else if (streamQueuesEnabled) {
+      typename StreamQueueMap::iterator queue = _oldestStreamQueue();
+      if (queue == streamQueues.end()) {
+        return 0;
+      }
+      return queue->second->packets.front();
+    } else if (packetQueue.empty()) {
       return 0;
     } else {
       return packetQueue.front();
@@ -513,6 +827,12 @@ namespace bulkio {
     TRACE_ENTER( _portLog, "InPort::block"  );
     breakBlock = true;
     dataAvailable.notify_all();
+    {
+      SCOPED_LOCK lock(dataBufferLock);
+      for (typename StreamQueueMap::iterator queue = streamQueues.begin(); queue != streamQueues.end(); ++queue) {
+        queue->second->dataAvailable.notify_all();
+      }
+    }
     packetWaiters.interrupt();
     TRACE_EXIT( _portLog, "InPort::block"  );
   }
@@ -640,13 +960,13 @@ namespace bulkio {
           TRACE_EXIT(_portLog, "InPort::nextPacket");
           return NULL;
         } else if (timeout > 0){
-          if (!dataAvailable.timed_wait(lock, to_time)) {
+          if (!_waitForData(lock, streamID, to_time)) {
             TRACE_EXIT(_portLog, "InPort::nextPacket");
             return NULL;
           }
         } else {
             to_time  = boost::get_system_time() + boost::posix_time::seconds(1);
-            while ((not breakBlock) and (not dataAvailable.timed_wait(lock, to_time))) {
+            while ((not breakBlock) and (not _waitForData(lock, streamID, to_time))) {
                 to_time  = boost::get_system_time() + boost::posix_time::seconds(1);
             }
         }
@@ -662,7 +982,7 @@ namespace bulkio {
         return NULL;
       }
 
-      LOG_TRACE(_portLog, "InPort::nextPacket PORT:" << name << " (QUEUE="<< packetQueue.size() << ")");
+      LOG_TRACE(_portLog, "InPort::nextPacket PORT:" << name << " (QUEUE="<< _queueDepth() << ")");
       queueAvailable.notify_all();
     }
 
@@ -729,12 +1049,34 @@ namespace bulkio {
   template <typename PortType>
   typename InPort<PortType>::Packet * InPort<PortType>::fetchPacket(const std::string &streamID)
   {
+    _drainLockFreeQueue();
+    if (streamQueuesEnabled) {
+      // Without a stream ID, take the oldest packet from any stream
+      typename StreamQueueMap::iterator queue;
+      if (streamID.empty()) {
+        queue = _oldestStreamQueue();
+      } else {
+        queue = streamQueues.find(streamID);
+      }
+      if ((queue == streamQueues.end()) || queue->second->packets.empty()) {
+        return 0;
+      }
+      PacketQueue& packets = queue->second->packets;
+      Packet* packet = packets.front();
+      packets.pop_front();
+      _packetsRemoved(1);
+      queue->second->queueAvailable.notify_all();
+      _releaseStreamQueue(queue, packet->EOS);
+      return packet;
+    }
+
     if (streamID.empty()) {
       if (packetQueue.empty()) {
         return 0;
       }
       Packet* packet = packetQueue.front();
       packetQueue.pop_front();
+      _packetsRemoved(1);
       return packet;
     }
 
@@ -742,21 +1084,338 @@ namespace bulkio {
       if ((*ii)->streamID == streamID) {
         Packet* packet = *ii;
         bulkio::do_erase(packetQueue, ii);
+        _packetsRemoved(1);
         return packet;
       }
     }
     return 0;
   }
 
+  template <typename PortType>
+  bool InPort<PortType>::_waitForData(boost::unique_lock<boost::mutex>& lock, const std::string& streamID, const boost::system_time& deadline)
+  {
+    if (streamQueuesEnabled && !streamID.empty()) {
+      // Hold a reference to the queue while waiting, in case it is removed.
+      // A stream with no queue yet is not given one (a reader polling for
+      // unknown stream IDs would otherwise leave an entry behind for each);
+      // every new packet also signals dataAvailable, so wait on that instead.
+      boost::shared_ptr<StreamQueue> queue = _findStreamQueue(streamID);
+      if (queue) {
+        return queue->dataAvailable.timed_wait(lock, deadline);
+      }
+      return dataAvailable.timed_wait(lock, deadline);
+    }
+
+    if (!lockFreeQueue) {
+      return dataAvailable.timed_wait(lock, deadline);
+    }
+
+    if (_spinForData(lock)) {
+      return true;
+    }
+
+    // Register as a waiter before the final check; a writer that queues a
+    // packet after this point will see the waiter count and signal under the
+    // lock, which it cannot acquire until this thread is waiting
+    __sync_add_and_fetch(&lockFreeWaiters, 1);
+    bool result = true;
+    if (lockFreeQueue->packets.empty()) {
+      result = dataAvailable.timed_wait(lock, deadline);
+    }
+    __sync_sub_and_fetch(&lockFreeWaiters, 1);
+    return result;
+  }
+
+  template <typename PortType>
+  void InPort<PortType>::_waitForData(boost::unique_lock<boost::mutex>& lock, const std::string& streamID)
+  {
+    if (streamQueuesEnabled && !streamID.empty()) {
+      boost::shared_ptr<StreamQueue> queue = _findStreamQueue(streamID);
+      if (queue) {
+        queue->dataAvailable.wait(lock);
+      } else {
+        dataAvailable.wait(lock);
+      }
+      return;
+    }
+
+    if (!lockFreeQueue) {
+      dataAvailable.wait(lock);
+      return;
+    }
+
+    if (_spinForData(lock)) {
+      return;
+    }
+
+    __sync_add_and_fetch(&lockFreeWaiters, 1);
+    if (lockFreeQueue->packets.empty()) {
+      dataAvailable.wait(lock);
+    }
+    __sync_sub_and_fetch(&lockFreeWaiters, 1);
+  }
+
+  template <typename PortType>
+  bool InPort<PortType>::_spinForData(boost::unique_lock<boost::mutex>& lock)
+  {
+    // Writers on the lock-free path do not take dataBufferLock, so first give
+    // them a brief window to deliver a packet without a context switch. The
+    // lock is released while spinning, so that writers on the normal path and
+    // other readers are not held up; the caller moves any packets into the
+    // queue once it has the lock back.
+    LockFreeQueue* queue = lockFreeQueue;
+    const size_t pushes = queue->lockedPushes;
+    __sync_add_and_fetch(&queue->spinners, 1);
+    lock.unlock();
+    bool ready = false;
+    for (int spin = 0; spin < LOCKFREE_SPIN_COUNT; ++spin) {
+      if (!queue->packets.empty() || breakBlock) {
+        ready = true;
+        break;
+      }
+      detail::cpu_relax();
+    }
+    __sync_sub_and_fetch(&queue->spinners, 1);
+    lock.lock();
+
+    // While the lock was released, the lock-free queue may have been
+    // disabled, or a writer on the normal path may have queued a packet and
+    // signalled; either way the caller needs to check again
+    return ready || (lockFreeQueue != queue) || (queue->lockedPushes != pushes);
+  }
+
+  template <typename PortType>
+  bool InPort<PortType>::_queueLockFree(LockFreeQueue* queue, Packet* packet)
+  {
+    // Reserve space in the queue; if it is full, the caller needs to take the
+    // normal path to block or flush
+    size_t depth = queue->depth;
+    for (;;) {
+      if (depth >= maxQueue) {
+        return false;
+      }
+      size_t prev = __sync_val_compare_and_swap(&queue->depth, depth, depth + 1);
+      if (prev == depth) {
+        break;
+      }
+      depth = prev;
+    }
+
+    if (packet->EOS) {
+      // Stop tracking the SRI before the packet becomes visible to readers,
+      // so that a pushSRI for a new stream with the same stream ID is treated
+      // the same as on the normal path
+      SCOPED_LOCK lock(sriUpdateLock);
+      SriTable::iterator target = currentHs.find(packet->streamID);
+      if (target != currentHs.end()) {
+        currentHs.erase(target);
+      }
+    }
+
+    if (!queue->packets.push(packet)) {
+      // The maximum queue depth was raised beyond the ring capacity; space has
+      // already been reserved, so queue the packet directly (draining this
+      // queue first, even if it is being disabled, to preserve ordering)
+      SCOPED_LOCK lock(dataBufferLock);
+      _drainLockFreeQueue(queue);
+      packetQueue.push_back(packet);
+      queue->lockedPushes++;
+      dataAvailable.notify_all();
+      return true;
+    }
+
+    // Only signal if a reader is asleep (the atomic operation is a full
+    // barrier, so the waiter count is read after the packet is published)
+    if (__sync_add_and_fetch(&lockFreeWaiters, 0) > 0) {
+      SCOPED_LOCK lock(dataBufferLock);
+      dataAvailable.notify_all();
+    }
+    return true;
+  }
+
+  template <typename PortType>
+  void InPort<PortType>::_disableLockFreeQueue(boost::unique_lock<boost::mutex>& lock)
+  {
+    // Detach the queue first; the atomic operation is a full barrier, so any
+    // writer that registers after this point sees a null queue. Until it is
+    // deleted, the queue is still drained along with packetQueue, so that a
+    // writer's packets already in the ring stay ahead of its later packets on
+    // the normal path.
+    LockFreeQueue* queue = lockFreeQueue;
+    lockFreeQueue = 0;
+    detachedLockFreeQueue = queue;
+    __sync_synchronize();
+    _drainLockFreeQueue();
+
+    // Writers may need dataBufferLock to finish (to signal a waiter, or if
+    // the ring is full), so wait for them and for spinning readers with the
+    // lock released; both finish within a bounded amount of time
+    lock.unlock();
+    while ((__sync_add_and_fetch(&lockFreeWriters, 0) > 0) || (__sync_add_and_fetch(&queue->spinners, 0) > 0)) {
+      detail::cpu_relax();
+    }
+    lock.lock();
+
+    // No thread can reach the queue now; keep any packets that were still in
+    // the ring
+    _drainLockFreeQueue();
+    detachedLockFreeQueue = 0;
+    delete queue;
+    dataAvailable.notify_all();
+  }
+
+  template <typename PortType>
+  void InPort<PortType>::_drainLockFreeQueue()
+  {
+    if (detachedLockFreeQueue) {
+      _drainLockFreeQueue(detachedLockFreeQueue);
+    }
+    if (lockFreeQueue) {
+      _drainLockFreeQueue(lockFreeQueue);
+    }
+  }
+
+  template <typename PortType>
+  void InPort<PortType>::_drainLockFreeQueue(LockFreeQueue* queue)
+  {
+    Packet* packet;
+    while (queue->packets.pop(packet)) {
+      packetQueue.push_back(packet);
+    }
+  }
+
+  template <typename PortType>
+  size_t InPort<PortType>::_queueDepth()
+  {
+    if (lockFreeQueue) {
+      return lockFreeQueue->depth;
+    } else if (streamQueuesEnabled) {
+      return streamQueueDepth;
+    }
+    return packetQueue.size();
+  }
+
+  template <typename PortType>
+  void InPort<PortType>::_packetsRemoved(size_t count)
+  {
+    if (lockFreeQueue && count) {
+      __sync_sub_and_fetch(&lockFreeQueue->depth, count);
+    } else if (streamQueuesEnabled) {
+      streamQueueDepth -= count;
+    }
+  }
+
+  template <typename PortType>
+  boost::shared_ptr<typename InPort<PortType>::StreamQueue> InPort<PortType>::_getStreamQueue(const std::string& streamID)
+  {
+    boost::shared_ptr<StreamQueue>& queue = streamQueues[streamID];
+    if (!queue) {
+      queue.reset(new StreamQueue());
+    }
+    return queue;
+  }
+
+  template <typename PortType>
+  boost::shared_ptr<typename InPort<PortType>::StreamQueue> InPort<PortType>::_findStreamQueue(const std::string& streamID)
+  {
+    typename StreamQueueMap::iterator queue = streamQueues.find(streamID);
+    if (queue == streamQueues.end()) {
+      return boost::shared_ptr<StreamQueue>();
+    }
+    return queue->second;
+  }
+
+  template <typename PortType>
+  typename InPort<PortType>::StreamQueueMap::iterator InPort<PortType>::_oldestStreamQueue()
+  {
+    // Compare the first packet of each stream; this is linear in the number
+    // of streams, rather than the number of queued packets
+    typename StreamQueueMap::iterator oldest = streamQueues.end();
+    for (typename StreamQueueMap::iterator queue = streamQueues.begin(); queue != streamQueues.end(); ++queue) {
+      const PacketQueue& packets = queue->second->packets;
+      if (packets.empty()) {
+        continue;
+      }
+      if ((oldest == streamQueues.end()) || (packets.front()->sequence < oldest->second->packets.front()->sequence)) {
+        oldest = queue;
+      }
+    }
+    return oldest;
+  }
+
+  template <typename PortType>
+  void InPort<PortType>::_releaseStreamQueue(typename StreamQueueMap::iterator queue, bool EOS)
+  {
+    // The map holds the only reference unless a reader or writer is waiting
+    // on the queue, in which case it must stay (it is removed after the next
+    // end-of-stream instead)
+    if (EOS && queue->second->packets.empty() && queue->second.unique()) {
+      streamQueues.erase(queue);
+    }
+  }
+
+  namespace {
+    template <class Packet>
+    inline bool packet_sequence_less(const Packet* lhs, const Packet* rhs)
+    {
+      return lhs->sequence < rhs->sequence;
+    }
+  }
+
+  template <typename PortType>
+  void InPort<PortType>::_splitStreamQueues()
+  {
+    streamQueueDepth = packetQueue.size();
+    for (typename PacketQueue::iterator ii = packetQueue.begin(); ii != packetQueue.end(); ++ii) {
+      (*ii)->sequence = packetSequence++;
+      _getStreamQueue((*ii)->streamID)->packets.push_back(*ii);
+    }
+    packetQueue.clear();
+  }
+
+  template <typename PortType>
+  void InPort<PortType>::_mergeStreamQueues()
+  {
+    for (typename StreamQueueMap::iterator queue = streamQueues.begin(); queue != streamQueues.end(); ++queue) {
+      PacketQueue& packets = queue->second->packets;
+      packetQueue.insert(packetQueue.end(), packets.begin(), packets.end());
+      packets.clear();
+      queue->second->queueAvailable.notify_all();
+      queue->second->dataAvailable.notify_all();
+    }
+    std::stable_sort(packetQueue.begin(), packetQueue.end(), &bulkio::packet_sequence_less<Packet>);
+    streamQueues.clear();
+    streamQueueDepth = 0;
+  }
+
   template <typename PortType>
   void InPort<PortType>::discardPacketsForStream(const std::string& streamID)
   {
     SCOPED_LOCK lock(dataBufferLock);
+    _drainLockFreeQueue();
+    if (streamQueuesEnabled) {
+      typename StreamQueueMap::iterator queue = streamQueues.find(streamID);
+      if (queue == streamQueues.end()) {
+        return;
+      }
+      PacketQueue& packets = queue->second->packets;
+      bool eos = false;
+      while (!packets.empty() && !eos) {
+        eos = packets.front()->EOS;
+        delete packets.front();
+        packets.pop_front();
+        _packetsRemoved(1);
+      }
+      queue->second->queueAvailable.notify_all();
+      _releaseStreamQueue(queue, eos);
+      return;
+    }
     for (typename PacketQueue::iterator ii = packetQueue.begin(); ii != packetQueue.end();) {
       if ((*ii)->streamID == streamID) {
         bool eos = (*ii)->EOS;
         delete *ii;
         ii = bulkio::do_erase(packetQueue, ii);
+        _packetsRemoved(1);
         queueAvailable.notify_one();
         if (eos) {
           break;
@@ -802,7 +1461,16 @@ namespace bulkio {
     size_t samples = 0;
     size_t item_size = 1;
     SCOPED_LOCK lock(dataBufferLock);
-    for (typename PacketQueue::iterator iter = packetQueue.begin(); iter != packetQueue.end(); ++iter) {
+    _drainLockFreeQueue();
+    PacketQueue* queue = &packetQueue;
+    if (streamQueuesEnabled) {
+      typename StreamQueueMap::iterator stream_queue = streamQueues.find(streamID);
+      if (stream_queue == streamQueues.end()) {
+        return 0;
+      }
+      queue = &(stream_queue->second->packets);
+    }
+    for (typename PacketQueue::iterator iter = queue->begin(); iter != queue->end(); ++iter) {
       Packet* packet = *iter;
       if (packet->streamID != streamID) {
         continue;
@@ -861,6 +1529,51 @@ namespace bulkio {
     return true;
   }
 
+  template <typename PortType>
+  bool InPort<PortType>::_isStreamCurrent(const StreamType& stream)
+  {
+    SCOPED_LOCK lock(streamsMutex);
+    typename StreamMap::iterator current = streams.find(stream.streamID());
+    if (current == streams.end()) {
+      return false;
+    }
+    return (current->second._impl == stream._impl);
+  }
+
+  template <typename PortType>
+  bool InPort<PortType>::_isStreamReady(StreamType& stream)
+  {
+    if (!stream.enabled()) {
+      return false;
+    } else if (stream.hasBufferedData()) {
+      return true;
+    }
+
+    // Once the stream's end-of-stream has been reported, any queued packets
+    // belong to the next stream with the same stream ID
+    if (!_isStreamCurrent(stream)) {
+      return false;
+    }
+    return _hasQueuedPacket(stream.streamID());
+  }
+
+  template <typename PortType>
+  bool InPort<PortType>::_hasQueuedPacket(const std::string& streamID)
+  {
+    SCOPED_LOCK lock(dataBufferLock);
+    _drainLockFreeQueue();
+    if (streamQueuesEnabled) {
+      typename StreamQueueMap::iterator queue = streamQueues.find(streamID);
+      return ((queue != streamQueues.end()) && !queue->second->packets.empty());
+    }
+    for (typename PacketQueue::iterator ii = packetQueue.begin(); ii != packetQueue.end(); ++ii) {
+      if ((*ii)->streamID == streamID) {
+        return true;
+      }
+    }
+    return false;
+  }
+
   template <typename PortType>
   bool InPort<PortType>::_acceptPacket(const std::string& streamID, bool EOS)
   {
@@ -22,9 +22,15 @@
 #include "bulkio_time_operators.h"
 #include "bulkio_in_port.h"
 #include "bulkio_p.h"
+#include "MirroredBuffer.h"
+
+#include <set>
+#include <stdexcept>
 
 #include <boost/make_shared.hpp>
 #include <boost/scoped_ptr.hpp>
+#include <boost/enable_shared_from_this.hpp>
+#include <boost/thread/mutex.hpp>
 #include <boost/ptr_container/ptr_deque.hpp>
 
 #include <ossie/bitops.h>
@@ -126,6 +132,11 @@ public:
         return (_eosState == EOS_REPORTED);
     }
 
+    InPortType* port() const
+    {
+        return _port;
+    }
+
     virtual bool hasBufferedData() const
     {
         // For the base class, there is no data to report; however, to nudge
@@ -299,9 +310,193 @@ void InputStream<PortType>::close()
     impl().close();
 }
 
+template <class PortType>
+typename InputStream<PortType>::InPortType* InputStream<PortType>::port() const
+{
+    return impl().port();
+}
+
 
 using bulkio::BufferedInputStream;
 
+namespace {
+
+    // Per-stream sample ring for BufferedInputStream's mirrored buffering
+    // mode. Incoming packet data is copied into a MirroredBuffer once, after
+    // which any window of queued samples (up to the capacity) can be returned
+    // as a single contiguous buffer without copying.
+    //
+    // Positions are absolute element counts since the ring was created, so
+    // that they can be compared without regard to wrap-around. Blocks handed
+    // out by read() pin their starting position until the last reference is
+    // released, and the writer never overwrites pinned data; the ring itself
+    // is kept alive by the blocks, so they may outlive the stream.
+    template <class BufferType>
+    class SampleRing;
+
+    template <typename T>
+    class SampleRing<redhawk::shared_buffer<T> > : public boost::enable_shared_from_this<SampleRing<redhawk::shared_buffer<T> > > {
+    public:
+        typedef redhawk::shared_buffer<T> BufferType;
+
+        static bool supported()
+        {
+            return true;
+        }
+
+        SampleRing(size_t capacity, size_t position) :
+            _memory(capacity * sizeof(T)),
+            _base(reinterpret_cast<T*>(_memory.data())),
+            _capacity(_memory.size() / sizeof(T)),
+            _readPos(position),
+            _writePos(position)
+        {
+        }
+
+        size_t capacity() const
+        {
+            return _capacity;
+        }
+
+        size_t readPosition() const
+        {
+            return _readPos;
+        }
+
+        size_t queued() const
+        {
+            return _writePos - _readPos;
+        }
+
+        // Number of elements that can be written without overwriting queued
+        // or pinned data
+        size_t writable()
+        {
+            size_t oldest = _readPos;
+            boost::mutex::scoped_lock lock(_mutex);
+            if (!_pinned.empty()) {
+                oldest = std::min(oldest, *_pinned.begin());
+            }
+            return oldest + _capacity - _writePos;
+        }
+
+        // Copies data into the ring, returning a non-owning view of the copy;
+        // the caller must ensure there is enough space
+        BufferType write(const BufferType& data)
+        {
+            T* dest = _address(_writePos);
+            std::copy(data.begin(), data.end(), dest);
+            _writePos += data.size();
+            return BufferType::make_transient(dest, data.size());
+        }
+
+        // Copies the unread data from another ring, keeping the same
+        // positions
+        void assign(const SampleRing& other)
+        {
+            _readPos = _writePos = other._readPos;
+            std::copy(other._address(_readPos), other._address(_readPos) + other.queued(), _address(_readPos));
+            _writePos += other.queued();
+        }
+
+        // Non-owning view of queued data at an absolute position
+        BufferType view(size_t position, size_t count) const
+        {
+            return BufferType::make_transient(_address(position), count);
+        }
+
+        // Returns an owning view of the next count elements from the read
+        // position
+        BufferType read(size_t count)
+        {
+            {
+                boost::mutex::scoped_lock lock(_mutex);
+                _pinned.insert(_readPos);
+            }
+            return BufferType(_address(_readPos), count, Release(this->shared_from_this(), _readPos));
+        }
+
+        void consume(size_t count)
+        {
+            _readPos += count;
+        }
+
+        void discard()
+        {
+            _readPos = _writePos;
+        }
+
+    private:
+        struct Release {
+            Release(const boost::shared_ptr<SampleRing>& ring, size_t position) :
+                ring(ring),
+                position(position)
+            {
+            }
+
+            void operator() (T*)
+            {
+                ring->_unpin(position);
+            }
+
+            boost::shared_ptr<SampleRing> ring;
+            size_t position;
+        };
+
+        T* _address(size_t position) const
+        {
+            return _base + (position % _capacity);
+        }
+
+        void _unpin(size_t position)
+        {
+            // Blocks may be released from any thread
+            boost::mutex::scoped_lock lock(_mutex);
+            _pinned.erase(_pinned.find(position));
+        }
+
+        bulkio::detail::MirroredBuffer _memory;
+        T* _base;
+        const size_t _capacity;
+
+        // Only accessed by the reading thread
+        size_t _readPos;
+        size_t _writePos;
+
+        boost::mutex _mutex;
+        std::multiset<size_t> _pinned;
+    };
+
+    // Bit data is not byte-addressable, and does not support mirrored
+    // buffering
+    template <>
+    class SampleRing<redhawk::shared_bitbuffer> {
+    public:
+        typedef redhawk::shared_bitbuffer BufferType;
+
+        static bool supported()
+        {
+            return false;
+        }
+
+        SampleRing(size_t, size_t)
+        {
+            throw std::logic_error("mirrored buffering is not supported for bit data");
+        }
+
+        size_t capacity() const { return 0; }
+        size_t readPosition() const { return 0; }
+        size_t queued() const { return 0; }
+        size_t writable() { return 0; }
+        BufferType write(const BufferType& data) { return data; }
+        void assign(const SampleRing&) { }
+        BufferType view(size_t, size_t) const { return BufferType(); }
+        BufferType read(size_t) { return BufferType(); }
+        void consume(size_t) { }
+        void discard() { }
+    };
+}
+
 template <class PortType>
 class BufferedInputStream<PortType>::Impl : public Base::Impl {
 public:
@@ -311,13 +506,15 @@ public:
     typedef typename NativeTraits<PortType>::NativeType NativeType;
     typedef typename BufferTraits<PortType>::BufferType BufferType;
     typedef typename BufferTraits<PortType>::MutableBufferType MutableBufferType;
+    typedef SampleRing<BufferType> RingType;
 
     Impl(const bulkio::StreamDescriptor& sri, InPortType* port) :
         ImplBase(sri, port),
         _queue(),
         _pending(0),
         _samplesQueued(0),
-        _sampleOffset(0)
+        _sampleOffset(0),
+        _ring()
     {
     }
 
@@ -490,6 +687,9 @@ public:
         _queue.clear();
         _sampleOffset = 0;
         _samplesQueued = 0;
+        if (_ring) {
+            _ring->discard();
+        }
 
         // Delete pending packet (it's safe to delete null pointers)
         delete _pending;
@@ -504,7 +704,61 @@ public:
         return ImplBase::hasBufferedData();
     }
 
+    bool enableMirroredBuffer(size_t capacity)
+    {
+        if (!RingType::supported()) {
+            return false;
+        }
+
+        // The ring must be able to hold everything that is already queued,
+        // including the consumed part of the first packet, which keeps the
+        // per-packet offsets intact
+        size_t total = _samplesQueued + _sampleOffset;
+        if (_ring) {
+            if (capacity <= _ring->capacity()) {
+                return true;
+            }
+            total = _ring->queued() + _sampleOffset;
+        }
+
+        boost::shared_ptr<RingType> ring;
+        try {
+            ring = boost::make_shared<RingType>(std::max(capacity, total), 0);
+        } catch (const std::exception&) {
+            return false;
+        }
+
+        // Copy the queued packets into the new ring and repoint them
+        for (typename QueueType::iterator packet = _queue.begin(); packet != _queue.end(); ++packet) {
+            packet->buffer = ring->write(packet->buffer);
+        }
+        ring->consume(_sampleOffset);
+        _ring = ring;
+        return true;
+    }
+
+    void disableMirroredBuffer()
+    {
+        if (!_ring) {
+            return;
+        }
+
+        // Give each queued packet its own copy of its data, since the views
+        // into the ring do not own the memory
+        for (typename QueueType::iterator packet = _queue.begin(); packet != _queue.end(); ++packet) {
+            packet->buffer = packet->buffer.copy();
+        }
+        _ring.reset();
+    }
+
+    bool isMirroredBufferEnabled() const
+    {
+        return static_cast<bool>(_ring);
+    }
+
 private:
+    typedef boost::ptr_deque<PacketType> QueueType;
+
     void _consumeData(size_t count)
     {
         while (count > 0) {
@@ -516,6 +770,9 @@ private:
             _sampleOffset += pass;
             _samplesQueued -= pass;
             count -= pass;
+            if (_ring) {
+                _ring->consume(pass);
+            }
 
             if (_sampleOffset >= data.size()) {
                 // Read pointer has passed the end of the packet data
@@ -563,11 +820,23 @@ private:
         if (last_offset <= front.buffer.size()) {
             // The requsted sample count can be satisfied from the first packet
             _addTimestamp(data, _sampleOffset, 0, front.T);
-            data.buffer(front.buffer.slice(_sampleOffset, last_offset));
+            if (_ring) {
+                // The packet buffer is only a view into the ring
+                data.buffer(_ring->read(count));
+            } else {
+                data.buffer(front.buffer.slice(_sampleOffset, last_offset));
+            }
         } else {
-            // We have to span multiple packets to get the data
-            MutableBufferType buffer(count);
-            data.buffer(buffer);
+            // We have to span multiple packets to get the data; with mirrored
+            // buffering it is already contiguous, so only the timestamps need
+            // to be gathered from the packets
+            MutableBufferType buffer;
+            if (_ring) {
+                data.buffer(_ring->read(count));
+            } else {
+                buffer = MutableBufferType(count);
+                data.buffer(buffer);
+            }
             size_t data_offset = 0;
 
             // Assemble data spanning several input packets into the output buffer
@@ -585,7 +854,9 @@ private:
                 const size_t available = input_data.size() - packet_offset;
                 const size_t pass = std::min(available, count);
 
-                buffer.replace(data_offset, pass, input_data, packet_offset);
+                if (!_ring) {
+                    buffer.replace(data_offset, pass, input_data, packet_offset);
+                }
                 data_offset += pass;
                 packet_offset += pass;
                 count -= pass;
@@ -685,6 +956,9 @@ private:
         } else {
             // Add the packet to the queue, taking ownership; it will be deleted when
             // it's consumed
+            if (_ring) {
+                _writeRing(packet->buffer);
+            }
             _samplesQueued += packet->buffer.size();
             _queue.push_back(packet);
             return true;
@@ -696,10 +970,48 @@ private:
         return !(packet->sriChanged || packet->inputQueueFlushed);
     }
 
-    boost::ptr_deque<PacketType> _queue;
+    void _writeRing(BufferType& buffer)
+    {
+        if (_ring->writable() < buffer.size()) {
+            _growRing(buffer.size());
+        }
+        // Replace the packet's data with a view of the copy in the ring, so
+        // that the rest of the sample accounting is unchanged
+        buffer = _ring->write(buffer);
+    }
+
+    void _growRing(size_t count)
+    {
+        // Either the ring is too small for the queued data plus the new
+        // packet, or older blocks that are still held by the reader pin the
+        // space; in both cases, move the queued data to a new ring (the old
+        // one lives on until the last block referencing it is released)
+        // NB: The consumed part of the first packet is included in the size
+        // so that every packet fits within the mirrored span
+        const size_t required = _sampleOffset + _ring->queued() + count;
+        size_t capacity = _ring->capacity();
+        while (capacity < required) {
+            capacity *= 2;
+        }
+        boost::shared_ptr<RingType> ring = boost::make_shared<RingType>(capacity, _ring->readPosition());
+        ring->assign(*_ring);
+
+        // Repoint the queued packets at the new ring; the packets are stored
+        // back-to-back, starting at the beginning of the first packet
+        size_t position = ring->readPosition() - _sampleOffset;
+        for (typename QueueType::iterator packet = _queue.begin(); packet != _queue.end(); ++packet) {
+            const size_t size = packet->buffer.size();
+            packet->buffer = ring->view(position, size);
+            position += size;
+        }
+        _ring = ring;
+    }
+
+    QueueType _queue;
     PacketType* _pending;
     size_t _samplesQueued;
     size_t _sampleOffset;
+    boost::shared_ptr<RingType> _ring;
 };
 
 template <class PortType>
@@ -774,6 +1086,24 @@ bool BufferedInputStream<PortType>::ready()
     return impl().ready();
 }
 
+template <class PortType>
+bool BufferedInputStream<PortType>::enableMirroredBuffer(size_t capacity)
+{
+    return impl().enableMirroredBuffer(capacity);
+}
+
+template <class PortType>
+void BufferedInputStream<PortType>::disableMirroredBuffer()
+{
+    impl().disableMirroredBuffer();
+}
+
+template <class PortType>
+bool BufferedInputStream<PortType>::isMirroredBufferEnabled() const
+{
+    return impl().isMirroredBufferEnabled();
+}
+
 template <class PortType>
 typename BufferedInputStream<PortType>::Impl& BufferedInputStream<PortType>::impl()
 {
@@ -18,11 +18,14 @@
  * along with this program.  If not, see http://www.gnu.org/licenses/.
  */
 
+#include <stdexcept>
+
 #include <bulkio_out_port.h>
 #include <BulkioTransport.h>
 
 #include "LocalTransport.h"
 #include "CorbaTransport.h"
+#include "FlowCredit.h"
 #include "bulkio_p.h"
 
 // Suppress warnings for access to deprecated currentSRI member (on gcc 4.4, at
@@ -42,7 +45,10 @@ namespace bulkio {
                                  LOGGER_PTR logger,
                                  ConnectionEventListener *connectCB,
                                  ConnectionEventListener *disconnectCB) :
-    redhawk::NegotiableUsesPort(name)
+    redhawk::NegotiableUsesPort(name),
+    _asyncQueueDepth(0),
+    _asyncPolicy(SEND_QUEUE_BLOCK),
+    _creditPolicy(CREDIT_WAIT)
   {
 
     if (!logger) {
@@ -68,7 +74,16 @@ namespace bulkio {
 
   template <typename PortType>
   OutPort<PortType>::~OutPort(){
+      // Stop the latency monitor first, as it may push data
+      _latencyMonitor.stop();
+      _latencyMonitor.clear();
 
+      // Stop any sender threads while the transports are still intact; the
+      // base class deletes them without disconnecting
+      SCOPED_LOCK lock(updatingPortsLock);
+      for (TransportIterator connection = _connections.begin(); connection != _connections.end(); ++connection) {
+          connection.transport()->disableAsync(false);
+      }
   }
 
 
@@ -124,6 +139,19 @@ namespace bulkio {
   template <typename PortType>
   void OutPort<PortType>::_connectListenerAdapter(const std::string& connectionId)
   {
+      {
+          SCOPED_LOCK lock(updatingPortsLock);
+          for (TransportIterator connection = _connections.begin(); connection != _connections.end(); ++connection) {
+              if (connection.connectionId() == connectionId) {
+                  if (_asyncQueueDepth > 0) {
+                      connection.transport()->enableAsync(_asyncQueueDepth, _asyncPolicy);
+                  }
+                  connection.transport()->setCreditPolicy(_creditPolicy);
+                  break;
+              }
+          }
+      }
+
       if (_connectCB) {
           (*_connectCB)(connectionId.c_str());
       }
@@ -189,10 +217,23 @@ namespace bulkio {
     // grab SRI context 
     StreamType stream = _getStream(streamID);
 
-    if (active) {
+    // Connections that need to wait for the reader to return credit are set
+    // aside and retried after waiting with the lock released, so that a slow
+    // reader does not hold up other threads using the port; the time spent
+    // is reported in the connection's statistics when the packet goes out
+    std::map<std::string,double> waiting;
+    bool retry = false;
+    while (active) {
+        std::vector<boost::shared_ptr<FlowCredit> > credits;
+        std::vector<size_t> counts;
         for (TransportIterator connection = _connections.begin(); connection != _connections.end(); ++connection) {
             PortTransportType* transport = connection.transport();
             const std::string& connection_id = connection.connectionId();
+            std::map<std::string,double>::iterator wait = waiting.find(connection_id);
+            if (retry && (wait == waiting.end())) {
+                continue;
+            }
+
             // Skip ports known to be dead
             if (!transport->isAlive()) {
                 continue;
@@ -204,6 +245,20 @@ namespace bulkio {
                 continue;
             }
 
+            size_t elements = 0;
+            boost::shared_ptr<FlowCredit> credit = transport->creditWait(data, EOS, elements);
+            if (credit) {
+                waiting.insert(std::make_pair(connection_id, 0.0));
+                credits.push_back(credit);
+                counts.push_back(elements);
+                continue;
+            }
+
+            if (wait != waiting.end()) {
+                transport->recordCreditWait(wait->second);
+                waiting.erase(wait);
+            }
+
             try {
                 transport->pushSRI(streamID, stream.sri(), stream.modcount());
                 transport->pushPacket(data, T, EOS, streamID, stream.sri());
@@ -215,6 +270,25 @@ namespace bulkio {
                 LOG_ERROR(_portLog, "pushPacket error on connection '" << connection_id << "': " << err.what());
             }
         }
+
+        if (credits.empty()) {
+            break;
+        }
+
+        // Wait in short intervals, checking again under the lock each time,
+        // so that a connection that has been closed or has died is dropped
+        lock.unlock();
+        const boost::system_time start = boost::get_system_time();
+        for (size_t index = 0; index < credits.size(); ++index) {
+            credits[index]->wait(counts[index], 0.1);
+        }
+        const double waited = (boost::get_system_time() - start).total_microseconds() * 1e-6;
+        lock.lock();
+
+        for (std::map<std::string,double>::iterator wait = waiting.begin(); wait != waiting.end(); ++wait) {
+            wait->second += waited;
+        }
+        retry = true;
     }
 
     // if we have end of stream removed old sri
@@ -239,6 +313,67 @@ namespace bulkio {
       return recStat._retn();
   }
 
+  template <typename PortType>
+  void OutPort<PortType>::setAsyncFanout(size_t queueDepth, SendQueuePolicy policy)
+  {
+      SCOPED_LOCK lock(updatingPortsLock);
+      _asyncQueueDepth = queueDepth;
+      _asyncPolicy = policy;
+      for (TransportIterator connection = _connections.begin(); connection != _connections.end(); ++connection) {
+          if (queueDepth > 0) {
+              connection.transport()->enableAsync(queueDepth, policy);
+          } else {
+              connection.transport()->disableAsync();
+          }
+      }
+  }
+
+  template <typename PortType>
+  void OutPort<PortType>::setConnectionAsync(const std::string& connectionId, size_t queueDepth, SendQueuePolicy policy)
+  {
+      SCOPED_LOCK lock(updatingPortsLock);
+      for (TransportIterator connection = _connections.begin(); connection != _connections.end(); ++connection) {
+          if (connection.connectionId() == connectionId) {
+              if (queueDepth > 0) {
+                  connection.transport()->enableAsync(queueDepth, policy);
+              } else {
+                  connection.transport()->disableAsync();
+              }
+              return;
+          }
+      }
+      throw std::invalid_argument("no connection '" + connectionId + "' on port " + name);
+  }
+
+  template <typename PortType>
+  void OutPort<PortType>::setCreditPolicy(CreditPolicy policy)
+  {
+      SCOPED_LOCK lock(updatingPortsLock);
+      _creditPolicy = policy;
+      for (TransportIterator connection = _connections.begin(); connection != _connections.end(); ++connection) {
+          connection.transport()->setCreditPolicy(policy);
+      }
+  }
+
+  template <typename PortType>
+  bool OutPort<PortType>::_canWrite(const std::string& streamID, size_t elements)
+  {
+      SCOPED_LOCK lock(updatingPortsLock);
+      if (!active) {
+          return true;
+      }
+      for (TransportIterator connection = _connections.begin(); connection != _connections.end(); ++connection) {
+          PortTransportType* transport = connection.transport();
+          if (!transport->isAlive() || !_isStreamRoutedToConnection(streamID, connection.connectionId())) {
+              continue;
+          }
+          if (!transport->hasCredit(elements)) {
+              return false;
+          }
+      }
+      return true;
+  }
+
   template <typename PortType>
   BULKIO::PortUsageType OutPort<PortType>::state()
   {
@@ -282,6 +417,25 @@ namespace bulkio {
   }
 
 
+  template <typename PortType>
+  void OutPort<PortType>::_scheduleLatencyCheck(const std::string& streamID, const boost::system_time& when)
+  {
+      _latencyMonitor.schedule(when, &OutPort::_checkLatency, this, streamID);
+      _latencyMonitor.start();
+  }
+
+  template <typename PortType>
+  void OutPort<PortType>::_checkLatency(const std::string& streamID)
+  {
+      // Look up the stream by ID, rather than holding a reference to it, so
+      // that pending checks do not keep closed streams alive; the port lock
+      // must not be held while the stream flushes
+      StreamType stream = getStream(streamID);
+      if (stream) {
+          stream._checkLatency();
+      }
+  }
+
   template <typename PortType>
   typename OutPort<PortType>::StreamType OutPort<PortType>::getStream(const std::string& streamID)
   {
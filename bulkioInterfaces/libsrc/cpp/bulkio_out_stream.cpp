@@ -19,6 +19,10 @@
  */
 #include <ossie/prop_helpers.h>
 
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/thread_time.hpp>
+
 #include "bulkio_out_stream.h"
 #include "bulkio_out_port.h"
 #include "bulkio_time_operators.h"
@@ -123,9 +127,7 @@ public:
         redhawk::PropertyMap & sri_keywords = redhawk::PropertyMap::cast(_sri->keywords);
         redhawk::PropertyMap::const_iterator it = sri_keywords.find(name);
         if ( it != sri_keywords.end() ) {
-            const CORBA::Any & value_orig = it->getValue();
-            std::string action("eq");
-            if ( ossie::compare_anys(value_orig, value, action) ) {
+            if ( bulkio::sri::compareKeywordValues(it->getValue(), value) ) {
                 return;
             }
         }
@@ -167,12 +169,31 @@ public:
         return _modcount;
     }
 
+    bool canWrite(size_t count) const
+    {
+        // Credit is counted in scalar elements, two per complex sample
+        if (_sri->mode) {
+            count *= 2;
+        }
+        return _port->_canWrite(_streamID, count);
+    }
+
+    virtual void checkLatency()
+    {
+        // By default, there is no buffered data to flush
+    }
+
 protected:
     virtual void _modifyingStreamMetadata()
     {
         // By default, do nothing
     }
 
+    void _scheduleLatencyCheck(const boost::system_time& when)
+    {
+        _port->_scheduleLatencyCheck(_streamID, when);
+    }
+
     template <typename Field, typename Value>
     void _setStreamMetadata(Field& field, Value value)
     {
@@ -294,6 +315,12 @@ void OutputStream<PortType>::eraseKeyword(const std::string& name)
     impl().eraseKeyword(name);
 }
 
+template <class PortType>
+bool OutputStream<PortType>::canWrite(size_t count) const
+{
+    return impl().canWrite(count);
+}
+
 template <class PortType>
 void OutputStream<PortType>::close()
 {
@@ -337,6 +364,12 @@ int OutputStream<PortType>::modcount() const
     return impl().modcount();
 }
 
+template <class PortType>
+void OutputStream<PortType>::_checkLatency()
+{
+    impl().checkLatency();
+}
+
 
 using bulkio::BufferedOutputStream;
 
@@ -354,12 +387,24 @@ public:
     Impl(const BULKIO::StreamSRI& sri, OutPortType* port) :
         ImplBase::Impl(sri, port),
         _bufferSize(0),
-        _bufferOffset(0)
+        _bufferOffset(0),
+        _maxLatency(),
+        _latencyCheckPending(false),
+        _flushing(false)
     {
+        _statistics.size = 0;
+        _statistics.latency = 0;
+        _statistics.sri = 0;
+        _statistics.eos = 0;
+        _statistics.manual = 0;
+        _statistics.errors = 0;
     }
 
     void write(const BufferType& data, const BULKIO::PrecisionUTCTime& time)
     {
+        boost::mutex::scoped_lock lock(_mutex);
+        _waitForFlush(lock);
+
         // If buffering is disabled, or the buffer is empty and the input data is
         // large enough for a full buffer, send it immediately
         if ((_bufferSize == 0) || (_bufferOffset == 0 && (data.size() >= _bufferSize))) {
@@ -371,11 +416,15 @@ public:
 
     size_t bufferSize() const
     {
+        boost::mutex::scoped_lock lock(_mutex);
         return _bufferSize;
     }
 
     void setBufferSize(size_t samples)
     {
+        boost::mutex::scoped_lock lock(_mutex);
+        _waitForFlush(lock);
+
         // Avoid needless thrashing
         if (samples == _bufferSize) {
             return;
@@ -385,45 +434,158 @@ public:
         // If the new buffer size is less than (or exactly equal to) the
         // currently buffered data size, flush
         if (_bufferSize <= _bufferOffset) {
-            flush();
+            _flushBuffer(FLUSH_MANUAL);
         } else if (_bufferSize > _buffer.size()) {
             // The buffer size is increasing beyond the existing allocation
             _buffer.resize(_bufferSize);
         }
     }
 
-    void flush()
+    double maxLatency() const
     {
-        if (_bufferOffset == 0) {
-            return;
+        boost::mutex::scoped_lock lock(_mutex);
+        return _maxLatency.total_microseconds() * 1e-6;
+    }
+
+    void setMaxLatency(double seconds)
+    {
+        boost::mutex::scoped_lock lock(_mutex);
+        if (seconds > 0.0) {
+            _maxLatency = boost::posix_time::microseconds(static_cast<long>(seconds * 1e6));
+        } else {
+            _maxLatency = boost::posix_time::time_duration();
         }
 
-        _flush(false);
+        // Buffered data is subject to the new bound; the check may be earlier
+        // than one that is already scheduled, so force a new one
+        if ((_bufferOffset > 0) && _latencyBounded()) {
+            _latencyCheckPending = false;
+            _scheduleLatencyCheck();
+        }
+    }
+
+    FlushStatistics flushStatistics() const
+    {
+        boost::mutex::scoped_lock lock(_mutex);
+        return _statistics;
+    }
+
+    void flush()
+    {
+        boost::mutex::scoped_lock lock(_mutex);
+        _waitForFlush(lock);
+        _flushBuffer(FLUSH_MANUAL);
     }
 
     virtual void close()
     {
+        boost::mutex::scoped_lock lock(_mutex);
+        _waitForFlush(lock);
         if (_bufferOffset > 0) {
             // Add the end-of-stream marker to the buffered data and its timestamp
-            _flush(true);
+            _flush(true, FLUSH_EOS);
         } else {
             ImplBase::close();
         }
     }
 
+    virtual void checkLatency()
+    {
+        // Called on the port's monitor thread
+        boost::mutex::scoped_lock lock(_mutex);
+        _latencyCheckPending = false;
+        if (_flushing || (_bufferOffset == 0) || !_latencyBounded()) {
+            return;
+        }
+
+        // The buffer may have been flushed and refilled since the check was
+        // scheduled; if so, check again at the new deadline
+        const boost::system_time deadline = _bufferStartTime + _maxLatency;
+        if (boost::get_system_time() < deadline) {
+            _scheduleLatencyCheck();
+            return;
+        }
+
+        // Detach the buffered data and send it without holding the lock, so
+        // that this thread never holds the stream lock while it waits for the
+        // port; the writer waits for the push to finish before sending again
+        // to preserve ordering
+        BufferType data = _buffer.slice(0, _bufferOffset);
+        BULKIO::PrecisionUTCTime time = _bufferTime;
+        _resetBuffer();
+        ++_statistics.latency;
+        _flushing = true;
+        lock.unlock();
+
+        // There is no caller to report a failure to (an exception escaping
+        // would terminate the monitor thread's process), so log and count it
+        bool failed = true;
+        try {
+            this->_send(data, time, false);
+            failed = false;
+        } catch (const std::exception& exc) {
+            RH_ERROR(this->_port->getLogger(), "Latency flush of stream '" << _streamID << "' failed: " << exc.what());
+        } catch (...) {
+            RH_ERROR(this->_port->getLogger(), "Latency flush of stream '" << _streamID << "' failed: unknown exception");
+        }
+        _endFlush(failed);
+    }
+
 private:
+    enum FlushReason {
+        FLUSH_SIZE,
+        FLUSH_LATENCY,
+        FLUSH_SRI,
+        FLUSH_EOS,
+        FLUSH_MANUAL
+    };
+
     virtual void _modifyingStreamMetadata()
     {
         // Flush any data queued with the old SRI
-        flush();
+        boost::mutex::scoped_lock lock(_mutex);
+        _waitForFlush(lock);
+        _flushBuffer(FLUSH_SRI);
     }
 
-    void _flush(bool eos)
+    void _flushBuffer(FlushReason reason)
     {
+        if (_bufferOffset == 0) {
+            return;
+        }
+
+        _flush(false, reason);
+    }
+
+    void _flush(bool eos, FlushReason reason)
+    {
+        switch (reason) {
+        case FLUSH_SIZE:
+            ++_statistics.size;
+            break;
+        case FLUSH_LATENCY:
+            ++_statistics.latency;
+            break;
+        case FLUSH_SRI:
+            ++_statistics.sri;
+            break;
+        case FLUSH_EOS:
+            ++_statistics.eos;
+            break;
+        case FLUSH_MANUAL:
+            ++_statistics.manual;
+            break;
+        }
+
         // Push out all buffered data, which must be less than the full allocated
         // size otherwise it would have already been sent
-        this->_send(_buffer.slice(0, _bufferOffset), _bufferTime, eos);
+        BufferType data = _buffer.slice(0, _bufferOffset);
+        _resetBuffer();
+        this->_send(data, _bufferTime, eos);
+    }
 
+    void _resetBuffer()
+    {
         // Allocate a new buffer and reset the offset index
         _buffer = MutableBufferType(_bufferSize);
         _bufferOffset = 0;
@@ -435,6 +597,10 @@ private:
         // time of the buffered data
         if (_bufferOffset == 0) {
             _bufferTime = time;
+            if (_latencyBounded()) {
+                _bufferStartTime = boost::get_system_time();
+                _scheduleLatencyCheck();
+            }
         }
 
         // Only buffer up to the currently configured buffer size
@@ -444,7 +610,7 @@ private:
         // Advance buffer offset, flushing if the buffer is full
         _bufferOffset += count;
         if (_bufferOffset >= _bufferSize) {
-            _flush(false);
+            _flush(false, FLUSH_SIZE);
         }
 
         // Handle remaining data
@@ -454,10 +620,56 @@ private:
         }
     }
 
+    bool _latencyBounded() const
+    {
+        return !_maxLatency.is_special() && (_maxLatency.ticks() > 0);
+    }
+
+    void _scheduleLatencyCheck()
+    {
+        // Only one check per stream is ever outstanding; if the buffer is
+        // flushed for another reason first, the check reschedules itself for
+        // the current buffer's deadline
+        if (!_latencyCheckPending) {
+            _latencyCheckPending = true;
+            ImplBase::_scheduleLatencyCheck(_bufferStartTime + _maxLatency);
+        }
+    }
+
+    void _waitForFlush(boost::mutex::scoped_lock& lock)
+    {
+        while (_flushing) {
+            _flushed.wait(lock);
+        }
+    }
+
+    void _endFlush(bool failed)
+    {
+        boost::mutex::scoped_lock lock(_mutex);
+        if (failed) {
+            ++_statistics.errors;
+        }
+        _flushing = false;
+        _flushed.notify_all();
+    }
+
+    mutable boost::mutex _mutex;
     MutableBufferType _buffer;
     BULKIO::PrecisionUTCTime _bufferTime;
     size_t _bufferSize;
     size_t _bufferOffset;
+
+    // Latency bound: the monitor thread flushes the buffer once its first
+    // sample has been held for _maxLatency
+    boost::posix_time::time_duration _maxLatency;
+    boost::system_time _bufferStartTime;
+    bool _latencyCheckPending;
+
+    // Set while the monitor thread is pushing detached data
+    bool _flushing;
+    boost::condition_variable _flushed;
+
+    FlushStatistics _statistics;
 };
 
 template <class PortType>
@@ -490,6 +702,24 @@ void BufferedOutputStream<PortType>::flush()
     impl().flush();
 }
 
+template <class PortType>
+double BufferedOutputStream<PortType>::maxLatency() const
+{
+    return impl().maxLatency();
+}
+
+template <class PortType>
+void BufferedOutputStream<PortType>::setMaxLatency(double seconds)
+{
+    impl().setMaxLatency(seconds);
+}
+
+template <class PortType>
+typename BufferedOutputStream<PortType>::FlushStatistics BufferedOutputStream<PortType>::flushStatistics() const
+{
+    return impl().flushStatistics();
+}
+
 template <class PortType>
 void BufferedOutputStream<PortType>::write(const BufferType& data, const BULKIO::PrecisionUTCTime& time)
 {
@@ -88,6 +88,10 @@ namespace bulkio    {
 
   namespace sri {
 
+    // Compare a single SRI keyword value. Common basic types are compared
+    // directly; other types fall back to ossie::compare_anys.
+    bool compareKeywordValues(const CORBA::Any& lhs, const CORBA::Any& rhs);
+
     // Compare SRI keyword lists.
     bool compareKeywords(const _CORBA_Unbounded_Sequence<CF::DataType>& lhs,
                          const _CORBA_Unbounded_Sequence<CF::DataType>& rhs);
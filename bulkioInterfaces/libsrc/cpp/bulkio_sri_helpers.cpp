@@ -59,6 +59,86 @@ bool DefaultComparator( const BULKIO::StreamSRI &SRI_1, const BULKIO::StreamSRI
     return true;
 }
 
+namespace {
+    // Extracts and compares two values of a basic CORBA type; both Anys
+    // are known to have the same TypeCode kind
+    template <typename T>
+    inline bool compareBasic(const CORBA::Any& lhs, const CORBA::Any& rhs)
+    {
+        T lval;
+        T rval;
+        if ((lhs >>= lval) && (rhs >>= rval)) {
+            return (lval == rval);
+        }
+        return false;
+    }
+
+    // Boolean, char and octet require wrapper types for extraction
+    template <typename T, typename Wrapper>
+    inline bool compareWrapped(const CORBA::Any& lhs, const CORBA::Any& rhs)
+    {
+        T lval;
+        T rval;
+        if ((lhs >>= Wrapper(lval)) && (rhs >>= Wrapper(rval))) {
+            return (lval == rval);
+        }
+        return false;
+    }
+}
+
+bool compareKeywordValues(const CORBA::Any& lhs, const CORBA::Any& rhs)
+{
+    CORBA::TypeCode_var lhs_type = lhs.type();
+    CORBA::TypeCode_var rhs_type = rhs.type();
+    const CORBA::TCKind kind = lhs_type->kind();
+    if (kind != rhs_type->kind()) {
+        return false;
+    }
+
+    // Compare the common keyword types directly, rather than going through
+    // compare_anys, which dispatches every comparison on an action string
+    switch (kind) {
+    case CORBA::tk_boolean:
+        return compareWrapped<CORBA::Boolean,CORBA::Any::to_boolean>(lhs, rhs);
+    case CORBA::tk_char:
+        return compareWrapped<CORBA::Char,CORBA::Any::to_char>(lhs, rhs);
+    case CORBA::tk_octet:
+        return compareWrapped<CORBA::Octet,CORBA::Any::to_octet>(lhs, rhs);
+    case CORBA::tk_short:
+        return compareBasic<CORBA::Short>(lhs, rhs);
+    case CORBA::tk_ushort:
+        return compareBasic<CORBA::UShort>(lhs, rhs);
+    case CORBA::tk_long:
+        return compareBasic<CORBA::Long>(lhs, rhs);
+    case CORBA::tk_ulong:
+        return compareBasic<CORBA::ULong>(lhs, rhs);
+    case CORBA::tk_longlong:
+        return compareBasic<CORBA::LongLong>(lhs, rhs);
+    case CORBA::tk_ulonglong:
+        return compareBasic<CORBA::ULongLong>(lhs, rhs);
+    case CORBA::tk_float:
+        return compareBasic<CORBA::Float>(lhs, rhs);
+    case CORBA::tk_double:
+        return compareBasic<CORBA::Double>(lhs, rhs);
+    case CORBA::tk_string:
+        {
+            const char* lval;
+            const char* rval;
+            if ((lhs >>= lval) && (rhs >>= rval)) {
+                return (strcmp(lval, rval) == 0);
+            }
+        }
+        break;
+    default:
+        break;
+    }
+
+    // Anything else (including bounded strings) goes through the general
+    // framework comparison
+    std::string action = "eq";
+    return ossie::compare_anys(lhs, rhs, action);
+}
+
 bool compareKeywords(const _CORBA_Unbounded_Sequence<CF::DataType>& lhs,
                      const _CORBA_Unbounded_Sequence<CF::DataType>& rhs)
 {
@@ -66,12 +146,17 @@ bool compareKeywords(const _CORBA_Unbounded_Sequence<CF::DataType>& lhs,
         return false;
     }
 
-    std::string action = "eq";
+    // Sequences that share a buffer (e.g., comparing an SRI to itself) are
+    // trivially equal
+    if (lhs.get_buffer() == rhs.get_buffer()) {
+        return true;
+    }
+
     for (unsigned int index=0; index<lhs.length(); index++) {
         if (strcmp(lhs[index].id, rhs[index].id)) {
             return false;
         }
-        if (!ossie::compare_anys(lhs[index].value, rhs[index].value, action)) {
+        if (!compareKeywordValues(lhs[index].value, rhs[index].value)) {
             return false;
         }
     }
@@ -0,0 +1,146 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK bulkioInterfaces.
+ *
+ * REDHAWK bulkioInterfaces is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK bulkioInterfaces is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+#include "bulkio_stream_selector.h"
+#include "bulkio_p.h"
+
+#include <algorithm>
+
+#include <ossie/signalling.h>
+
+using bulkio::StreamSelector;
+
+template <class PortType>
+StreamSelector<PortType>::StreamSelector() :
+    _ports(),
+    _streams()
+{
+}
+
+template <class PortType>
+void StreamSelector<PortType>::addPort(InPortType* port)
+{
+    if (std::find(_ports.begin(), _ports.end(), port) == _ports.end()) {
+        _ports.push_back(port);
+    }
+}
+
+template <class PortType>
+void StreamSelector<PortType>::removePort(InPortType* port)
+{
+    _ports.remove(port);
+}
+
+template <class PortType>
+void StreamSelector<PortType>::addStream(const StreamType& stream)
+{
+    removeStream(stream);
+    _streams.push_back(Entry(stream.port(), stream));
+}
+
+template <class PortType>
+void StreamSelector<PortType>::removeStream(const StreamType& stream)
+{
+    InPortType* port = stream.port();
+    for (typename EntryList::iterator entry = _streams.begin(); entry != _streams.end(); ) {
+        if ((entry->port == port) && (entry->stream.streamID() == stream.streamID())) {
+            entry = _streams.erase(entry);
+        } else {
+            ++entry;
+        }
+    }
+}
+
+template <class PortType>
+void StreamSelector<PortType>::clear()
+{
+    _ports.clear();
+    _streams.clear();
+}
+
+template <class PortType>
+typename StreamSelector<PortType>::StreamList StreamSelector<PortType>::select(float timeout)
+{
+    // Create the waiter and attach it to every port's packet signal before
+    // checking readiness, so that no packets are missed in between
+    redhawk::signal<std::string>::waiter waiter(timeout);
+    for (typename PortList::iterator port = _ports.begin(); port != _ports.end(); ++port) {
+        waiter.attach(&(*port)->packetWaiters);
+    }
+
+    // If only individual streams are selected, ignore packets for other
+    // streams; the signal set is shared between ports, but a false wakeup
+    // only costs a readiness check
+    redhawk::signal<std::string>::signal_set stream_ids;
+    for (typename EntryList::iterator entry = _streams.begin(); entry != _streams.end(); ++entry) {
+        waiter.attach(&entry->port->packetWaiters);
+        if (_ports.empty()) {
+            stream_ids.insert(entry->stream.streamID());
+        }
+    }
+
+    StreamList result = getReadyStreams();
+    while (result.empty() && (!_ports.empty() || !_streams.empty())) {
+        if (!waiter.wait(stream_ids)) {
+            break;
+        }
+        result = getReadyStreams();
+    }
+    return result;
+}
+
+template <class PortType>
+typename StreamSelector<PortType>::StreamList StreamSelector<PortType>::getReadyStreams()
+{
+    StreamList result;
+    for (typename PortList::iterator port = _ports.begin(); port != _ports.end(); ++port) {
+        StreamList streams = (*port)->getStreams();
+        for (typename StreamList::iterator stream = streams.begin(); stream != streams.end(); ++stream) {
+            if ((*port)->_isStreamReady(*stream)) {
+                result.push_back(*stream);
+            }
+        }
+    }
+
+    for (typename EntryList::iterator entry = _streams.begin(); entry != _streams.end(); ) {
+        // Streams on selected ports have already been checked
+        if (std::find(_ports.begin(), _ports.end(), entry->port) != _ports.end()) {
+            ++entry;
+            continue;
+        }
+
+        // Drop streams that have been removed from their port
+        if (!entry->port->_isStreamCurrent(entry->stream)) {
+            entry = _streams.erase(entry);
+            continue;
+        }
+
+        if (entry->port->_isStreamReady(entry->stream)) {
+            result.push_back(entry->stream);
+        }
+        ++entry;
+    }
+    return result;
+}
+
+#define INSTANTIATE_TEMPLATE(x) \
+    template class StreamSelector<x>;
+
+FOREACH_PORT_TYPE(INSTANTIATE_TEMPLATE);
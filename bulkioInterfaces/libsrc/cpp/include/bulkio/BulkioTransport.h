@@ -20,6 +20,9 @@
 #ifndef __bulkio_BulkioTransport_h
 #define __bulkio_BulkioTransport_h
 
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+
 #include <ossie/Transport.h>
 
 #include "bulkio_base.h"
@@ -33,6 +36,41 @@ namespace bulkio {
     template <class PortType>
     class OutPort;
 
+    template <class PortType>
+    class AsyncSender;
+
+    class FlowCredit;
+
+    //
+    // Behavior of an asynchronous connection when its send queue is full:
+    //   SEND_QUEUE_BLOCK       - the caller waits for the sender thread to make room
+    //   SEND_QUEUE_DROP_NEWEST - the new packet is discarded
+    //   SEND_QUEUE_DROP_OLDEST - the oldest queued packet is discarded
+    //
+    // SRI updates and end-of-stream packets are never dropped.
+    //
+    enum SendQueuePolicy {
+        SEND_QUEUE_BLOCK,
+        SEND_QUEUE_DROP_NEWEST,
+        SEND_QUEUE_DROP_OLDEST
+    };
+
+    //
+    // Behavior of a connection with credit-based flow control when the reader
+    // has not returned enough credit to send a packet:
+    //   CREDIT_WAIT - the packet waits for the reader to return credit; for
+    //                 asynchronous connections the wait happens on the sender
+    //                 thread, otherwise the caller waits with the port
+    //                 unlocked
+    //   CREDIT_DROP - the packet is discarded
+    //
+    // End-of-stream packets are always sent immediately.
+    //
+    enum CreditPolicy {
+        CREDIT_WAIT,
+        CREDIT_DROP
+    };
+
     template <typename PortType>
     class OutputTransport : public redhawk::UsesTransport
     {
@@ -53,7 +91,44 @@ namespace bulkio {
 
         BULKIO::PortStatistics getStatistics();
 
+        //
+        // Hands pushes off to a dedicated sender thread with a bounded queue
+        // of up to queueDepth packets, so that a slow peer does not stall the
+        // caller; buffers are queued by reference, not copied
+        //
+        void enableAsync(size_t queueDepth, SendQueuePolicy policy);
+
+        //
+        // Returns to synchronous pushes; if drain is true, waits for queued
+        // pushes to be sent, otherwise discards them
+        //
+        void disableAsync(bool drain=true);
+
+        bool isAsync() const;
+
+        //
+        // Returns true if the connection can send count elements without
+        // exceeding the reader's credit; connections without credit-based
+        // flow control can always send
+        //
+        bool hasCredit(size_t count) const;
+
+        void setCreditPolicy(CreditPolicy policy);
+
+        //
+        // For a synchronous connection under CREDIT_WAIT, returns the credit
+        // that a packet must wait for before it can be pushed, and the number
+        // of elements to wait for; otherwise, returns a null pointer. The port
+        // waits without holding its lock, then reports the time spent with
+        // recordCreditWait().
+        //
+        boost::shared_ptr<FlowCredit> creditWait(const BufferType& data, bool EOS, size_t& elements);
+
+        void recordCreditWait(double seconds);
+
     protected:
+        friend class AsyncSender<PortType>;
+
         typedef OutPort<PortType> OutPortType;
         typedef typename PortType::_ptr_type PtrType;
         typedef typename PortType::_var_type VarType;
@@ -76,6 +151,20 @@ namespace bulkio {
 
         void _recordPush(const std::string& streamID, size_t elements, bool endOfStream);
 
+        //
+        // Enables credit-based flow control, once the transport has agreed on
+        // a window with the reader
+        //
+        void _enableCredit(const boost::shared_ptr<FlowCredit>& credit);
+
+        //
+        // Charges a packet against the credit, dropping according to the
+        // policy if there is not enough; returns false if the packet should
+        // be discarded. Only the asynchronous sender (passed as sender) waits
+        // here; synchronous pushes have already waited in the port.
+        //
+        bool _acquireCredit(size_t elements, bool EOS, AsyncSender<PortType>* sender);
+
         virtual redhawk::PropertyMap _getExtendedStatistics();
 
         //
@@ -89,9 +178,20 @@ namespace bulkio {
         VarType _objref;
         typedef std::map<std::string,int> VersionMap;
         VersionMap _sriVersions;
+        boost::shared_ptr<FlowCredit> _credit;
+
+        // Guards statistics that may be updated from the asynchronous sender
+        // thread; subclasses use it for their extended statistics as well
+        boost::mutex _statsMutex;
 
     private:
         linkStatistics _stats;
+        AsyncSender<PortType>* _sender;
+
+        CreditPolicy _creditPolicy;
+        uint64_t _creditExhausted;
+        uint64_t _creditDropped;
+        double _creditWaitTime;
     };
 
     template <class PortType>
@@ -108,6 +208,16 @@ namespace bulkio {
           _port->queuePacket(data, T, eos, streamID);
         }
 
+        //
+        // Queues a packet that holds flow control credit, which is returned
+        // to the sender once the packet leaves the port's queue
+        //
+        inline void _queuePacket(const BufferType& data, const BULKIO::PrecisionUTCTime& T, bool eos, const std::string& streamID,
+                                 const boost::shared_ptr<FlowCredit>& credit)
+        {
+          _port->queuePacket(data, T, eos, streamID, credit);
+        }
+
         InPortType* _port;
     };
 
@@ -57,11 +57,26 @@
 //
 #include "bulkio_in_port.h"
 
+//
+// Multi-stream readiness wait for input streams
+//
+#include "bulkio_stream_selector.h"
+
+//
+// Sample format conversion (SIMD-accelerated)
+//
+#include "bulkio_convert.h"
+
 //
 // Output (Uses) Port template definitions for Sequences and String types
 //
 #include "bulkio_out_port.h"
 
+//
+// Recording and playback of BLUE and raw files
+//
+#include "bulkio_file.h"
+
 //
 // Input/Output Port definitions for managing SDDS streams
 //
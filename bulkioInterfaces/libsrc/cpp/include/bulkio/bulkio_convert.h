@@ -0,0 +1,273 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK bulkioInterfaces.
+ *
+ * REDHAWK bulkioInterfaces is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK bulkioInterfaces is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+#ifndef __bulkio_convert_h
+#define __bulkio_convert_h
+
+#include <cstddef>
+#include <list>
+#include <stdint.h>
+
+#include <ossie/shared_buffer.h>
+#include <ossie/BufferManager.h>
+
+#include "bulkio_datablock.h"
+#include "bulkio_stream.h"
+
+namespace bulkio {
+
+    /**
+     * @brief  Sample format conversion for BulkIO data.
+     *
+     * The functions in this namespace convert between the BulkIO numeric
+     * sample formats. The array kernels select the best implementation for
+     * the CPU at runtime (AVX2, SSE4.1 or portable code), so callers do not
+     * need to be built with any special compiler flags.
+     *
+     * All array functions take a count of scalar elements; complex data is
+     * converted by treating each complex sample as two scalars.
+     */
+    namespace convert {
+
+        /**
+         * @name Integer to floating point
+         *
+         * Converts @a count elements from @a src to floating point, storing
+         * the results in @a dst, with each output multiplied by @a scale.
+         * For example, a scale of 1.0/32768 maps 16-bit A/D samples to the
+         * range [-1.0, 1.0).
+         *
+         * The float-to-float and double-to-double overloads apply only the
+         * scale.
+         */
+        ///@{
+        void toFloat(const int8_t* src, float* dst, size_t count, float scale=1.0f);
+        void toFloat(const uint8_t* src, float* dst, size_t count, float scale=1.0f);
+        void toFloat(const int16_t* src, float* dst, size_t count, float scale=1.0f);
+        void toFloat(const uint16_t* src, float* dst, size_t count, float scale=1.0f);
+        void toFloat(const int32_t* src, float* dst, size_t count, float scale=1.0f);
+        void toFloat(const uint32_t* src, float* dst, size_t count, float scale=1.0f);
+        void toFloat(const float* src, float* dst, size_t count, float scale=1.0f);
+        void toFloat(const double* src, float* dst, size_t count, float scale=1.0f);
+
+        void toDouble(const int8_t* src, double* dst, size_t count, double scale=1.0);
+        void toDouble(const uint8_t* src, double* dst, size_t count, double scale=1.0);
+        void toDouble(const int16_t* src, double* dst, size_t count, double scale=1.0);
+        void toDouble(const uint16_t* src, double* dst, size_t count, double scale=1.0);
+        void toDouble(const int32_t* src, double* dst, size_t count, double scale=1.0);
+        void toDouble(const uint32_t* src, double* dst, size_t count, double scale=1.0);
+        void toDouble(const float* src, double* dst, size_t count, double scale=1.0);
+        void toDouble(const double* src, double* dst, size_t count, double scale=1.0);
+        ///@}
+
+        /**
+         * @name Floating point to integer
+         *
+         * Converts @a count elements from @a src to integers, storing the
+         * results in @a dst. Each input is multiplied by @a scale, rounded to
+         * the nearest integer, and saturated to the range of the output type.
+         * NaN inputs produce an unspecified value.
+         */
+        ///@{
+        void fromFloat(const float* src, int8_t* dst, size_t count, float scale=1.0f);
+        void fromFloat(const float* src, uint8_t* dst, size_t count, float scale=1.0f);
+        void fromFloat(const float* src, int16_t* dst, size_t count, float scale=1.0f);
+        void fromFloat(const float* src, uint16_t* dst, size_t count, float scale=1.0f);
+        void fromFloat(const float* src, int32_t* dst, size_t count, float scale=1.0f);
+        void fromFloat(const float* src, uint32_t* dst, size_t count, float scale=1.0f);
+
+        void fromDouble(const double* src, int8_t* dst, size_t count, double scale=1.0);
+        void fromDouble(const double* src, uint8_t* dst, size_t count, double scale=1.0);
+        void fromDouble(const double* src, int16_t* dst, size_t count, double scale=1.0);
+        void fromDouble(const double* src, uint16_t* dst, size_t count, double scale=1.0);
+        void fromDouble(const double* src, int32_t* dst, size_t count, double scale=1.0);
+        void fromDouble(const double* src, uint32_t* dst, size_t count, double scale=1.0);
+        ///@}
+
+        /**
+         * @name Complex interleaving
+         *
+         * deinterleave() splits @a count interleaved complex samples (2 *
+         * @a count scalars) from @a src into separate @a real and @a imag
+         * arrays of @a count elements each. interleave() performs the
+         * inverse.
+         */
+        ///@{
+        void deinterleave(const int8_t* src, int8_t* real, int8_t* imag, size_t count);
+        void deinterleave(const uint8_t* src, uint8_t* real, uint8_t* imag, size_t count);
+        void deinterleave(const int16_t* src, int16_t* real, int16_t* imag, size_t count);
+        void deinterleave(const uint16_t* src, uint16_t* real, uint16_t* imag, size_t count);
+        void deinterleave(const int32_t* src, int32_t* real, int32_t* imag, size_t count);
+        void deinterleave(const uint32_t* src, uint32_t* real, uint32_t* imag, size_t count);
+        void deinterleave(const float* src, float* real, float* imag, size_t count);
+        void deinterleave(const double* src, double* real, double* imag, size_t count);
+
+        void interleave(const int8_t* real, const int8_t* imag, int8_t* dst, size_t count);
+        void interleave(const uint8_t* real, const uint8_t* imag, uint8_t* dst, size_t count);
+        void interleave(const int16_t* real, const int16_t* imag, int16_t* dst, size_t count);
+        void interleave(const uint16_t* real, const uint16_t* imag, uint16_t* dst, size_t count);
+        void interleave(const int32_t* real, const int32_t* imag, int32_t* dst, size_t count);
+        void interleave(const uint32_t* real, const uint32_t* imag, uint32_t* dst, size_t count);
+        void interleave(const float* real, const float* imag, float* dst, size_t count);
+        void interleave(const double* real, const double* imag, double* dst, size_t count);
+        ///@}
+
+        /**
+         * @name Byte swapping
+         *
+         * Reverses the byte order of each of @a count elements, either in
+         * place or from @a src to @a dst. This converts between network
+         * (big-endian) and host byte order on little-endian systems.
+         */
+        ///@{
+        void byteSwap(int16_t* data, size_t count);
+        void byteSwap(uint16_t* data, size_t count);
+        void byteSwap(int32_t* data, size_t count);
+        void byteSwap(uint32_t* data, size_t count);
+        void byteSwap(int64_t* data, size_t count);
+        void byteSwap(uint64_t* data, size_t count);
+        void byteSwap(float* data, size_t count);
+        void byteSwap(double* data, size_t count);
+
+        void byteSwap(const int16_t* src, int16_t* dst, size_t count);
+        void byteSwap(const uint16_t* src, uint16_t* dst, size_t count);
+        void byteSwap(const int32_t* src, int32_t* dst, size_t count);
+        void byteSwap(const uint32_t* src, uint32_t* dst, size_t count);
+        void byteSwap(const int64_t* src, int64_t* dst, size_t count);
+        void byteSwap(const uint64_t* src, uint64_t* dst, size_t count);
+        void byteSwap(const float* src, float* dst, size_t count);
+        void byteSwap(const double* src, double* dst, size_t count);
+        ///@}
+
+        /**
+         * @brief  Returns the name of the kernel set selected for this CPU
+         *         ("avx2", "sse4.1" or "generic").
+         */
+        const char* kernelName();
+
+        /// @cond IMPL
+        namespace detail {
+            // Selects toFloat or toDouble based on the output type
+            template <typename Out>
+            struct converter;
+
+            template <>
+            struct converter<float> {
+                template <typename In>
+                static void apply(const In* src, float* dst, size_t count, float scale)
+                {
+                    toFloat(src, dst, count, scale);
+                }
+            };
+
+            template <>
+            struct converter<double> {
+                template <typename In>
+                static void apply(const In* src, double* dst, size_t count, double scale)
+                {
+                    toDouble(src, dst, count, scale);
+                }
+            };
+
+            // Allocates a buffer from the per-thread buffer cache
+            template <typename T>
+            inline redhawk::buffer<T> allocate(size_t count)
+            {
+                return redhawk::buffer<T>(count, redhawk::BufferManager::Allocator<T>());
+            }
+        }
+        /// @endcond
+
+        /**
+         * @brief  Converts a buffer to floating point.
+         * @tparam Out  Output type (float or double).
+         * @param src  Input samples.
+         * @param scale  Multiplier applied to each output.
+         * @returns  A new buffer, allocated through the BufferManager so that
+         *           repeated conversions of the same size reuse memory.
+         */
+        template <typename Out, typename In>
+        redhawk::buffer<Out> toFloatingPoint(const redhawk::shared_buffer<In>& src, Out scale=Out(1))
+        {
+            redhawk::buffer<Out> dst = detail::allocate<Out>(src.size());
+            detail::converter<Out>::apply(src.data(), dst.data(), src.size(), scale);
+            return dst;
+        }
+
+        /**
+         * @brief  Converts a data block to floating point.
+         * @tparam Out  Output type (float or double).
+         * @param block  Input data block.
+         * @param scale  Multiplier applied to each output.
+         * @returns  A data block with the same SRI, time stamps and status
+         *           flags as @a block, or a null block if @a block is null.
+         */
+        template <typename Out, typename In>
+        SampleDataBlock<Out> toFloatingPoint(const SampleDataBlock<In>& block, Out scale=Out(1))
+        {
+            if (!block) {
+                return SampleDataBlock<Out>();
+            }
+            SampleDataBlock<Out> result(block.sri(), toFloatingPoint<Out>(block.buffer(), scale));
+            result.sriChangeFlags(block.sriChangeFlags());
+            result.inputQueueFlushed(block.inputQueueFlushed());
+            std::list<SampleTimestamp> timestamps = block.getTimestamps();
+            for (std::list<SampleTimestamp>::const_iterator ts = timestamps.begin(); ts != timestamps.end(); ++ts) {
+                result.addTimestamp(*ts);
+            }
+            return result;
+        }
+
+        /**
+         * @brief  Reads the next packet from an input stream and converts it
+         *         to floating point.
+         * @tparam Out  Output type (float or double).
+         * @param stream  Numeric input stream.
+         * @param scale  Multiplier applied to each output.
+         * @see  BufferedInputStream::read()
+         *
+         * Equivalent to converting the result of @c stream.read() with
+         * toFloatingPoint(), without holding on to the intermediate block.
+         */
+        template <typename Out, class Stream>
+        SampleDataBlock<Out> readPacket(Stream& stream, Out scale=Out(1))
+        {
+            return toFloatingPoint<Out>(stream.read(), scale);
+        }
+
+        /**
+         * @brief  Reads a specified number of samples from an input stream,
+         *         with overlap, and converts them to floating point.
+         * @tparam Out  Output type (float or double).
+         * @param stream  Numeric input stream.
+         * @param count  Number of samples to read.
+         * @param consume  Number of samples to advance read pointer.
+         * @param scale  Multiplier applied to each output.
+         * @see  BufferedInputStream::read(size_t,size_t)
+         */
+        template <typename Out, class Stream>
+        SampleDataBlock<Out> read(Stream& stream, size_t count, size_t consume, Out scale=Out(1))
+        {
+            return toFloatingPoint<Out>(stream.read(count, consume), scale);
+        }
+    }
+}
+
+#endif // __bulkio_convert_h
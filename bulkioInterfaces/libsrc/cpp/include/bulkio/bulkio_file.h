@@ -0,0 +1,432 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK bulkioInterfaces.
+ *
+ * REDHAWK bulkioInterfaces is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK bulkioInterfaces is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+#ifndef __bulkio_file_h
+#define __bulkio_file_h
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <list>
+#include <string>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/thread_time.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <ossie/shared_buffer.h>
+#include <BULKIO/bulkioDataTypes.h>
+
+#include "bulkio_datablock.h"
+
+namespace bulkio {
+
+    /**
+     * @brief  On-disk formats supported by FileWriter and FileReader.
+     */
+    enum FileFormat {
+        /**
+         * X-Midas BLUE file (type 1000 or 2000). The SRI is stored in the
+         * main header and adjunct, with SRI keywords in the extended header.
+         * Only the time of the first sample is kept, in the header timecode.
+         */
+        FILE_FORMAT_BLUE,
+        /**
+         * Raw sample data, with the SRI, keywords and time stamps stored in a
+         * text sidecar file with the same name plus ".sri".
+         */
+        FILE_FORMAT_RAW
+    };
+
+    /// @cond IMPL
+    namespace detail {
+        // X-Midas type character for a sample type, based on its size and
+        // whether it is an integer (signed and unsigned types of the same
+        // size are stored alike, as with the Python bluefile helpers)
+        template <size_t N, bool Integer>
+        struct file_type_code;
+
+        template <> struct file_type_code<1,true> { static const char value = 'B'; };
+        template <> struct file_type_code<2,true> { static const char value = 'I'; };
+        template <> struct file_type_code<4,true> { static const char value = 'L'; };
+        template <> struct file_type_code<8,true> { static const char value = 'X'; };
+        template <> struct file_type_code<4,false> { static const char value = 'F'; };
+        template <> struct file_type_code<8,false> { static const char value = 'D'; };
+
+        template <typename T>
+        struct file_type : public file_type_code<sizeof(T),std::numeric_limits<T>::is_integer> {
+        };
+
+        class MappedFile;
+
+        // Keeps a file mapping alive for as long as any buffer refers to it
+        struct mapped_file_deleter {
+            boost::shared_ptr<MappedFile> file;
+
+            void operator() (const void*) const
+            {
+            }
+        };
+    }
+    /// @endcond
+
+    /**
+     * @brief  Records sample data to a BLUE or raw file.
+     *
+     * %FileWriter is meant for sustained high-rate recording. Data is copied
+     * into one of two large page-aligned buffers; when a buffer fills, it is
+     * handed to a background thread to be written while the caller fills the
+     * other. Where the file system supports it, the file is opened with
+     * O_DIRECT so that recording does not evict useful data from the page
+     * cache.
+     *
+     * The SRI and data type are taken from the first write. Later writes must
+     * use the same sample type and complex mode; changes to other SRI fields
+     * are not recorded. Time stamps are kept where they differ from the time
+     * extrapolated from the previous time stamp (i.e., discontinuities).
+     *
+     * The file header (or, for raw files, the sidecar file) is written when
+     * the writer is closed, either explicitly or on destruction.
+     *
+     * I/O errors are reported by throwing std::runtime_error from the next
+     * call to write() or close().
+     */
+    class FileWriter {
+    public:
+        /**
+         * @brief  Default size of each of the two I/O buffers, in bytes.
+         */
+        static const size_t DEFAULT_BUFFER_SIZE = 4 * 1024 * 1024;
+
+        /**
+         * @brief  Creates a new file for recording.
+         * @param path  Path of the file to create; an existing file is
+         *              truncated.
+         * @param format  File format.
+         * @param bufferSize  Size of each I/O buffer, in bytes (rounded up to
+         *                    the page size).
+         * @throw std::runtime_error  If the file cannot be created.
+         */
+        FileWriter(const std::string& path, FileFormat format, size_t bufferSize=DEFAULT_BUFFER_SIZE);
+
+        /**
+         * @brief  Destructor.
+         *
+         * Closes the file if it is still open; any error is logged rather than
+         * thrown.
+         */
+        ~FileWriter();
+
+        /**
+         * @brief  Appends a data block.
+         * @param block  Sample data block read from an input stream.
+         * @throw std::logic_error  If the sample type or complex mode does not
+         *                          match the first write.
+         * @throw std::runtime_error  If a prior write to disk failed.
+         *
+         * Null blocks are ignored.
+         */
+        template <typename T>
+        void write(const SampleDataBlock<T>& block)
+        {
+            if (!block) {
+                return;
+            }
+            _write(block.sri(), block.buffer().data(), block.buffer().size(), sizeof(T),
+                   detail::file_type<T>::value, block.getTimestamps());
+        }
+
+        /**
+         * @brief  Appends sample data.
+         * @param sri  Stream SRI.
+         * @param data  Pointer to the first scalar value.
+         * @param count  Number of scalar values.
+         * @param time  Time stamp of the first sample.
+         * @throw std::logic_error  If the sample type or complex mode does not
+         *                          match the first write.
+         * @throw std::runtime_error  If a prior write to disk failed.
+         */
+        template <typename T>
+        void write(const BULKIO::StreamSRI& sri, const T* data, size_t count, const BULKIO::PrecisionUTCTime& time)
+        {
+            std::list<SampleTimestamp> timestamps;
+            timestamps.push_back(SampleTimestamp(time));
+            _write(sri, data, count, sizeof(T), detail::file_type<T>::value, timestamps);
+        }
+
+        /**
+         * @brief  Flushes all data and writes the header or sidecar.
+         * @throw std::runtime_error  If writing failed.
+         *
+         * Further writes are not allowed. Closing an already closed writer
+         * has no effect.
+         */
+        void close();
+
+        /**
+         * @brief  Returns true if the writer has not been closed.
+         */
+        bool isOpen() const;
+
+        /**
+         * @brief  Returns the path of the data file.
+         */
+        const std::string& path() const;
+
+        /**
+         * @brief  Returns the format of the file.
+         */
+        FileFormat format() const;
+
+        /**
+         * @brief  Returns the number of scalar values written so far.
+         */
+        size_t size() const;
+
+        /**
+         * @brief  Returns true if the data file was opened with O_DIRECT.
+         */
+        bool directIO() const;
+
+    private:
+        /// @cond IMPL
+        class Impl;
+
+        // Non-copyable, non-assignable
+        FileWriter(const FileWriter&);
+        FileWriter& operator=(const FileWriter&);
+
+        void _write(const BULKIO::StreamSRI& sri, const void* data, size_t count, size_t elementSize,
+                    char typeCode, const std::list<SampleTimestamp>& timestamps);
+
+        boost::shared_ptr<Impl> _impl;
+        /// @endcond
+    };
+
+    /**
+     * @brief  Memory-mapped access to a recorded BLUE or raw file.
+     *
+     * The data file is mapped into memory, and data() returns a
+     * redhawk::shared_buffer that points directly into the mapping, so
+     * playback does not copy the samples. The mapping remains valid as long
+     * as any buffer refers to it, even after the reader is destroyed.
+     *
+     * BLUE files written in the other byte order are swapped once when they
+     * are opened, into private copy-on-write pages.
+     *
+     * Errors in opening or parsing the file are reported by throwing
+     * std::runtime_error.
+     */
+    class FileReader {
+    public:
+        /**
+         * @brief  Opens a recorded file.
+         * @param path  Path of the data file. If a sidecar file named
+         *              @a path plus ".sri" exists, the file is read as raw
+         *              data; otherwise, it must be a BLUE file.
+         * @throw std::runtime_error  If the file cannot be opened or is not
+         *                            a supported format.
+         */
+        explicit FileReader(const std::string& path);
+
+        /**
+         * @brief  Returns the format of the file.
+         */
+        FileFormat format() const;
+
+        /**
+         * @brief  Returns the stream SRI stored with the file.
+         *
+         * For BLUE files, the stream ID is the base name of the file.
+         */
+        const BULKIO::StreamSRI& sri() const;
+
+        /**
+         * @brief  Returns the recorded time stamps.
+         *
+         * There is always at least one time stamp, at offset 0. Offsets are
+         * in samples (i.e., complex samples count once).
+         */
+        const std::list<SampleTimestamp>& timestamps() const;
+
+        /**
+         * @brief  Returns the time of a sample, extrapolated from the most
+         *         recent time stamp at or before it.
+         * @param offset  Sample offset (complex samples count once).
+         */
+        BULKIO::PrecisionUTCTime timeAt(size_t offset) const;
+
+        /**
+         * @brief  Returns true if the data is complex.
+         */
+        bool complex() const;
+
+        /**
+         * @brief  Returns the X-Midas type character of the data ('B', 'I',
+         *         'L', 'X', 'F' or 'D').
+         */
+        char typeCode() const;
+
+        /**
+         * @brief  Returns the number of scalar values in the file.
+         */
+        size_t size() const;
+
+        /**
+         * @brief  Returns the sample data.
+         * @tparam T  Sample type; must have the same size and integer-ness as
+         *            the stored type (e.g., short or unsigned short for 'I').
+         * @throw std::logic_error  If @a T does not match the stored type.
+         */
+        template <typename T>
+        redhawk::shared_buffer<T> data() const
+        {
+            _checkType(detail::file_type<T>::value);
+            detail::mapped_file_deleter deleter;
+            deleter.file = _file;
+            // The mapping is read-only; shared_buffer only provides const
+            // access to the data
+            T* base = static_cast<T*>(const_cast<void*>(_data()));
+            return redhawk::shared_buffer<T>(base, size(), deleter);
+        }
+
+    private:
+        /// @cond IMPL
+        void _openBlue(const std::string& path);
+        void _openRaw(const std::string& path, const std::string& sidecar);
+        void _checkType(char typeCode) const;
+        const void* _data() const;
+
+        FileFormat _format;
+        BULKIO::StreamSRI _sri;
+        std::list<SampleTimestamp> _timestamps;
+        char _typeCode;
+        boost::shared_ptr<detail::MappedFile> _file;
+        size_t _offset;
+        size_t _size;
+        /// @endcond
+    };
+
+    /**
+     * @brief  Plays a recorded file out of an output port, one packet at a
+     *         time.
+     * @tparam PortType  Numeric BulkIO output port type (e.g.,
+     *                   bulkio::OutFloatPort).
+     *
+     * Each packet is a slice of the file mapping, so no sample data is
+     * copied. In real-time mode, playPacket() sleeps until the wall clock
+     * time at which the packet's first sample is due, measured from the first
+     * call and the SRI xdelta; otherwise, packets are sent as fast as the
+     * port accepts them.
+     *
+     * A typical component service function calls playPacket() once per
+     * iteration, returning FINISH when it returns false.
+     */
+    template <class PortType>
+    class FilePlayer {
+    public:
+        typedef typename PortType::StreamType StreamType;
+        typedef typename StreamType::ScalarType ScalarType;
+
+        /**
+         * @brief  Creates a player.
+         * @param reader  Opened file.
+         * @param port  Output port to write to.
+         * @param packetSize  Number of samples per packet (complex samples
+         *                    count once).
+         * @param realTime  If true, pace packets according to the sample
+         *                  rate.
+         * @throw std::logic_error  If the port's sample type does not match
+         *                          the file.
+         */
+        FilePlayer(const FileReader& reader, PortType* port, size_t packetSize, bool realTime=false) :
+            _reader(reader),
+            _port(port),
+            _data(reader.data<ScalarType>()),
+            _scalarsPerSample(reader.complex() ? 2 : 1),
+            _packetSize(packetSize > 0 ? packetSize : 1),
+            _realTime(realTime),
+            _offset(0),
+            _started(false)
+        {
+        }
+
+        /**
+         * @brief  Sends the next packet.
+         * @returns  True if a packet was sent, or false if the end of the
+         *           file has been reached (in which case the stream has been
+         *           closed).
+         */
+        bool playPacket()
+        {
+            const size_t samples = _data.size() / _scalarsPerSample;
+            if (!_started) {
+                _stream = _port->createStream(_reader.sri());
+                _startTime = boost::get_system_time();
+                _started = true;
+            } else if (_offset >= samples) {
+                return false;
+            }
+
+            if (_offset >= samples) {
+                // Empty file, or the last packet was already sent
+                _stream.close();
+                return false;
+            }
+
+            if (_realTime) {
+                double elapsed = _offset * _reader.sri().xdelta;
+                boost::system_time due = _startTime + boost::posix_time::microseconds(static_cast<long>(elapsed * 1e6));
+                boost::this_thread::sleep(due);
+            }
+
+            size_t count = std::min(_packetSize, samples - _offset);
+            size_t start = _offset * _scalarsPerSample;
+            _stream.write(_data.slice(start, start + count * _scalarsPerSample), _reader.timeAt(_offset));
+            _offset += count;
+            if (_offset >= samples) {
+                _stream.close();
+            }
+            return true;
+        }
+
+        /**
+         * @brief  Returns true once all data has been sent.
+         */
+        bool done() const
+        {
+            return _started && (_offset >= (_data.size() / _scalarsPerSample));
+        }
+
+    private:
+        FileReader _reader;
+        PortType* _port;
+        StreamType _stream;
+        redhawk::shared_buffer<ScalarType> _data;
+        size_t _scalarsPerSample;
+        size_t _packetSize;
+        bool _realTime;
+        size_t _offset;
+        bool _started;
+        boost::system_time _startTime;
+    };
+}
+
+#endif // __bulkio_file_h
@@ -25,6 +25,7 @@
 #include <vector>
 #include <boost/thread/condition_variable.hpp>
 #include <boost/thread/locks.hpp>
+#include <boost/shared_ptr.hpp>
 
 #include <ossie/callback.h>
 #include <ossie/signalling.h>
@@ -44,6 +45,11 @@ namespace bulkio {
   template <typename PortType>
   class InputTransport;
 
+  class FlowCredit;
+
+  template <class PortType>
+  class StreamSelector;
+
   template <class PortType>
   struct InStreamTraits {
       typedef BufferedInputStream<PortType> InStreamType;
@@ -203,6 +209,76 @@ namespace bulkio {
      */
     void setMaxQueueDepth(int newDepth);
 
+    /*
+     * setCreditWindow - sets the number of elements of flow control credit advertised to new connections that support
+     *                   credit-based flow control (local and shared memory). The sender may then have at most this many
+     *                   elements outstanding (in transit or in this port's queue) before it must wait, drop or
+     *                   decimate, instead of this port blocking or flushing its queue. The window should fit within
+     *                   the maximum queue depth for the expected packet size. A value of 0 (the default) disables
+     *                   credit-based flow control. Existing connections are not affected.
+     */
+    void setCreditWindow(size_t elements);
+
+    /*
+     * getCreditWindow
+     *
+     * @return size_t number of elements of credit advertised to new connections, or 0 if disabled
+     */
+    size_t getCreditWindow();
+
+    /*
+     * enableLockFreeQueue - turn on/off the lock-free input queue. When enabled, pushPacket stages packets in a fixed-size
+     *                       lock-free ring (sized to the maximum queue depth) without taking the port's queue lock, and
+     *                       readers spin briefly before sleeping. Blocking and flush-on-full behavior are unchanged.
+     *                       This should be set before any data is pushed to the port, typically in the component's
+     *                       constructor.
+     */
+    void enableLockFreeQueue(bool enable);
+
+    /*
+     * isLockFreeQueueEnabled
+     *
+     * @return bool returns true if the lock-free input queue is in use
+     */
+    bool isLockFreeQueueEnabled();
+
+    /*
+     * enableStreamQueues - turn on/off per-stream input queues. When enabled, each stream ID has its own queue, bounded by
+     *                      the maximum queue depth, so that reading one stream does not require scanning past the packets
+     *                      of others, and a full queue only blocks or flushes the stream that filled it. getPacket()
+     *                      without a stream ID still returns packets in arrival order. Enabling per-stream queues disables
+     *                      the lock-free queue, and vice versa. This should be set before any data is pushed to the
+     *                      port, typically in the component's constructor.
+     */
+    void enableStreamQueues(bool enable);
+
+    /*
+     * isStreamQueuesEnabled
+     *
+     * @return bool returns true if per-stream input queues are in use
+     */
+    bool isStreamQueuesEnabled();
+
+    /*
+     * Status of a single stream's input queue, when per-stream queues are enabled
+     */
+    struct StreamQueueStatus {
+      // Number of packets currently queued
+      size_t depth;
+      // Number of times the queue was flushed because it was full
+      size_t flushes;
+      // Number of pushPacket calls that waited for space in the queue
+      size_t blocks;
+    };
+
+    /*
+     * getStreamQueueStatus - returns the queue status for a stream ID. Counts are kept until the stream's queue is removed
+     *                        after its end-of-stream is read.
+     *
+     * @return bool returns false if per-stream queues are not enabled or there is no queue for streamID
+     */
+    bool getStreamQueueStatus(const std::string& streamID, StreamQueueStatus& status);
+
     //
     // Allow the component to control the flow of data from the port to the component.  Block will restrict the flow of data back into the
     // component.  Call in component's stop method
@@ -319,7 +395,9 @@ namespace bulkio {
         SRI(SRI),
         sriChanged(sriChanged),
         inputQueueFlushed(inputQueueFlushed),
-        streamID(SRI.streamID())
+        streamID(SRI.streamID()),
+        sequence(0),
+        creditCount(0)
       {
       }
 
@@ -330,6 +408,22 @@ namespace bulkio {
       bool sriChanged;
       bool inputQueueFlushed;
       std::string streamID;
+
+      // Arrival order, used to merge per-stream queues
+      uint64_t sequence;
+
+      // Flow control credit held by this packet, if any; it is returned to
+      // the sender when the packet is destroyed, however the packet leaves
+      // the queue
+      boost::shared_ptr<FlowCredit> credit;
+      size_t creditCount;
+
+      ~Packet();
+
+      // Packets are recycled through a shared pool to avoid a heap
+      // allocation on every push
+      static void* operator new(size_t bytes);
+      static void operator delete(void* ptr, size_t bytes);
     };
 
     //
@@ -362,6 +456,57 @@ namespace bulkio {
     CONDITION queueAvailable;
     size_t maxQueue;
 
+    //
+    // Flow control credit window advertised to new connections (0 to disable)
+    //
+    size_t creditWindow;
+
+    //
+    // Optional lock-free staging queue for incoming packets; when enabled,
+    // packets are moved into packetQueue by the reader while holding
+    // dataBufferLock
+    //
+    struct LockFreeQueue;
+    LockFreeQueue* lockFreeQueue;
+
+    //
+    // Lock-free queue that is being disabled, while waiting for writers that
+    // may still push to it; it is drained along with lockFreeQueue
+    //
+    LockFreeQueue* detachedLockFreeQueue;
+
+    //
+    // Number of writers that may be using the lock-free queue without holding
+    // dataBufferLock; a writer registers before reading lockFreeQueue, so the
+    // queue is not deleted until every writer that could have seen it is done
+    //
+    volatile int lockFreeWriters;
+
+    //
+    // Number of readers sleeping on dataAvailable while the lock-free queue
+    // is enabled; kept outside of the queue because a sleeping reader does
+    // not hold dataBufferLock, so the queue may be disabled before it wakes
+    //
+    volatile int lockFreeWaiters;
+
+    //
+    // Optional per-stream queues; when enabled, packetQueue is unused and
+    // packets are kept in their stream's queue, with a sequence number to
+    // preserve arrival order across streams. Queues are shared so that a
+    // thread waiting on one keeps it alive if the queue is removed.
+    //
+    struct StreamQueue;
+    typedef std::map<std::string,boost::shared_ptr<StreamQueue> > StreamQueueMap;
+    bool streamQueuesEnabled;
+    StreamQueueMap streamQueues;
+    size_t streamQueueDepth;
+    uint64_t packetSequence;
+
+    //
+    // synchronizes access to the stats member
+    //
+    MUTEX                                          statsLock;
+
     //
     // synchronizes access to the currentHs member
     //
@@ -411,8 +556,10 @@ namespace bulkio {
     // exactly to pushPacket, except for dataFile
     //
     void queuePacket(const BufferType& data, const BULKIO::PrecisionUTCTime& T, CORBA::Boolean EOS, const std::string& streamID);
+    void queuePacket(const BufferType& data, const BULKIO::PrecisionUTCTime& T, CORBA::Boolean EOS, const std::string& streamID,
+                     const boost::shared_ptr<FlowCredit>& credit);
 
-    // Allow local transport classes to directly queue packets
+    // Allow local transport classes to directly queue packets and SRI
     friend class LocalTransport<PortType>;
 
     //
@@ -429,6 +576,65 @@ namespace bulkio {
 
     Packet* fetchPacket(const std::string& streamID);
 
+    // Waits on dataAvailable until the deadline; with the lock-free queue
+    // enabled, spins briefly first and registers as a waiter so that writers
+    // know to signal. With per-stream queues enabled and a non-empty stream
+    // ID, waits on that stream's queue instead, if it exists. Must hold
+    // dataBufferLock.
+    bool _waitForData(boost::unique_lock<boost::mutex>& lock, const std::string& streamID, const boost::system_time& deadline);
+    void _waitForData(boost::unique_lock<boost::mutex>& lock, const std::string& streamID);
+
+    // Spins briefly with dataBufferLock released, waiting for the lock-free
+    // queue to become non-empty; returns true if it did, if a packet was
+    // queued on the normal path in the meantime, or if the port was stopped.
+    // The lock is held again on return.
+    bool _spinForData(boost::unique_lock<boost::mutex>& lock);
+
+    // Attempts to queue a packet without acquiring dataBufferLock, returning
+    // false if the queue is full and the caller needs to block or flush. The
+    // caller must be registered in lockFreeWriters.
+    bool _queueLockFree(LockFreeQueue* queue, Packet* packet);
+
+    // Detaches and deletes the lock-free queue, moving its packets into
+    // packetQueue. Releases dataBufferLock while waiting for writers and
+    // spinning readers to finish with the queue; the lock is held again on
+    // return.
+    void _disableLockFreeQueue(boost::unique_lock<boost::mutex>& lock);
+
+    // Moves packets from the lock-free queue (if enabled, or being disabled)
+    // into packetQueue; must hold dataBufferLock
+    void _drainLockFreeQueue();
+    void _drainLockFreeQueue(LockFreeQueue* queue);
+
+    // Returns the total number of queued packets, including packets in the
+    // lock-free queue; must hold dataBufferLock
+    size_t _queueDepth();
+
+    // Accounts for packets removed from packetQueue or a stream queue; must
+    // hold dataBufferLock
+    void _packetsRemoved(size_t count);
+
+    // Returns the queue for streamID, creating it if necessary; must hold
+    // dataBufferLock
+    boost::shared_ptr<StreamQueue> _getStreamQueue(const std::string& streamID);
+
+    // Returns the queue for streamID, or a null pointer if it has none; must
+    // hold dataBufferLock
+    boost::shared_ptr<StreamQueue> _findStreamQueue(const std::string& streamID);
+
+    // Returns the stream queue holding the oldest packet, or the end of
+    // streamQueues if all are empty; must hold dataBufferLock
+    typename StreamQueueMap::iterator _oldestStreamQueue();
+
+    // Removes a stream queue once it is empty after an end-of-stream, unless
+    // another thread is waiting on it; must hold dataBufferLock
+    void _releaseStreamQueue(typename StreamQueueMap::iterator queue, bool EOS);
+
+    // Moves all packets into per-stream queues, or back into packetQueue in
+    // arrival order; must hold dataBufferLock
+    void _splitStreamQueues();
+    void _mergeStreamQueues();
+
     // Discard currently queued packets for the given stream ID, up to the
     // first end-of-stream
     void discardPacketsForStream(const std::string& streamID);
@@ -442,10 +648,23 @@ namespace bulkio {
     bool isStreamActive(const std::string& streamID);
     bool isStreamEnabled(const std::string& streamID);
 
-    // Purges the input queue, discarding existing packets while preserving
-    // end-of-stream and SRI change flags; must hold both dataBufferLock and
-    // sriUpdateLock
-    void _flushQueue();
+    // Allow StreamSelector to wait on packetWaiters and check readiness
+    friend class StreamSelector<PortType>;
+
+    // Returns true if stream is the port's active stream for its stream ID
+    bool _isStreamCurrent(const StreamType& stream);
+
+    // Returns true if stream can be read without blocking, including when
+    // the next packet only carries an SRI change or end-of-stream
+    bool _isStreamReady(StreamType& stream);
+
+    // Returns true if any packets are queued for streamID
+    bool _hasQueuedPacket(const std::string& streamID);
+
+    // Purges an input queue (packetQueue or a stream queue), discarding
+    // existing packets while preserving end-of-stream and SRI change flags;
+    // must hold both dataBufferLock and sriUpdateLock
+    void _flushQueue(PacketQueue& queue);
 
     // Checks whether the packet should be queued or discarded; also handles
     // notifying disabled streams of end-of-stream if the packet is being
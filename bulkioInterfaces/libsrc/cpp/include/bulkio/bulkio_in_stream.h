@@ -35,6 +35,9 @@ namespace bulkio {
     template <class PortType>
     class InPort;
 
+    template <class PortType>
+    class StreamSelector;
+
     template <class PortType>
     struct BlockTraits {
         typedef SampleDataBlock<typename NativeTraits<PortType>::NativeType> DataBlockType;
@@ -239,6 +242,10 @@ namespace bulkio {
         bool hasBufferedData();
 
         void close();
+
+        // Allow StreamSelector to find the port that owns a stream
+        friend class StreamSelector<PortType>;
+        InPortType* port() const;
         /// @endcond
     public:
         /**
@@ -543,6 +550,49 @@ namespace bulkio {
          */
         bool ready();
 
+        /**
+         * @brief  Enables mirrored buffering for this stream.
+         * @param capacity  Initial buffer size, in real samples (a complex
+         *                  sample counts as two).
+         * @returns  True if mirrored buffering is enabled.
+         * @returns  False if the data type does not support it (bit data) or
+         *           the buffer could not be allocated.
+         * @pre  Stream is valid.
+         *
+         * By default, a read() that spans several packets must allocate a new
+         * buffer and copy the samples out of each packet. In mirrored
+         * buffering mode, incoming data is instead copied once into a
+         * per-stream ring buffer whose memory is mapped twice, back-to-back,
+         * so that any read of up to the ring size is a contiguous view of the
+         * ring with no further copying. This favors overlapped reads (e.g.,
+         * read(8192, 4096) for an FFT), which would otherwise copy every
+         * sample more than once.
+         *
+         * The ring grows as needed to hold the queued data plus any samples
+         * that are still referenced by data blocks the caller holds; to avoid
+         * growth, the capacity should be a few times the largest read size.
+         * Data blocks remain valid after the stream is closed. Any data that
+         * is already queued is moved into the ring.
+         */
+        bool enableMirroredBuffer(size_t capacity);
+
+        /**
+         * @brief  Disables mirrored buffering for this stream.
+         * @pre  Stream is valid.
+         * @see  enableMirroredBuffer(size_t)
+         *
+         * Queued data is copied out of the ring, and subsequent multi-packet
+         * reads copy into a new buffer. Data blocks that have already been
+         * read remain valid.
+         */
+        void disableMirroredBuffer();
+
+        /**
+         * @brief  Returns true if this stream uses mirrored buffering.
+         * @pre  Stream is valid.
+         */
+        bool isMirroredBufferEnabled() const;
+
     private:
         /// @cond IMPL
         typedef InputStream<PortType> Base;
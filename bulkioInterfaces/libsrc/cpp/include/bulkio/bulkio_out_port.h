@@ -31,6 +31,7 @@
 
 #include <ossie/CorbaUtils.h>
 #include <ossie/UsesPort.h>
+#include <ossie/ExecutorService.h>
 
 #include "bulkio_base.h"
 #include "bulkio_typetraits.h"
@@ -235,6 +236,32 @@ namespace bulkio {
     //
     void enableStats(bool enable);
 
+    //
+    // Asynchronous fan-out: when enabled, each connection gets its own bounded
+    // send queue and sender thread, so that a slow or blocked consumer does not
+    // stall the other connections or the caller. Data is queued by reference,
+    // not copied (transient data from vectors or raw pointers is copied once).
+    //
+    // setAsyncFanout sets the mode for all current and future connections;
+    // setConnectionAsync overrides it for a single existing connection. A
+    // queueDepth of 0 restores synchronous pushes. Queue depth and drop counts
+    // are reported in the connection statistics.
+    //
+    void setAsyncFanout(size_t queueDepth, SendQueuePolicy policy=SEND_QUEUE_BLOCK);
+    void setConnectionAsync(const std::string& connectionId, size_t queueDepth, SendQueuePolicy policy=SEND_QUEUE_BLOCK);
+
+    //
+    // Credit-based flow control: an input port that advertises a credit window
+    // (see InPort::setCreditWindow) limits how much data may be outstanding on
+    // its connection, over transports that support it (local and shared
+    // memory). setCreditPolicy selects whether a push that exceeds the
+    // remaining credit waits or is dropped, for all current and future
+    // connections; producers can avoid either by checking
+    // OutputStream::canWrite() first. Credit exhaustion, drops and total wait
+    // time are reported in the connection statistics.
+    //
+    void setCreditPolicy(CreditPolicy policy);
+
     //
     // Return map of streamID/SRI objects 
     //
@@ -298,6 +325,17 @@ namespace bulkio {
     void _connectListenerAdapter(const std::string& connectionId);
     void _disconnectListenerAdapter(const std::string& connectionId);
 
+    //
+    // Default asynchronous fan-out settings for new connections
+    //
+    size_t _asyncQueueDepth;
+    SendQueuePolicy _asyncPolicy;
+
+    //
+    // Flow control policy for connections with credit
+    //
+    CreditPolicy _creditPolicy;
+
     //
     // Returns true if the given connection should receive SRI updates and data
     // for the given stream
@@ -315,6 +353,20 @@ namespace bulkio {
                      const std::string& streamID);
 
     StreamType _getStream(const std::string& streamID);
+
+    //
+    // Returns true if every connection that receives the given stream has
+    // enough credit to send the given number of elements
+    //
+    bool _canWrite(const std::string& streamID, size_t elements);
+
+    //
+    // Shared monitor thread that enforces the maximum latency of buffered
+    // output streams; it is only started when a stream first needs it
+    //
+    redhawk::ExecutorService _latencyMonitor;
+    void _scheduleLatencyCheck(const std::string& streamID, const boost::system_time& when);
+    void _checkLatency(const std::string& streamID);
   };
 
   
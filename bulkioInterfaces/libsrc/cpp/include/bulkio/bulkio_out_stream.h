@@ -314,6 +314,22 @@ namespace bulkio {
          */
         void eraseKeyword(const std::string& name);
 
+        /**
+         * @brief  Checks whether the connected receivers can accept more data.
+         * @param count  Number of samples to write.
+         * @returns  True if a write of @a count samples can be sent to every
+         *           connection without waiting for flow control credit.
+         * @pre  Stream is valid.
+         *
+         * Receivers may advertise a credit window that limits how much data
+         * can be outstanding on a connection (see InPort::setCreditWindow()).
+         * Producers that would rather drop or decimate than wait can check
+         * this method before writing. Connections without credit-based flow
+         * control never limit writes. For complex streams, @a count is in
+         * complex samples.
+         */
+        bool canWrite(size_t count) const;
+
         /**
          * @brief  Closes this stream and sends an end-of-stream.
          * @pre  Stream is valid.
@@ -338,6 +354,10 @@ namespace bulkio {
 
         int modcount() const;
 
+        // Flushes data that has exceeded the latency bound (called from the
+        // port's monitor thread)
+        void _checkLatency();
+
         typedef const Impl& (OutputStream::*unspecified_bool_type)() const;
         /// @endcond
     public:
@@ -406,6 +426,16 @@ namespace bulkio {
      * methods may be discarded. Furthermore, when write sizes do not align
      * exactly with the buffer size, the output time stamp may be interpolated.
      * If precise time stamps are required, buffering should not be used.
+     *
+     * @par  Latency Bound
+     *
+     * A large buffer size reduces the per-packet overhead of a high-rate
+     * stream, but can hold the data of a low-rate stream indefinitely. To
+     * bound the delay, set a maximum latency with setMaxLatency(); buffered
+     * data is then pushed no later than (approximately) the maximum latency
+     * after the first sample was written, even if the buffer is not full. The
+     * output port checks the latency bound of all of its streams on a single
+     * shared monitor thread.
      */
     template <class PortType>
     class BufferedOutputStream : public OutputStream<PortType> {
@@ -413,6 +443,25 @@ namespace bulkio {
         /// @brief  Data type for write().
         typedef typename BufferTraits<PortType>::BufferType BufferType;
 
+        /**
+         * @brief  Number of buffer flushes, by cause.
+         */
+        struct FlushStatistics {
+            /// @brief  Buffer reached the buffer size.
+            size_t size;
+            /// @brief  Buffered data reached the maximum latency.
+            size_t latency;
+            /// @brief  SRI changed.
+            size_t sri;
+            /// @brief  Stream was closed.
+            size_t eos;
+            /// @brief  flush() was called, or the buffer size was reduced.
+            size_t manual;
+            /// @brief  Latency flushes that failed to send; the error is logged
+            ///         to the port's logger.
+            size_t errors;
+        };
+
         /**
          * @brief  Default constructor.
          * @see  OutPort::createStream(const std::string&)
@@ -454,6 +503,41 @@ namespace bulkio {
          */
         void setBufferSize(size_t samples);
 
+        /**
+         * @brief  Gets the maximum buffering latency.
+         * @returns  Maximum time, in seconds, to hold buffered data.
+         * @pre  Stream is valid.
+         *
+         * A maximum latency of 0 indicates that there is no bound.
+         */
+        double maxLatency() const;
+
+        /**
+         * @brief  Sets the maximum buffering latency.
+         * @param seconds  Maximum time to hold buffered data.
+         * @pre  Stream is valid.
+         * @see maxLatency() const
+         *
+         * When buffering is enabled, buffered data is pushed once the first
+         * buffered sample has been held for @a seconds, even if the buffer is
+         * not full. The time is measured from the write, not from the data
+         * time stamps. Data is pushed from the output port's monitor thread.
+         *
+         * A maximum latency of 0 (the default) disables the bound, and data is
+         * only pushed when the buffer is full, the SRI changes, the stream is
+         * closed, or flush() is called.
+         */
+        void setMaxLatency(double seconds);
+
+        /**
+         * @brief  Gets the number of buffer flushes, by cause.
+         * @pre  Stream is valid.
+         *
+         * Writes that bypass the buffer (because buffering is disabled, or the
+         * write is at least as large as the buffer) are not counted.
+         */
+        FlushStatistics flushStatistics() const;
+
         /**
          * @brief  Flushes the internal buffer.
          * @pre  Stream is valid.
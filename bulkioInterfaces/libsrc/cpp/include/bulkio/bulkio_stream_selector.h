@@ -0,0 +1,166 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK bulkioInterfaces.
+ *
+ * REDHAWK bulkioInterfaces is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK bulkioInterfaces is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+#ifndef __bulkio_stream_selector_h
+#define __bulkio_stream_selector_h
+
+#include <list>
+#include <string>
+
+#include "bulkio_base.h"
+#include "bulkio_in_port.h"
+
+namespace bulkio {
+
+    /**
+     * @brief  Waits for any of a set of input streams to become ready.
+     * @headerfile  bulkio_stream_selector.h <bulkio/bulkio_stream_selector.h>
+     *
+     * %StreamSelector allows one processing thread to serve many input
+     * streams, on one or more input ports of the same type, without polling
+     * each stream in turn or blocking on one stream while others have data.
+     * The selector may contain entire ports, in which case all of the port's
+     * active streams (including ones created later) are selected, as well as
+     * individual streams.
+     *
+     * @par  Readiness
+     * A stream is ready if the next read would not block: there is buffered
+     * data, or the input port has queued a packet for the stream. Because an
+     * SRI change or end-of-stream is delivered with a packet, a stream is also
+     * ready when its next read would report an SRI change or fail due to
+     * end-of-stream, even if the packet has no data.
+     *
+     * @par  Waiting
+     * The selector waits on the same notification that input ports use to
+     * signal that a packet has been queued, so a thread blocked in select()
+     * wakes up as soon as any selected stream may have become ready. Stopping
+     * an input port interrupts any select() calls that include it.
+     *
+     * @par  Stream Lifetime
+     * Individually added streams are dropped from the selector once their
+     * end-of-stream has been reported, because any further packets with the
+     * same stream ID belong to a new stream.
+     *
+     * @note  %StreamSelector is not thread-safe; it is intended for use by a
+     *        single processing thread.
+     */
+    template <class PortType>
+    class StreamSelector {
+    public:
+        /// @brief  The input port type.
+        typedef InPort<PortType> InPortType;
+
+        /// @brief  The input stream type.
+        typedef typename InPortType::StreamType StreamType;
+
+        /// @brief  List type for input streams.
+        typedef typename InPortType::StreamList StreamList;
+
+        /**
+         * @brief  Constructs an empty %StreamSelector.
+         */
+        StreamSelector();
+
+        /**
+         * @brief  Selects all streams on an input port.
+         * @param port  Input port.
+         */
+        void addPort(InPortType* port);
+
+        /**
+         * @brief  Stops selecting all streams on an input port.
+         * @param port  Input port.
+         *
+         * Streams from @a port that were added individually remain selected.
+         */
+        void removePort(InPortType* port);
+
+        /**
+         * @brief  Selects a single input stream.
+         * @param stream  Input stream.
+         * @pre  @a stream is valid.
+         */
+        void addStream(const StreamType& stream);
+
+        /**
+         * @brief  Stops selecting a single input stream.
+         * @param stream  Input stream.
+         * @pre  @a stream is valid.
+         */
+        void removeStream(const StreamType& stream);
+
+        /**
+         * @brief  Removes all ports and streams.
+         */
+        void clear();
+
+        /**
+         * @brief  Waits for one or more selected streams to become ready.
+         * @param timeout  Seconds to wait; a negative value waits
+         *                 indefinitely, and zero does not wait.
+         * @returns  List of ready streams.
+         * @returns  Empty list if the timeout expires, or an input port is
+         *           stopped.
+         */
+        StreamList select(float timeout=bulkio::Const::BLOCKING);
+
+        /**
+         * @brief  Gets the selected streams that are currently ready.
+         * @returns  List of ready streams, without waiting.
+         */
+        StreamList getReadyStreams();
+
+    private:
+        /// @cond IMPL
+        struct Entry {
+            Entry(InPortType* port, const StreamType& stream) :
+                port(port),
+                stream(stream)
+            {
+            }
+
+            InPortType* port;
+            StreamType stream;
+        };
+
+        typedef std::list<InPortType*> PortList;
+        typedef std::list<Entry> EntryList;
+
+        PortList _ports;
+        EntryList _streams;
+        /// @endcond
+    };
+
+    typedef StreamSelector<BULKIO::dataChar>      InCharStreamSelector;
+    typedef StreamSelector<BULKIO::dataOctet>     InOctetStreamSelector;
+    typedef StreamSelector<BULKIO::dataShort>     InShortStreamSelector;
+    typedef StreamSelector<BULKIO::dataUshort>    InUShortStreamSelector;
+    typedef StreamSelector<BULKIO::dataLong>      InLongStreamSelector;
+    typedef StreamSelector<BULKIO::dataUlong>     InULongStreamSelector;
+    typedef StreamSelector<BULKIO::dataLongLong>  InLongLongStreamSelector;
+    typedef StreamSelector<BULKIO::dataUlongLong> InULongLongStreamSelector;
+    typedef StreamSelector<BULKIO::dataFloat>     InFloatStreamSelector;
+    typedef StreamSelector<BULKIO::dataDouble>    InDoubleStreamSelector;
+    typedef StreamSelector<BULKIO::dataBit>       InBitStreamSelector;
+    typedef StreamSelector<BULKIO::dataXML>       InXMLStreamSelector;
+    typedef StreamSelector<BULKIO::dataFile>      InFileStreamSelector;
+}
+
+#endif // __bulkio_stream_selector_h
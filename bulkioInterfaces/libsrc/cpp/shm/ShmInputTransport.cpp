@@ -21,6 +21,7 @@
 #include "ShmInputTransport.h"
 #include "FifoIPC.h"
 #include "MessageBuffer.h"
+#include "ShmRing.h"
 
 #include <boost/thread.hpp>
 
@@ -30,6 +31,7 @@
 #include <bulkio_in_port.h>
 
 #include "bulkio_p.h"
+#include "FlowCredit.h"
 
 namespace bulkio {
 
@@ -42,17 +44,40 @@ namespace bulkio {
         typedef typename BufferTraits<PortType>::BufferType BufferType;
 
         ShmInputTransport(InPort<PortType>* port, const std::string& transportId,
-                          ManagerType* manager, const std::string& writePath) :
+                          ManagerType* manager, const std::string& writePath,
+                          const std::string& ringName) :
             InputTransport<PortType>(port, transportId),
             _manager(manager),
             _running(false),
-            _fifo()
+            _fifo(),
+            _ring()
         {
             _fifo.connect(writePath);
+
+            if (!ringName.empty()) {
+                // If the ring cannot be opened, do not report it back to the
+                // uses side, which will then use the FIFO protocol
+                try {
+                    _ring.open(ringName);
+                } catch (const std::exception& exc) {
+                    RH_NL_DEBUG("ShmTransport", "Unable to open descriptor ring " << ringName << ": " << exc.what());
+                }
+            }
+
+            // Credit is returned through the ring's shared memory, so flow
+            // control is only offered when the ring is in use
+            const size_t window = port->getCreditWindow();
+            if (_ring.isOpen() && (window > 0)) {
+                _credit = boost::make_shared<FlowCredit>(window, _ring.creditCounter(), _ring.closedFlag());
+            }
         }
 
         ~ShmInputTransport()
         {
+            if (_credit) {
+                // Packets still in the port's queue may outlive the ring
+                _credit->detach();
+            }
             _fifo.disconnect();
         }
 
@@ -78,6 +103,11 @@ namespace bulkio {
                 _running = false;
                 _thread.interrupt();
             }
+            if (_ring.isOpen()) {
+                // Wake the reader thread if it is parked on the ring, and let
+                // the uses side know that no more messages will be consumed
+                _ring.close();
+            }
             _thread.join();
         }
 
@@ -86,6 +116,19 @@ namespace bulkio {
             return _fifo.name();
         }
 
+        bool isRingEnabled() const
+        {
+            return _ring.isOpen();
+        }
+
+        size_t getCreditWindow() const
+        {
+            if (_credit) {
+                return _credit->window();
+            }
+            return 0;
+        }
+
     protected:
         bool _isRunning()
         {
@@ -106,6 +149,11 @@ namespace bulkio {
                 return;
             }
 
+            if (_ring.isOpen()) {
+                _runRing();
+                return;
+            }
+
             while (_isRunning()) {
                 if (!_receiveMessage()) {
                     return;
@@ -113,18 +161,66 @@ namespace bulkio {
             }
         }
 
-        bool _receiveMessage()
+        void _runRing()
+        {
+            while (_isRunning()) {
+                ShmRing::Slot* slot = _ring.beginRead(100);
+                if (!slot) {
+                    if (_ring.isClosed()) {
+                        return;
+                    }
+                    continue;
+                }
+
+                MessageBuffer msg;
+                if (slot->flags & ShmRing::Slot::MESSAGE_ON_FIFO) {
+                    if (!_readFifoMessage(msg)) {
+                        return;
+                    }
+                } else {
+                    msg.resize(slot->length);
+                    std::memcpy(msg.buffer(), slot->data, slot->length);
+                }
+
+                // There is no response in ring mode; errors are reported back
+                // to the uses side asynchronously via the ring
+                if (!_handleMessage(msg)) {
+                    _ring.reportError();
+                }
+                _ring.commitRead();
+            }
+        }
+
+        bool _readFifoMessage(MessageBuffer& msg)
         {
             size_t msg_length;
             if (_fifo.read(&msg_length, sizeof(msg_length)) != sizeof(msg_length)) {
                 return false;
             }
 
-            MessageBuffer msg(msg_length);
+            msg.resize(msg_length);
             if (_fifo.read(msg.buffer(), msg.size()) != msg_length){
                 return false;
             }
+            return true;
+        }
+
+        bool _receiveMessage()
+        {
+            MessageBuffer msg;
+            if (!_readFifoMessage(msg)) {
+                return false;
+            }
+
+            // Send response back
+            size_t status = _handleMessage(msg) ? 0 : 1;
+            _fifo.write(&status, sizeof(size_t));
 
+            return true;
+        }
+
+        bool _handleMessage(MessageBuffer& msg)
+        {
             std::string message_name;
             try {
                 msg.read(message_name);
@@ -136,10 +232,8 @@ namespace bulkio {
                 }
             } catch (const std::exception& exc) {
                 RH_NL_ERROR("ShmTransport", "Error handling message '" << message_name << "': " << exc.what());
-                size_t status = 1;
-                _fifo.write(&status, sizeof(size_t));
+                return false;
             }
-
             return true;
         }
 
@@ -175,11 +269,11 @@ namespace bulkio {
                 std::cerr << "Message bytes left over" << std::endl;
             }
 
-            this->_queuePacket(buffer, T, EOS, streamID);
-
-            // Send response back
-            size_t status = 0;
-            _fifo.write(&status, sizeof(size_t));
+            if (_credit) {
+                this->_queuePacket(buffer, T, EOS, streamID, _credit);
+            } else {
+                this->_queuePacket(buffer, T, EOS, streamID);
+            }
         }
 
         void _receiveSharedBuffer(MessageBuffer& msg, BufferType& buffer, size_t size)
@@ -226,6 +320,8 @@ namespace bulkio {
         boost::mutex _mutex;
         boost::thread _thread;
         FifoEndpoint _fifo;
+        ShmRing _ring;
+        boost::shared_ptr<FlowCredit> _credit;
     };
 
     template <class PortType>
@@ -260,8 +356,9 @@ namespace bulkio {
             throw redhawk::FatalTransportError("invalid properties for shared memory connection");
         }
         const std::string location = properties["fifo"].toString();
+        const std::string ring_name = properties.get("ring", std::string()).toString();
         try {
-            return new ShmInputTransport<PortType>(this->_port, transportId, this, location);
+            return new ShmInputTransport<PortType>(this->_port, transportId, this, location, ring_name);
         } catch (const std::exception& exc) {
             throw redhawk::FatalTransportError("failed to connect to FIFO " + location);
         }
@@ -276,6 +373,13 @@ namespace bulkio {
         }
         redhawk::PropertyMap properties;
         properties["fifo"] = transport->getFifoName();
+        if (transport->isRingEnabled()) {
+            properties["ring"] = true;
+            size_t window = transport->getCreditWindow();
+            if (window > 0) {
+                properties["credits"] = (CORBA::ULongLong) window;
+            }
+        }
         return properties;
     }
 
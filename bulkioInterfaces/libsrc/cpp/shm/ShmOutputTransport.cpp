@@ -21,6 +21,7 @@
 #include "ShmOutputTransport.h"
 #include "FifoIPC.h"
 #include "MessageBuffer.h"
+#include "ShmRing.h"
 
 #include <numeric>
 
@@ -30,6 +31,7 @@
 #include <bulkio_out_port.h>
 
 #include "bulkio_p.h"
+#include "FlowCredit.h"
 
 namespace bulkio {
 
@@ -73,10 +75,22 @@ namespace bulkio {
         typedef typename BufferType::value_type ElementType;
         typedef typename CorbaTraits<PortType>::TransportType TransportType;
 
-        ShmOutputTransport(OutPort<PortType>* parent, PtrType port) :
+        ShmOutputTransport(OutPort<PortType>* parent, PtrType port, bool enableRing) :
             OutputTransport<PortType>(parent, port),
-            _fifo()
+            _fifo(),
+            _ring(),
+            _useRing(false),
+            _errorsSeen(0)
         {
+            if (enableRing) {
+                // The ring is optional; if it cannot be created, the FIFO
+                // protocol is still available
+                try {
+                    _ring.create();
+                } catch (const std::exception& exc) {
+                    RH_NL_DEBUG("ShmTransport", "Unable to create descriptor ring: " << exc.what());
+                }
+            }
         }
 
         ~ShmOutputTransport()
@@ -90,7 +104,12 @@ namespace bulkio {
 
         virtual CF::Properties transportInfo() const
         {
-            return CF::Properties();
+            redhawk::PropertyMap info;
+            info["protocol"] = std::string(_useRing ? "ring" : "fifo");
+            if (this->_credit) {
+                info["credit_window"] = (CORBA::ULongLong) this->_credit->window();
+            }
+            return info;
         }
 
         const std::string& getFifoName()
@@ -98,18 +117,48 @@ namespace bulkio {
             return _fifo.name();
         }
 
-        void finishConnect(const std::string& filename)
+        std::string getRingName()
+        {
+            if (_ring.isOpen()) {
+                return _ring.name();
+            }
+            return std::string();
+        }
+
+        void finishConnect(const std::string& filename, bool useRing, size_t credits)
         {
             _fifo.connect(filename);
 
             // The provides side should have already opened its write end, so
             // if the FIFO doesn't sync immediately, something is wrong.
             _fifo.sync(0);
+
+            if (useRing && _ring.isOpen()) {
+                // Both sides have the ring mapped, so it no longer needs a
+                // name in the file system
+                _ring.unlink();
+                _useRing = true;
+
+                // The provides side returns flow control credit through the
+                // ring's shared counter
+                if (credits > 0) {
+                    this->_enableCredit(boost::make_shared<FlowCredit>(credits, _ring.creditCounter(), _ring.closedFlag()));
+                }
+            } else {
+                // The provides side does not support the ring (or could not
+                // open it); fall back to the synchronous FIFO protocol
+                _ring.detach();
+            }
         }
 
         virtual void disconnect()
         {
             OutputTransport<PortType>::disconnect();
+            if (_useRing) {
+                _ring.close();
+                _waitForPending();
+                _pending.clear();
+            }
             _fifo.disconnect();
         }
 
@@ -189,7 +238,18 @@ namespace bulkio {
                 }
             }
 
-            _sendMessage(header.buffer(), header.size(), body, body_size);
+            if (_useRing) {
+                // The reader has not attached to the shared memory buffer by
+                // the time the message is queued, so a reference needs to be
+                // held until the reader has consumed the message
+                BufferType hold;
+                if (!data.empty() && (body_size == 0)) {
+                    hold = copy.empty() ? data : copy;
+                }
+                _sendRingMessage(header, body, body_size, hold);
+            } else {
+                _sendMessage(header.buffer(), header.size(), body, body_size);
+            }
 
             ShmStatPoint stat(body_size == 0, !copy.empty());
             _recordExtendedStatistics(stat);
@@ -197,6 +257,8 @@ namespace bulkio {
 
         virtual redhawk::PropertyMap _getExtendedStatistics()
         {
+            // Packets may be sent from the asynchronous sender thread
+            boost::mutex::scoped_lock lock(this->_statsMutex);
             ShmStatPoint stats = std::accumulate(_extendedStats.begin(), _extendedStats.end(), ShmStatPoint());
             double copy_rate = 0.0;
             double shm_rate = 0.0;
@@ -214,6 +276,7 @@ namespace bulkio {
     private:
         void _recordExtendedStatistics(const ShmStatPoint& stat)
         {
+            boost::mutex::scoped_lock lock(this->_statsMutex);
             _extendedStats.push_back(stat);
             if (_extendedStats.size() > 10) {
                 _extendedStats.pop_front();
@@ -269,8 +332,82 @@ namespace bulkio {
             }
         }
 
+        void _sendRingMessage(const MessageBuffer& header, const void* body, size_t bsize, const BufferType& hold)
+        {
+            _releasePending();
+
+            ShmRing::Slot* slot = _ring.beginWrite();
+            if (!slot) {
+                throw redhawk::FatalTransportError("connection closed by provides side");
+            }
+
+            // Small messages (the usual case) go directly in the slot; large
+            // ones (e.g., very long stream IDs) are sent over the FIFO, with
+            // the slot only serving to preserve ordering
+            const bool inline_message = (header.size() <= _ring.maxMessageSize());
+            if (inline_message) {
+                slot->flags = 0;
+                slot->length = header.size();
+                std::memcpy(slot->data, header.buffer(), header.size());
+            } else {
+                slot->flags = ShmRing::Slot::MESSAGE_ON_FIFO;
+                slot->length = 0;
+            }
+            uint64_t sequence = _ring.commitWrite();
+            if (!hold.empty()) {
+                _pending.push_back(std::make_pair(sequence, hold));
+            }
+
+            try {
+                if (!inline_message) {
+                    size_t hsize = header.size();
+                    _fifo.write(&hsize, sizeof(hsize));
+                    _fifo.write(header.buffer(), hsize);
+                }
+                if (bsize > 0) {
+                    _fifo.write(body, bsize);
+                }
+            } catch (const std::exception& exc) {
+                throw redhawk::FatalTransportError(exc.what());
+            }
+
+            // Errors on the provides side are reported asynchronously, so the
+            // failure may correspond to an earlier packet
+            uint32_t errors = _ring.errorCount();
+            if (errors != _errorsSeen) {
+                _errorsSeen = errors;
+                throw redhawk::TransportError("call failed");
+            }
+        }
+
+        void _releasePending()
+        {
+            const uint64_t consumed = _ring.readCount();
+            while (!_pending.empty() && (_pending.front().first < consumed)) {
+                _pending.pop_front();
+            }
+        }
+
+        void _waitForPending()
+        {
+            // Give the provides side a bounded amount of time to attach to any
+            // outstanding buffers before releasing them
+            for (int retry = 0; retry < 1000; ++retry) {
+                _releasePending();
+                if (_pending.empty()) {
+                    return;
+                }
+                boost::this_thread::sleep(boost::posix_time::milliseconds(1));
+            }
+        }
+
         FifoEndpoint _fifo;
 
+        ShmRing _ring;
+        bool _useRing;
+        uint32_t _errorsSeen;
+        std::deque<std::pair<uint64_t,BufferType> > _pending;
+
         std::deque<ShmStatPoint> _extendedStats;
     };
 
@@ -324,7 +461,12 @@ namespace bulkio {
             return 0;
         }
 
-        return new ShmOutputTransport<PortType>(this->_port, object);
+        // The pipelined descriptor ring is preferred, but can be disabled to
+        // force the synchronous FIFO protocol
+        const char* ring_env = getenv("BULKIO_SHM_RING");
+        bool enable_ring = !(ring_env && (strcmp(ring_env, "disable") == 0));
+
+        return new ShmOutputTransport<PortType>(this->_port, object, enable_ring);
     }
 
     template <typename PortType>
@@ -337,6 +479,10 @@ namespace bulkio {
 
         redhawk::PropertyMap properties;
         properties["fifo"] = shm_transport->getFifoName();
+        std::string ring_name = shm_transport->getRingName();
+        if (!ring_name.empty()) {
+            properties["ring"] = ring_name;
+        }
         return properties;
     }
 
@@ -355,7 +501,12 @@ namespace bulkio {
 
         std::string fifo_name = properties["fifo"].toString();
         RH_NL_DEBUG("ShmTransport", "Connecting to provides port FIFO: " << fifo_name);
-        shm_transport->finishConnect(fifo_name);
+
+        // Older provides sides do not know about the ring, and will not
+        // include it in the result
+        bool use_ring = properties.get("ring", false).toBoolean();
+        size_t credits = properties.get("credits", (CORBA::ULongLong) 0).toULongLong();
+        shm_transport->finishConnect(fifo_name, use_ring, credits);
     }
 
 #define INSTANTIATE_TEMPLATE(x)                 \
@@ -0,0 +1,61 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK bulkioInterfaces.
+ *
+ * REDHAWK bulkioInterfaces is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK bulkioInterfaces is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+#include "ShmRing.h"
+
+#include <cstddef>
+
+// Identifies BulkIO descriptor rings; change when the slot format changes
+#define RING_TYPE 0x52494e47
+
+namespace bulkio {
+
+    void ShmRing::create(size_t capacity, size_t slotSize)
+    {
+        redhawk::shm::SlotRing::create("bulkio-ring", RING_TYPE, capacity, slotSize, sizeof(uint64_t));
+    }
+
+    void ShmRing::open(const std::string& name)
+    {
+        redhawk::shm::SlotRing::open(name, RING_TYPE, sizeof(uint64_t));
+    }
+
+    size_t ShmRing::maxMessageSize() const
+    {
+        return slotSize() - offsetof(Slot, data);
+    }
+
+    ShmRing::Slot* ShmRing::beginWrite()
+    {
+        return static_cast<Slot*>(redhawk::shm::SlotRing::beginWrite());
+    }
+
+    ShmRing::Slot* ShmRing::beginRead(int timeout)
+    {
+        return static_cast<Slot*>(redhawk::shm::SlotRing::beginRead(timeout));
+    }
+
+    volatile uint64_t* ShmRing::creditCounter()
+    {
+        // The extra area starts on its own cache line, which keeps the credit
+        // updates from the reader away from the ring indices
+        return static_cast<volatile uint64_t*>(extra());
+    }
+}
@@ -0,0 +1,73 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK bulkioInterfaces.
+ *
+ * REDHAWK bulkioInterfaces is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK bulkioInterfaces is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+#ifndef __bulkio_shmring_h
+#define __bulkio_shmring_h
+
+#include <string>
+#include <stdint.h>
+
+#include <ossie/shm/Ring.h>
+
+namespace bulkio {
+
+    /**
+     * Descriptor ring for the shared memory transport.
+     *
+     * The ring carries fixed-size message slots between the uses (writer) and
+     * provides (reader) sides of a shared memory connection, replacing the
+     * per-message FIFO round trip. The ring itself is a
+     * redhawk::shm::SlotRing; this class adds the BulkIO slot format and the
+     * shared counter for flow control credit.
+     */
+    class ShmRing : public redhawk::shm::SlotRing {
+    public:
+        struct Slot {
+            // Slot message is too large for the ring, and is sent over the
+            // FIFO instead
+            static const uint32_t MESSAGE_ON_FIFO = 0x1;
+
+            uint32_t flags;
+            uint32_t length;
+            char data[1];
+        };
+
+        static const size_t DEFAULT_CAPACITY = 64;
+        static const size_t DEFAULT_SLOT_SIZE = 512;
+
+        // Uses side: create a new ring file and map it
+        void create(size_t capacity=DEFAULT_CAPACITY, size_t slotSize=DEFAULT_SLOT_SIZE);
+
+        // Provides side: map an existing ring file created by the other side
+        void open(const std::string& name);
+
+        // Maximum number of bytes of message data that fit in a slot
+        size_t maxMessageSize() const;
+
+        Slot* beginWrite();
+        Slot* beginRead(int timeout);
+
+        // Shared counter for credit-based flow control (see FlowCredit); the
+        // pointer is only valid while the ring is mapped
+        volatile uint64_t* creditCounter();
+    };
+}
+
+#endif // __bulkio_shmring_h
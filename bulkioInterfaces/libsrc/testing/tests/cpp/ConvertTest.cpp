@@ -0,0 +1,212 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK bulkioInterfaces.
+ *
+ * REDHAWK bulkioInterfaces is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK bulkioInterfaces is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+#include "ConvertTest.h"
+
+#include <bulkio/bulkio.h>
+
+CPPUNIT_TEST_SUITE_REGISTRATION(ConvertTest);
+
+// Sizes chosen to exercise both the vector loops and the scalar tails of each
+// kernel
+static const size_t TEST_SIZE = 67;
+
+void ConvertTest::testToFloat()
+{
+    std::vector<int16_t> shorts(TEST_SIZE);
+    std::vector<uint8_t> octets(TEST_SIZE);
+    for (size_t ii = 0; ii < TEST_SIZE; ++ii) {
+        shorts[ii] = (ii * 997) - 32768;
+        octets[ii] = ii * 3;
+    }
+
+    std::vector<float> result(TEST_SIZE);
+    bulkio::convert::toFloat(&shorts[0], &result[0], TEST_SIZE, 1.0f / 32768);
+    for (size_t ii = 0; ii < TEST_SIZE; ++ii) {
+        CPPUNIT_ASSERT_EQUAL(shorts[ii] / 32768.0f, result[ii]);
+    }
+
+    bulkio::convert::toFloat(&octets[0], &result[0], TEST_SIZE);
+    for (size_t ii = 0; ii < TEST_SIZE; ++ii) {
+        CPPUNIT_ASSERT_EQUAL((float) octets[ii], result[ii]);
+    }
+
+    std::vector<double> doubles(TEST_SIZE);
+    bulkio::convert::toDouble(&shorts[0], &doubles[0], TEST_SIZE, 2.0);
+    for (size_t ii = 0; ii < TEST_SIZE; ++ii) {
+        CPPUNIT_ASSERT_EQUAL(shorts[ii] * 2.0, doubles[ii]);
+    }
+}
+
+void ConvertTest::testFromFloat()
+{
+    std::vector<float> input(TEST_SIZE);
+    for (size_t ii = 0; ii < TEST_SIZE; ++ii) {
+        input[ii] = ii * 0.75f - 20.0f;
+    }
+
+    // Round to nearest, with ties to even
+    std::vector<int16_t> shorts(TEST_SIZE);
+    bulkio::convert::fromFloat(&input[0], &shorts[0], TEST_SIZE, 2.0f);
+    for (size_t ii = 0; ii < TEST_SIZE; ++ii) {
+        CPPUNIT_ASSERT_EQUAL((int16_t) lrint(input[ii] * 2.0f), shorts[ii]);
+    }
+
+    std::vector<int8_t> chars(TEST_SIZE);
+    bulkio::convert::fromFloat(&input[0], &chars[0], TEST_SIZE);
+    for (size_t ii = 0; ii < TEST_SIZE; ++ii) {
+        CPPUNIT_ASSERT_EQUAL((int8_t) lrint(input[ii]), chars[ii]);
+    }
+
+    std::vector<double> doubles(input.begin(), input.end());
+    std::vector<int32_t> longs(TEST_SIZE);
+    bulkio::convert::fromDouble(&doubles[0], &longs[0], TEST_SIZE, 100.0);
+    for (size_t ii = 0; ii < TEST_SIZE; ++ii) {
+        CPPUNIT_ASSERT_EQUAL((int32_t) lrint(doubles[ii] * 100.0), longs[ii]);
+    }
+}
+
+void ConvertTest::testSaturation()
+{
+    std::vector<float> input(TEST_SIZE);
+    for (size_t ii = 0; ii < TEST_SIZE; ++ii) {
+        input[ii] = (ii % 2) ? 1.0e6f : -1.0e6f;
+    }
+
+    std::vector<int16_t> shorts(TEST_SIZE);
+    bulkio::convert::fromFloat(&input[0], &shorts[0], TEST_SIZE);
+    std::vector<uint8_t> octets(TEST_SIZE);
+    bulkio::convert::fromFloat(&input[0], &octets[0], TEST_SIZE);
+    std::vector<uint16_t> ushorts(TEST_SIZE);
+    bulkio::convert::fromFloat(&input[0], &ushorts[0], TEST_SIZE);
+    for (size_t ii = 0; ii < TEST_SIZE; ++ii) {
+        if (ii % 2) {
+            CPPUNIT_ASSERT_EQUAL((int16_t) 32767, shorts[ii]);
+            CPPUNIT_ASSERT_EQUAL((uint8_t) 255, octets[ii]);
+            CPPUNIT_ASSERT_EQUAL((uint16_t) 65535, ushorts[ii]);
+        } else {
+            CPPUNIT_ASSERT_EQUAL((int16_t) -32768, shorts[ii]);
+            CPPUNIT_ASSERT_EQUAL((uint8_t) 0, octets[ii]);
+            CPPUNIT_ASSERT_EQUAL((uint16_t) 0, ushorts[ii]);
+        }
+    }
+
+    // Values beyond the range of a 32-bit integer must not wrap around
+    std::vector<int32_t> longs(TEST_SIZE);
+    std::fill(input.begin(), input.end(), 1.0e10f);
+    bulkio::convert::fromFloat(&input[0], &longs[0], TEST_SIZE);
+    for (size_t ii = 0; ii < TEST_SIZE; ++ii) {
+        CPPUNIT_ASSERT(longs[ii] > 2147483000);
+    }
+}
+
+void ConvertTest::testInterleave()
+{
+    std::vector<float> complex(TEST_SIZE * 2);
+    for (size_t ii = 0; ii < complex.size(); ++ii) {
+        complex[ii] = ii;
+    }
+
+    std::vector<float> real(TEST_SIZE);
+    std::vector<float> imag(TEST_SIZE);
+    bulkio::convert::deinterleave(&complex[0], &real[0], &imag[0], TEST_SIZE);
+    for (size_t ii = 0; ii < TEST_SIZE; ++ii) {
+        CPPUNIT_ASSERT_EQUAL(complex[ii*2], real[ii]);
+        CPPUNIT_ASSERT_EQUAL(complex[ii*2+1], imag[ii]);
+    }
+
+    std::vector<float> result(TEST_SIZE * 2);
+    bulkio::convert::interleave(&real[0], &imag[0], &result[0], TEST_SIZE);
+    CPPUNIT_ASSERT(result == complex);
+
+    // 16-bit complex has its own kernels
+    std::vector<int16_t> shorts(TEST_SIZE * 2);
+    for (size_t ii = 0; ii < shorts.size(); ++ii) {
+        shorts[ii] = ii;
+    }
+    std::vector<int16_t> sreal(TEST_SIZE);
+    std::vector<int16_t> simag(TEST_SIZE);
+    bulkio::convert::deinterleave(&shorts[0], &sreal[0], &simag[0], TEST_SIZE);
+    for (size_t ii = 0; ii < TEST_SIZE; ++ii) {
+        CPPUNIT_ASSERT_EQUAL(shorts[ii*2], sreal[ii]);
+        CPPUNIT_ASSERT_EQUAL(shorts[ii*2+1], simag[ii]);
+    }
+    std::vector<int16_t> sresult(TEST_SIZE * 2);
+    bulkio::convert::interleave(&sreal[0], &simag[0], &sresult[0], TEST_SIZE);
+    CPPUNIT_ASSERT(sresult == shorts);
+}
+
+void ConvertTest::testByteSwap()
+{
+    std::vector<uint16_t> shorts(TEST_SIZE, 0x1234);
+    bulkio::convert::byteSwap(&shorts[0], TEST_SIZE);
+    for (size_t ii = 0; ii < TEST_SIZE; ++ii) {
+        CPPUNIT_ASSERT_EQUAL((uint16_t) 0x3412, shorts[ii]);
+    }
+
+    std::vector<uint32_t> longs(TEST_SIZE, 0x12345678);
+    std::vector<uint32_t> swapped(TEST_SIZE);
+    bulkio::convert::byteSwap(&longs[0], &swapped[0], TEST_SIZE);
+    for (size_t ii = 0; ii < TEST_SIZE; ++ii) {
+        CPPUNIT_ASSERT_EQUAL((uint32_t) 0x78563412, swapped[ii]);
+    }
+
+    // Swapping twice must restore the original values
+    std::vector<double> doubles(TEST_SIZE);
+    for (size_t ii = 0; ii < TEST_SIZE; ++ii) {
+        doubles[ii] = ii * 1.5;
+    }
+    std::vector<double> copy(doubles);
+    bulkio::convert::byteSwap(&copy[0], TEST_SIZE);
+    bulkio::convert::byteSwap(&copy[0], TEST_SIZE);
+    CPPUNIT_ASSERT(copy == doubles);
+}
+
+void ConvertTest::testDataBlock()
+{
+    // Null blocks convert to null blocks
+    bulkio::ShortDataBlock empty;
+    CPPUNIT_ASSERT(!bulkio::convert::toFloatingPoint<float>(empty));
+
+    BULKIO::StreamSRI sri = bulkio::sri::create("convert_block");
+    sri.mode = 1;
+    redhawk::buffer<short> data(TEST_SIZE * 2);
+    for (size_t ii = 0; ii < data.size(); ++ii) {
+        data[ii] = ii;
+    }
+    bulkio::ShortDataBlock block(sri, data);
+    block.addTimestamp(bulkio::SampleTimestamp(bulkio::time::utils::create(100.0, 0.0), 0));
+    block.addTimestamp(bulkio::SampleTimestamp(bulkio::time::utils::create(101.0, 0.0), 10));
+    block.sriChangeFlags(bulkio::sri::MODE);
+    block.inputQueueFlushed(true);
+
+    bulkio::FloatDataBlock result = bulkio::convert::toFloatingPoint<float>(block, 0.5f);
+    CPPUNIT_ASSERT(result);
+    CPPUNIT_ASSERT_EQUAL(std::string("convert_block"), std::string(result.sri().streamID));
+    CPPUNIT_ASSERT(result.complex());
+    CPPUNIT_ASSERT_EQUAL(block.size(), result.size());
+    for (size_t ii = 0; ii < result.size(); ++ii) {
+        CPPUNIT_ASSERT_EQUAL(data[ii] * 0.5f, result.data()[ii]);
+    }
+    CPPUNIT_ASSERT_EQUAL((int) bulkio::sri::MODE, result.sriChangeFlags());
+    CPPUNIT_ASSERT(result.inputQueueFlushed());
+    CPPUNIT_ASSERT_EQUAL((size_t) 2, result.getTimestamps().size());
+    CPPUNIT_ASSERT_EQUAL((size_t) 10, result.getTimestamps().back().offset);
+}
@@ -0,0 +1,146 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK bulkioInterfaces.
+ *
+ * REDHAWK bulkioInterfaces is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK bulkioInterfaces is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+#include "FileTest.h"
+
+#include <sstream>
+#include <unistd.h>
+
+#include <bulkio/bulkio.h>
+#include <ossie/PropertyMap.h>
+
+CPPUNIT_TEST_SUITE_REGISTRATION(FileTest);
+
+namespace {
+    bulkio::ShortDataBlock createBlock(const BULKIO::StreamSRI& sri, size_t size, short start,
+                                       const BULKIO::PrecisionUTCTime& time)
+    {
+        redhawk::buffer<short> data(size);
+        for (size_t ii = 0; ii < size; ++ii) {
+            data[ii] = start + ii;
+        }
+        bulkio::ShortDataBlock block(sri, data);
+        block.addTimestamp(bulkio::SampleTimestamp(time, 0));
+        return block;
+    }
+}
+
+void FileTest::setUp()
+{
+    std::ostringstream oss;
+    oss << "/tmp/bulkio_filetest_" << getpid() << ".tmp";
+    _path = oss.str();
+}
+
+void FileTest::tearDown()
+{
+    unlink(_path.c_str());
+    unlink((_path + ".sri").c_str());
+}
+
+void FileTest::testBlueFile()
+{
+    BULKIO::StreamSRI sri = bulkio::sri::create("blue_file", 1000.0);
+    sri.mode = 1;
+    sri.xstart = 2.5;
+    redhawk::PropertyMap& keywords = redhawk::PropertyMap::cast(sri.keywords);
+    keywords["COL_RF"] = 1.0e9;
+    keywords["CHAN"] = (CORBA::Long) 4;
+    keywords["NAME"] = "test";
+
+    // Use a small buffer size so that the I/O thread writes several buffers
+    BULKIO::PrecisionUTCTime start = bulkio::time::utils::create(1000.0, 0.5);
+    {
+        bulkio::FileWriter writer(_path, bulkio::FILE_FORMAT_BLUE, 4096);
+        for (int ii = 0; ii < 10; ++ii) {
+            writer.write(createBlock(sri, 2000, ii * 2000, start + ii * 1000 * sri.xdelta));
+        }
+        CPPUNIT_ASSERT_EQUAL((size_t) 20000, writer.size());
+        writer.close();
+        CPPUNIT_ASSERT(!writer.isOpen());
+    }
+
+    bulkio::FileReader reader(_path);
+    CPPUNIT_ASSERT_EQUAL(bulkio::FILE_FORMAT_BLUE, reader.format());
+    CPPUNIT_ASSERT(reader.complex());
+    CPPUNIT_ASSERT_EQUAL('I', reader.typeCode());
+    CPPUNIT_ASSERT_EQUAL(sri.xstart, reader.sri().xstart);
+    CPPUNIT_ASSERT_EQUAL(sri.xdelta, reader.sri().xdelta);
+
+    const redhawk::PropertyMap& read_keywords = redhawk::PropertyMap::cast(reader.sri().keywords);
+    CPPUNIT_ASSERT_EQUAL((size_t) 3, read_keywords.size());
+    CPPUNIT_ASSERT_EQUAL(1.0e9, read_keywords["COL_RF"].toDouble());
+    CPPUNIT_ASSERT_EQUAL((CORBA::Long) 4, read_keywords["CHAN"].toLong());
+    CPPUNIT_ASSERT_EQUAL(std::string("test"), read_keywords["NAME"].toString());
+
+    // Only the start time is kept in a BLUE file
+    CPPUNIT_ASSERT_EQUAL(start, reader.timeAt(0));
+
+    redhawk::shared_buffer<short> data = reader.data<short>();
+    CPPUNIT_ASSERT_EQUAL((size_t) 20000, data.size());
+    for (size_t ii = 0; ii < data.size(); ++ii) {
+        CPPUNIT_ASSERT_EQUAL((short) ii, data[ii]);
+    }
+}
+
+void FileTest::testRawFile()
+{
+    BULKIO::StreamSRI sri = bulkio::sri::create("raw_file", 100.0);
+    redhawk::PropertyMap::cast(sri.keywords)["NAME"] = "line 1\nline 2";
+
+    // Write three contiguous blocks, then jump forward by 5 seconds
+    BULKIO::PrecisionUTCTime start = bulkio::time::utils::create(2000.0, 0.0);
+    bulkio::FileWriter writer(_path, bulkio::FILE_FORMAT_RAW, 4096);
+    for (int ii = 0; ii < 3; ++ii) {
+        writer.write(createBlock(sri, 100, ii * 100, start + ii * 1.0));
+    }
+    writer.write(createBlock(sri, 100, 300, start + 8.0));
+    writer.close();
+
+    bulkio::FileReader reader(_path);
+    CPPUNIT_ASSERT_EQUAL(bulkio::FILE_FORMAT_RAW, reader.format());
+    CPPUNIT_ASSERT_EQUAL(std::string("raw_file"), std::string(reader.sri().streamID));
+    CPPUNIT_ASSERT(!reader.complex());
+    CPPUNIT_ASSERT_EQUAL((size_t) 400, reader.size());
+    CPPUNIT_ASSERT_EQUAL(std::string("line 1\nline 2"),
+                         redhawk::PropertyMap::cast(reader.sri().keywords)["NAME"].toString());
+
+    // Contiguous time stamps are collapsed; the discontinuity is kept
+    CPPUNIT_ASSERT_EQUAL((size_t) 2, reader.timestamps().size());
+    CPPUNIT_ASSERT_EQUAL(start + 2.5, reader.timeAt(250));
+    CPPUNIT_ASSERT_EQUAL(start + 8.5, reader.timeAt(350));
+}
+
+void FileTest::testTypeMismatch()
+{
+    BULKIO::StreamSRI sri = bulkio::sri::create("type_mismatch");
+    bulkio::FileWriter writer(_path, bulkio::FILE_FORMAT_BLUE);
+    writer.write(createBlock(sri, 16, 0, bulkio::time::utils::now()));
+
+    // Changing the sample type is not allowed
+    std::vector<float> floats(16);
+    CPPUNIT_ASSERT_THROW(writer.write(sri, &floats[0], floats.size(), bulkio::time::utils::now()), std::logic_error);
+    writer.close();
+
+    // Unsigned short shares a type code with short, but float does not
+    bulkio::FileReader reader(_path);
+    CPPUNIT_ASSERT_EQUAL((size_t) 16, reader.data<unsigned short>().size());
+    CPPUNIT_ASSERT_THROW(reader.data<float>(), std::logic_error);
+}
@@ -0,0 +1,48 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK bulkioInterfaces.
+ *
+ * REDHAWK bulkioInterfaces is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK bulkioInterfaces is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+#ifndef BULKIO_FILETEST_H
+#define BULKIO_FILETEST_H
+
+#include <string>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class FileTest : public CppUnit::TestFixture
+{
+    CPPUNIT_TEST_SUITE(FileTest);
+    CPPUNIT_TEST(testBlueFile);
+    CPPUNIT_TEST(testRawFile);
+    CPPUNIT_TEST(testTypeMismatch);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp();
+    void tearDown();
+
+    void testBlueFile();
+    void testRawFile();
+    void testTypeMismatch();
+
+private:
+    std::string _path;
+};
+
+#endif  // BULKIO_FILETEST_H
@@ -20,21 +20,59 @@
 #ifndef BULKIO_INPORTSTUB_H
 #define BULKIO_INPORTSTUB_H
 
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+
 #include "bulkio.h"
 
 template <class PortType>
 class InPortStubBase : public virtual bulkio::CorbaTraits<PortType>::POAType
 {
 public:
-    InPortStubBase()
+    InPortStubBase() :
+        _gated(false),
+        _waiting(false)
     {
     }
 
     virtual void pushSRI(const BULKIO::StreamSRI& H)
     {
+        {
+            // Simulate a slow consumer by holding the caller until opened
+            boost::mutex::scoped_lock lock(_gateMutex);
+            while (_gated) {
+                _waiting = true;
+                _gateCond.notify_all();
+                _gateCond.wait(lock);
+            }
+            _waiting = false;
+        }
         this->H.push_back(H);
     }
 
+    // Makes pushSRI() block until open() is called
+    void close()
+    {
+        boost::mutex::scoped_lock lock(_gateMutex);
+        _gated = true;
+    }
+
+    void open()
+    {
+        boost::mutex::scoped_lock lock(_gateMutex);
+        _gated = false;
+        _gateCond.notify_all();
+    }
+
+    // Waits until a caller is blocked in pushSRI()
+    void waitBlocked()
+    {
+        boost::mutex::scoped_lock lock(_gateMutex);
+        while (!_waiting) {
+            _gateCond.wait(lock);
+        }
+    }
+
     virtual BULKIO::PortUsageType state()
     {
         return BULKIO::IDLE;
@@ -51,6 +89,12 @@ public:
     }
 
     std::vector<BULKIO::StreamSRI> H;
+
+private:
+    boost::mutex _gateMutex;
+    boost::condition_variable _gateCond;
+    bool _gated;
+    bool _waiting;
 };
 
 template <class PortType>
@@ -20,7 +20,35 @@
 
 #include "InPortTest.h"
 
+#include <map>
+
 #include <boost/scoped_ptr.hpp>
+#include <boost/thread.hpp>
+
+namespace {
+    // Reads one packet on another thread, for tests that need the reader to
+    // be blocked before the packet is pushed
+    template <class Port>
+    struct PacketReader {
+        PacketReader(Port* port, float timeout, const std::string& streamID) :
+            port(port),
+            timeout(timeout),
+            streamID(streamID),
+            packet(0)
+        {
+        }
+
+        void operator() ()
+        {
+            packet = port->getPacket(timeout, streamID);
+        }
+
+        Port* port;
+        float timeout;
+        std::string streamID;
+        typename Port::dataTransfer* packet;
+    };
+}
 
 class SriListener {
 public:
@@ -310,6 +338,260 @@ void InPortTest<Port>::testQueueDepth()
     CPPUNIT_ASSERT_EQUAL((size_t)6, packet->dataBuffer.size());
 }
 
+template <class Port>
+void InPortTest<Port>::testLockFreeQueue()
+{
+    const char* stream_id = "test_lockfree";
+
+    CPPUNIT_ASSERT(!port->isLockFreeQueueEnabled());
+    port->enableLockFreeQueue(true);
+    CPPUNIT_ASSERT(port->isLockFreeQueueEnabled());
+    port->setMaxQueueDepth(4);
+
+    // Use a non-blocking stream to allow queue flushing
+    BULKIO::StreamSRI sri = bulkio::sri::create(stream_id);
+    sri.blocking = false;
+    port->pushSRI(sri);
+
+    // Fill the queue; depth and state must include packets that have not yet
+    // been moved out of the lock-free queue
+    for (int ii = 0; ii < 4; ii++) {
+        this->_pushTestPacket(ii+1, bulkio::time::utils::now(), false, stream_id);
+    }
+    CPPUNIT_ASSERT_EQUAL(4, port->getCurrentQueueDepth());
+    CPPUNIT_ASSERT_EQUAL(BULKIO::BUSY, port->state());
+
+    // One more packet should flush the queue, as with the normal queue
+    this->_pushTestPacket(5, bulkio::time::utils::now(), false, stream_id);
+    CPPUNIT_ASSERT_EQUAL(1, port->getCurrentQueueDepth());
+
+    boost::scoped_ptr<PacketType> packet;
+    packet.reset(port->getPacket(bulkio::Const::BLOCKING));
+    CPPUNIT_ASSERT(packet);
+    CPPUNIT_ASSERT(packet->inputQueueFlushed);
+    CPPUNIT_ASSERT(packet->sriChanged);
+    CPPUNIT_ASSERT_EQUAL((size_t)5, packet->dataBuffer.size());
+    CPPUNIT_ASSERT_EQUAL(BULKIO::IDLE, port->state());
+
+    // End-of-stream goes through the lock-free path and must still be
+    // delivered in order
+    this->_pushTestPacket(6, bulkio::time::utils::now(), false, stream_id);
+    this->_pushTestPacket(0, bulkio::time::utils::now(), true, stream_id);
+    packet.reset(port->getPacket(bulkio::Const::NON_BLOCKING));
+    CPPUNIT_ASSERT(packet);
+    CPPUNIT_ASSERT(!packet->inputQueueFlushed);
+    CPPUNIT_ASSERT(!packet->EOS);
+    packet.reset(port->getPacket(bulkio::Const::NON_BLOCKING));
+    CPPUNIT_ASSERT(packet);
+    CPPUNIT_ASSERT(packet->EOS);
+    CPPUNIT_ASSERT_EQUAL(0, port->getCurrentQueueDepth());
+
+    // Disabling moves any remaining packets back to the normal queue
+    port->pushSRI(sri);
+    this->_pushTestPacket(7, bulkio::time::utils::now(), false, stream_id);
+    port->enableLockFreeQueue(false);
+    CPPUNIT_ASSERT(!port->isLockFreeQueueEnabled());
+    CPPUNIT_ASSERT_EQUAL(1, port->getCurrentQueueDepth());
+    packet.reset(port->getPacket(bulkio::Const::NON_BLOCKING));
+    CPPUNIT_ASSERT(packet);
+    CPPUNIT_ASSERT_EQUAL((size_t)7, packet->dataBuffer.size());
+}
+
+template <class Port>
+void InPortTest<Port>::_pushPackets(const std::string& streamID, size_t count)
+{
+    for (size_t length = 1; length <= count; ++length) {
+        this->_pushTestPacket(length, bulkio::time::utils::now(), false, streamID.c_str());
+    }
+}
+
+template <class Port>
+void InPortTest<Port>::testLockFreeQueueConcurrent()
+{
+    // Two writers and a reader run at once through a small queue, so that the
+    // reader both spins and sleeps, and the writers both use the ring and
+    // block on the normal path when it is full; every packet must arrive, in
+    // order within its stream
+    port->enableLockFreeQueue(true);
+    port->setMaxQueueDepth(8);
+
+    const std::string streams[] = { "stream_a", "stream_b" };
+    for (size_t index = 0; index < 2; ++index) {
+        BULKIO::StreamSRI sri = bulkio::sri::create(streams[index]);
+        sri.blocking = true;
+        port->pushSRI(sri);
+    }
+
+    const size_t COUNT = 1000;
+    boost::thread writer_a(&InPortTest::_pushPackets, this, streams[0], COUNT);
+    boost::thread writer_b(&InPortTest::_pushPackets, this, streams[1], COUNT);
+
+    std::map<std::string,size_t> received;
+    for (size_t ii = 0; ii < (2 * COUNT); ++ii) {
+        boost::scoped_ptr<PacketType> packet(port->getPacket(5.0));
+        CPPUNIT_ASSERT_MESSAGE("Packet lost", packet);
+        CPPUNIT_ASSERT(!packet->inputQueueFlushed);
+        size_t& last = received[packet->streamID];
+        CPPUNIT_ASSERT_EQUAL_MESSAGE("Packet out of order", last + 1, (size_t) packet->dataBuffer.size());
+        last = packet->dataBuffer.size();
+    }
+    writer_a.join();
+    writer_b.join();
+
+    CPPUNIT_ASSERT_EQUAL(COUNT, received[streams[0]]);
+    CPPUNIT_ASSERT_EQUAL(COUNT, received[streams[1]]);
+    CPPUNIT_ASSERT_EQUAL(0, port->getCurrentQueueDepth());
+}
+
+template <class Port>
+void InPortTest<Port>::testLockFreeQueueToggle()
+{
+    // Switch between the lock-free queue, the normal queue and per-stream
+    // queues while two writers are pushing; the queue is deep enough that the
+    // writers never block, and every packet must be kept, in order within its
+    // stream
+    const size_t COUNT = 2000;
+    port->setMaxQueueDepth(2 * COUNT);
+
+    const std::string streams[] = { "stream_a", "stream_b" };
+    for (size_t index = 0; index < 2; ++index) {
+        port->pushSRI(bulkio::sri::create(streams[index]));
+    }
+
+    boost::thread writer_a(&InPortTest::_pushPackets, this, streams[0], COUNT);
+    boost::thread writer_b(&InPortTest::_pushPackets, this, streams[1], COUNT);
+    for (int toggle = 0; toggle < 100; ++toggle) {
+        port->enableLockFreeQueue(true);
+        boost::this_thread::yield();
+        if (toggle % 2) {
+            port->enableStreamQueues(true);
+            boost::this_thread::yield();
+            port->enableStreamQueues(false);
+        } else {
+            port->enableLockFreeQueue(false);
+        }
+        boost::this_thread::yield();
+    }
+    writer_a.join();
+    writer_b.join();
+    port->enableLockFreeQueue(false);
+
+    std::map<std::string,size_t> received;
+    for (size_t ii = 0; ii < (2 * COUNT); ++ii) {
+        boost::scoped_ptr<PacketType> packet(port->getPacket(bulkio::Const::NON_BLOCKING));
+        CPPUNIT_ASSERT_MESSAGE("Packet lost", packet);
+        size_t& last = received[packet->streamID];
+        CPPUNIT_ASSERT_EQUAL_MESSAGE("Packet out of order", last + 1, (size_t) packet->dataBuffer.size());
+        last = packet->dataBuffer.size();
+    }
+    CPPUNIT_ASSERT_EQUAL(0, port->getCurrentQueueDepth());
+}
+
+template <class Port>
+void InPortTest<Port>::testStreamQueues()
+{
+    CPPUNIT_ASSERT(!port->isStreamQueuesEnabled());
+    port->enableStreamQueues(true);
+    CPPUNIT_ASSERT(port->isStreamQueuesEnabled());
+    port->setMaxQueueDepth(2);
+
+    // Use non-blocking streams to allow queue flushing
+    BULKIO::StreamSRI sri_a = bulkio::sri::create("stream_a");
+    sri_a.blocking = false;
+    port->pushSRI(sri_a);
+    BULKIO::StreamSRI sri_b = bulkio::sri::create("stream_b");
+    sri_b.blocking = false;
+    port->pushSRI(sri_b);
+
+    // Interleave packets so that arrival order differs from stream order
+    this->_pushTestPacket(1, bulkio::time::utils::now(), false, "stream_a");
+    this->_pushTestPacket(2, bulkio::time::utils::now(), false, "stream_b");
+    this->_pushTestPacket(3, bulkio::time::utils::now(), false, "stream_a");
+    CPPUNIT_ASSERT_EQUAL(3, port->getCurrentQueueDepth());
+
+    // Each stream has its own maximum depth; filling one does not affect the
+    // other, and pushing more flushes only the full stream
+    typename Port::StreamQueueStatus status;
+    CPPUNIT_ASSERT(port->getStreamQueueStatus("stream_a", status));
+    CPPUNIT_ASSERT_EQUAL((size_t) 2, status.depth);
+    CPPUNIT_ASSERT_EQUAL(BULKIO::BUSY, port->state());
+    this->_pushTestPacket(4, bulkio::time::utils::now(), false, "stream_a");
+    CPPUNIT_ASSERT(port->getStreamQueueStatus("stream_a", status));
+    CPPUNIT_ASSERT_EQUAL((size_t) 1, status.depth);
+    CPPUNIT_ASSERT_EQUAL((size_t) 1, status.flushes);
+    CPPUNIT_ASSERT(port->getStreamQueueStatus("stream_b", status));
+    CPPUNIT_ASSERT_EQUAL((size_t) 1, status.depth);
+    CPPUNIT_ASSERT_EQUAL((size_t) 0, status.flushes);
+
+    // Reading by stream ID returns that stream's oldest packet
+    boost::scoped_ptr<PacketType> packet;
+    packet.reset(port->getPacket(bulkio::Const::NON_BLOCKING, "stream_a"));
+    CPPUNIT_ASSERT(packet);
+    CPPUNIT_ASSERT(packet->inputQueueFlushed);
+    CPPUNIT_ASSERT_EQUAL((size_t) 4, packet->dataBuffer.size());
+    packet.reset(port->getPacket(bulkio::Const::NON_BLOCKING, "stream_a"));
+    CPPUNIT_ASSERT(!packet);
+
+    // Reading without a stream ID follows arrival order across streams
+    this->_pushTestPacket(5, bulkio::time::utils::now(), false, "stream_a");
+    packet.reset(port->getPacket(bulkio::Const::NON_BLOCKING));
+    CPPUNIT_ASSERT(packet);
+    CPPUNIT_ASSERT_EQUAL(std::string("stream_b"), packet->streamID);
+    packet.reset(port->getPacket(bulkio::Const::NON_BLOCKING));
+    CPPUNIT_ASSERT(packet);
+    CPPUNIT_ASSERT_EQUAL(std::string("stream_a"), packet->streamID);
+    CPPUNIT_ASSERT_EQUAL((size_t) 5, packet->dataBuffer.size());
+    CPPUNIT_ASSERT_EQUAL(0, port->getCurrentQueueDepth());
+
+    // Once its end-of-stream is read, the stream's queue goes away
+    this->_pushTestPacket(0, bulkio::time::utils::now(), true, "stream_b");
+    packet.reset(port->getPacket(bulkio::Const::NON_BLOCKING, "stream_b"));
+    CPPUNIT_ASSERT(packet);
+    CPPUNIT_ASSERT(packet->EOS);
+    CPPUNIT_ASSERT(!port->getStreamQueueStatus("stream_b", status));
+
+    // Disabling moves any remaining packets back to the normal queue, in
+    // arrival order
+    port->pushSRI(sri_b);
+    this->_pushTestPacket(6, bulkio::time::utils::now(), false, "stream_b");
+    this->_pushTestPacket(7, bulkio::time::utils::now(), false, "stream_a");
+    port->enableStreamQueues(false);
+    CPPUNIT_ASSERT(!port->isStreamQueuesEnabled());
+    CPPUNIT_ASSERT_EQUAL(2, port->getCurrentQueueDepth());
+    packet.reset(port->getPacket(bulkio::Const::NON_BLOCKING));
+    CPPUNIT_ASSERT(packet);
+    CPPUNIT_ASSERT_EQUAL((size_t) 6, packet->dataBuffer.size());
+    packet.reset(port->getPacket(bulkio::Const::NON_BLOCKING));
+    CPPUNIT_ASSERT(packet);
+    CPPUNIT_ASSERT_EQUAL((size_t) 7, packet->dataBuffer.size());
+}
+
+template <class Port>
+void InPortTest<Port>::testStreamQueuesUnknownStream()
+{
+    port->enableStreamQueues(true);
+
+    // Waiting on a stream ID that has never been seen must not leave a queue
+    // behind for it
+    boost::scoped_ptr<PacketType> packet;
+    packet.reset(port->getPacket(0.01, "unknown"));
+    CPPUNIT_ASSERT(!packet);
+    typename Port::StreamQueueStatus status;
+    CPPUNIT_ASSERT(!port->getStreamQueueStatus("unknown", status));
+
+    // A reader blocked on a stream that does not have a queue yet must still
+    // be woken by the stream's first packet
+    PacketReader<Port> reader(port, 5.0, "late");
+    boost::thread thread(boost::ref(reader));
+    usleep(50000);
+    port->pushSRI(bulkio::sri::create("late"));
+    this->_pushTestPacket(3, bulkio::time::utils::now(), false, "late");
+    thread.join();
+    packet.reset(reader.packet);
+    CPPUNIT_ASSERT(packet);
+    CPPUNIT_ASSERT_EQUAL(std::string("late"), packet->streamID);
+}
+
 template <class Port>
 void InPortTest<Port>::testState()
 {
@@ -42,6 +42,11 @@ class InPortTest : public InPortTestFixture<Port>
     CPPUNIT_TEST(testDiscardEmptyPacket);
     CPPUNIT_TEST(testQueueFlushFlags);
     CPPUNIT_TEST(testQueueSize);
+    CPPUNIT_TEST(testLockFreeQueue);
+    CPPUNIT_TEST(testLockFreeQueueConcurrent);
+    CPPUNIT_TEST(testLockFreeQueueToggle);
+    CPPUNIT_TEST(testStreamQueues);
+    CPPUNIT_TEST(testStreamQueuesUnknownStream);
     CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -59,6 +64,11 @@ public:
     void testDiscardEmptyPacket();
     void testQueueFlushFlags();
     void testQueueSize();
+    void testLockFreeQueue();
+    void testLockFreeQueueConcurrent();
+    void testLockFreeQueueToggle();
+    void testStreamQueues();
+    void testStreamQueuesUnknownStream();
 
 protected:
     typedef typename Port::dataTransfer PacketType;
@@ -66,6 +76,10 @@ protected:
 
     static const size_t BITS_PER_ELEMENT;
 
+    // Pushes packets of length 1 through count to a stream, for use from a
+    // writer thread
+    void _pushPackets(const std::string& streamID, size_t count);
+
     using TestBase::port;
 };
 
@@ -1087,6 +1087,76 @@ void NumericInStreamTest<Port>::testReadTimestampsComplex()
     CPPUNIT_ASSERT_EQUAL(false, it->synthetic);
 }
 
+template <class Port>
+void NumericInStreamTest<Port>::testMirroredBuffer()
+{
+    const char* stream_id = "mirrored_buffer";
+
+    BULKIO::StreamSRI sri = bulkio::sri::create(stream_id);
+    sri.xdelta = 0.125;
+    port->pushSRI(sri);
+
+    // Push a packet with a ramp so that data placement can be checked
+    typename Port::PortSequenceType data;
+    data.length(96);
+    for (size_t index = 0; index < data.length(); ++index) {
+        data[index] = index;
+    }
+    BULKIO::PrecisionUTCTime ts = bulkio::time::utils::create(100.0, 0.0);
+    port->pushPacket(data, ts, false, stream_id);
+
+    // Enable mirrored buffering with a small ring, with data already queued
+    StreamType stream = port->getStream(stream_id);
+    CPPUNIT_ASSERT(stream);
+    CPPUNIT_ASSERT(!stream.isMirroredBufferEnabled());
+    CPPUNIT_ASSERT(stream.enableMirroredBuffer(100));
+    CPPUNIT_ASSERT(stream.isMirroredBufferEnabled());
+
+    // Push enough packets to fill the ring several times over, reading with
+    // overlap; every block must contain the ramp in order and have a
+    // timestamp at each packet boundary
+    for (int packet = 1; packet < 50; ++packet) {
+        for (size_t index = 0; index < data.length(); ++index) {
+            data[index] = (packet * data.length() + index) % 100;
+        }
+        port->pushPacket(data, ts + (packet * 12.0), false, stream_id);
+    }
+
+    size_t offset = 0;
+    DataBlockType block;
+    DataBlockType previous;
+    while (offset < (40 * data.length())) {
+        // Holding on to the previous block pins its data in the ring
+        previous = block;
+        block = stream.read(128, 64);
+        CPPUNIT_ASSERT(block);
+        CPPUNIT_ASSERT_EQUAL((size_t) 128, block.buffer().size());
+        for (size_t index = 0; index < block.buffer().size(); ++index) {
+            typename DataBlockType::ScalarType expected = (offset + index) % 100;
+            CPPUNIT_ASSERT_EQUAL_MESSAGE("Wrong data at index", expected, block.buffer()[index]);
+        }
+        std::list<bulkio::SampleTimestamp> timestamps = block.getTimestamps();
+        CPPUNIT_ASSERT_EQUAL_MESSAGE("Wrong timestamp", ts + (offset * 0.125), timestamps.begin()->time);
+        if (previous) {
+            CPPUNIT_ASSERT_EQUAL_MESSAGE("Earlier block was overwritten", block.buffer()[0], previous.buffer()[64]);
+        }
+        offset += 64;
+    }
+
+    // Disabling copies the queued data out of the ring, and does not affect
+    // blocks that have already been read
+    stream.disableMirroredBuffer();
+    CPPUNIT_ASSERT(!stream.isMirroredBufferEnabled());
+    previous = block;
+    block = stream.read(128, 64);
+    CPPUNIT_ASSERT(block);
+    CPPUNIT_ASSERT_EQUAL(block.buffer()[0], previous.buffer()[64]);
+    for (size_t index = 0; index < block.buffer().size(); ++index) {
+        typename DataBlockType::ScalarType expected = (offset + index) % 100;
+        CPPUNIT_ASSERT_EQUAL_MESSAGE("Wrong data after disable", expected, block.buffer()[index]);
+    }
+}
+
 #define CREATE_TEST(x, BASE)                                            \
     class In##x##StreamTest : public BASE<bulkio::In##x##Port>          \
     {                                                                   \
@@ -100,6 +100,7 @@ class NumericInStreamTest : public BufferedInStreamTest<Port>
     CPPUNIT_TEST_SUB_SUITE(NumericInStreamTest, TestBase);
     CPPUNIT_TEST(testSriModeChanges);
     CPPUNIT_TEST(testReadTimestampsComplex);
+    CPPUNIT_TEST(testMirroredBuffer);
     CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -107,6 +108,8 @@ public:
 
     void testReadTimestampsComplex();
 
+    void testMirroredBuffer();
+
 private:
     typedef typename Port::StreamType StreamType;
     typedef typename StreamType::DataBlockType DataBlockType;
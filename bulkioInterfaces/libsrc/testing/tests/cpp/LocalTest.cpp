@@ -19,8 +19,11 @@
  */
 
 #include "LocalTest.h"
+#include <ossie/PropertyMap.h>
 #include <bulkio/bulkio.h>
 
+#include <boost/thread.hpp>
+
 namespace {
     template <class T>
     bool overlaps(const T start1, const T end1, const T start2, const T end2)
@@ -180,6 +183,172 @@ void LocalTest<OutPort,InPort>::testReadSlice()
     CPPUNIT_ASSERT(!overlaps(data2, result));
 }
 
+template <class OutPort, class InPort>
+void LocalTest<OutPort,InPort>::testCreditFlowControl()
+{
+    // Credit is advertised when the connection is made, so reconnect after
+    // setting the window
+    outPort->disconnectPort("local_connection");
+    inPort->setCreditWindow(2048);
+    CORBA::Object_var objref = inPort->_this();
+    outPort->connectPort(objref, "local_connection");
+
+    OutStreamType out_stream = outPort->createStream("test_stream");
+    CPPUNIT_ASSERT(out_stream.canWrite(2048));
+    CPPUNIT_ASSERT(!out_stream.canWrite(2049));
+
+    // Two writes use up the whole window
+    MutableBufferType data(1024);
+    out_stream.write(data, bulkio::time::utils::now());
+    CPPUNIT_ASSERT(out_stream.canWrite(1024));
+    out_stream.write(data, bulkio::time::utils::now());
+    CPPUNIT_ASSERT(!out_stream.canWrite(1));
+
+    // Reading a packet returns its credit
+    InStreamType in_stream = inPort->getStream("test_stream");
+    CPPUNIT_ASSERT(in_stream);
+    DataBlockType block = in_stream.tryread();
+    CPPUNIT_ASSERT(block);
+    CPPUNIT_ASSERT(out_stream.canWrite(1024));
+    CPPUNIT_ASSERT(!out_stream.canWrite(1025));
+
+    // With the drop policy, a write that exceeds the remaining credit is
+    // discarded instead of waiting
+    outPort->setCreditPolicy(bulkio::CREDIT_DROP);
+    out_stream.write(data, bulkio::time::utils::now());
+    out_stream.write(data, bulkio::time::utils::now());
+    CPPUNIT_ASSERT_EQUAL(2, inPort->getCurrentQueueDepth());
+
+    BULKIO::UsesPortStatisticsSequence_var uses_stats = outPort->statistics();
+    CPPUNIT_ASSERT_EQUAL((CORBA::ULong) 1, uses_stats->length());
+    const redhawk::PropertyMap& keywords = redhawk::PropertyMap::cast(uses_stats[0].statistics.keywords);
+    CPPUNIT_ASSERT_EQUAL((CORBA::ULongLong) 2048, keywords["credit::window"].toULongLong());
+    CPPUNIT_ASSERT_EQUAL((CORBA::ULongLong) 0, keywords["credit::available"].toULongLong());
+    CPPUNIT_ASSERT_EQUAL((CORBA::ULongLong) 1, keywords["credit::exhausted"].toULongLong());
+    CPPUNIT_ASSERT_EQUAL((CORBA::ULongLong) 1, keywords["credit::dropped"].toULongLong());
+
+    // Reading the remaining packets returns the rest of the credit
+    in_stream.tryread();
+    in_stream.tryread();
+    CPPUNIT_ASSERT(out_stream.canWrite(2048));
+}
+
+template <class OutPort, class InPort>
+void LocalTest<OutPort,InPort>::testCreditWaitUnlocked()
+{
+    _connectWithCredit(1024);
+    OutStreamType out_stream = outPort->createStream("test_stream");
+    _writePacket(out_stream, 1024);
+    CPPUNIT_ASSERT(!out_stream.canWrite(1));
+
+    // A synchronous write that is waiting for credit must not hold the port's
+    // lock, so that other calls into the port (here, statistics) complete
+    boost::thread writer(&LocalTest::_writePacket, this, out_stream, 1024);
+    boost::this_thread::sleep(boost::posix_time::milliseconds(50));
+    BULKIO::UsesPortStatisticsSequence_var uses_stats = outPort->statistics();
+    CPPUNIT_ASSERT_EQUAL((CORBA::ULong) 1, uses_stats->length());
+    CPPUNIT_ASSERT(!writer.timed_join(boost::posix_time::milliseconds(0)));
+    CPPUNIT_ASSERT_EQUAL(1, inPort->getCurrentQueueDepth());
+
+    // Reading a packet returns the credit, which lets the write go through
+    InStreamType in_stream = inPort->getStream("test_stream");
+    CPPUNIT_ASSERT(in_stream);
+    CPPUNIT_ASSERT(_readPacket(in_stream));
+    CPPUNIT_ASSERT(writer.timed_join(boost::posix_time::seconds(2)));
+    CPPUNIT_ASSERT_EQUAL(1, inPort->getCurrentQueueDepth());
+
+    uses_stats = outPort->statistics();
+    const redhawk::PropertyMap& keywords = redhawk::PropertyMap::cast(uses_stats[0].statistics.keywords);
+    CPPUNIT_ASSERT_EQUAL((CORBA::ULongLong) 1, keywords["credit::exhausted"].toULongLong());
+    CPPUNIT_ASSERT(keywords["credit::wait_time"].toDouble() > 0.0);
+}
+
+template <class OutPort, class InPort>
+void LocalTest<OutPort,InPort>::testCreditWaitAsync()
+{
+    _connectWithCredit(1024);
+    outPort->setAsyncFanout(4);
+    OutStreamType out_stream = outPort->createStream("test_stream");
+
+    // With asynchronous pushes, the wait for credit happens on the sender
+    // thread, so the writes return even though the reader is not reading
+    for (int ii = 0; ii < 3; ++ii) {
+        _writePacket(out_stream, 1024);
+    }
+
+    // Each packet read returns enough credit for the sender to send the next
+    InStreamType in_stream = inPort->getStream("test_stream");
+    CPPUNIT_ASSERT(in_stream);
+    for (int ii = 0; ii < 3; ++ii) {
+        CPPUNIT_ASSERT_MESSAGE("Packet not delivered", _readPacket(in_stream));
+    }
+    CPPUNIT_ASSERT_EQUAL(0, inPort->getCurrentQueueDepth());
+}
+
+template <class OutPort, class InPort>
+void LocalTest<OutPort,InPort>::_connectWithCredit(size_t window)
+{
+    // Credit is advertised when the connection is made, so reconnect after
+    // setting the window
+    outPort->disconnectPort("local_connection");
+    inPort->setCreditWindow(window);
+    CORBA::Object_var objref = inPort->_this();
+    outPort->connectPort(objref, "local_connection");
+}
+
+template <class OutPort, class InPort>
+void LocalTest<OutPort,InPort>::_writePacket(OutStreamType stream, size_t size)
+{
+    MutableBufferType data(size);
+    stream.write(data, bulkio::time::utils::now());
+}
+
+template <class OutPort, class InPort>
+typename LocalTest<OutPort,InPort>::DataBlockType LocalTest<OutPort,InPort>::_readPacket(InStreamType stream)
+{
+    // Poll rather than block, so that a packet that never arrives fails the
+    // test instead of hanging it
+    const boost::system_time end = boost::get_system_time() + boost::posix_time::seconds(2);
+    DataBlockType block = stream.tryread();
+    while (!block && (boost::get_system_time() < end)) {
+        boost::this_thread::sleep(boost::posix_time::milliseconds(1));
+        block = stream.tryread();
+    }
+    return block;
+}
+
+template <class OutPort, class InPort>
+void LocalTest<OutPort,InPort>::testSriChanged()
+{
+    OutStreamType out_stream = outPort->createStream("test_stream");
+    MutableBufferType data(16);
+    out_stream.write(data, bulkio::time::utils::now());
+
+    InStreamType in_stream = inPort->getStream("test_stream");
+    CPPUNIT_ASSERT(in_stream);
+    DataBlockType block = in_stream.tryread();
+    CPPUNIT_ASSERT(block);
+    CPPUNIT_ASSERT(block.sriChanged());
+
+    // Changing the SRI and then restoring it bumps the stream's SRI version,
+    // but the reader should not see a change
+    const double xdelta = out_stream.xdelta();
+    out_stream.xdelta(xdelta * 2.0);
+    out_stream.xdelta(xdelta);
+    out_stream.write(data, bulkio::time::utils::now());
+    block = in_stream.tryread();
+    CPPUNIT_ASSERT(block);
+    CPPUNIT_ASSERT_MESSAGE("Restored SRI reported as changed", !block.sriChanged());
+
+    // An actual change must still be reported
+    out_stream.xdelta(xdelta * 2.0);
+    out_stream.write(data, bulkio::time::utils::now());
+    block = in_stream.tryread();
+    CPPUNIT_ASSERT(block);
+    CPPUNIT_ASSERT(block.sriChanged());
+    CPPUNIT_ASSERT_EQUAL(xdelta * 2.0, block.xdelta());
+}
+
 #define CREATE_TEST(x)                                                  \
     class Local##x##Test : public LocalTest<bulkio::Out##x##Port,bulkio::In##x##Port> \
     {                                                                   \
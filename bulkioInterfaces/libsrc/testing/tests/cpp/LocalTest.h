@@ -31,6 +31,10 @@ class LocalTest : public CppUnit::TestFixture
     CPPUNIT_TEST(testBasicWrite);
     CPPUNIT_TEST(testLargeWrite);
     CPPUNIT_TEST(testReadSlice);
+    CPPUNIT_TEST(testCreditFlowControl);
+    CPPUNIT_TEST(testCreditWaitUnlocked);
+    CPPUNIT_TEST(testCreditWaitAsync);
+    CPPUNIT_TEST(testSriChanged);
     CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -42,6 +46,12 @@ public:
 
     void testReadSlice();
 
+    void testCreditFlowControl();
+    void testCreditWaitUnlocked();
+    void testCreditWaitAsync();
+
+    void testSriChanged();
+
 protected:
     typedef typename OutPort::StreamType OutStreamType;
     typedef typename InPort::StreamType InStreamType;
@@ -50,6 +60,10 @@ protected:
     typedef typename bulkio::BufferTraits<CorbaType>::BufferType BufferType;
     typedef typename bulkio::BufferTraits<CorbaType>::MutableBufferType MutableBufferType;
 
+    void _connectWithCredit(size_t window);
+    void _writePacket(OutStreamType stream, size_t size);
+    DataBlockType _readPacket(InStreamType stream);
+
     OutPort* outPort;
     InPort* inPort;
 };
@@ -178,6 +178,139 @@ void OutPortTest<Port>::testMultiOut()
     CPPUNIT_ASSERT_EQUAL((size_t) 9, stub2->packets.back().size());
 }
 
+template <class Port>
+void OutPortTest<Port>::testAsyncFanout()
+{
+    const std::string stream_id = "async_fanout";
+
+    port->setAsyncFanout(16);
+
+    // Statistics should report the send queue
+    BULKIO::UsesPortStatisticsSequence_var uses_stats = port->statistics();
+    CPPUNIT_ASSERT_EQUAL((CORBA::ULong) 1, uses_stats->length());
+    const redhawk::PropertyMap& keywords = redhawk::PropertyMap::cast(uses_stats[0].statistics.keywords);
+    CPPUNIT_ASSERT(keywords.contains("async::queue_depth"));
+    CPPUNIT_ASSERT_EQUAL((CORBA::ULong) 16, keywords["async::queue_capacity"].toULong());
+
+    // New connections pick up the port-wide setting
+    StubType* stub2 = this->_createStub();
+    CORBA::Object_var objref = stub2->_this();
+    port->connectPort(objref, "connection_2");
+
+    BULKIO::StreamSRI sri = bulkio::sri::create(stream_id);
+    port->pushSRI(sri);
+    for (size_t index = 1; index <= 4; ++index) {
+        this->_pushTestPacket(index * 8, BULKIO::PrecisionUTCTime(), false, stream_id);
+    }
+
+    // Returning to synchronous mode drains the queues
+    port->setAsyncFanout(0);
+    CPPUNIT_ASSERT_EQUAL((size_t) 1, stub->H.size());
+    CPPUNIT_ASSERT_EQUAL((size_t) 1, stub2->H.size());
+    CPPUNIT_ASSERT_EQUAL((size_t) 4, stub->packets.size());
+    CPPUNIT_ASSERT_EQUAL((size_t) 4, stub2->packets.size());
+    for (size_t index = 0; index < 4; ++index) {
+        CPPUNIT_ASSERT_EQUAL((index + 1) * 8, stub->packets[index].size());
+        CPPUNIT_ASSERT_EQUAL((index + 1) * 8, stub2->packets[index].size());
+    }
+
+    uses_stats = port->statistics();
+    const redhawk::PropertyMap& sync_keywords = redhawk::PropertyMap::cast(uses_stats[0].statistics.keywords);
+    CPPUNIT_ASSERT(!sync_keywords.contains("async::queue_depth"));
+
+    // Unknown connection
+    CPPUNIT_ASSERT_THROW(port->setConnectionAsync("connection_bad", 4), std::invalid_argument);
+}
+
+template <class Port>
+void OutPortTest<Port>::testAsyncSlowConsumer()
+{
+    const std::string stream_id = "async_slow";
+
+    // Only the slow connection gets a send queue
+    StubType* stub2 = this->_createStub();
+    CORBA::Object_var objref = stub2->_this();
+    port->connectPort(objref, "connection_2");
+    port->setConnectionAsync("test_connection", 8);
+
+    // Stall the first connection; pushes should still reach the second one
+    // without waiting on it
+    stub->close();
+    BULKIO::StreamSRI sri = bulkio::sri::create(stream_id);
+    port->pushSRI(sri);
+    stub->waitBlocked();
+    for (size_t index = 1; index <= 4; ++index) {
+        this->_pushTestPacket(index, BULKIO::PrecisionUTCTime(), false, stream_id);
+    }
+    CPPUNIT_ASSERT_EQUAL((size_t) 1, stub2->H.size());
+    CPPUNIT_ASSERT_EQUAL((size_t) 4, stub2->packets.size());
+    CPPUNIT_ASSERT(stub->H.empty());
+    CPPUNIT_ASSERT(stub->packets.empty());
+
+    BULKIO::UsesPortStatisticsSequence_var uses_stats = port->statistics();
+    for (CORBA::ULong index = 0; index < uses_stats->length(); ++index) {
+        if (std::string(uses_stats[index].connectionId) == "test_connection") {
+            const redhawk::PropertyMap& keywords = redhawk::PropertyMap::cast(uses_stats[index].statistics.keywords);
+            CPPUNIT_ASSERT_EQUAL((CORBA::ULong) 4, keywords["async::queue_depth"].toULong());
+        }
+    }
+
+    // Once the consumer catches up, it gets everything in order
+    stub->open();
+    port->setConnectionAsync("test_connection", 0);
+    CPPUNIT_ASSERT_EQUAL((size_t) 1, stub->H.size());
+    CPPUNIT_ASSERT_EQUAL((size_t) 4, stub->packets.size());
+    for (size_t index = 0; index < 4; ++index) {
+        CPPUNIT_ASSERT_EQUAL(index + 1, stub->packets[index].size());
+    }
+}
+
+template <class Port>
+void OutPortTest<Port>::testAsyncDropPolicy()
+{
+    const std::string stream_id = "async_drop";
+    BULKIO::StreamSRI sri = bulkio::sri::create(stream_id);
+
+    // Drop newest: with the consumer stalled, packets beyond the queue depth
+    // are discarded and the caller never blocks
+    port->setConnectionAsync("test_connection", 2, bulkio::SEND_QUEUE_DROP_NEWEST);
+    stub->close();
+    port->pushSRI(sri);
+    stub->waitBlocked();
+    for (size_t index = 1; index <= 5; ++index) {
+        this->_pushTestPacket(index, BULKIO::PrecisionUTCTime(), false, stream_id);
+    }
+
+    BULKIO::UsesPortStatisticsSequence_var uses_stats = port->statistics();
+    const redhawk::PropertyMap& keywords = redhawk::PropertyMap::cast(uses_stats[0].statistics.keywords);
+    CPPUNIT_ASSERT_EQUAL((CORBA::ULongLong) 3, keywords["async::dropped"].toULongLong());
+    CPPUNIT_ASSERT_EQUAL(std::string("drop_newest"), keywords["async::policy"].toString());
+
+    stub->open();
+    port->setConnectionAsync("test_connection", 0);
+    CPPUNIT_ASSERT_EQUAL((size_t) 2, stub->packets.size());
+    CPPUNIT_ASSERT_EQUAL((size_t) 1, stub->packets[0].size());
+    CPPUNIT_ASSERT_EQUAL((size_t) 2, stub->packets[1].size());
+
+    // Drop oldest: the newest packets are kept; end-of-stream is never
+    // dropped, even when the queue is full
+    stub->packets.clear();
+    sri.xdelta = 0.5;
+    port->setConnectionAsync("test_connection", 2, bulkio::SEND_QUEUE_DROP_OLDEST);
+    stub->close();
+    port->pushSRI(sri);
+    stub->waitBlocked();
+    for (size_t index = 1; index <= 5; ++index) {
+        this->_pushTestPacket(index, BULKIO::PrecisionUTCTime(), false, stream_id);
+    }
+
+    stub->open();
+    port->setConnectionAsync("test_connection", 0);
+    CPPUNIT_ASSERT_EQUAL((size_t) 2, stub->packets.size());
+    CPPUNIT_ASSERT_EQUAL((size_t) 4, stub->packets[0].size());
+    CPPUNIT_ASSERT_EQUAL((size_t) 5, stub->packets[1].size());
+}
+
 template <class Port>
 void OutPortTest<Port>::_addStreamFilter(const std::string& streamId, const std::string& connectionId)
 {
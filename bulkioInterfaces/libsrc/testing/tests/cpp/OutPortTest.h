@@ -32,6 +32,9 @@ class OutPortTest : public OutPortTestFixture<Port>
     CPPUNIT_TEST(testConnections);
     CPPUNIT_TEST(testStatistics);
     CPPUNIT_TEST(testMultiOut);
+    CPPUNIT_TEST(testAsyncFanout);
+    CPPUNIT_TEST(testAsyncSlowConsumer);
+    CPPUNIT_TEST(testAsyncDropPolicy);
     CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -39,6 +42,9 @@ public:
     void testConnections();
     void testStatistics();
     void testMultiOut();
+    void testAsyncFanout();
+    void testAsyncSlowConsumer();
+    void testAsyncDropPolicy();
 
 protected:
     typedef typename TestBase::StubType StubType;
@@ -574,6 +574,57 @@ void BufferedOutStreamTest<Port>::testFlushOnBufferSizeChange()
     CPPUNIT_ASSERT_MESSAGE("Disabling buffering did not flush", stub->packets.size() == 3);
 }
 
+template <class Port>
+void BufferedOutStreamTest<Port>::testFlushOnLatency()
+{
+    StreamType stream = port->createStream("test_flush_latency");
+    stream.setBufferSize(128);
+    CPPUNIT_ASSERT_EQUAL(0.0, stream.maxLatency());
+    stream.setMaxLatency(0.05);
+    CPPUNIT_ASSERT_EQUAL(0.05, stream.maxLatency());
+
+    // Queue data below the buffer size; it should not be pushed immediately
+    BufferType buffer;
+    buffer.resize(48);
+    stream.write(buffer, bulkio::time::utils::now());
+    CPPUNIT_ASSERT(stub->packets.size() == 0);
+
+    // The monitor thread should push the data once the latency expires
+    for (int tries = 0; (tries < 100) && stub->packets.empty(); ++tries) {
+        boost::this_thread::sleep(boost::posix_time::milliseconds(10));
+    }
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Buffered data was not flushed on latency", (size_t) 1, stub->packets.size());
+    CPPUNIT_ASSERT_EQUAL((size_t) 48, stub->packets.back().size());
+
+    // Fill the buffer, which should flush on size
+    buffer.resize(128);
+    stream.write(buffer.slice(0, 100), bulkio::time::utils::now());
+    stream.write(buffer.slice(0, 28), bulkio::time::utils::now());
+    CPPUNIT_ASSERT_EQUAL((size_t) 2, stub->packets.size());
+
+    // SRI change and explicit flush
+    stream.write(buffer.slice(0, 10), bulkio::time::utils::now());
+    stream.xdelta(0.5);
+    CPPUNIT_ASSERT_EQUAL((size_t) 3, stub->packets.size());
+    stream.write(buffer.slice(0, 10), bulkio::time::utils::now());
+    stream.flush();
+    CPPUNIT_ASSERT_EQUAL((size_t) 4, stub->packets.size());
+
+    typename StreamType::FlushStatistics stats = stream.flushStatistics();
+    CPPUNIT_ASSERT_EQUAL((size_t) 1, stats.latency);
+    CPPUNIT_ASSERT_EQUAL((size_t) 1, stats.size);
+    CPPUNIT_ASSERT_EQUAL((size_t) 1, stats.sri);
+    CPPUNIT_ASSERT_EQUAL((size_t) 1, stats.manual);
+    CPPUNIT_ASSERT_EQUAL((size_t) 0, stats.eos);
+    CPPUNIT_ASSERT_EQUAL((size_t) 0, stats.errors);
+
+    // With the latency bound disabled, data should stay buffered
+    stream.setMaxLatency(0.0);
+    stream.write(buffer.slice(0, 10), bulkio::time::utils::now());
+    boost::this_thread::sleep(boost::posix_time::milliseconds(100));
+    CPPUNIT_ASSERT_EQUAL((size_t) 4, stub->packets.size());
+}
+
 template <class Port>
 void NumericOutStreamTest<Port>::testStreamWriteCheck()
 {
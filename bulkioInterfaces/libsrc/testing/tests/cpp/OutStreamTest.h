@@ -76,6 +76,7 @@ class BufferedOutStreamTest : public OutStreamTest<Port>
     CPPUNIT_TEST(testFlushOnClose);
     CPPUNIT_TEST(testFlushOnSriChange);
     CPPUNIT_TEST(testFlushOnBufferSizeChange);
+    CPPUNIT_TEST(testFlushOnLatency);
     CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -86,6 +87,7 @@ public:
     void testFlushOnClose();
     void testFlushOnSriChange();
     void testFlushOnBufferSizeChange();
+    void testFlushOnLatency();
 
 protected:
     typedef typename Port::StreamType StreamType;
@@ -0,0 +1,119 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK bulkioInterfaces.
+ *
+ * REDHAWK bulkioInterfaces is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK bulkioInterfaces is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+#include "ShmRingTest.h"
+
+#include <cstddef>
+#include <cstring>
+
+CPPUNIT_TEST_SUITE_REGISTRATION(ShmRingTest);
+
+// The ring mechanics (wrap-around, blocking, timeouts, close) are covered by
+// the libossiecf RingTest; these tests only cover what the BulkIO adapter
+// adds on top of redhawk::shm::SlotRing.
+
+void ShmRingTest::setUp()
+{
+    _writer = new bulkio::ShmRing();
+    _writer->create(4, 64);
+    _reader = new bulkio::ShmRing();
+    _reader->open(_writer->name());
+}
+
+void ShmRingTest::tearDown()
+{
+    delete _reader;
+    delete _writer;
+}
+
+void ShmRingTest::testSlotLayout()
+{
+    // The message data follows the slot header, and both sides agree on how
+    // much of it fits
+    const size_t max_size = 64 - offsetof(bulkio::ShmRing::Slot, data);
+    CPPUNIT_ASSERT_EQUAL(max_size, _writer->maxMessageSize());
+    CPPUNIT_ASSERT_EQUAL(max_size, _reader->maxMessageSize());
+
+    // A message that fills the slot arrives intact
+    bulkio::ShmRing::Slot* slot = _writer->beginWrite();
+    CPPUNIT_ASSERT(slot);
+    slot->flags = 0;
+    slot->length = max_size;
+    std::memset(slot->data, 0x5A, max_size);
+    _writer->commitWrite();
+
+    slot = _reader->beginRead(1000);
+    CPPUNIT_ASSERT(slot);
+    CPPUNIT_ASSERT_EQUAL((uint32_t) 0, slot->flags);
+    CPPUNIT_ASSERT_EQUAL((uint32_t) max_size, slot->length);
+    for (size_t index = 0; index < max_size; ++index) {
+        CPPUNIT_ASSERT_EQUAL((char) 0x5A, slot->data[index]);
+    }
+    _reader->commitRead();
+}
+
+void ShmRingTest::testMessageOnFifo()
+{
+    // A slot flagged MESSAGE_ON_FIFO carries no data of its own; the flag
+    // must survive the trip so that the reader knows to go to the FIFO
+    bulkio::ShmRing::Slot* slot = _writer->beginWrite();
+    CPPUNIT_ASSERT(slot);
+    slot->flags = bulkio::ShmRing::Slot::MESSAGE_ON_FIFO;
+    slot->length = 0;
+    _writer->commitWrite();
+
+    slot = _reader->beginRead(1000);
+    CPPUNIT_ASSERT(slot);
+    CPPUNIT_ASSERT_EQUAL(bulkio::ShmRing::Slot::MESSAGE_ON_FIFO, slot->flags);
+    CPPUNIT_ASSERT_EQUAL((uint32_t) 0, slot->length);
+    _reader->commitRead();
+}
+
+void ShmRingTest::testCreditCounter()
+{
+    // The credit counter starts at zero and is shared between both sides
+    volatile uint64_t* writer_credit = _writer->creditCounter();
+    volatile uint64_t* reader_credit = _reader->creditCounter();
+    CPPUNIT_ASSERT(writer_credit);
+    CPPUNIT_ASSERT(reader_credit);
+    CPPUNIT_ASSERT_EQUAL((uint64_t) 0, *writer_credit);
+
+    *reader_credit = 4096;
+    CPPUNIT_ASSERT_EQUAL((uint64_t) 4096, *writer_credit);
+
+    // Updating the credit must not disturb messages in flight
+    bulkio::ShmRing::Slot* slot = _writer->beginWrite();
+    CPPUNIT_ASSERT(slot);
+    slot->flags = 0;
+    slot->length = 0;
+    _writer->commitWrite();
+    *reader_credit = 0;
+    CPPUNIT_ASSERT(_reader->beginRead(1000));
+    _reader->commitRead();
+    CPPUNIT_ASSERT_EQUAL((uint64_t) 1, _writer->readCount());
+}
+
+void ShmRingTest::testReportError()
+{
+    // Errors on the reader side are visible to the writer
+    CPPUNIT_ASSERT_EQUAL((uint32_t) 0, _writer->errorCount());
+    _reader->reportError();
+    CPPUNIT_ASSERT_EQUAL((uint32_t) 1, _writer->errorCount());
+}
@@ -0,0 +1,194 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK bulkioInterfaces.
+ *
+ * REDHAWK bulkioInterfaces is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK bulkioInterfaces is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+#include "ShmTransportTest.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+#include <boost/scoped_ptr.hpp>
+
+#include <ossie/PropertyMap.h>
+#include <bulkio/bulkio.h>
+
+#include "ShmRing.h"
+
+template <class OutPort, class InPort>
+void ShmTransportTest<OutPort,InPort>::setUp()
+{
+    std::string name = bulkio::CorbaTraits<CorbaType>::name();
+    outPort = new OutPort(name + "_out");
+    inPort = new InPort(name + "_in");
+    inPort->setMaxQueueDepth(1000);
+
+    PortableServer::ObjectId_var oid = ossie::corba::RootPOA()->activate_object(inPort);
+    objref = inPort->_this();
+
+    outManager = new bulkio::ShmOutputManager<CorbaType>(outPort);
+    inManager = new bulkio::ShmInputManager<CorbaType>(inPort);
+    outTransport = 0;
+    inTransport = 0;
+
+    sri = bulkio::sri::create("shm_stream");
+}
+
+template <class OutPort, class InPort>
+void ShmTransportTest<OutPort,InPort>::tearDown()
+{
+    if (outTransport) {
+        outTransport->disconnect();
+    }
+    if (inTransport) {
+        inTransport->stopTransport();
+    }
+    delete outTransport;
+    delete inTransport;
+    delete outManager;
+    delete inManager;
+
+    unsetenv("BULKIO_SHM_RING");
+
+    try {
+        PortableServer::ObjectId_var oid = ossie::corba::RootPOA()->servant_to_id(inPort);
+        ossie::corba::RootPOA()->deactivate_object(oid);
+    } catch (...) {
+        // Ignore CORBA exceptions
+    }
+    inPort->_remove_ref();
+
+    delete outPort;
+}
+
+template <class OutPort, class InPort>
+void ShmTransportTest<OutPort,InPort>::_connect()
+{
+    // Follow the same steps as NegotiableUsesPort and the provides side's
+    // negotiateTransport()
+    CF::Properties transport_props = inManager->transportProperties();
+    outTransport = outManager->createOutputTransport(objref.in(), "shm_connection",
+                                                     redhawk::PropertyMap::cast(transport_props));
+    CPPUNIT_ASSERT_MESSAGE("Shared memory transport is not available", outTransport);
+
+    redhawk::PropertyMap negotiation_props = outManager->getNegotiationProperties(outTransport);
+    inTransport = inManager->createInputTransport("shm_transport", negotiation_props);
+    CPPUNIT_ASSERT(inTransport);
+    inTransport->startTransport();
+
+    redhawk::PropertyMap result = inManager->getNegotiationProperties(inTransport);
+    outManager->setNegotiationResult(outTransport, result);
+
+    outTransport->pushSRI("shm_stream", sri, 1);
+}
+
+template <class OutPort, class InPort>
+void ShmTransportTest<OutPort,InPort>::_pushPackets(size_t count, size_t length)
+{
+    for (size_t index = 0; index < count; ++index) {
+        MutableBufferType data(length);
+        std::fill(data.begin(), data.end(), NativeType());
+        data[0] = index % 100;
+        outTransport->pushPacket(data, bulkio::time::utils::now(), false, "shm_stream", sri);
+    }
+}
+
+template <class OutPort, class InPort>
+std::string ShmTransportTest<OutPort,InPort>::_getProtocol()
+{
+    CF::Properties info = outTransport->transportInfo();
+    return redhawk::PropertyMap::cast(info).get("protocol", "").toString();
+}
+
+template <class OutPort, class InPort>
+void ShmTransportTest<OutPort,InPort>::testRingTransfer()
+{
+    _connect();
+    CPPUNIT_ASSERT_EQUAL(std::string("ring"), _getProtocol());
+
+    _pushPackets(1, 1024);
+    boost::scoped_ptr<PacketType> packet(inPort->getPacket(1.0));
+    CPPUNIT_ASSERT(packet);
+    CPPUNIT_ASSERT_EQUAL(std::string("shm_stream"), packet->streamID);
+    CPPUNIT_ASSERT_EQUAL((size_t) 1024, packet->dataBuffer.size());
+    CPPUNIT_ASSERT(!packet->EOS);
+    CPPUNIT_ASSERT(packet->sriChanged);
+
+    MutableBufferType empty;
+    outTransport->pushPacket(empty, bulkio::time::utils::now(), true, "shm_stream", sri);
+    packet.reset(inPort->getPacket(1.0));
+    CPPUNIT_ASSERT(packet);
+    CPPUNIT_ASSERT(packet->EOS);
+    CPPUNIT_ASSERT(packet->dataBuffer.empty());
+}
+
+template <class OutPort, class InPort>
+void ShmTransportTest<OutPort,InPort>::testRingManyPackets()
+{
+    _connect();
+    CPPUNIT_ASSERT_EQUAL(std::string("ring"), _getProtocol());
+
+    // Send more packets than there are slots in the ring, so that the writer
+    // has to wait for the reader to catch up, and the indices wrap around
+    const size_t count = 4 * bulkio::ShmRing::DEFAULT_CAPACITY;
+    _pushPackets(count, 16);
+
+    for (size_t index = 0; index < count; ++index) {
+        boost::scoped_ptr<PacketType> packet(inPort->getPacket(1.0));
+        CPPUNIT_ASSERT(packet);
+        CPPUNIT_ASSERT_EQUAL((size_t) 16, packet->dataBuffer.size());
+        CPPUNIT_ASSERT_EQUAL((NativeType) (index % 100), (NativeType) packet->dataBuffer[0]);
+    }
+}
+
+template <class OutPort, class InPort>
+void ShmTransportTest<OutPort,InPort>::testFifoTransfer()
+{
+    // Disabling the ring falls back to the synchronous FIFO protocol
+    setenv("BULKIO_SHM_RING", "disable", 1);
+    _connect();
+    CPPUNIT_ASSERT_EQUAL(std::string("fifo"), _getProtocol());
+
+    _pushPackets(4, 1024);
+    for (size_t index = 0; index < 4; ++index) {
+        boost::scoped_ptr<PacketType> packet(inPort->getPacket(bulkio::Const::NON_BLOCKING));
+        CPPUNIT_ASSERT(packet);
+        CPPUNIT_ASSERT_EQUAL((size_t) 1024, packet->dataBuffer.size());
+        CPPUNIT_ASSERT_EQUAL((NativeType) index, (NativeType) packet->dataBuffer[0]);
+    }
+}
+
+#define CREATE_TEST(x)                                                  \
+    class Shm##x##Test : public ShmTransportTest<bulkio::Out##x##Port,bulkio::In##x##Port> \
+    {                                                                   \
+        typedef ShmTransportTest<bulkio::Out##x##Port,bulkio::In##x##Port> TestBase; \
+        CPPUNIT_TEST_SUB_SUITE(Shm##x##Test, TestBase);                 \
+        CPPUNIT_TEST_SUITE_END();                                       \
+    };                                                                  \
+    CPPUNIT_TEST_SUITE_REGISTRATION(Shm##x##Test);
+
+CREATE_TEST(Octet);
+CREATE_TEST(Char);
+CREATE_TEST(Short);
+CREATE_TEST(UShort);
+CREATE_TEST(Long);
+CREATE_TEST(ULong);
+CREATE_TEST(LongLong);
+CREATE_TEST(ULongLong);
+CREATE_TEST(Float);
+CREATE_TEST(Double);
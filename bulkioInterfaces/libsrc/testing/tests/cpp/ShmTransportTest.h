@@ -0,0 +1,76 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK bulkioInterfaces.
+ *
+ * REDHAWK bulkioInterfaces is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK bulkioInterfaces is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+#ifndef BULKIO_SHMTRANSPORTTEST_H
+#define BULKIO_SHMTRANSPORTTEST_H
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <bulkio/bulkio_typetraits.h>
+#include <bulkio/BulkioTransport.h>
+
+#include "ShmInputTransport.h"
+#include "ShmOutputTransport.h"
+
+template <class OutPort, class InPort>
+class ShmTransportTest : public CppUnit::TestFixture
+{
+    CPPUNIT_TEST_SUITE(ShmTransportTest);
+    CPPUNIT_TEST(testRingTransfer);
+    CPPUNIT_TEST(testRingManyPackets);
+    CPPUNIT_TEST(testFifoTransfer);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp();
+    void tearDown();
+
+    void testRingTransfer();
+    void testRingManyPackets();
+    void testFifoTransfer();
+
+protected:
+    typedef typename OutPort::CorbaType CorbaType;
+    typedef typename InPort::dataTransfer PacketType;
+    typedef typename bulkio::NativeTraits<CorbaType>::NativeType NativeType;
+    typedef typename bulkio::BufferTraits<CorbaType>::MutableBufferType MutableBufferType;
+
+    // Negotiates a shared memory connection between the ports by hand, since
+    // ports in the same process would otherwise use the local transport
+    void _connect();
+
+    // Sends count packets, with the packet index in the first element
+    void _pushPackets(size_t count, size_t length);
+
+    // Checks the protocol reported by the uses side transport
+    std::string _getProtocol();
+
+    OutPort* outPort;
+    InPort* inPort;
+    typename CorbaType::_var_type objref;
+
+    bulkio::ShmOutputManager<CorbaType>* outManager;
+    bulkio::ShmInputManager<CorbaType>* inManager;
+    bulkio::OutputTransport<CorbaType>* outTransport;
+    bulkio::InputTransport<CorbaType>* inTransport;
+
+    BULKIO::StreamSRI sri;
+};
+
+#endif  // BULKIO_SHMTRANSPORTTEST_H
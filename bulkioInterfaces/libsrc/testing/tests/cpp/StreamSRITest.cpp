@@ -20,6 +20,8 @@
 
 #include "StreamSRITest.h"
 
+#include <ossie/PropertyMap.h>
+
 #include <bulkio/bulkio.h>
 
 CPPUNIT_TEST_SUITE_REGISTRATION(StreamSRITest);
@@ -51,3 +53,48 @@ void StreamSRITest::testCompare()
     CPPUNIT_ASSERT_MESSAGE("SRIs with different blocking should compare unequal",
                            ! bulkio::sri::DefaultComparator(A, C));
 }
+
+void StreamSRITest::testCompareKeywords()
+{
+    BULKIO::StreamSRI A = bulkio::sri::create("test_keywords");
+    redhawk::PropertyMap& keywords = redhawk::PropertyMap::cast(A.keywords);
+    keywords["COL_RF"] = 101.1e6;
+    keywords["CHAN_RF"] = (CORBA::Float) 2.5e6;
+    keywords["RF_FLOW_ID"] = "flow_1";
+    keywords["ENABLED"] = true;
+    keywords["COUNT"] = (CORBA::ULongLong) 1234;
+
+    BULKIO::StreamSRI B = A;
+    CPPUNIT_ASSERT_MESSAGE("Identical keywords should compare equal",
+                           bulkio::sri::DefaultComparator(A, B));
+    CPPUNIT_ASSERT_EQUAL((int) bulkio::sri::NONE, bulkio::sri::compareFields(A, B));
+
+    // Changing a value, but not the type, must be detected for each type
+    redhawk::PropertyMap& other = redhawk::PropertyMap::cast(B.keywords);
+    other["RF_FLOW_ID"] = "flow_2";
+    CPPUNIT_ASSERT_EQUAL((int) bulkio::sri::KEYWORDS, bulkio::sri::compareFields(A, B));
+    B = A;
+    other["COL_RF"] = 101.2e6;
+    CPPUNIT_ASSERT_EQUAL((int) bulkio::sri::KEYWORDS, bulkio::sri::compareFields(A, B));
+    B = A;
+    other["CHAN_RF"] = (CORBA::Float) 2.0e6;
+    CPPUNIT_ASSERT_EQUAL((int) bulkio::sri::KEYWORDS, bulkio::sri::compareFields(A, B));
+    B = A;
+    other["ENABLED"] = false;
+    CPPUNIT_ASSERT_EQUAL((int) bulkio::sri::KEYWORDS, bulkio::sri::compareFields(A, B));
+    B = A;
+    other["COUNT"] = (CORBA::ULongLong) 1235;
+    CPPUNIT_ASSERT_EQUAL((int) bulkio::sri::KEYWORDS, bulkio::sri::compareFields(A, B));
+
+    // The same value with a different type is a change
+    B = A;
+    other["COUNT"] = (CORBA::LongLong) 1234;
+    CPPUNIT_ASSERT_EQUAL((int) bulkio::sri::KEYWORDS, bulkio::sri::compareFields(A, B));
+
+    // Keyword order is significant
+    B = A;
+    other.erase("COL_RF");
+    other["COL_RF"] = 101.1e6;
+    CPPUNIT_ASSERT_MESSAGE("Reordered keywords should compare unequal",
+                           !bulkio::sri::DefaultComparator(A, B));
+}
@@ -27,11 +27,13 @@ class StreamSRITest : public CppUnit::TestFixture
     CPPUNIT_TEST_SUITE(StreamSRITest);
     CPPUNIT_TEST(testCreate);
     CPPUNIT_TEST(testCompare);
+    CPPUNIT_TEST(testCompareKeywords);
     CPPUNIT_TEST_SUITE_END();
 
 public:
     void testCreate();
     void testCompare();
+    void testCompareKeywords();
 };
 
 #endif  // BULKIO_STREAMSRITEST_H
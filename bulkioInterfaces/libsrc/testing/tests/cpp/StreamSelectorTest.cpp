@@ -0,0 +1,157 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK bulkioInterfaces.
+ *
+ * REDHAWK bulkioInterfaces is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK bulkioInterfaces is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+#include "StreamSelectorTest.h"
+#include "bulkio.h"
+#include <boost/thread.hpp>
+
+template <class Port>
+void StreamSelectorTest<Port>::testSelectPort()
+{
+    SelectorType selector;
+    selector.addPort(port);
+
+    // With no streams, select should time out immediately
+    StreamList ready = selector.select(bulkio::Const::NON_BLOCKING);
+    CPPUNIT_ASSERT(ready.empty());
+
+    // Create two streams, only one of which has data
+    BULKIO::StreamSRI sri_1 = bulkio::sri::create("select_port_1");
+    port->pushSRI(sri_1);
+    BULKIO::StreamSRI sri_2 = bulkio::sri::create("select_port_2");
+    port->pushSRI(sri_2);
+    this->_pushTestPacket(16, bulkio::time::utils::now(), false, sri_2.streamID);
+
+    ready = selector.select(bulkio::Const::NON_BLOCKING);
+    CPPUNIT_ASSERT_EQUAL((size_t) 1, ready.size());
+    CPPUNIT_ASSERT_EQUAL(std::string("select_port_2"), ready.front().streamID());
+
+    // Once the data has been read, no streams should be ready
+    CPPUNIT_ASSERT(ready.front().read());
+    ready = selector.select(bulkio::Const::NON_BLOCKING);
+    CPPUNIT_ASSERT(ready.empty());
+
+    // Push data to both streams; both should be reported
+    this->_pushTestPacket(16, bulkio::time::utils::now(), false, sri_1.streamID);
+    this->_pushTestPacket(16, bulkio::time::utils::now(), false, sri_2.streamID);
+    ready = selector.select(bulkio::Const::NON_BLOCKING);
+    CPPUNIT_ASSERT_EQUAL((size_t) 2, ready.size());
+
+    // After removing the port, nothing is selected
+    selector.removePort(port);
+    ready = selector.select(bulkio::Const::NON_BLOCKING);
+    CPPUNIT_ASSERT(ready.empty());
+}
+
+template <class Port>
+void StreamSelectorTest<Port>::testSelectStream()
+{
+    BULKIO::StreamSRI sri_1 = bulkio::sri::create("select_stream_1");
+    port->pushSRI(sri_1);
+    BULKIO::StreamSRI sri_2 = bulkio::sri::create("select_stream_2");
+    port->pushSRI(sri_2);
+
+    // Only select the first stream
+    SelectorType selector;
+    StreamType stream = port->getStream("select_stream_1");
+    CPPUNIT_ASSERT_EQUAL(!stream, false);
+    selector.addStream(stream);
+
+    // Data on the other stream should not make anything ready
+    this->_pushTestPacket(16, bulkio::time::utils::now(), false, sri_2.streamID);
+    StreamList ready = selector.select(bulkio::Const::NON_BLOCKING);
+    CPPUNIT_ASSERT(ready.empty());
+
+    this->_pushTestPacket(16, bulkio::time::utils::now(), false, sri_1.streamID);
+    ready = selector.select(bulkio::Const::NON_BLOCKING);
+    CPPUNIT_ASSERT_EQUAL((size_t) 1, ready.size());
+    CPPUNIT_ASSERT_EQUAL(std::string("select_stream_1"), ready.front().streamID());
+
+    selector.removeStream(stream);
+    ready = selector.select(bulkio::Const::NON_BLOCKING);
+    CPPUNIT_ASSERT(ready.empty());
+}
+
+template <class Port>
+void StreamSelectorTest<Port>::testSelectEos()
+{
+    BULKIO::StreamSRI sri = bulkio::sri::create("select_eos");
+    port->pushSRI(sri);
+    StreamType stream = port->getStream("select_eos");
+    CPPUNIT_ASSERT_EQUAL(!stream, false);
+
+    SelectorType selector;
+    selector.addStream(stream);
+    CPPUNIT_ASSERT(selector.select(bulkio::Const::NON_BLOCKING).empty());
+
+    // An empty end-of-stream packet has no data, but the stream is still
+    // ready because the next read will not block
+    this->_pushTestPacket(0, bulkio::time::utils::now(), true, sri.streamID);
+    StreamList ready = selector.select(bulkio::Const::NON_BLOCKING);
+    CPPUNIT_ASSERT_EQUAL((size_t) 1, ready.size());
+    CPPUNIT_ASSERT(!ready.front().read());
+    CPPUNIT_ASSERT(ready.front().eos());
+
+    // The stream is gone from the port, so the selector drops it, and a new
+    // stream with the same ID is not selected
+    port->pushSRI(sri);
+    this->_pushTestPacket(16, bulkio::time::utils::now(), false, sri.streamID);
+    CPPUNIT_ASSERT(selector.select(bulkio::Const::NON_BLOCKING).empty());
+}
+
+template <class Port>
+void StreamSelectorTest<Port>::_delayedPush(const std::string& streamID)
+{
+    boost::this_thread::sleep(boost::posix_time::milliseconds(100));
+    this->_pushTestPacket(16, bulkio::time::utils::now(), false, streamID.c_str());
+}
+
+template <class Port>
+void StreamSelectorTest<Port>::testSelectBlocking()
+{
+    SelectorType selector;
+    selector.addPort(port);
+
+    // Timed select with no data should give up
+    CPPUNIT_ASSERT(selector.select(0.05).empty());
+
+    BULKIO::StreamSRI sri = bulkio::sri::create("select_blocking");
+    port->pushSRI(sri);
+
+    // Push from another thread while the selector is waiting
+    boost::thread thread(&StreamSelectorTest<Port>::_delayedPush, this, std::string(sri.streamID));
+    StreamList ready = selector.select(5.0);
+    thread.join();
+    CPPUNIT_ASSERT_EQUAL((size_t) 1, ready.size());
+    CPPUNIT_ASSERT_EQUAL(std::string("select_blocking"), ready.front().streamID());
+}
+
+#define CREATE_TEST(x)                                                  \
+    class In##x##StreamSelectorTest : public StreamSelectorTest<bulkio::In##x##Port> \
+    {                                                                   \
+        CPPUNIT_TEST_SUB_SUITE(In##x##StreamSelectorTest, StreamSelectorTest<bulkio::In##x##Port>); \
+        CPPUNIT_TEST_SUITE_END();                                       \
+    };                                                                  \
+    CPPUNIT_TEST_SUITE_REGISTRATION(In##x##StreamSelectorTest);
+
+CREATE_TEST(XML);
+CREATE_TEST(File);
+CREATE_TEST(Bit);
+CREATE_TEST(Short);
+CREATE_TEST(Float);
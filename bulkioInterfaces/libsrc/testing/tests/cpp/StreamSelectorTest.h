@@ -0,0 +1,53 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK bulkioInterfaces.
+ *
+ * REDHAWK bulkioInterfaces is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK bulkioInterfaces is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+#ifndef BULKIO_STREAMSELECTORTEST_H
+#define BULKIO_STREAMSELECTORTEST_H
+
+#include "InPortTestFixture.h"
+
+template <class Port>
+class StreamSelectorTest : public InPortTestFixture<Port>
+{
+    typedef InPortTestFixture<Port> TestBase;
+
+    CPPUNIT_TEST_SUITE(StreamSelectorTest);
+    CPPUNIT_TEST(testSelectPort);
+    CPPUNIT_TEST(testSelectStream);
+    CPPUNIT_TEST(testSelectEos);
+    CPPUNIT_TEST(testSelectBlocking);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void testSelectPort();
+    void testSelectStream();
+    void testSelectEos();
+    void testSelectBlocking();
+
+protected:
+    typedef typename Port::StreamType StreamType;
+    typedef typename Port::StreamList StreamList;
+    typedef bulkio::StreamSelector<typename Port::CorbaType> SelectorType;
+
+    void _delayedPush(const std::string& streamID);
+
+    using TestBase::port;
+};
+
+#endif  // BULKIO_STREAMSELECTORTEST_H
@@ -20,24 +20,65 @@
 #ifndef BURSTIO_BURSTPACKET_H
 #define BURSTIO_BURSTPACKET_H
 
+#include <algorithm>
 #include <complex>
 
 #include <boost/make_shared.hpp>
 
 #include <ossie/PropertyMap.h>
+#include <ossie/shared_buffer.h>
 
 #include "PortTraits.h"
+#include "utils.h"
 
 namespace burstio {
+    template <class Traits> class InPort;
+
+    namespace detail {
+        // Deleter for burst data taken from a CORBA sequence
+        template <class Traits>
+        struct sequence_deleter {
+            typedef typename Traits::SequenceType SequenceType;
+            typedef typename Traits::ElementType ElementType;
+            typedef typename Traits::NativeType NativeType;
+
+            void operator() (NativeType* ptr)
+            {
+                SequenceType::freebuf(reinterpret_cast<ElementType*>(ptr));
+            }
+        };
+    }
+
     template <class Traits>
     class BurstPacket {
     public:
         typedef typename Traits::BurstType BurstType;
         typedef typename Traits::NativeType NativeType;
         typedef typename Traits::SequenceType SequenceType;
+        typedef typename Traits::ElementType ElementType;
+        typedef redhawk::shared_buffer<NativeType> BufferType;
 
         typedef std::complex<NativeType> ComplexType;
 
+        // Creates an empty burst.
+        BurstPacket() :
+            eos_(false),
+            blockOccurred_(false)
+        {
+        }
+
+        // Creates a burst from a shared buffer, without copying the data; for
+        // use by transports that deliver payloads as shared buffers.
+        BurstPacket(const BURSTIO::BurstSRI& sri, const BufferType& data,
+                    const BULKIO::PrecisionUTCTime& time, bool eos) :
+            eos_(eos),
+            sri_(sri),
+            time_(time),
+            buffer_(data),
+            blockOccurred_(false)
+        {
+        }
+
         // Returns the stream ID of this burst.
         inline std::string getStreamID() const {
             return std::string(sri_.streamID);
@@ -47,13 +88,42 @@ namespace burstio {
         // burst data is complex (i.e., isComplex() is true), the number of
         // complex pairs is half of this value.
         inline size_t getSize() const {
-            return data_.length();
+            if (buffer_.empty()) {
+                return data_.length();
+            }
+            return buffer_.size();
         }
 
         // Returns a view of the burst data as a pointer to the native C++
         // type (e.g., short*).
         inline NativeType* getData() {
-            return reinterpret_cast<NativeType*>(data_.get_buffer());
+            if (buffer_.empty()) {
+                return reinterpret_cast<NativeType*>(data_.get_buffer());
+            }
+            return const_cast<NativeType*>(buffer_.data());
+        }
+
+        // Returns the burst data as a shared buffer. This does not copy the
+        // data, and the buffer remains valid after this packet is deleted.
+        // Bursts received via CORBA hold their data in a sequence; the first
+        // call transfers it to the buffer, after which getSequence() must
+        // make a copy.
+        const BufferType& getBuffer() const {
+            if (buffer_.empty() && (data_.length() > 0)) {
+                const CORBA::ULong length = data_.length();
+                NativeType* data = reinterpret_cast<NativeType*>(data_.get_buffer(1));
+                if (data) {
+                    buffer_ = BufferType(data, length, detail::sequence_deleter<Traits>());
+                } else {
+                    // The sequence does not own its buffer
+                    const NativeType* source = reinterpret_cast<const NativeType*>(data_.get_buffer());
+                    redhawk::buffer<NativeType> copy(length);
+                    std::copy(source, source + length, copy.begin());
+                    buffer_ = copy;
+                }
+                data_.length(0);
+            }
+            return buffer_;
         }
 
         // Returns true if the burst data is complex, false otherwise.
@@ -64,7 +134,7 @@ namespace burstio {
         // Returns a view of the burst data as a pointer to complex pairs of
         // the native C++ type (e.g., std::complex<short>).
         inline ComplexType* getComplexData() {
-            return reinterpret_cast<ComplexType*>(data_.get_buffer());
+            return reinterpret_cast<ComplexType*>(getData());
         }
 
         // Returns true if this was the last burst in the stream.
@@ -98,22 +168,43 @@ namespace burstio {
             return blockOccurred_;
         }
 
-        // Get the CORBA sequence containing the burst data.
+        // Get the burst data as a CORBA sequence. Bursts received via CORBA
+        // return their original sequence without copying; bursts received
+        // as shared buffers (e.g., from shared memory), or whose buffer has
+        // been requested with getBuffer(), are copied on the first call.
         SequenceType& getSequence() {
+            if (!buffer_.empty() && (data_.length() != buffer_.size())) {
+                data_.length(buffer_.size());
+                std::copy(buffer_.begin(), buffer_.end(), reinterpret_cast<NativeType*>(data_.get_buffer()));
+            }
             return data_;
         }
 
-    private:
-        BurstPacket()
-        {
+        // Exchanges the contents of this burst with another burst, without
+        // copying the data.
+        void swap(BurstPacket& other) {
+            std::swap(eos_, other.eos_);
+            burstio::utils::swapSRI(sri_, other.sri_);
+            std::swap(time_, other.time_);
+            buffer_.swap(other.buffer_);
+            SequenceType temp;
+            ossie::corba::move(temp, data_);
+            ossie::corba::move(data_, other.data_);
+            ossie::corba::move(other.data_, temp);
+            std::swap(blockOccurred_, other.blockOccurred_);
         }
 
+    private:
         friend class InPort<Traits>;
 
         bool eos_;
         BURSTIO::BurstSRI sri_;
         BULKIO::PrecisionUTCTime time_;
-        SequenceType data_;
+        // The burst data is held in exactly one of these: data_ for bursts
+        // received via CORBA, or buffer_ for shared buffers; getBuffer()
+        // moves data_ into buffer_ on demand, so both are mutable
+        mutable BufferType buffer_;
+        mutable SequenceType data_;
         bool blockOccurred_;
     };
 
@@ -20,24 +20,23 @@
 #ifndef BURSTIO_INPORT_DECL_H
 #define BURSTIO_INPORT_DECL_H
 
-#include <list>
 #include <set>
+#include <vector>
 
 #include <boost/thread/condition_variable.hpp>
 #include <boost/thread/locks.hpp>
 #include <boost/shared_ptr.hpp>
 
-#include <ossie/Port_impl.h>
+#include <ossie/ProvidesPort.h>
 
+#include "BurstPacket.h"
 #include "BurstStatistics.h"
 #include "PortTraits.h"
 #include "debug.h"
 
 namespace burstio {
-    template <class Traits> class BurstPacket;
-
     template <class Traits>
-    class InPort : public Port_Provides_base_impl, public virtual Traits::POAType
+    class InPort : public redhawk::NegotiableProvidesPortBase, public virtual Traits::POATypeExt
     {
         ENABLE_INSTANCE_LOGGING;
 
@@ -46,9 +45,11 @@ namespace burstio {
         typedef typename Traits::BurstType BurstType;
         typedef typename Traits::BurstSequenceType BurstSequenceType;
         typedef typename Traits::ElementType ElementType;
+        typedef typename Traits::NativeType NativeType;
         typedef typename BurstSequenceType::_var_type BurstSequenceVar;
 
         typedef BurstPacket<Traits> PacketType;
+        typedef typename PacketType::BufferType BufferType;
 
         static const size_t DEFAULT_QUEUE_THRESHOLD = 100;
 
@@ -93,9 +94,19 @@ namespace burstio {
         //
         PacketType* getBurst (float timeout);
         
-        // Lower-level interface to get at the received CORBA sequence of
-        // bursts; if the operation times out, or the port is stopped, returns
-        // an empty sequence.
+        // Batch interface to retrieve up to max bursts at once, replacing the
+        // contents of bursts. Only waits (as with getBurst) if no bursts are
+        // queued. The queue lock is taken once for the entire batch, and the
+        // burst data is shared with the queue rather than copied; reusing the
+        // same vector across calls avoids reallocation. Returns the number of
+        // bursts retrieved, which is 0 on timeout or if the port is stopped.
+        size_t getBursts (std::vector<PacketType>& bursts, size_t max, float timeout);
+
+        // Lower-level interface to get all queued bursts as a CORBA sequence;
+        // if the operation times out, or the port is stopped, returns an
+        // empty sequence. Burst data received via CORBA is moved into the
+        // sequence without copying; data received as shared buffers (e.g.,
+        // from shared memory) is copied.
         BurstSequenceType* getBursts (float timeout);
 
         // Returns true if a CORBA pushBursts call blocked since the last time
@@ -107,6 +118,11 @@ namespace burstio {
         // this method.
         void pushBursts(const BurstSequenceType& bursts);
 
+        // Queues bursts whose data is already in shared buffers, leaving the
+        // vector empty; used by transports that deliver payloads without
+        // copying them. User code should not call this method.
+        void queueBursts(std::vector<PacketType>& bursts);
+
         BULKIO::PortUsageType state();
         BULKIO::PortStatistics* statistics();
 
@@ -134,12 +150,24 @@ namespace burstio {
         bool waitBurst (float timeout, boost::mutex::scoped_lock& lock);
 
     private:
-        typedef std::list<BurstSequenceVar> BurstQueue;
+        // Bursts are queued in a ring of reusable packet slots, which grows
+        // as needed but never shrinks, so that steady-state traffic does not
+        // allocate any queue storage
+        typedef std::vector<PacketType> BurstQueue;
+
+        // Waits for the queue to drop below the threshold; returns false if
+        // the port is stopped
+        bool waitQueueSpace (boost::mutex::scoped_lock& lock);
+        PacketType& nextSlot ();
+        void reserveSlots (size_t count);
+        void burstsQueued (size_t bursts, size_t elements, float queueDepth, const BULKIO::PrecisionUTCTime& begin);
+        void takeBurst (PacketType& burst);
+
         boost::mutex queueMutex_;
         boost::condition_variable queueNotEmpty_;
         boost::condition_variable queueNotFull_;
         BurstQueue queue_;
-        size_t queueOffset_;
+        size_t queueHead_;
         size_t queuedBursts_;
         size_t queueThreshold_;
         volatile bool blockOccurred_;
@@ -28,6 +28,7 @@
 #include <boost/thread.hpp>
 
 #include <BULKIO/bio_runtimeStats.h>
+#include <BULKIO/internal/bio_dataExt.h>
 
 #include <ossie/ExecutorService.h>
 #include <ossie/UsesPort.h>
@@ -53,6 +54,19 @@ namespace burstio {
         virtual void setByteThreshold (size_t bytes) = 0;
         virtual long getLatencyThreshold () const = 0;
         virtual void setLatencyThreshold (long usec) = 0;
+
+        // When adaptive batching is enabled, the number of bursts sent per
+        // push is tuned from the observed arrival rate and the time taken to
+        // send each batch downstream, up to the max bursts setting; the byte
+        // and latency thresholds still apply. When disabled, bursts are sent
+        // only when a threshold is reached.
+        virtual bool getAdaptiveBatching () const = 0;
+        virtual void setAdaptiveBatching (bool enabled) = 0;
+
+        // Returns the number of bursts that currently triggers a push (the
+        // max bursts setting, unless adaptive batching is enabled)
+        virtual size_t getBatchSize () const = 0;
+
         virtual void flush () = 0;
     };
 
@@ -60,7 +74,7 @@ namespace burstio {
     class BurstTransport;
 
     template <class Traits>
-    class OutPort : public redhawk::UsesPort, public virtual POA_BULKIO::UsesPortStatisticsProvider
+    class OutPort : public redhawk::NegotiableUsesPort, public virtual POA_BULKIO::internal::UsesPortStatisticsProviderExt
     {
     public:
         typedef typename Traits::PortType PortType;
@@ -73,6 +87,12 @@ namespace burstio {
         static const size_t DEFAULT_MAX_BURSTS = 100;
         static const long DEFAULT_LATENCY_THRESHOLD = 10000; // 10000 us = 10 ms
 
+        // Adaptive batching parameters: the weight given to each new sample
+        // of the burst arrival interval and batch send time, and the ratio of
+        // batch size to the bursts that arrive during one send
+        static const double ADAPTIVE_WEIGHT;
+        static const double ADAPTIVE_HEADROOM;
+
         OutPort(std::string port_name);
         ~OutPort();
 
@@ -95,6 +115,9 @@ namespace burstio {
         long getLatencyThreshold () const;
         void setLatencyThreshold (long usec);
 
+        bool getAdaptiveBatching () const;
+        void setAdaptiveBatching (bool enabled);
+
         OutputPolicy* getDefaultPolicy ();
         const OutputPolicy* getDefaultPolicy () const;
 
@@ -179,6 +202,27 @@ namespace burstio {
         std::string getRepid() const;
 
     protected:
+        enum FlushReason {
+            FLUSH_NONE = -1,
+            FLUSH_BATCH_SIZE,
+            FLUSH_BYTES,
+            FLUSH_LATENCY,
+            FLUSH_FORCED,
+            FLUSH_REASON_COUNT
+        };
+
+        // Batching state summed over the queues feeding a connection, for
+        // reporting in the port statistics
+        struct BatchStatistics {
+            BatchStatistics();
+
+            BatchStatistics& operator+= (const BatchStatistics& rhs);
+
+            size_t queues;
+            size_t batchSize;
+            CORBA::ULongLong flushes[FLUSH_REASON_COUNT];
+        };
+
         class Queue : public OutputPolicy
         {
         public:
@@ -196,6 +240,11 @@ namespace burstio {
             long getLatencyThreshold () const;
             void setLatencyThreshold (long usec);
 
+            bool getAdaptiveBatching () const;
+            void setAdaptiveBatching (bool enabled);
+
+            size_t getBatchSize () const;
+
             void queueBurst (SequenceType& data, const BURSTIO::BurstSRI& sri,
                              const BULKIO::PrecisionUTCTime& timestamp, bool eos, bool isComplex);
 
@@ -204,15 +253,22 @@ namespace burstio {
         protected:
             friend class OutPort;
 
-            Queue(OutPort* port, const std::string& streamID, size_t maxBursts, size_t byteThreshold, long latencyThreshold);
+            Queue(OutPort* port, const std::string& streamID, size_t maxBursts, size_t byteThreshold,
+                  long latencyThreshold, bool adaptive);
 
-            bool shouldFlush ();
+            FlushReason flushReason (boost::system_time now) const;
             void checkFlush ();
+            void scheduleCheck ();
+            void resumeChecks ();
 
             void executeThreadedFlush ();
 
+            void getBatchStatistics (BatchStatistics& stats) const;
+
         private:
-            void sendBursts_ ();
+            void sendBursts_ (FlushReason reason);
+            static void updateAverage_ (double& average, double sample);
+            void updateBatchSize_ ();
 
             OutPort<Traits>* port_;
             LoggerPtr& logger;
@@ -227,6 +283,17 @@ namespace burstio {
             size_t bytes_;
             boost::system_time startTime_;
 
+            // Adaptive batching state; the arrival interval and send time are
+            // exponentially-weighted moving averages, in seconds (negative
+            // until the first sample)
+            bool adaptive_;
+            size_t batchSize_;
+            boost::system_time lastArrival_;
+            double arrivalInterval_;
+            double sendTime_;
+
+            CORBA::ULongLong flushCounts_[FLUSH_REASON_COUNT];
+
             std::string streamID_;
         };
 
@@ -246,11 +313,13 @@ namespace burstio {
         // void partitionBursts (const BurstSequenceType& bursts, boost::system_time startTime, float queueDepth, const std::string& streamID, const Connection& connection);
 
         void scheduleCheck (boost::system_time when);
+        void executeCheck ();
         void checkQueues ();
 
         void queueBurst (SequenceType& data, const BURSTIO::BurstSRI& sri,
                          const BULKIO::PrecisionUTCTime& timestamp, bool eos, bool isComplex);
 
+        virtual redhawk::UsesTransport* _createLocalTransport(PortBase* port, CORBA::Object_ptr object, const std::string& connectionId);
         virtual redhawk::UsesTransport* _createTransport(CORBA::Object_ptr object, const std::string& connectionId);
 
         const Queue& getQueueForStream (const std::string& streamID) const;
@@ -265,6 +334,9 @@ namespace burstio {
         RoutingModeType routingMode_;
         RouteTable routes_;
 
+        // Latency checks are timed on a process-wide timer wheel while the
+        // port is started, and run on the monitor thread
+        bool started_;
         redhawk::ExecutorService monitor_;
     };
 
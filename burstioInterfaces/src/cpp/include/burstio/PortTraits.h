@@ -30,12 +30,14 @@
 #include <BURSTIO/burstio_burstUlongLong.h>
 #include <BURSTIO/burstio_burstUlong.h>
 #include <BURSTIO/burstio_burstUshort.h>
+#include <BURSTIO/burstio_burstExt.h>
 
 namespace burstio {
-    template <class Port, class POA, class Burst, class BurstSequence, class Element, class Sequence, class Native>
+    template <class Port, class POA, class POAExt, class Burst, class BurstSequence, class Element, class Sequence, class Native>
     struct PortTraits {
         typedef Port PortType;
         typedef POA POAType;
+        typedef POAExt POATypeExt;
         typedef Burst BurstType;
         typedef BurstSequence BurstSequenceType;
         typedef Element ElementType;
@@ -44,7 +46,7 @@ namespace burstio {
     };
 
 #define DEFINE_PORTTRAITS(T, CT, ST, NT) \
-    struct T##Traits : public PortTraits<BURSTIO::burst##T, POA_BURSTIO::burst##T, BURSTIO::T##Burst, BURSTIO::T##BurstSequence, CORBA::CT, ST, NT> { \
+    struct T##Traits : public PortTraits<BURSTIO::burst##T, POA_BURSTIO::burst##T, POA_BURSTIO::internal::burst##T##Ext, BURSTIO::T##Burst, BURSTIO::T##BurstSequence, CORBA::CT, ST, NT> { \
     };
 
     DEFINE_PORTTRAITS(Byte, Octet, CF::OctetSequence, signed char);
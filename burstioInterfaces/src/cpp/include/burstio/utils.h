@@ -146,6 +146,10 @@ namespace burstio {
 
         BURSTIO::BurstSRI createSRI (const std::string& streamID, double xdelta=1.0);
 
+        // Exchanges the contents of two SRIs; strings and keywords are swapped
+        // by pointer, so no memory is allocated
+        void swapSRI (BURSTIO::BurstSRI& lhs, BURSTIO::BurstSRI& rhs);
+
     }
 }
 
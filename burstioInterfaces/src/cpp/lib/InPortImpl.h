@@ -20,6 +20,7 @@
 #ifndef BURSTIO_INPORTIMPL_H
 #define BURSTIO_INPORTIMPL_H
 
+#include <algorithm>
 #include <stdexcept>
 
 #include <burstio/BurstPacket.h>
@@ -30,8 +31,8 @@
 namespace burstio {
     template <class Traits>
     InPort<Traits>::InPort(std::string port_name) : 
-        Port_Provides_base_impl(port_name),
-        queueOffset_(0),
+        redhawk::NegotiableProvidesPortBase(port_name),
+        queueHead_(0),
         queuedBursts_(0),
         queueThreshold_(DEFAULT_QUEUE_THRESHOLD),
         blockOccurred_(false),
@@ -118,6 +119,87 @@ namespace burstio {
         // doesn't grow) or blocking (average >= 100).
         float queue_depth = queuedBursts_ / (float)queueThreshold_;
 
+        // Discard bursts if processing is not started
+        if (!waitQueueSpace(lock)) {
+            LOG_INSTANCE_TRACE("Port is stopped, discarding " << bursts.length() << " bursts");
+            return;
+        }
+
+        const size_t total_bursts = bursts.length();
+        if (total_bursts == 0) {
+            LOG_INSTANCE_DEBUG("Push contained no bursts");
+            burstsQueued(0, 0, queue_depth, begin);
+            return;
+        }
+
+        // If the sequence is owned by the caller, the data buffers (and SRI
+        // strings) can be stolen; otherwise, make a copy. Either way, the
+        // data stays in a CORBA sequence so that getBursts(float) and
+        // getSequence() can hand it over without copying.
+        const bool steal = bursts.release();
+        BurstType* burst_buffer = const_cast<BurstType*>(bursts.get_buffer());
+
+        LOG_INSTANCE_TRACE("Queueing " << total_bursts << " bursts");
+        reserveSlots(queuedBursts_ + total_bursts);
+        size_t total_elements = 0;
+        for (size_t index = 0; index < total_bursts; ++index) {
+            BurstType& burst = burst_buffer[index];
+            PacketType& slot = nextSlot();
+            const CORBA::ULong length = burst.data.length();
+            if (steal) {
+                burstio::utils::swapSRI(slot.sri_, burst.SRI);
+                if (length > 0) {
+                    ossie::corba::move(slot.data_, burst.data);
+                }
+            } else {
+                slot.sri_ = burst.SRI;
+                slot.data_ = burst.data;
+            }
+            slot.time_ = burst.T;
+            slot.eos_ = burst.EOS;
+            total_elements += length;
+            if (!slot.eos_) {
+                streamIDs_.insert(static_cast<const char*>(slot.sri_.streamID));
+            }
+        }
+
+        burstsQueued(total_bursts, total_elements, queue_depth, begin);
+    }
+
+    template <class Traits>
+    void InPort<Traits>::queueBursts(std::vector<PacketType>& bursts)
+    {
+        BULKIO::PrecisionUTCTime begin = burstio::utils::now();
+
+        boost::mutex::scoped_lock lock(queueMutex_);
+
+        float queue_depth = queuedBursts_ / (float)queueThreshold_;
+
+        if (!waitQueueSpace(lock)) {
+            LOG_INSTANCE_TRACE("Port is stopped, discarding " << bursts.size() << " bursts");
+            bursts.clear();
+            return;
+        }
+
+        LOG_INSTANCE_TRACE("Queueing " << bursts.size() << " bursts");
+        reserveSlots(queuedBursts_ + bursts.size());
+        size_t total_elements = 0;
+        for (typename std::vector<PacketType>::iterator burst = bursts.begin(); burst != bursts.end(); ++burst) {
+            PacketType& slot = nextSlot();
+            slot.swap(*burst);
+            total_elements += slot.getSize();
+            if (!slot.eos_) {
+                streamIDs_.insert(static_cast<const char*>(slot.sri_.streamID));
+            }
+        }
+
+        burstsQueued(bursts.size(), total_elements, queue_depth, begin);
+        bursts.clear();
+    }
+
+    template <class Traits>
+    bool InPort<Traits>::waitQueueSpace (boost::mutex::scoped_lock& lock)
+    {
         // Only set the block flag once to avoid multiple notifications
         bool block_reported = false;
 
@@ -130,44 +212,67 @@ namespace burstio {
             }
             queueNotFull_.wait(lock);
         }
+        return started_;
+    }
 
-        // Discard bursts if processing is not started
-        if (!started_) {
-            LOG_INSTANCE_TRACE("Port is stopped, discarding " << bursts.length() << " bursts");
+    template <class Traits>
+    void InPort<Traits>::reserveSlots (size_t count)
+    {
+        if (count <= queue_.size()) {
             return;
         }
 
-        // Count total elements and active stream IDs
-        const size_t total_bursts = bursts.length();
-        size_t total_elements = 0;
-        for (CORBA::ULong index = 0; index < total_bursts; ++index) {
-            const BurstType& burst = bursts[index];
-            total_elements += burst.data.length();
-            if (!burst.EOS) {
-                streamIDs_.insert(static_cast<const char*>(burst.SRI.streamID));
-            }
+        // Grow the queue (at least doubling, to amortize the cost), moving
+        // the queued bursts to the front of the new slots
+        BurstQueue slots(std::max(count, queue_.size() * 2));
+        for (size_t index = 0; index < queuedBursts_; ++index) {
+            slots[index].swap(queue_[(queueHead_ + index) % queue_.size()]);
         }
+        queue_.swap(slots);
+        queueHead_ = 0;
+    }
 
-        // Add bursts to queue, if there are any
-        if (total_bursts > 0) {
-            LOG_INSTANCE_TRACE("Queueing " << total_bursts << " bursts");
-            if (bursts.release()) {
-                // Steal the bursts
-                queue_.push_back(new BurstSequenceType());
-                ossie::corba::move(queue_.back(), const_cast<BurstSequenceType&>(bursts));
-            } else {
-                // Someone else owns the bursts, make a copy
-                queue_.push_back(new BurstSequenceType(bursts));
-            }
-            queuedBursts_ += total_bursts;
+    template <class Traits>
+    typename InPort<Traits>::PacketType& InPort<Traits>::nextSlot ()
+    {
+        // Caller must have already reserved enough slots
+        PacketType& slot = queue_[(queueHead_ + queuedBursts_) % queue_.size()];
+        queuedBursts_++;
+        return slot;
+    }
+
+    template <class Traits>
+    void InPort<Traits>::burstsQueued (size_t bursts, size_t elements, float queueDepth, const BULKIO::PrecisionUTCTime& begin)
+    {
+        if (bursts > 0) {
             queueNotEmpty_.notify_all();
-        } else {
-            LOG_INSTANCE_DEBUG("Push contained no bursts");
+            this->_dataArrived();
         }
 
         // Record total time spent in pushBursts for latency measurement
         double elapsed = burstio::utils::elapsed(begin);
-        statistics_.record(total_bursts, total_elements, queue_depth, elapsed);
+        statistics_.record(bursts, elements, queueDepth, elapsed);
+    }
+
+    template <class Traits>
+    void InPort<Traits>::takeBurst (PacketType& burst)
+    {
+        PacketType& slot = queue_[queueHead_];
+        burst.swap(slot);
+        burst.blockOccurred_ = false;
+
+        // Release the data now rather than when the slot is reused
+        slot.buffer_ = BufferType();
+        typename PacketType::SequenceType empty;
+        ossie::corba::move(slot.data_, empty);
+
+        if (burst.eos_) {
+            LOG_INSTANCE_TRACE("Received EOS for stream \"" << burst.getStreamID() << "\"");
+            streamIDs_.erase(burst.getStreamID());
+        }
+
+        queueHead_ = (queueHead_ + 1) % queue_.size();
+        queuedBursts_--;
     }
 
     template <class Traits>
@@ -180,33 +285,41 @@ namespace burstio {
         }
         LOG_INSTANCE_TRACE("Returning burst from queue");
 
-        BurstSequenceType& front = queue_.front();
-        BurstType& queue_burst = front[queueOffset_];
-
         PacketType* burst = new PacketType();
-        burst->sri_ = queue_burst.SRI;
-        burst->eos_ = queue_burst.EOS;
-        burst->time_ = queue_burst.T;
-        ossie::corba::move(burst->data_, queue_burst.data);
+        takeBurst(*burst);
         burst->blockOccurred_ = blockOccurred_;
         // If a block had occurred, it has been reported now, so clear the flag
         blockOccurred_ = false;
 
-        if (burst->getEOS()) {
-            LOG_INSTANCE_TRACE("Received EOS for stream \"" << burst->getStreamID() << "\"");
-            streamIDs_.erase(burst->getStreamID());
+        queueNotFull_.notify_all();
+
+        return burst;
+    }
+
+    template <class Traits>
+    size_t InPort<Traits>::getBursts (std::vector<PacketType>& bursts, size_t max, float timeout)
+    {
+        boost::mutex::scoped_lock lock(queueMutex_);
+
+        if ((max == 0) || !waitBurst(timeout, lock)) {
+            bursts.clear();
+            return 0;
         }
 
-        queueOffset_++;
-        if (queueOffset_ == front.length()) {
-            queue_.pop_front();
-            queueOffset_ = 0;
+        const size_t count = std::min(max, queuedBursts_);
+        LOG_INSTANCE_TRACE("Returning " << count << " bursts from queue");
+        bursts.resize(count);
+        for (size_t index = 0; index < count; ++index) {
+            takeBurst(bursts[index]);
         }
 
-        queuedBursts_--;
+        // Report any block on the first burst only
+        bursts[0].blockOccurred_ = blockOccurred_;
+        blockOccurred_ = false;
+
         queueNotFull_.notify_all();
 
-        return burst;
+        return count;
     }
 
     template <class Traits>
@@ -221,29 +334,21 @@ namespace burstio {
             return new BurstSequenceType();
         }
 
-        BurstSequenceVar bursts; 
-        if (queueOffset_ == 0) {
-            LOG_INSTANCE_TRACE("Returning burst sequence from front of queue");
-            bursts = queue_.front()._retn();
-        } else {
-            LOG_INSTANCE_TRACE("Copying remaining burst sequence from front of queue");
-            BurstSequenceType& queue_bursts = queue_.front();
-            const CORBA::ULong length = queue_bursts.length() - queueOffset_;
-            bursts = new BurstSequenceType();
-            bursts->length(length);
-            BurstType* dest = &bursts[0];
-            BurstType* const end = dest + length;
-            for (BurstType* source = &queue_bursts[queueOffset_]; dest != end; ++dest, ++source) {
-                dest->SRI = source->SRI;
-                dest->T = source->T;
-                dest->EOS = source->EOS;
-                ossie::corba::move(dest->data, source->data);
-            }
+        LOG_INSTANCE_TRACE("Returning " << queuedBursts_ << " bursts from queue");
+        BurstSequenceVar bursts = new BurstSequenceType();
+        bursts->length(queuedBursts_);
+        PacketType packet;
+        for (CORBA::ULong index = 0; index < bursts->length(); ++index) {
+            takeBurst(packet);
+            BurstType& dest = bursts[index];
+            burstio::utils::swapSRI(dest.SRI, packet.sri_);
+            dest.T = packet.time_;
+            dest.EOS = packet.eos_;
+            // Bursts received via CORBA are moved without copying; shared
+            // buffers (e.g., from shared memory) have to be copied
+            ossie::corba::move(dest.data, packet.getSequence());
         }
 
-        queue_.pop_front();
-        queueOffset_ = 0;
-        queuedBursts_ -= bursts->length();
         queueNotFull_.notify_all();
 
         return bursts._retn();
@@ -314,11 +419,13 @@ namespace burstio {
     void InPort<Traits>::flush ()
     {
         boost::mutex::scoped_lock lock(queueMutex_);
-        if (!queue_.empty()) {
+        if (queuedBursts_ > 0) {
             statistics_.flushOccurred(queuedBursts_);
-            queue_.clear();
-            queueOffset_ = 0;
-            queuedBursts_ = 0;
+            // Release the burst data, but keep the slots for reuse
+            PacketType packet;
+            while (queuedBursts_ > 0) {
+                takeBurst(packet);
+            }
             queueNotFull_.notify_all();
         }
     }
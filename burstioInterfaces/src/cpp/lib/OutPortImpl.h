@@ -20,6 +20,10 @@
 #ifndef BURSTIO_OUTPORTIMPL_H
 #define BURSTIO_OUTPORTIMPL_H
 
+#include <algorithm>
+#include <cmath>
+
+#include <boost/bind.hpp>
 #include <boost/foreach.hpp>
 
 #include <ossie/CorbaUtils.h>
@@ -28,6 +32,7 @@
 #include <burstio/InPortDecl.h>
 
 #include "debug_impl.h"
+#include "TimerWheel.h"
 
 namespace burstio {
 
@@ -190,15 +195,47 @@ namespace burstio {
     };
 
     template <class Traits>
-    OutPort<Traits>::Queue::Queue(OutPort<Traits>* port, const std::string& streamID, size_t maxBursts, size_t thresholdBytes, long thresholdLatency) :
+    const double OutPort<Traits>::ADAPTIVE_WEIGHT = 0.125;
+
+    template <class Traits>
+    const double OutPort<Traits>::ADAPTIVE_HEADROOM = 2.0;
+
+    template <class Traits>
+    OutPort<Traits>::BatchStatistics::BatchStatistics() :
+        queues(0),
+        batchSize(0)
+    {
+        std::fill(flushes, flushes + FLUSH_REASON_COUNT, 0);
+    }
+
+    template <class Traits>
+    typename OutPort<Traits>::BatchStatistics& OutPort<Traits>::BatchStatistics::operator+= (const BatchStatistics& rhs)
+    {
+        queues += rhs.queues;
+        batchSize += rhs.batchSize;
+        for (int reason = 0; reason < FLUSH_REASON_COUNT; ++reason) {
+            flushes[reason] += rhs.flushes[reason];
+        }
+        return *this;
+    }
+
+    template <class Traits>
+    OutPort<Traits>::Queue::Queue(OutPort<Traits>* port, const std::string& streamID, size_t maxBursts,
+                                  size_t thresholdBytes, long thresholdLatency, bool adaptive) :
         port_(port),
         logger(port->_portLog),
         maxBursts_(maxBursts),
         thresholdBytes_(thresholdBytes),
         thresholdLatency_(boost::posix_time::microseconds(thresholdLatency)),
         bytes_(0),
+        adaptive_(adaptive),
+        batchSize_(maxBursts),
+        arrivalInterval_(-1.0),
+        sendTime_(-1.0),
         streamID_(streamID)
     {
+        std::fill(flushCounts_, flushCounts_ + FLUSH_REASON_COUNT, 0);
+        updateBatchSize_();
     }
 
     template <class Traits>
@@ -213,7 +250,8 @@ namespace burstio {
     {
         boost::mutex::scoped_lock lock(mutex_);
         maxBursts_ = count;
-        if (bursts_.length() >= maxBursts_) {
+        updateBatchSize_();
+        if (bursts_.length() >= batchSize_) {
             RH_DEBUG(logger, "New max bursts " << maxBursts_ << " triggering push");
             executeThreadedFlush();
         }
@@ -249,25 +287,58 @@ namespace burstio {
     {
         boost::mutex::scoped_lock lock(mutex_);
         thresholdLatency_ = boost::posix_time::microseconds(usec);
+        updateBatchSize_();
         if (bursts_.length() > 0) {
-            port_->scheduleCheck(startTime_ + thresholdLatency_);
+            scheduleCheck();
+        }
+    }
+
+    template <class Traits>
+    bool OutPort<Traits>::Queue::getAdaptiveBatching () const
+    {
+        boost::mutex::scoped_lock lock(mutex_);
+        return adaptive_;
+    }
+
+    template <class Traits>
+    void OutPort<Traits>::Queue::setAdaptiveBatching (bool enabled)
+    {
+        boost::mutex::scoped_lock lock(mutex_);
+        adaptive_ = enabled;
+        updateBatchSize_();
+        if ((bursts_.length() > 0) && (bursts_.length() >= batchSize_)) {
+            RH_DEBUG(logger, "New batch size " << batchSize_ << " triggering push");
+            executeThreadedFlush();
         }
     }
 
+    template <class Traits>
+    size_t OutPort<Traits>::Queue::getBatchSize () const
+    {
+        boost::mutex::scoped_lock lock(mutex_);
+        return batchSize_;
+    }
+
     template <class Traits>
     void OutPort<Traits>::Queue::queueBurst (SequenceType& data, const BURSTIO::BurstSRI& sri,
                                          const BULKIO::PrecisionUTCTime& timestamp, bool eos,
                                          bool isComplex)
     {
         boost::mutex::scoped_lock lock(mutex_);
-        // If this is the first burst, mark the time for latency guarantees
-        if (bursts_.length() == 0) {
-            startTime_ = boost::get_system_time();
-            RH_TRACE(logger, "Scheduling latency check on monitor thread after " << thresholdLatency_.total_microseconds() << " usec");
-            port_->scheduleCheck(startTime_ + thresholdLatency_);
+        const boost::system_time now = boost::get_system_time();
+
+        // Track the arrival rate for adaptive batching
+        if (!lastArrival_.is_not_a_date_time()) {
+            updateAverage_(arrivalInterval_, (now - lastArrival_).total_microseconds() * 1e-6);
         }
+        lastArrival_ = now;
 
+        // If this is the first burst, mark the time for latency guarantees
         const CORBA::ULong index = bursts_.length();
+        if (index == 0) {
+            startTime_ = now;
+        }
+
         bursts_.length(index+1);
         BurstType& burst = bursts_[index];
         burst.SRI = sri;
@@ -279,9 +350,13 @@ namespace burstio {
         bytes_ += burst.data.length() * sizeof(ElementType);
         RH_TRACE(logger, "Queue size: " << bursts_.length() << " bursts / " << bytes_ << " bytes");
 
-        if (shouldFlush()) {
+        FlushReason reason = flushReason(now);
+        if (reason != FLUSH_NONE) {
             RH_DEBUG(logger, "Queued burst exceeded threshold, flushing queue");
-            sendBursts_();
+            sendBursts_(reason);
+        } else if (index == 0) {
+            RH_TRACE(logger, "Scheduling latency check after " << thresholdLatency_.total_microseconds() << " usec");
+            scheduleCheck();
         }
     }
 
@@ -290,20 +365,20 @@ namespace burstio {
     void OutPort<Traits>::Queue::flush ()
     {
         boost::mutex::scoped_lock lock(mutex_);
-        sendBursts_();
+        sendBursts_(FLUSH_FORCED);
     }
 
     template <class Traits>
-    bool OutPort<Traits>::Queue::shouldFlush ()
+    typename OutPort<Traits>::FlushReason OutPort<Traits>::Queue::flushReason (boost::system_time now) const
     {
-        if (bursts_.length() >= maxBursts_) {
-            return true;
+        if (bursts_.length() >= batchSize_) {
+            return FLUSH_BATCH_SIZE;
         } else if (bytes_ >= thresholdBytes_) {
-            return true;
-        } else if (boost::get_system_time() >= (startTime_ + thresholdLatency_)) {
-            return true;
+            return FLUSH_BYTES;
+        } else if (now >= (startTime_ + thresholdLatency_)) {
+            return FLUSH_LATENCY;
         }
-        return false;
+        return FLUSH_NONE;
     }
 
     template <class Traits>
@@ -316,16 +391,52 @@ namespace burstio {
     void OutPort<Traits>::Queue::checkFlush ()
     {
         boost::mutex::scoped_lock lock(mutex_);
-        if (shouldFlush()) {
-            sendBursts_();
+        if (bursts_.length() == 0) {
+            return;
+        }
+        FlushReason reason = flushReason(boost::get_system_time());
+        if (reason != FLUSH_NONE) {
+            sendBursts_(reason);
         }
     }
 
     template <class Traits>
-    void OutPort<Traits>::Queue::sendBursts_ ()
+    void OutPort<Traits>::Queue::scheduleCheck ()
+    {
+        port_->scheduleCheck(startTime_ + thresholdLatency_);
+    }
+
+    template <class Traits>
+    void OutPort<Traits>::Queue::resumeChecks ()
+    {
+        boost::mutex::scoped_lock lock(mutex_);
+        if (bursts_.length() > 0) {
+            scheduleCheck();
+        }
+    }
+
+    template <class Traits>
+    void OutPort<Traits>::Queue::getBatchStatistics (BatchStatistics& stats) const
+    {
+        boost::mutex::scoped_lock lock(mutex_);
+        stats.queues = 1;
+        stats.batchSize = batchSize_;
+        std::copy(flushCounts_, flushCounts_ + FLUSH_REASON_COUNT, stats.flushes);
+    }
+
+    template <class Traits>
+    void OutPort<Traits>::Queue::sendBursts_ (FlushReason reason)
     {
         if (bursts_.length() > 0) {
+            flushCounts_[reason]++;
+
+            // Time the push to all connections, which bounds how quickly
+            // batches can be sent
+            const boost::system_time begin = boost::get_system_time();
             port_->sendBursts(bursts_, startTime_, bursts_.length()/(float)maxBursts_, streamID_);
+            updateAverage_(sendTime_, (boost::get_system_time() - begin).total_microseconds() * 1e-6);
+            updateBatchSize_();
+
             // Reset the burst queue to empty, reallocating if necessary
             if (bursts_.maximum() < maxBursts_) {
                 bursts_.replace(maxBursts_, 0, BurstSequenceType::allocbuf(maxBursts_), true);
@@ -337,18 +448,60 @@ namespace burstio {
         }
     }
 
+    template <class Traits>
+    void OutPort<Traits>::Queue::updateAverage_ (double& average, double sample)
+    {
+        // A negative average means there are no samples yet
+        if (average < 0.0) {
+            average = sample;
+        } else {
+            average += (sample - average) * ADAPTIVE_WEIGHT;
+        }
+    }
+
+    template <class Traits>
+    void OutPort<Traits>::Queue::updateBatchSize_ ()
+    {
+        if (!adaptive_) {
+            batchSize_ = maxBursts_;
+            return;
+        }
+
+        // Until the arrival rate and send time are known, send bursts
+        // immediately
+        double target = 1.0;
+        if ((arrivalInterval_ < 0.0) || (sendTime_ < 0.0)) {
+            target = 1.0;
+        } else if (arrivalInterval_ == 0.0) {
+            // Bursts are arriving faster than the clock resolution
+            target = maxBursts_;
+        } else {
+            // To keep up, each batch must hold at least as many bursts as
+            // arrive while the previous batch is being sent; allow headroom
+            // for variation in send time, but never wait longer for a batch
+            // to fill than the latency threshold allows
+            const double rate = 1.0 / arrivalInterval_;
+            const double latency = thresholdLatency_.total_microseconds() * 1e-6;
+            target = std::min(rate * sendTime_ * ADAPTIVE_HEADROOM, rate * latency);
+        }
+
+        batchSize_ = std::max<size_t>(1, std::min<size_t>(std::ceil(target), maxBursts_));
+    }
+
     template <class Traits>
     OutPort<Traits>::OutPort(std::string port_name) :
-        UsesPort(port_name),
-        defaultQueue_(this, "(default)", DEFAULT_MAX_BURSTS, omniORB::giopMaxMsgSize() * 0.9, DEFAULT_LATENCY_THRESHOLD),
+        NegotiableUsesPort(port_name),
+        defaultQueue_(this, "(default)", DEFAULT_MAX_BURSTS, omniORB::giopMaxMsgSize() * 0.9, DEFAULT_LATENCY_THRESHOLD, false),
         streamQueues_(),
-        routingMode_(ROUTE_ALL_INTERLEAVED)
+        routingMode_(ROUTE_ALL_INTERLEAVED),
+        started_(false)
     {
     }
 
     template <class Traits>
     OutPort<Traits>::~OutPort()
     {
+        TimerWheel::Instance().cancel(this);
         if (ROUTE_ALL_INTERLEAVED != routingMode_) {
             // Only delete unique stream queues
             for (typename QueueMap::iterator queue = streamQueues_.begin(); queue != streamQueues_.end(); ++queue) {
@@ -393,6 +546,18 @@ namespace burstio {
         getDefaultPolicy()->setLatencyThreshold(usec);
     }
 
+    template <class Traits>
+    bool OutPort<Traits>::getAdaptiveBatching () const
+    {
+        return getDefaultPolicy()->getAdaptiveBatching();
+    }
+
+    template <class Traits>
+    void OutPort<Traits>::setAdaptiveBatching (bool enabled)
+    {
+        getDefaultPolicy()->setAdaptiveBatching(enabled);
+    }
+
     template <class Traits>
     void OutPort<Traits>::setRoutingMode (RoutingModeType mode)
     {
@@ -446,13 +611,30 @@ namespace burstio {
     void OutPort<Traits>::start ()
     {
         monitor_.start();
+
+        // Latency checks are not scheduled while stopped, so schedule any
+        // that are needed for bursts queued in the meantime
+        boost::mutex::scoped_lock lock(queueMutex_);
+        started_ = true;
+        if (ROUTE_ALL_INTERLEAVED == routingMode_) {
+            defaultQueue_.resumeChecks();
+        } else {
+            for (typename QueueMap::iterator queue = streamQueues_.begin(); queue != streamQueues_.end(); ++queue) {
+                queue->second->resumeChecks();
+            }
+        }
     }
 
     template <class Traits>
     void OutPort<Traits>::stop ()
     {
-        // Stop the monitor thread and remove any queued checks, as the queue(s)
-        // will be flushed anyway
+        // Cancel any pending latency checks, then stop the monitor thread and
+        // remove any queued work, as the queue(s) will be flushed anyway
+        {
+            boost::mutex::scoped_lock lock(queueMutex_);
+            started_ = false;
+        }
+        TimerWheel::Instance().cancel(this);
         monitor_.stop();
         monitor_.clear();
 
@@ -571,18 +753,50 @@ namespace burstio {
     template <class Traits>
     BULKIO::UsesPortStatisticsSequence * OutPort<Traits>::statistics()
     {
+        // Take a snapshot of the batching state of each queue first; the
+        // queues' locks must not be acquired while holding the connection
+        // lock, because a push holds them in the opposite order
+        boost::mutex::scoped_lock queue_lock(queueMutex_);
+        BatchStatistics default_batching;
+        defaultQueue_.getBatchStatistics(default_batching);
+        std::map<std::string,BatchStatistics> stream_batching;
+        if (ROUTE_ALL_INTERLEAVED != routingMode_) {
+            for (typename QueueMap::iterator jj = streamQueues_.begin(); jj != streamQueues_.end(); ++jj) {
+                jj->second->getBatchStatistics(stream_batching[jj->first]);
+            }
+        }
+
         boost::mutex::scoped_lock lock(updatingPortsLock);
         BULKIO::UsesPortStatisticsSequence_var retval = new BULKIO::UsesPortStatisticsSequence();
         retval->length(_connections.size());
         CORBA::ULong index = 0;
         for (TransportIterator connection = _connections.begin(); connection != _connections.end(); ++connection, ++index) {
             BULKIO::PortStatistics_var stats = connection.transport()->getStatistics();
+            BatchStatistics batching;
+            if (ROUTE_ALL_INTERLEAVED == routingMode_) {
+                batching = default_batching;
+            }
             for (typename QueueMap::iterator jj = streamQueues_.begin(); jj != streamQueues_.end(); ++jj) {
                 const std::string& streamID = jj->first;
                 if (isStreamRoutedToConnection(streamID, connection.connectionId())) {
                     burstio::utils::push_back(stats->streamIDs, jj->first.c_str());
+                    if (ROUTE_ALL_INTERLEAVED != routingMode_) {
+                        batching += stream_batching[streamID];
+                    }
                 }
             }
+
+            // Report the batch size that triggers a push (averaged over the
+            // streams sent to this connection) and why queues were pushed
+            double batch_size = 0.0;
+            if (batching.queues > 0) {
+                batch_size = batching.batchSize / (double)batching.queues;
+            }
+            burstio::utils::addKeyword(stats->keywords, "BATCH_SIZE", batch_size);
+            burstio::utils::addKeyword(stats->keywords, "FLUSH_BATCH_SIZE", batching.flushes[FLUSH_BATCH_SIZE]);
+            burstio::utils::addKeyword(stats->keywords, "FLUSH_BYTES", batching.flushes[FLUSH_BYTES]);
+            burstio::utils::addKeyword(stats->keywords, "FLUSH_LATENCY", batching.flushes[FLUSH_LATENCY]);
+            burstio::utils::addKeyword(stats->keywords, "FLUSH_FORCED", batching.flushes[FLUSH_FORCED]);
             retval[index].statistics = stats;
         }
         return retval._retn();
@@ -603,30 +817,51 @@ namespace burstio {
         }
     }
 
+    template <class Traits>
+    redhawk::UsesTransport* OutPort<Traits>::_createLocalTransport (PortBase* port,
+                                                                    CORBA::Object_ptr object,
+                                                                    const std::string& connectionId)
+    {
+        InPort<Traits>* local_port = dynamic_cast<InPort<Traits>*>(port);
+        if (local_port) {
+            return new LocalTransport(this, local_port);
+        }
+        return 0;
+    }
+
     template <class Traits>
     redhawk::UsesTransport* OutPort<Traits>::_createTransport (CORBA::Object_ptr object,
                                                                const std::string& connectionId)
     {
         typedef typename PortType::_var_type var_type;
         var_type port = ossie::corba::_narrowSafe<PortType>(object);
-        InPort<Traits>* local_port = ossie::corba::getLocalServant<InPort<Traits> >(port);
-        if (local_port) {
-            return new LocalTransport(this, local_port);
-        } else {
-            return new CorbaTransport(this, port);
-        }
+        return new CorbaTransport(this, port);
     }
 
     template <class Traits>
     void OutPort<Traits>::scheduleCheck (boost::system_time when)
     {
-        monitor_.schedule(when, &OutPort<Traits>::checkQueues, this);
+        if (started_) {
+            TimerWheel::Instance().schedule(this, when, boost::bind(&OutPort<Traits>::executeCheck, this));
+        }
+    }
+
+    template <class Traits>
+    void OutPort<Traits>::executeCheck ()
+    {
+        // The timer wheel is shared by all ports, so hand off the check (and
+        // any resulting push) to this port's monitor thread, where a slow
+        // connection only delays this port
+        monitor_.execute(&OutPort<Traits>::checkQueues, this);
     }
 
     template <class Traits>
     void OutPort<Traits>::checkQueues ()
     {
         boost::mutex::scoped_lock lock(queueMutex_);
+        if (!started_) {
+            return;
+        }
         if (ROUTE_ALL_INTERLEAVED == routingMode_) {
             defaultQueue_.checkFlush();
         } else {
@@ -664,7 +899,8 @@ namespace burstio {
             size_t max_bursts = defaultQueue_.getMaxBursts();
             size_t byte_threshold = defaultQueue_.getByteThreshold();
             float latency_threshold = defaultQueue_.getLatencyThreshold();
-            Queue* new_queue = new Queue(this, streamID, max_bursts, byte_threshold, latency_threshold);
+            bool adaptive = defaultQueue_.getAdaptiveBatching();
+            Queue* new_queue = new Queue(this, streamID, max_bursts, byte_threshold, latency_threshold, adaptive);
             streamQueues_[streamID] = new_queue;
             return *new_queue;
         }
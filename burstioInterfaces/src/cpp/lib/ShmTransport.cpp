@@ -0,0 +1,607 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK burstioInterfaces.
+ *
+ * REDHAWK burstioInterfaces is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK burstioInterfaces is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+#include "ShmTransport.h"
+
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <stdexcept>
+#include <limits.h>
+#include <unistd.h>
+#include <vector>
+
+#include <boost/thread.hpp>
+
+#include <ossie/ProvidesPort.h>
+#include <ossie/shm/Allocator.h>
+#include <ossie/shm/Heap.h>
+#include <ossie/shm/Ring.h>
+
+#include "OutPortImpl.h"
+
+namespace burstio {
+
+    namespace {
+        // Identifies burst descriptor rings; change when BatchDescriptor does
+        const uint32_t RING_TYPE = 0x42525354;
+        const size_t RING_CAPACITY = 64;
+        const size_t RING_SLOT_SIZE = 256;
+
+        // Descriptor written into a ring slot for each batch of bursts; the
+        // heap name immediately follows the fixed-size fields
+        struct BatchDescriptor {
+            uint64_t superblock;
+            uint64_t offset;
+            uint64_t headerSize;
+            uint64_t payloadSize;
+            uint32_t bursts;
+            uint32_t nameLength;
+            char heap[1];
+        };
+
+        // Payloads within a block start on 8-byte boundaries, so that every
+        // element type is naturally aligned
+        inline size_t align(size_t bytes)
+        {
+            return (bytes + 7) & ~size_t(7);
+        }
+
+        std::string getHostname()
+        {
+            char host[HOST_NAME_MAX+1];
+            gethostname(host, sizeof(host));
+            return host;
+        }
+    }
+
+    template <class Traits>
+    class ShmOutputTransport : public BurstTransport<Traits>
+    {
+    public:
+        typedef BurstTransport<Traits> super;
+        typedef typename Traits::PortType PortType;
+        typedef typename PortType::_var_type VarType;
+        typedef typename PortType::_ptr_type PtrType;
+        typedef typename Traits::BurstType BurstType;
+        typedef typename Traits::BurstSequenceType BurstSequenceType;
+        typedef typename Traits::ElementType ElementType;
+
+        ShmOutputTransport(OutPort<Traits>* parent, PtrType objref) :
+            super(parent),
+            _objref(PortType::_duplicate(objref)),
+            _ring(),
+            _errorsSeen(0)
+        {
+            _ring.create("burstio-ring", RING_TYPE, RING_CAPACITY, RING_SLOT_SIZE);
+        }
+
+        ~ShmOutputTransport()
+        {
+            _releaseAll();
+        }
+
+        virtual std::string transportType() const
+        {
+            return "shmipc";
+        }
+
+        virtual CF::Properties transportInfo() const
+        {
+            return CF::Properties();
+        }
+
+        const std::string& getRingName() const
+        {
+            return _ring.name();
+        }
+
+        void finishConnect()
+        {
+            // Both sides have the ring mapped, so it no longer needs a name in
+            // the file system
+            _ring.unlink();
+        }
+
+        virtual void disconnect()
+        {
+            // Let the provides side finish with any outstanding batches before
+            // the blocks are released
+            _ring.close();
+            _waitForPending();
+            _releaseAll();
+        }
+
+        void pushBursts(const BurstSequenceType& bursts, boost::system_time startTime, float queueDepth)
+        {
+            // Record delay from queueing of first burst to now
+            boost::posix_time::time_duration delay = boost::get_system_time() - startTime;
+
+            _releasePending();
+
+            // Encode everything except the payloads; payload offsets are
+            // relative to the end of the encoded header
+            cdrMemoryStream header;
+            const CORBA::ULong total_bursts = bursts.length();
+            size_t total_elements = 0;
+            size_t payload_bytes = 0;
+            for (CORBA::ULong index = 0; index < total_bursts; ++index) {
+                const BurstType& burst = bursts[index];
+                burst.SRI >>= header;
+                burst.T >>= header;
+                header.marshalBoolean(burst.EOS);
+                CORBA::ULongLong length = burst.data.length();
+                length >>= header;
+                CORBA::ULongLong offset = payload_bytes;
+                offset >>= header;
+                total_elements += length;
+                payload_bytes += align(length * sizeof(ElementType));
+            }
+
+            const size_t header_size = align(header.bufSize());
+            char* block = static_cast<char*>(redhawk::shm::allocate(header_size + payload_bytes));
+            if (!block) {
+                // Shared memory must be exhausted; fall back to CORBA for this
+                // batch, which is slower but does not lose data
+                _pushCorba(bursts);
+            } else {
+                std::memcpy(block, header.bufPtr(), header.bufSize());
+                char* payload = block + header_size;
+                for (CORBA::ULong index = 0; index < total_bursts; ++index) {
+                    const BurstType& burst = bursts[index];
+                    size_t bytes = burst.data.length() * sizeof(ElementType);
+                    if (bytes > 0) {
+                        std::memcpy(payload, burst.data.get_buffer(), bytes);
+                    }
+                    payload += align(bytes);
+                }
+                _sendBlock(block, header_size, payload_bytes, total_bursts);
+            }
+            this->setAlive(true);
+
+            this->_stats.record(total_bursts, total_elements, queueDepth, delay.total_microseconds() * 1e-6);
+
+            // Errors on the provides side are reported asynchronously, so the
+            // failure may correspond to an earlier batch
+            uint32_t errors = _ring.errorCount();
+            if (errors != _errorsSeen) {
+                _errorsSeen = errors;
+                throw redhawk::TransportError("pushBursts failed");
+            }
+        }
+
+    private:
+        void _sendBlock(char* block, size_t headerSize, size_t payloadSize, CORBA::ULong count)
+        {
+            redhawk::shm::MemoryRef ref = redhawk::shm::Heap::getRef(block);
+            if (!ref || ((offsetof(BatchDescriptor, heap) + ref.heap.size()) > _ring.slotSize())) {
+                redhawk::shm::deallocate(block);
+                throw redhawk::TransportError("unable to reference shared memory block");
+            }
+
+            void* slot = _ring.beginWrite();
+            if (!slot) {
+                redhawk::shm::deallocate(block);
+                throw redhawk::FatalTransportError("connection closed by provides side");
+            }
+            BatchDescriptor* descriptor = static_cast<BatchDescriptor*>(slot);
+            descriptor->superblock = ref.superblock;
+            descriptor->offset = ref.offset;
+            descriptor->headerSize = headerSize;
+            descriptor->payloadSize = payloadSize;
+            descriptor->bursts = count;
+            descriptor->nameLength = ref.heap.size();
+            std::memcpy(descriptor->heap, ref.heap.data(), ref.heap.size());
+
+            // The provides side has not attached to the block yet, so this
+            // side's reference must be held until it consumes the descriptor
+            uint64_t sequence = _ring.commitWrite();
+            _pending.push_back(std::make_pair(sequence, block));
+        }
+
+        void _pushCorba(const BurstSequenceType& bursts)
+        {
+            // Batches already in the ring must be delivered first to preserve
+            // ordering, because the provides side handles CORBA calls on a
+            // different thread
+            while (!_pending.empty() && !_ring.isClosed()) {
+                boost::this_thread::sleep(boost::posix_time::milliseconds(1));
+                _releasePending();
+            }
+            try {
+                _objref->pushBursts(bursts);
+            } catch (const CORBA::Exception& ex) {
+                throw redhawk::FatalTransportError(ossie::corba::describeException(ex));
+            }
+        }
+
+        void _releasePending()
+        {
+            const uint64_t consumed = _ring.readCount();
+            while (!_pending.empty() && (_pending.front().first < consumed)) {
+                redhawk::shm::deallocate(_pending.front().second);
+                _pending.pop_front();
+            }
+        }
+
+        void _waitForPending()
+        {
+            // Give the provides side a bounded amount of time to attach to any
+            // outstanding blocks before releasing them
+            for (int retry = 0; retry < 1000; ++retry) {
+                _releasePending();
+                if (_pending.empty()) {
+                    return;
+                }
+                boost::this_thread::sleep(boost::posix_time::milliseconds(1));
+            }
+        }
+
+        void _releaseAll()
+        {
+            while (!_pending.empty()) {
+                redhawk::shm::deallocate(_pending.front().second);
+                _pending.pop_front();
+            }
+        }
+
+        VarType _objref;
+        redhawk::shm::SlotRing _ring;
+        uint32_t _errorsSeen;
+        std::deque<std::pair<uint64_t,char*> > _pending;
+    };
+
+    template <class Traits>
+    class ShmInputTransport : public redhawk::ProvidesTransport
+    {
+    public:
+        typedef typename InPort<Traits>::PacketType PacketType;
+        typedef typename InPort<Traits>::BufferType BufferType;
+
+        ShmInputTransport(InPort<Traits>* port, ShmInputManager<Traits>* manager,
+                          const std::string& transportId, const std::string& ringName) :
+            redhawk::ProvidesTransport(port, transportId),
+            _port(port),
+            _manager(manager),
+            _running(false)
+        {
+            _ring.open(ringName, RING_TYPE);
+        }
+
+        std::string transportType() const
+        {
+            return "shmipc";
+        }
+
+        void startTransport()
+        {
+            _running = true;
+            _thread = boost::thread(&ShmInputTransport::_run, this);
+        }
+
+        void stopTransport()
+        {
+            {
+                boost::mutex::scoped_lock lock(_mutex);
+                if (!_running) {
+                    return;
+                }
+                _running = false;
+            }
+            // Wake the reader thread if it is parked on the ring, and let the
+            // uses side know that no more batches will be consumed
+            _ring.close();
+            _thread.join();
+        }
+
+    private:
+        bool _isRunning()
+        {
+            boost::mutex::scoped_lock lock(_mutex);
+            return _running;
+        }
+
+        void _run()
+        {
+            while (_isRunning()) {
+                const void* slot = _ring.beginRead(100);
+                if (!slot) {
+                    if (_ring.isClosed()) {
+                        return;
+                    }
+                    continue;
+                }
+
+                // Errors are reported back to the uses side asynchronously
+                // via the ring
+                try {
+                    _receiveBatch(static_cast<const BatchDescriptor*>(slot));
+                } catch (const std::exception& exc) {
+                    RH_NL_ERROR("ShmTransport", "Error receiving bursts: " << exc.what());
+                    _ring.reportError();
+                } catch (const CORBA::Exception& exc) {
+                    RH_NL_ERROR("ShmTransport", "Error receiving bursts: " << ossie::corba::describeException(exc));
+                    _ring.reportError();
+                }
+
+                // Commit only after the bursts are queued, so that a full
+                // input queue pushes back on the uses side through the ring
+                _ring.commitRead();
+            }
+        }
+
+        void _receiveBatch(const BatchDescriptor* descriptor)
+        {
+            redhawk::shm::MemoryRef ref;
+            ref.heap.assign(descriptor->heap, descriptor->nameLength);
+            ref.superblock = descriptor->superblock;
+            ref.offset = descriptor->offset;
+
+            // The payloads are handed to the port as views into the block,
+            // which stays attached until the last burst referencing it is
+            // released
+            const size_t header_size = descriptor->headerSize;
+            char* block = static_cast<char*>(_manager->fetchShmRef(ref));
+            redhawk::shared_buffer<char> buffer(block, header_size + descriptor->payloadSize,
+                                                &redhawk::shm::HeapClient::deallocate,
+                                                redhawk::detail::process_shared_tag());
+
+            cdrMemoryStream header(block, header_size);
+            _bursts.resize(descriptor->bursts);
+            for (size_t index = 0; index < _bursts.size(); ++index) {
+                BURSTIO::BurstSRI sri;
+                sri <<= header;
+                BULKIO::PrecisionUTCTime time;
+                time <<= header;
+                bool eos = header.unmarshalBoolean();
+                CORBA::ULongLong length;
+                length <<= header;
+                CORBA::ULongLong offset;
+                offset <<= header;
+                const size_t start = header_size + offset;
+                const size_t end = start + length * sizeof(typename Traits::NativeType);
+                if (end > buffer.size()) {
+                    _bursts.clear();
+                    throw std::runtime_error("burst payload exceeds shared memory block");
+                }
+                BufferType data = BufferType::recast(buffer.slice(start, end));
+                PacketType(sri, data, time, eos).swap(_bursts[index]);
+            }
+
+            // Releases the transport's references to the block as the bursts
+            // are moved into the queue
+            _port->queueBursts(_bursts);
+        }
+
+        InPort<Traits>* _port;
+        ShmInputManager<Traits>* _manager;
+        volatile bool _running;
+        boost::mutex _mutex;
+        boost::thread _thread;
+        redhawk::shm::SlotRing _ring;
+        std::vector<PacketType> _bursts;
+    };
+
+    template <class Traits>
+    ShmOutputManager<Traits>::ShmOutputManager(OutPort<Traits>* port) :
+        _port(port),
+        _hostname(getHostname())
+    {
+    }
+
+    template <class Traits>
+    std::string ShmOutputManager<Traits>::transportType()
+    {
+        return "shmipc";
+    }
+
+    template <class Traits>
+    CF::Properties ShmOutputManager<Traits>::transportProperties()
+    {
+        CF::Properties properties;
+        ossie::corba::push_back(properties, redhawk::PropertyType("hostname", _hostname));
+        return properties;
+    }
+
+    template <class Traits>
+    redhawk::UsesTransport* ShmOutputManager<Traits>::createUsesTransport(CORBA::Object_ptr object,
+                                                                          const std::string& connectionId,
+                                                                          const redhawk::PropertyMap& properties)
+    {
+        // For testing, allow disabling
+        const char* shm_env = getenv("BURSTIO_SHM");
+        if (shm_env && (strcmp(shm_env, "disable") == 0)) {
+            return 0;
+        }
+
+        // If the other end of the connection has a different hostname, it
+        // is reasonable to assume that we cannot use shared memory
+        if (properties.get("hostname", "").toString() != _hostname) {
+            RH_NL_TRACE("ShmTransport", "Connection '" << connectionId << "' is on another host");
+            return 0;
+        }
+
+        if (!redhawk::shm::isEnabled()) {
+            RH_NL_DEBUG("ShmTransport", "Cannot create SHM transport, shared memory is not available");
+            return 0;
+        }
+
+        typename Traits::PortType::_var_type port = ossie::corba::_narrowSafe<typename Traits::PortType>(object);
+        if (CORBA::is_nil(port)) {
+            return 0;
+        }
+
+        try {
+            return new ShmOutputTransport<Traits>(_port, port);
+        } catch (const std::exception& exc) {
+            RH_NL_DEBUG("ShmTransport", "Unable to create descriptor ring: " << exc.what());
+            return 0;
+        }
+    }
+
+    template <class Traits>
+    redhawk::PropertyMap ShmOutputManager<Traits>::getNegotiationProperties(redhawk::UsesTransport* transport)
+    {
+        ShmOutputTransport<Traits>* shm_transport = dynamic_cast<ShmOutputTransport<Traits>*>(transport);
+        if (!shm_transport) {
+            throw std::logic_error("invalid transport type");
+        }
+
+        redhawk::PropertyMap properties;
+        properties["ring"] = shm_transport->getRingName();
+        return properties;
+    }
+
+    template <class Traits>
+    void ShmOutputManager<Traits>::setNegotiationResult(redhawk::UsesTransport* transport,
+                                                        const redhawk::PropertyMap& properties)
+    {
+        ShmOutputTransport<Traits>* shm_transport = dynamic_cast<ShmOutputTransport<Traits>*>(transport);
+        if (!shm_transport) {
+            throw std::logic_error("invalid transport type");
+        }
+
+        if (!properties.get("ring", false).toBoolean()) {
+            throw redhawk::FatalTransportError("provides side did not attach to descriptor ring");
+        }
+        shm_transport->finishConnect();
+    }
+
+    template <class Traits>
+    ShmInputManager<Traits>::ShmInputManager(InPort<Traits>* port) :
+        _port(port)
+    {
+    }
+
+    template <class Traits>
+    std::string ShmInputManager<Traits>::transportType()
+    {
+        return "shmipc";
+    }
+
+    template <class Traits>
+    CF::Properties ShmInputManager<Traits>::transportProperties()
+    {
+        CF::Properties properties;
+        ossie::corba::push_back(properties, redhawk::PropertyType("hostname", getHostname()));
+        return properties;
+    }
+
+    template <class Traits>
+    redhawk::ProvidesTransport* ShmInputManager<Traits>::createProvidesTransport(const std::string& transportId,
+                                                                                 const redhawk::PropertyMap& properties)
+    {
+        if (!properties.contains("ring")) {
+            throw redhawk::FatalTransportError("invalid properties for shared memory connection");
+        }
+        const std::string ring_name = properties["ring"].toString();
+        try {
+            return new ShmInputTransport<Traits>(_port, this, transportId, ring_name);
+        } catch (const std::exception& exc) {
+            throw redhawk::FatalTransportError("failed to open descriptor ring " + ring_name);
+        }
+    }
+
+    template <class Traits>
+    redhawk::PropertyMap ShmInputManager<Traits>::getNegotiationProperties(redhawk::ProvidesTransport*)
+    {
+        redhawk::PropertyMap properties;
+        properties["ring"] = true;
+        return properties;
+    }
+
+    template <class Traits>
+    void* ShmInputManager<Traits>::fetchShmRef(const redhawk::shm::MemoryRef& ref)
+    {
+        boost::mutex::scoped_lock lock(_mutex);
+        return _heapClient.fetch(ref);
+    }
+
+    template <class Traits>
+    class ShmTransportFactory : public redhawk::TransportFactory
+    {
+    public:
+        virtual std::string transportType()
+        {
+            return "shmipc";
+        }
+
+        virtual std::string repoId()
+        {
+            return Traits::PortType::_PD_repoId;
+        }
+
+        virtual int defaultPriority()
+        {
+            return 1;
+        }
+
+        virtual redhawk::ProvidesTransportManager* createProvidesManager(redhawk::NegotiableProvidesPortBase* port)
+        {
+            InPort<Traits>* burstio_port = dynamic_cast<InPort<Traits>*>(port);
+            if (!burstio_port) {
+                throw std::logic_error("incorrect input port type for BurstIO transport factory " + repoId());
+            }
+            return new ShmInputManager<Traits>(burstio_port);
+        }
+
+        virtual redhawk::UsesTransportManager* createUsesManager(redhawk::NegotiableUsesPort* port)
+        {
+            OutPort<Traits>* burstio_port = dynamic_cast<OutPort<Traits>*>(port);
+            if (!burstio_port) {
+                throw std::logic_error("incorrect output port type for BurstIO transport factory " + repoId());
+            }
+            return new ShmOutputManager<Traits>(burstio_port);
+        }
+    };
+
+#define FOREACH_BURST_TRAITS(x)                 \
+    x(ByteTraits);                              \
+    x(DoubleTraits);                            \
+    x(FloatTraits);                             \
+    x(LongTraits);                              \
+    x(LongLongTraits);                          \
+    x(ShortTraits);                             \
+    x(UbyteTraits);                             \
+    x(UlongTraits);                             \
+    x(UlongLongTraits);                         \
+    x(UshortTraits);
+
+#define INSTANTIATE_SHM_TEMPLATE(traits)        \
+    template class ShmOutputManager<traits>;    \
+    template class ShmInputManager<traits>
+
+    FOREACH_BURST_TRAITS(INSTANTIATE_SHM_TEMPLATE);
+
+    static int initializeModule()
+    {
+#define REGISTER_FACTORY(traits)                                        \
+        {                                                               \
+            static ShmTransportFactory<traits> factory;                 \
+            redhawk::TransportRegistry::RegisterTransport(&factory);    \
+        }
+
+        FOREACH_BURST_TRAITS(REGISTER_FACTORY);
+
+        return 0;
+    }
+
+    static int initialized = initializeModule();
+}
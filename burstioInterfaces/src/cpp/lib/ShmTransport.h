@@ -0,0 +1,93 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK burstioInterfaces.
+ *
+ * REDHAWK burstioInterfaces is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK burstioInterfaces is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+#ifndef BURSTIO_SHMTRANSPORT_H
+#define BURSTIO_SHMTRANSPORT_H
+
+#include <string>
+
+#include <boost/thread/mutex.hpp>
+
+#include <ossie/PropertyMap.h>
+#include <ossie/Transport.h>
+#include <ossie/shm/HeapClient.h>
+
+#include <burstio/InPortDecl.h>
+#include <burstio/OutPortDecl.h>
+
+namespace burstio {
+
+    // Shared memory transport for burst ports on the same host. Each batch of
+    // bursts is copied once into a single shared memory block, holding the
+    // CDR-encoded SRI, timestamps and EOS flags followed by the payloads; the
+    // uses side passes a heap reference to the block to the provides side
+    // through a descriptor ring (see redhawk::shm::SlotRing). This avoids the
+    // ORB entirely, including the GIOP message size limit on batches.
+    template <class Traits>
+    class ShmOutputManager : public redhawk::UsesTransportManager
+    {
+    public:
+        ShmOutputManager(OutPort<Traits>* port);
+
+        virtual std::string transportType();
+
+        virtual CF::Properties transportProperties();
+
+        virtual redhawk::UsesTransport* createUsesTransport(CORBA::Object_ptr object,
+                                                            const std::string& connectionId,
+                                                            const redhawk::PropertyMap& properties);
+
+        virtual redhawk::PropertyMap getNegotiationProperties(redhawk::UsesTransport* transport);
+
+        virtual void setNegotiationResult(redhawk::UsesTransport* transport, const redhawk::PropertyMap& properties);
+
+    private:
+        OutPort<Traits>* _port;
+        std::string _hostname;
+    };
+
+    template <class Traits>
+    class ShmInputManager : public redhawk::ProvidesTransportManager
+    {
+    public:
+        ShmInputManager(InPort<Traits>* port);
+
+        virtual std::string transportType();
+
+        virtual CF::Properties transportProperties();
+
+        virtual redhawk::ProvidesTransport* createProvidesTransport(const std::string& transportId,
+                                                                    const redhawk::PropertyMap& properties);
+
+        virtual redhawk::PropertyMap getNegotiationProperties(redhawk::ProvidesTransport* transport);
+
+        // Attaches to a block from the uses side's heap. The heap mappings are
+        // owned by the manager rather than the transport, because received
+        // bursts refer directly to shared memory and may outlive the
+        // connection.
+        void* fetchShmRef(const redhawk::shm::MemoryRef& ref);
+
+    private:
+        InPort<Traits>* _port;
+        boost::mutex _mutex;
+        redhawk::shm::HeapClient _heapClient;
+    };
+}
+
+#endif // BURSTIO_SHMTRANSPORT_H
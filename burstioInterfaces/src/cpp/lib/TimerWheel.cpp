@@ -0,0 +1,164 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK burstioInterfaces.
+ *
+ * REDHAWK burstioInterfaces is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK burstioInterfaces is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+#include "TimerWheel.h"
+
+namespace burstio {
+
+    const long TimerWheel::TICK_USEC;
+    const size_t TimerWheel::SLOT_COUNT;
+
+    TimerWheel* TimerWheel::instance_ = 0;
+    boost::once_flag TimerWheel::once_ = BOOST_ONCE_INIT;
+
+    TimerWheel& TimerWheel::Instance()
+    {
+        boost::call_once(&TimerWheel::Create, once_);
+        return *instance_;
+    }
+
+    void TimerWheel::Create()
+    {
+        instance_ = new TimerWheel();
+    }
+
+    TimerWheel::TimerWheel() :
+        thread_(0),
+        slots_(SLOT_COUNT),
+        current_(0),
+        currentTick_(boost::get_system_time()),
+        pending_(0),
+        running_(0)
+    {
+        thread_ = new boost::thread(&TimerWheel::run_, this);
+    }
+
+    void TimerWheel::schedule (const void* owner, boost::system_time when, const func_type& func)
+    {
+        boost::mutex::scoped_lock lock(mutex_);
+        if (pending_ == 0) {
+            // The wheel stops ticking while idle; re-align to the present so
+            // that the thread does not have to catch up
+            currentTick_ = boost::get_system_time();
+            wakeup_.notify_one();
+        }
+
+        // Timers more than one revolution away are placed by their deadline
+        // modulo the wheel size, and skipped until they are due; those that
+        // are already due go in the next slot
+        long ticks = (when - currentTick_).total_microseconds() / TICK_USEC + 1;
+        if (ticks < 1) {
+            ticks = 1;
+        }
+        TimerList& slot = slots_[(current_ + ticks) % SLOT_COUNT];
+        slot.push_back(Timer());
+        Timer& timer = slot.back();
+        timer.owner = owner;
+        timer.deadline = when;
+        timer.func = func;
+        ++pending_;
+    }
+
+    void TimerWheel::cancel (const void* owner)
+    {
+        boost::mutex::scoped_lock lock(mutex_);
+        for (std::vector<TimerList>::iterator slot = slots_.begin(); slot != slots_.end(); ++slot) {
+            pending_ -= removeOwner_(*slot, owner);
+        }
+        removeOwner_(expired_, owner);
+
+        // A timer callback may cancel its own owner, which must not wait on
+        // itself
+        if (boost::this_thread::get_id() == thread_->get_id()) {
+            return;
+        }
+        while (running_ == owner) {
+            finished_.wait(lock);
+        }
+    }
+
+    size_t TimerWheel::removeOwner_ (TimerList& timers, const void* owner)
+    {
+        size_t removed = 0;
+        TimerList::iterator timer = timers.begin();
+        while (timer != timers.end()) {
+            if (timer->owner == owner) {
+                timer = timers.erase(timer);
+                ++removed;
+            } else {
+                ++timer;
+            }
+        }
+        return removed;
+    }
+
+    void TimerWheel::run_ ()
+    {
+        boost::mutex::scoped_lock lock(mutex_);
+        while (true) {
+            if (pending_ == 0) {
+                wakeup_.wait(lock);
+                continue;
+            }
+
+            boost::system_time next_tick = currentTick_ + boost::posix_time::microseconds(TICK_USEC);
+            if (boost::get_system_time() < next_tick) {
+                // A newly scheduled timer may re-align the wheel, so always
+                // re-check after waking
+                wakeup_.timed_wait(lock, next_tick);
+                continue;
+            }
+            currentTick_ = next_tick;
+            current_ = (current_ + 1) % SLOT_COUNT;
+
+            // Collect the expired timers in this slot, leaving any that are
+            // due on a later revolution
+            TimerList& slot = slots_[current_];
+            TimerList::iterator timer = slot.begin();
+            while (timer != slot.end()) {
+                if (timer->deadline <= currentTick_) {
+                    expired_.splice(expired_.end(), slot, timer++);
+                    --pending_;
+                } else {
+                    ++timer;
+                }
+            }
+
+            // The expired list is a member so that cancel() can remove timers
+            // that have not run yet while the lock is released
+            while (!expired_.empty()) {
+                Timer& front = expired_.front();
+                running_ = front.owner;
+                func_type func;
+                func.swap(front.func);
+                expired_.pop_front();
+                lock.unlock();
+                try {
+                    func();
+                } catch (...) {
+                    // Callbacks are responsible for their own error handling;
+                    // do not let one stop the timers for every other port
+                }
+                lock.lock();
+                running_ = 0;
+                finished_.notify_all();
+            }
+        }
+    }
+}
@@ -0,0 +1,93 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK burstioInterfaces.
+ *
+ * REDHAWK burstioInterfaces is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK burstioInterfaces is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+#ifndef BURSTIO_TIMERWHEEL_H
+#define BURSTIO_TIMERWHEEL_H
+
+#include <list>
+#include <vector>
+
+#include <boost/function.hpp>
+#include <boost/thread.hpp>
+
+namespace burstio {
+
+    // Process-wide hashed timer wheel used for output port latency checks.
+    // All ports share a single thread; scheduling and expiring a timer are
+    // constant-time regardless of how many ports or streams are active,
+    // unlike a per-port executor that keeps its tasks sorted. Timers fire on
+    // the first tick at or after their deadline, so the resolution is one
+    // tick (TICK_USEC). The thread only ticks while timers are pending.
+    class TimerWheel {
+    public:
+        typedef boost::function<void()> func_type;
+
+        static const long TICK_USEC = 1000;
+        static const size_t SLOT_COUNT = 512;
+
+        static TimerWheel& Instance();
+
+        // Schedules func to be called at (or shortly after) when; owner is an
+        // opaque key used to cancel the owner's timers as a group
+        void schedule (const void* owner, boost::system_time when, const func_type& func);
+
+        // Removes all pending timers for owner. If one of the owner's timers
+        // is running on another thread, waits for it to complete, so that the
+        // owner may be safely destroyed after this returns.
+        void cancel (const void* owner);
+
+    private:
+        struct Timer {
+            const void* owner;
+            boost::system_time deadline;
+            func_type func;
+        };
+        typedef std::list<Timer> TimerList;
+
+        // The instance is intentionally never destroyed, to avoid static
+        // destruction order problems with ports that outlive main()
+        TimerWheel();
+
+        // Non-copyable, non-assignable
+        TimerWheel(const TimerWheel&);
+        TimerWheel& operator=(const TimerWheel&);
+
+        static void Create();
+
+        static size_t removeOwner_ (TimerList& timers, const void* owner);
+        void run_ ();
+
+        boost::mutex mutex_;
+        boost::condition_variable wakeup_;
+        boost::condition_variable finished_;
+        boost::thread* thread_;
+
+        std::vector<TimerList> slots_;
+        TimerList expired_;
+        size_t current_;
+        boost::system_time currentTick_;
+        size_t pending_;
+        const void* running_;
+
+        static TimerWheel* instance_;
+        static boost::once_flag once_;
+    };
+}
+
+#endif // BURSTIO_TIMERWHEEL_H
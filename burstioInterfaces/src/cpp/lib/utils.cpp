@@ -73,5 +73,46 @@ namespace burstio {
             return sri;
         }
 
+        namespace {
+            inline void swapString (CORBA::String_member& lhs, CORBA::String_member& rhs)
+            {
+                char* temp = lhs._retn();
+                lhs = rhs._retn();
+                rhs = temp;
+            }
+        }
+
+        void swapSRI (BURSTIO::BurstSRI& lhs, BURSTIO::BurstSRI& rhs)
+        {
+            std::swap(lhs.hversion, rhs.hversion);
+            swapString(lhs.streamID, rhs.streamID);
+            swapString(lhs.id, rhs.id);
+            std::swap(lhs.xdelta, rhs.xdelta);
+            std::swap(lhs.mode, rhs.mode);
+            std::swap(lhs.flags, rhs.flags);
+            std::swap(lhs.tau, rhs.tau);
+            std::swap(lhs.theta, rhs.theta);
+            std::swap(lhs.gain, rhs.gain);
+            std::swap(lhs.uwlength, rhs.uwlength);
+            std::swap(lhs.bursttype, rhs.bursttype);
+            std::swap(lhs.burstLength, rhs.burstLength);
+            std::swap(lhs.CHAN_RF, rhs.CHAN_RF);
+            std::swap(lhs.baudestimate, rhs.baudestimate);
+            std::swap(lhs.carrieroffset, rhs.carrieroffset);
+            std::swap(lhs.SNR, rhs.SNR);
+            swapString(lhs.modulation, rhs.modulation);
+            std::swap(lhs.baudrate, rhs.baudrate);
+            swapString(lhs.fec, rhs.fec);
+            swapString(lhs.fecrate, rhs.fecrate);
+            swapString(lhs.randomizer, rhs.randomizer);
+            swapString(lhs.overhead, rhs.overhead);
+            std::swap(lhs.expectedStartOfBurstTime, rhs.expectedStartOfBurstTime);
+
+            CF::Properties temp;
+            ossie::corba::move(temp, lhs.keywords);
+            ossie::corba::move(lhs.keywords, rhs.keywords);
+            ossie::corba::move(rhs.keywords, temp);
+        }
+
     }
 }
@@ -280,6 +280,114 @@ void  Burstio_InPort::test_push_flush_sequence( T *port  )
   RH_DEBUG(logger, "BURSTIO-PUSH/FLUSH END PORT: " << port->getName() );
 }
 
+template< typename T >
+void  Burstio_InPort::test_get_bursts_zero_copy( T *port  ) 
+{
+  RH_DEBUG(logger, "BURSTIO-ZERO COPY BEGIN: " << port->getName() );
+
+  typedef typename T::PacketType::ElementType ElementType;
+
+  port->setQueueThreshold(100);
+  port->start();
+
+  // bursts pushed in an owned sequence keep their data buffers all the way
+  // through to the CORBA sequence returned by getBursts(float)
+  typename T::BurstSequenceType bursts;
+  bursts.length(2);
+  std::vector<const ElementType*> buffers;
+  for ( CORBA::ULong j=0; j<bursts.length(); j++ ) {
+    bursts[j].SRI = make_sri_pkt1();
+    bursts[j].EOS = false;
+    bursts[j].T = burstio::utils::now();
+    bursts[j].data.length(16);
+    buffers.push_back(bursts[j].data.get_buffer());
+  }
+  port->pushBursts( bursts );
+
+  typename T::BurstSequenceVar result = port->getBursts( bulkio::Const::NON_BLOCKING );
+  CPPUNIT_ASSERT_MESSAGE( "BURSTIO-ZERO COPY getBursts should return 2", result->length() == 2 );
+  for ( CORBA::ULong j=0; j<result->length(); j++ ) {
+    CPPUNIT_ASSERT_MESSAGE( "BURSTIO-ZERO COPY Data Length mismatch", result[j].data.length() == 16 );
+    CPPUNIT_ASSERT_MESSAGE( "BURSTIO-ZERO COPY getBursts copied data", result[j].data.get_buffer() == buffers[j] );
+  }
+
+  // the same holds for getSequence() on a single burst
+  bursts.length(1);
+  bursts[0].SRI = make_sri_pkt1();
+  bursts[0].EOS = false;
+  bursts[0].T = burstio::utils::now();
+  bursts[0].data.length(16);
+  const ElementType* buffer = bursts[0].data.get_buffer();
+  port->pushBursts( bursts );
+
+  typename T::PacketType* packet = port->getBurst( bulkio::Const::NON_BLOCKING );
+  CPPUNIT_ASSERT_MESSAGE( "BURSTIO-ZERO COPY getBurst returned null", packet != 0 );
+  CPPUNIT_ASSERT_MESSAGE( "BURSTIO-ZERO COPY Data Length mismatch", packet->getSize() == 16 );
+  CPPUNIT_ASSERT_MESSAGE( "BURSTIO-ZERO COPY getSequence copied data", packet->getSequence().get_buffer() == buffer );
+  delete packet;
+
+  port->stop();
+
+  RH_DEBUG(logger, "BURSTIO-ZERO COPY END PORT: " << port->getName() );
+}
+
+template< typename T >
+void  Burstio_InPort::test_get_bursts_batch( T *port  ) 
+{
+  RH_DEBUG(logger, "BURSTIO-GET BATCH BEGIN: " << port->getName() );
+
+  typedef typename T::PacketType::NativeType NativeType;
+
+  port->setQueueThreshold(100);
+  port->start();
+
+  // push two sequences of bursts, so that the batch spans both
+  typename T::BurstSequenceType bursts;
+  bursts.length(3);
+  for ( int i=0; i<2; i++ ) {
+    for ( CORBA::ULong j=0; j<bursts.length(); j++ ) {
+      bursts[j].SRI = make_sri_pkt1();
+      bursts[j].EOS = false;
+      bursts[j].T = burstio::utils::now();
+      bursts[j].data.length(10 + i*3 + j);
+      for ( CORBA::ULong k=0; k<bursts[j].data.length(); k++ ) {
+        bursts[j].data[k] = k;
+      }
+    }
+    port->pushBursts( bursts );
+  }
+
+  size_t tmp = port->getQueueDepth();
+  CPPUNIT_ASSERT_MESSAGE( "BURSTIO-GET BATCH getQueueDepth should be 6", tmp == 6);
+
+  std::vector<typename T::PacketType> batch;
+  size_t count = port->getBursts(batch, 4, bulkio::Const::NON_BLOCKING);
+  CPPUNIT_ASSERT_MESSAGE( "BURSTIO-GET BATCH first batch should be 4", count == 4 );
+  CPPUNIT_ASSERT_MESSAGE( "BURSTIO-GET BATCH vector size mismatch", batch.size() == 4 );
+  for ( size_t i=0; i<batch.size(); i++ ) {
+    CPPUNIT_ASSERT_MESSAGE( "BURSTIO-GET BATCH Data Length mismatch", (10 + i) == batch[i].getSize() );
+    CPPUNIT_ASSERT_MESSAGE( "BURSTIO-GET BATCH Buffer Length mismatch", batch[i].getSize() == batch[i].getBuffer().size() );
+    CPPUNIT_ASSERT_MESSAGE( "BURSTIO-GET BATCH Data mismatch", (NativeType)(batch[i].getSize() - 1) == batch[i].getData()[batch[i].getSize() - 1] );
+    CPPUNIT_ASSERT_MESSAGE( "BURSTIO-GET BATCH Sequence Length mismatch", batch[i].getSize() == batch[i].getSequence().length() );
+  }
+
+  tmp = port->getQueueDepth();
+  CPPUNIT_ASSERT_MESSAGE( "BURSTIO-GET BATCH getQueueDepth should be 2", tmp == 2);
+
+  count = port->getBursts(batch, 4, bulkio::Const::NON_BLOCKING);
+  CPPUNIT_ASSERT_MESSAGE( "BURSTIO-GET BATCH second batch should be 2", count == 2 );
+  CPPUNIT_ASSERT_MESSAGE( "BURSTIO-GET BATCH vector size mismatch", batch.size() == 2 );
+  CPPUNIT_ASSERT_MESSAGE( "BURSTIO-GET BATCH Data Length mismatch", 15 == batch[1].getSize() );
+
+  count = port->getBursts(batch, 4, bulkio::Const::NON_BLOCKING);
+  CPPUNIT_ASSERT_MESSAGE( "BURSTIO-GET BATCH empty queue should return 0", count == 0 );
+  CPPUNIT_ASSERT_MESSAGE( "BURSTIO-GET BATCH vector should be empty", batch.empty() );
+
+  port->stop();
+
+  RH_DEBUG(logger, "BURSTIO-GET BATCH END PORT: " << port->getName() );
+}
+
 void 
 Burstio_InPort::test_create_int8()
 {
@@ -300,6 +408,10 @@ Burstio_InPort::test_int8()
 
   test_push_flush_sequence( port );
 
+  test_get_bursts_batch( port );
+
+  test_get_bursts_zero_copy( port );
+
   CPPUNIT_ASSERT_NO_THROW( port );
 
 }
@@ -344,6 +456,10 @@ Burstio_InPort::test_int32()
 
   test_push_flush_sequence( port );
 
+  test_get_bursts_batch( port );
+
+  test_get_bursts_zero_copy( port );
+
   CPPUNIT_ASSERT_NO_THROW( port );
 
 }
@@ -367,6 +483,10 @@ Burstio_InPort::test_int64()
 
   test_push_flush_sequence( port );
 
+  test_get_bursts_batch( port );
+
+  test_get_bursts_zero_copy( port );
+
   CPPUNIT_ASSERT_NO_THROW( port );
 
 }
@@ -389,6 +509,10 @@ Burstio_InPort::test_uint8()
 
   test_push_flush_sequence( port );
 
+  test_get_bursts_batch( port );
+
+  test_get_bursts_zero_copy( port );
+
   CPPUNIT_ASSERT_NO_THROW( port );
 
 }
@@ -410,6 +534,10 @@ Burstio_InPort::test_uint16()
 
   test_push_flush_sequence( port );
 
+  test_get_bursts_batch( port );
+
+  test_get_bursts_zero_copy( port );
+
   CPPUNIT_ASSERT_NO_THROW( port );
 
 }
@@ -432,6 +560,10 @@ Burstio_InPort::test_uint32()
 
   test_push_flush_sequence( port );
 
+  test_get_bursts_batch( port );
+
+  test_get_bursts_zero_copy( port );
+
   CPPUNIT_ASSERT_NO_THROW( port );
 
 }
@@ -454,6 +586,10 @@ Burstio_InPort::test_uint64()
 
   test_push_flush_sequence( port );
 
+  test_get_bursts_batch( port );
+
+  test_get_bursts_zero_copy( port );
+
   CPPUNIT_ASSERT_NO_THROW( port );
 
 }
@@ -478,6 +614,10 @@ Burstio_InPort::test_float()
 
   test_push_flush_sequence( port );
 
+  test_get_bursts_batch( port );
+
+  test_get_bursts_zero_copy( port );
+
   CPPUNIT_ASSERT_NO_THROW( port );
 
 }
@@ -502,6 +642,10 @@ Burstio_InPort::test_double()
 
   test_push_flush_sequence( port );
 
+  test_get_bursts_batch( port );
+
+  test_get_bursts_zero_copy( port );
+
   CPPUNIT_ASSERT_NO_THROW( port );
 
 }
@@ -78,6 +78,8 @@ public:
 
   template < typename T > void test_port_api( T *port );
   template < typename T > void test_push_flush_sequence( T *port );
+  template < typename T > void test_get_bursts_batch( T *port );
+  template < typename T > void test_get_bursts_zero_copy( T *port );
   
   BURSTIO::BurstSRI make_sri_test(const  std::string &sid, const std::string &id );
   BURSTIO::BurstSRI make_sri_pkt1();
@@ -194,6 +194,76 @@ void LocalTest<OutPort,InPort>::testFanOut()
     }
 }
 
+template <class OutPort,class InPort>
+void LocalTest<OutPort,InPort>::testLatencyFlush()
+{
+    // With a short latency threshold and a large burst count, a single burst
+    // should be sent by the latency timer
+    outPort->setMaxBursts(100);
+    outPort->setLatencyThreshold(1000);
+    _pushTestBurst();
+
+    boost::scoped_ptr<PacketType> burst(inPort->getBurst(1.0));
+    CPPUNIT_ASSERT(burst);
+
+    redhawk::PropertyMap stats = _getStatistics();
+    CPPUNIT_ASSERT_EQUAL((CORBA::ULongLong) 1, stats["FLUSH_LATENCY"].toULongLong());
+    CPPUNIT_ASSERT_EQUAL((CORBA::ULongLong) 0, stats["FLUSH_BATCH_SIZE"].toULongLong());
+    CPPUNIT_ASSERT_EQUAL(100.0, stats["BATCH_SIZE"].toDouble());
+}
+
+template <class OutPort,class InPort>
+void LocalTest<OutPort,InPort>::testAdaptiveBatching()
+{
+    // Make room in the input queue for all of the bursts
+    inPort->setQueueThreshold(2000);
+
+    outPort->setMaxBursts(100);
+    outPort->setLatencyThreshold(1000000);
+    outPort->setAdaptiveBatching(true);
+    CPPUNIT_ASSERT(outPort->getAdaptiveBatching());
+
+    // Before the arrival rate is known, bursts should go out immediately
+    // instead of waiting for the (long) latency threshold
+    _pushTestBurst();
+    CPPUNIT_ASSERT_EQUAL((size_t) 1, inPort->getQueueDepth());
+    redhawk::PropertyMap stats = _getStatistics();
+    CPPUNIT_ASSERT_EQUAL((CORBA::ULongLong) 1, stats["FLUSH_BATCH_SIZE"].toULongLong());
+
+    // A fast stream of bursts should be batched, within the max bursts
+    for (size_t ii = 0; ii < 1000; ++ii) {
+        _pushTestBurst();
+    }
+    size_t batch_size = outPort->getDefaultPolicy()->getBatchSize();
+    CPPUNIT_ASSERT(batch_size >= 1);
+    CPPUNIT_ASSERT(batch_size <= 100);
+    outPort->flush();
+    CPPUNIT_ASSERT_EQUAL((size_t) 1001, inPort->getQueueDepth());
+
+    // Disabling adaptive batching restores the fixed batch size
+    outPort->setAdaptiveBatching(false);
+    CPPUNIT_ASSERT_EQUAL((size_t) 100, outPort->getDefaultPolicy()->getBatchSize());
+}
+
+template <class OutPort,class InPort>
+void LocalTest<OutPort,InPort>::_pushTestBurst(bool eos)
+{
+    BurstType burst;
+    burst.SRI = burstio::utils::createSRI("test_stream");
+    burst.data.length(10);
+    burst.T = burstio::utils::now();
+    burst.EOS = eos;
+    outPort->pushBurst(burst);
+}
+
+template <class OutPort,class InPort>
+redhawk::PropertyMap LocalTest<OutPort,InPort>::_getStatistics()
+{
+    BULKIO::UsesPortStatisticsSequence_var stats = outPort->statistics();
+    CPPUNIT_ASSERT_EQUAL((CORBA::ULong) 1, stats->length());
+    return redhawk::PropertyMap::cast(stats[0].statistics.keywords);
+}
+
 #define CREATE_TEST(x)                                                  \
     class Local##x##Test : public LocalTest<burstio::Burst##x##Out,burstio::Burst##x##In> \
     {                                                                   \
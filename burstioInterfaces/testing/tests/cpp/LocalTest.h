@@ -24,6 +24,7 @@
 
 #include <cppunit/extensions/HelperMacros.h>
 #include <ossie/debug.h>
+#include <ossie/PropertyMap.h>
 
 template <class OutPort, class InPort>
 class LocalTest : public CppUnit::TestFixture
@@ -32,6 +33,8 @@ class LocalTest : public CppUnit::TestFixture
     CPPUNIT_TEST(testPushBurst);
     CPPUNIT_TEST(testPushBursts);
     CPPUNIT_TEST(testFanOut);
+    CPPUNIT_TEST(testLatencyFlush);
+    CPPUNIT_TEST(testAdaptiveBatching);
     CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -41,6 +44,8 @@ public:
     void testPushBurst();
     void testPushBursts();
     void testFanOut();
+    void testLatencyFlush();
+    void testAdaptiveBatching();
 
 protected:
     typedef typename OutPort::BurstType BurstType;
@@ -50,6 +55,9 @@ protected:
 
     virtual std::string getPortName() const = 0;
 
+    void _pushTestBurst(bool eos=false);
+    redhawk::PropertyMap _getStatistics();
+
     OutPort* outPort;
     InPort* inPort;
 
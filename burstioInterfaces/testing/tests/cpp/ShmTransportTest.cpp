@@ -0,0 +1,194 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK burstioInterfaces.
+ *
+ * REDHAWK burstioInterfaces is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK burstioInterfaces is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+#include "ShmTransportTest.h"
+
+#include <algorithm>
+
+#include <boost/scoped_ptr.hpp>
+
+#include <bulkio/bulkio_time_operators.h>
+
+template <class Traits>
+void ShmTransportTest<Traits>::setUp()
+{
+    std::string name = "burst_shm";
+    outPort = new OutPortType(name + "_out");
+    inPort = new InPortType(name + "_in");
+    inPort->setQueueThreshold(1000);
+
+    PortableServer::ObjectId_var oid = ossie::corba::RootPOA()->activate_object(inPort);
+    objref = inPort->_this();
+    inPort->start();
+
+    outManager = new burstio::ShmOutputManager<Traits>(outPort);
+    inManager = new burstio::ShmInputManager<Traits>(inPort);
+    outTransport = 0;
+    inTransport = 0;
+}
+
+template <class Traits>
+void ShmTransportTest<Traits>::tearDown()
+{
+    if (outTransport) {
+        outTransport->disconnect();
+    }
+    if (inTransport) {
+        inTransport->stopTransport();
+    }
+    delete outTransport;
+    delete inTransport;
+    delete outManager;
+    delete inManager;
+
+    inPort->stop();
+    try {
+        PortableServer::ObjectId_var oid = ossie::corba::RootPOA()->servant_to_id(inPort);
+        ossie::corba::RootPOA()->deactivate_object(oid);
+    } catch (...) {
+        // Ignore CORBA exceptions
+    }
+    inPort->_remove_ref();
+
+    delete outPort;
+}
+
+template <class Traits>
+void ShmTransportTest<Traits>::_connect()
+{
+    CF::Properties transport_props = inManager->transportProperties();
+    redhawk::UsesTransport* transport = outManager->createUsesTransport(objref.in(), "shm_connection",
+                                                                        redhawk::PropertyMap::cast(transport_props));
+    outTransport = dynamic_cast<burstio::BurstTransport<Traits>*>(transport);
+    CPPUNIT_ASSERT(outTransport);
+    inTransport = inManager->createProvidesTransport("shm_transport", outManager->getNegotiationProperties(outTransport));
+    CPPUNIT_ASSERT(inTransport);
+    inTransport->startTransport();
+    outManager->setNegotiationResult(outTransport, inManager->getNegotiationProperties(inTransport));
+}
+
+template <class Traits>
+void ShmTransportTest<Traits>::_pushBursts(size_t count, size_t length, size_t first)
+{
+    BurstSequenceType bursts;
+    for (size_t index = 0; index < count; ++index) {
+        BurstType burst;
+        burst.SRI = burstio::utils::createSRI("shm_stream");
+        burst.data.length(length);
+        std::fill(burst.data.get_buffer(), burst.data.get_buffer() + length, (first + index) % 100);
+        burst.T = burstio::utils::now();
+        burst.EOS = false;
+        ossie::corba::push_back(bursts, burst);
+    }
+    outTransport->pushBursts(bursts, boost::get_system_time(), 0.0);
+}
+
+template <class Traits>
+void ShmTransportTest<Traits>::testPushBursts()
+{
+    _connect();
+    CPPUNIT_ASSERT_EQUAL(std::string("shmipc"), outTransport->transportType());
+
+    // Bursts of different lengths, so that the payloads land at different
+    // offsets in the shared memory block
+    BurstSequenceType bursts;
+    for (size_t index = 0; index < 24; ++index) {
+        BurstType burst;
+        burst.SRI = burstio::utils::createSRI("shm_stream");
+        burst.data.length(index * 7 + 1);
+        std::fill(burst.data.get_buffer(), burst.data.get_buffer() + burst.data.length(), index);
+        burst.T = burstio::utils::now();
+        burst.EOS = (index == 23);
+        ossie::corba::push_back(bursts, burst);
+    }
+    outTransport->pushBursts(bursts, boost::get_system_time(), 0.0);
+
+    for (CORBA::ULong index = 0; index < bursts.length(); ++index) {
+        boost::scoped_ptr<PacketType> burst(inPort->getBurst(1.0));
+        CPPUNIT_ASSERT(burst);
+        CPPUNIT_ASSERT_EQUAL(std::string("shm_stream"), burst->getStreamID());
+        CPPUNIT_ASSERT_EQUAL((size_t) bursts[index].data.length(), burst->getSize());
+        CPPUNIT_ASSERT(burst->getData()[0] == index);
+        CPPUNIT_ASSERT(burst->getData()[burst->getSize() - 1] == index);
+        CPPUNIT_ASSERT_EQUAL(bursts[index].T, burst->getTime());
+        CPPUNIT_ASSERT_EQUAL((bool) bursts[index].EOS, burst->getEOS());
+    }
+}
+
+template <class Traits>
+void ShmTransportTest<Traits>::testManyBatches()
+{
+    _connect();
+
+    // Send more batches than there are slots in the descriptor ring, so that
+    // the uses side has to wait for the provides side to catch up and the
+    // indices wrap around
+    const size_t count = 256;
+    for (size_t index = 0; index < count; ++index) {
+        _pushBursts(1, 16, index);
+    }
+
+    for (size_t index = 0; index < count; ++index) {
+        boost::scoped_ptr<PacketType> burst(inPort->getBurst(1.0));
+        CPPUNIT_ASSERT(burst);
+        CPPUNIT_ASSERT_EQUAL((size_t) 16, burst->getSize());
+        CPPUNIT_ASSERT(burst->getData()[0] == (index % 100));
+    }
+}
+
+template <class Traits>
+void ShmTransportTest<Traits>::testEmptyBurst()
+{
+    _connect();
+
+    // An empty end-of-stream burst has no payload in the block
+    BurstSequenceType bursts;
+    BurstType burst;
+    burst.SRI = burstio::utils::createSRI("shm_stream");
+    burst.T = burstio::utils::now();
+    burst.EOS = true;
+    ossie::corba::push_back(bursts, burst);
+    outTransport->pushBursts(bursts, boost::get_system_time(), 0.0);
+
+    boost::scoped_ptr<PacketType> packet(inPort->getBurst(1.0));
+    CPPUNIT_ASSERT(packet);
+    CPPUNIT_ASSERT_EQUAL((size_t) 0, packet->getSize());
+    CPPUNIT_ASSERT(packet->getEOS());
+}
+
+#define CREATE_TEST(x)                                                  \
+    class Shm##x##Test : public ShmTransportTest<burstio::x##Traits>    \
+    {                                                                   \
+        typedef ShmTransportTest<burstio::x##Traits> TestBase;          \
+        CPPUNIT_TEST_SUB_SUITE(Shm##x##Test, TestBase);                 \
+        CPPUNIT_TEST_SUITE_END();                                       \
+    };                                                                  \
+    CPPUNIT_TEST_SUITE_REGISTRATION(Shm##x##Test);
+
+CREATE_TEST(Byte);
+CREATE_TEST(Ubyte);
+CREATE_TEST(Short);
+CREATE_TEST(Ushort);
+CREATE_TEST(Long);
+CREATE_TEST(Ulong);
+CREATE_TEST(LongLong);
+CREATE_TEST(UlongLong);
+CREATE_TEST(Float);
+CREATE_TEST(Double);
@@ -0,0 +1,71 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK burstioInterfaces.
+ *
+ * REDHAWK burstioInterfaces is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK burstioInterfaces is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+#ifndef BURSTIO_SHMTRANSPORTTEST_H
+#define BURSTIO_SHMTRANSPORTTEST_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <burstio/burstio.h>
+
+#include "ShmTransport.h"
+#include "OutPortImpl.h"
+
+template <class Traits>
+class ShmTransportTest : public CppUnit::TestFixture
+{
+    CPPUNIT_TEST_SUITE(ShmTransportTest);
+    CPPUNIT_TEST(testPushBursts);
+    CPPUNIT_TEST(testManyBatches);
+    CPPUNIT_TEST(testEmptyBurst);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp();
+    void tearDown();
+
+    void testPushBursts();
+    void testManyBatches();
+    void testEmptyBurst();
+
+protected:
+    typedef burstio::OutPort<Traits> OutPortType;
+    typedef burstio::InPort<Traits> InPortType;
+    typedef typename Traits::BurstType BurstType;
+    typedef typename Traits::BurstSequenceType BurstSequenceType;
+    typedef typename InPortType::PacketType PacketType;
+
+    // Creates the shmipc transport pair directly from the managers
+    void _connect();
+
+    // Sends a single batch of count bursts, with the burst index (offset by
+    // first) in every element
+    void _pushBursts(size_t count, size_t length, size_t first=0);
+
+    OutPortType* outPort;
+    InPortType* inPort;
+    typename Traits::PortType::_var_type objref;
+
+    burstio::ShmOutputManager<Traits>* outManager;
+    burstio::ShmInputManager<Traits>* inManager;
+    burstio::BurstTransport<Traits>* outTransport;
+    redhawk::ProvidesTransport* inTransport;
+};
+
+#endif  // BURSTIO_SHMTRANSPORTTEST_H
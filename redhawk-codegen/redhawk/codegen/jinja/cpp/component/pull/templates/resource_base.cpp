@@ -160,6 +160,16 @@ void ${className}::stop() throw (CORBA::SystemException, CF::Resource::StopError
 }
 /*{% endblock %}*/
 
+void ${className}::portDataArrived()
+{
+    ThreadedComponent::eventArrived();
+}
+
+void ${className}::propertyChanged(const std::string& id)
+{
+    ThreadedComponent::eventArrived();
+}
+
 /*{% block releaseObject %}*/
 void ${className}::releaseObject() throw (CORBA::SystemException, CF::LifeCycle::ReleaseError)
 {
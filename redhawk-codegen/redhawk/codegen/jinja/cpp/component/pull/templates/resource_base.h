@@ -104,6 +104,10 @@ class ${className} : public ${component.superclasses|join(', public ', attribute
 
     protected:
 /*{% block baseProtectedFunctions %}*/
+        // Wake the processing thread on input events in event-driven mode
+        void portDataArrived();
+        void propertyChanged(const std::string& id);
+
 /*{%   if component.hasmultioutport %}*/
         void connectionTableChanged(const std::vector<connection_descriptor_struct>* oldValue, const std::vector<connection_descriptor_struct>* newValue);
 
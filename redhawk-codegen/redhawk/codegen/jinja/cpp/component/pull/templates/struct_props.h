@@ -35,6 +35,7 @@
 #include <ossie/CorbaUtils.h>
 #include <CF/cf.h>
 #include <ossie/PropertyMap.h>
+#include <ossie/BinaryCodec.h>
 /*{% set isSet = False %}*/
 /*{% for struct in component.structdefs %}*/
 /*{%   for field in struct.fields %}*/
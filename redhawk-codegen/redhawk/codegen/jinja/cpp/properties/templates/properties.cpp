@@ -108,6 +108,19 @@ struct ${struct.cpptype}${' : public '+struct.baseclass if struct.baseclass} {
     static const char* getFormat() {
         return "${struct.format}";
     }
+
+    void encode(redhawk::BinaryEncoder& encoder) const {
+/*{% for field in struct.fields %}*/
+        encoder << ${field.cppname};
+/*{% endfor %}*/
+    }
+
+    bool decode(redhawk::BinaryDecoder& decoder) {
+/*{% for field in struct.fields %}*/
+        decoder >> ${field.cppname};
+/*{% endfor %}*/
+        return decoder.ok();
+    }
 /*{% for field in struct.fields if not field.inherited %}*/
 /*{%   if loop.first %}*/
 
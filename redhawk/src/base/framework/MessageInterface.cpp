@@ -18,11 +18,102 @@
  * along with this program.  If not, see http://www.gnu.org/licenses/.
  */
 
+#include <cstring>
+
+#include <boost/thread/thread.hpp>
+
 #include <ossie/MessageInterface.h>
 #include <ossie/PropertyMap.h>
 
+#include "MessageRing.h"
+
 PREPARE_CF_LOGGING(MessageConsumerPort)
 
+/*
+ * Reads messages from a shared memory ring created by a MessageSupplierPort
+ * in another process, and dispatches them on its own thread.
+ */
+class MessageConsumerPort::ShmReader
+{
+public:
+    ShmReader(MessageConsumerPort* port, const std::string& name) :
+        _port(port),
+        _running(true),
+        _finished(false)
+    {
+        _ring.open(name);
+    }
+
+    ~ShmReader()
+    {
+        stop();
+    }
+
+    void start(const std::string& info)
+    {
+        _ring.setConsumerInfo(info.data(), info.size());
+        _thread = boost::thread(&ShmReader::run, this);
+    }
+
+    void stop()
+    {
+        _running = false;
+        _ring.close();
+        if (_thread.joinable()) {
+            _thread.join();
+        }
+    }
+
+    bool isFinished() const
+    {
+        return _finished;
+    }
+
+private:
+    void run()
+    {
+        while (_running) {
+            const redhawk::MessageRing::Record* record = _ring.beginRead(100);
+            if (!record) {
+                // Timed out or closed; if the supplier has gone away without
+                // closing the ring, there is nothing left to read
+                if (_ring.isClosed() || !_ring.isPeerAlive()) {
+                    break;
+                }
+                continue;
+            }
+
+            const std::string id(record->id(), record->idLength);
+            try {
+                if (record->type == redhawk::MessageRing::RECORD_BINARY) {
+                    if (!_port->dispatchBinary(id, record->payload(), record->length)) {
+                        _ring.reportError();
+                    }
+                } else {
+                    cdrMemoryStream stream(const_cast<char*>(record->payload()), record->length);
+                    CORBA::Any data;
+                    data <<= stream;
+                    _port->fireCallback(id, data);
+                }
+            } catch (const std::exception& exc) {
+                RH_NL_ERROR("MessageConsumerPort", "Error dispatching message '" << id << "': " << exc.what());
+                _ring.reportError();
+            } catch (const CORBA::Exception& exc) {
+                RH_NL_ERROR("MessageConsumerPort", "Error dispatching message '" << id << "': " << exc._name());
+                _ring.reportError();
+            }
+            _ring.commitRead();
+        }
+        _finished = true;
+    }
+
+    MessageConsumerPort* _port;
+    redhawk::MessageRing _ring;
+    volatile bool _running;
+    volatile bool _finished;
+    boost::thread _thread;
+};
+
 Consumer_i::Consumer_i(MessageConsumerPort *_parent) {
     parent = _parent;
 }
@@ -31,6 +122,15 @@ Consumer_i::Consumer_i(MessageConsumerPort *_parent) {
 void Consumer_i::push(const CORBA::Any& data) {
     CF::Properties* temp;
     if (!(data >>= temp)) {
+        // Suppliers in the same host may ask to send messages through shared
+        // memory; this is the only message that is not a CF::Properties
+        const CF::DataType* request;
+        if ((data >>= request) && (strcmp(request->id, redhawk::MessageRing::NEGOTIATION_ID) == 0)) {
+            const CF::Properties* properties;
+            if (request->value >>= properties) {
+                parent->attachShmReader(*properties);
+            }
+        }
         return;
     }
     CF::Properties& props = *temp;
@@ -77,6 +177,8 @@ MessageConsumerPort::MessageConsumerPort(std::string port_name) :
 
 MessageConsumerPort::~MessageConsumerPort()
 {
+    detachShmReaders();
+
     // If a SupplierAdmin was created, deactivate and delete it
     if (supplier_admin) {
         PortableServer::POA_var poa = supplier_admin->_default_POA();
@@ -190,6 +292,8 @@ void MessageConsumerPort::fireCallback (const std::string& id, const CORBA::Any&
 
     // Invoke the callback for those messages that are generic
     dispatchGeneric(id, data);
+
+    _dataArrived();
 };
 
 MessageConsumerPort::MessageCallback* MessageConsumerPort::getMessageCallback(const std::string& id)
@@ -211,6 +315,103 @@ void MessageConsumerPort::dispatchGeneric(const std::string& id, const CORBA::An
     generic_callbacks_(id, data);
 }
 
+CORBA::Boolean MessageConsumerPort::_is_a(const char* repoId)
+{
+    if (strcmp(repoId, redhawk::MessageRing::CAPABILITY_ID) == 0) {
+        return true;
+    }
+    return POA_ExtendedEvent::MessageEvent::_is_a(repoId);
+}
+
+void MessageConsumerPort::attachShmReader(const CF::Properties& properties)
+{
+    const redhawk::PropertyMap& props = redhawk::PropertyMap::cast(properties);
+    if (props.get("hostname", "").toString() != redhawk::MessageRing::hostname()) {
+        RH_NL_TRACE("MessageConsumerPort", "Shared memory message supplier is on another host");
+        return;
+    }
+
+    ShmReader* reader;
+    try {
+        reader = new ShmReader(this, props.get("ring", "").toString());
+    } catch (const std::exception& exc) {
+        RH_NL_DEBUG("MessageConsumerPort", "Unable to open shared memory message ring: " << exc.what());
+        return;
+    }
+
+    boost::mutex::scoped_lock lock(portInterfaceAccess);
+
+    // Clean up readers whose suppliers have disconnected
+    for (std::vector<ShmReader*>::iterator iter = shm_readers_.begin(); iter != shm_readers_.end(); ) {
+        if ((*iter)->isFinished()) {
+            delete *iter;
+            iter = shm_readers_.erase(iter);
+        } else {
+            ++iter;
+        }
+    }
+
+    reader->start(describeCallbacks());
+    shm_readers_.push_back(reader);
+}
+
+void MessageConsumerPort::detachShmReaders()
+{
+    std::vector<ShmReader*> readers;
+    {
+        boost::mutex::scoped_lock lock(portInterfaceAccess);
+        readers.swap(shm_readers_);
+    }
+    for (std::vector<ShmReader*>::iterator reader = readers.begin(); reader != readers.end(); ++reader) {
+        delete *reader;
+    }
+}
+
+std::string MessageConsumerPort::describeCallbacks()
+{
+    // Tell the supplier which messages can be sent in binary form: those with
+    // a typed callback whose struct supports it, as long as there are no
+    // generic callbacks (which need a CORBA::Any anyway)
+    redhawk::BinaryEncoder encoder;
+    encoder << hasGenericCallbacks();
+    std::vector<std::string> ids;
+    std::vector<std::string> formats;
+    for (CallbackTable::iterator callback = callbacks_.begin(); callback != callbacks_.end(); ++callback) {
+        if (callback->second->supportsBinary()) {
+            ids.push_back(callback->first);
+            formats.push_back(callback->second->format());
+        }
+    }
+    encoder << ids << formats;
+    return std::string(encoder.data(), encoder.size());
+}
+
+bool MessageConsumerPort::dispatchBinary(const std::string& id, const char* data, size_t size)
+{
+    MessageCallback* callback = getMessageCallback(id);
+    if (!callback) {
+        LOG_WARN(MessageConsumerPort, "no callbacks registered for binary message with id: " << id);
+        return false;
+    }
+
+    // The supplier only sends binary messages when there were no generic
+    // callbacks at the time of connection; if any have been added since, they
+    // still get a CORBA::Any
+    redhawk::BinaryDecoder decoder(data, size);
+    bool generic = hasGenericCallbacks();
+    CORBA::Any any;
+    if (!callback->dispatch(id, decoder, generic ? &any : 0)) {
+        LOG_WARN(MessageConsumerPort, "unable to decode binary message with id: " << id);
+        return false;
+    }
+    if (generic) {
+        dispatchGeneric(id, any);
+    }
+
+    _dataArrived();
+    return true;
+}
+
 std::string MessageConsumerPort::getRepid() const 
 {
     return ExtendedEvent::MessageEvent::_PD_repoId;
@@ -0,0 +1,231 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK core.
+ *
+ * REDHAWK core is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK core is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+#include "MessageRing.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include <unistd.h>
+#include <limits.h>
+
+#include <ossie/shm/MappedFile.h>
+
+// Identifies message rings, as opposed to other users of redhawk::shm::Ring
+#define RING_TYPE 0x4d534752
+
+// Records start on boundaries of the record header size, so that there is
+// always room for a pad record at the end of the ring
+#define RECORD_ALIGN sizeof(MessageRing::Record)
+
+using namespace redhawk;
+
+namespace {
+    inline size_t align_record(size_t bytes)
+    {
+        return (bytes + RECORD_ALIGN - 1) & ~(size_t)(RECORD_ALIGN - 1);
+    }
+}
+
+// Consumer description, kept in the ring's extra header area
+struct MessageRing::Info {
+    volatile uint32_t infoSize;
+    volatile int32_t attached;
+    char info[MessageRing::INFO_SIZE];
+};
+
+const char* const MessageRing::CAPABILITY_ID = "IDL:REDHAWK/MessageRing:1.0";
+const char* const MessageRing::NEGOTIATION_ID = "REDHAWK::MessageRing::attach";
+
+const size_t MessageRing::DEFAULT_CAPACITY;
+const size_t MessageRing::INFO_SIZE;
+
+std::string MessageRing::hostname()
+{
+    char host[HOST_NAME_MAX+1];
+    gethostname(host, sizeof(host));
+    return host;
+}
+
+MessageRing::MessageRing() :
+    _ring()
+{
+}
+
+MessageRing::~MessageRing()
+{
+}
+
+void MessageRing::create(size_t capacity)
+{
+    capacity = std::max(capacity, redhawk::shm::MappedFile::PAGE_SIZE);
+    _ring.create("redhawk-msgring", RING_TYPE, capacity, sizeof(Info));
+}
+
+void MessageRing::open(const std::string& name)
+{
+    _ring.open(name, RING_TYPE, sizeof(Info));
+}
+
+const std::string& MessageRing::name() const
+{
+    return _ring.name();
+}
+
+void MessageRing::unlink()
+{
+    _ring.unlink();
+}
+
+void MessageRing::setConsumerInfo(const char* info, size_t size)
+{
+    Info* shared = _getInfo();
+    size = std::min(size, INFO_SIZE);
+    std::memcpy(shared->info, info, size);
+    shared->infoSize = size;
+    __sync_synchronize();
+    shared->attached = 1;
+}
+
+bool MessageRing::isAttached() const
+{
+    return _getInfo()->attached;
+}
+
+std::string MessageRing::consumerInfo() const
+{
+    const Info* shared = _getInfo();
+    __sync_synchronize();
+    return std::string(shared->info, shared->infoSize);
+}
+
+size_t MessageRing::maxRecordSize() const
+{
+    // Limit records to half the ring so that a record never has to wait for
+    // more than one wrap-around pad record to be consumed
+    return (_ring.capacity() / 2) - sizeof(Record);
+}
+
+bool MessageRing::write(RecordType type, const std::string& id, const char* data, size_t length)
+{
+    if (id.size() > 0xFFFF) {
+        throw std::length_error("message ID is too long for ring");
+    }
+    const size_t id_bytes = (id.size() + 7) & ~7;
+    const size_t bytes = align_record(sizeof(Record) + id_bytes + length);
+    if ((bytes - sizeof(Record)) > maxRecordSize()) {
+        throw std::length_error("message is too large for ring");
+    }
+
+    // Records are never split across the end of the ring; if the remaining
+    // space is too small, fill it with a pad record and start at the
+    // beginning
+    uint64_t head = _ring.head();
+    const size_t offset = head & (_ring.capacity() - 1);
+    const size_t contiguous = _ring.capacity() - offset;
+    const size_t pad = (contiguous < bytes) ? contiguous : 0;
+    if (!_ring.waitSpace(pad + bytes)) {
+        return false;
+    }
+
+    if (pad) {
+        Record* record = _getRecord(head);
+        record->size = pad;
+        record->length = 0;
+        record->type = RECORD_PAD;
+        record->idLength = 0;
+        head += pad;
+    }
+
+    Record* record = _getRecord(head);
+    record->size = bytes;
+    record->length = length;
+    record->type = type;
+    record->idLength = id.size();
+    std::memcpy(const_cast<char*>(record->id()), id.data(), id.size());
+    std::memcpy(const_cast<char*>(record->payload()), data, length);
+
+    _ring.publish(head + bytes);
+    return true;
+}
+
+bool MessageRing::waitEmpty()
+{
+    return _ring.waitSpace(_ring.capacity());
+}
+
+const MessageRing::Record* MessageRing::beginRead(int timeout)
+{
+    while (_ring.waitData(timeout)) {
+        Record* record = _getRecord(_ring.tail());
+        if (record->type != RECORD_PAD) {
+            return record;
+        }
+        commitRead();
+    }
+    return 0;
+}
+
+void MessageRing::commitRead()
+{
+    const uint64_t tail = _ring.tail();
+    _ring.release(tail + _getRecord(tail)->size);
+}
+
+bool MessageRing::isPeerAlive() const
+{
+    return _ring.isPeerAlive();
+}
+
+void MessageRing::reportError()
+{
+    _ring.reportError();
+}
+
+uint32_t MessageRing::errorCount() const
+{
+    return _ring.errorCount();
+}
+
+void MessageRing::close()
+{
+    _ring.close();
+}
+
+bool MessageRing::isClosed() const
+{
+    return _ring.isClosed();
+}
+
+void MessageRing::detach()
+{
+    _ring.detach();
+}
+
+MessageRing::Info* MessageRing::_getInfo() const
+{
+    return static_cast<Info*>(_ring.extra());
+}
+
+MessageRing::Record* MessageRing::_getRecord(uint64_t offset) const
+{
+    return reinterpret_cast<Record*>(_ring.at(offset));
+}
@@ -0,0 +1,156 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK core.
+ *
+ * REDHAWK core is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK core is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+#ifndef REDHAWK_MESSAGERING_H
+#define REDHAWK_MESSAGERING_H
+
+#include <cstddef>
+#include <string>
+#include <stdint.h>
+
+#include <ossie/shm/Ring.h>
+
+namespace redhawk {
+
+    // Single-producer, single-consumer ring of variable-length message records
+    // in shared memory, used to pass messages between a MessageSupplierPort
+    // and a MessageConsumerPort in different processes on the same host.
+    //
+    // The supplier creates the ring and asks the consumer to open it with a
+    // negotiation message sent over the existing CORBA connection. The
+    // consumer opens the ring and publishes a description of the messages it
+    // can decode (see setConsumerInfo()) before returning from the push, so
+    // the supplier knows whether the ring is usable as soon as the push
+    // completes.
+    //
+    // The ring itself is a redhawk::shm::Ring; this class adds the record
+    // format and the consumer's description.
+    class MessageRing {
+    public:
+        // Repository ID that a MessageConsumerPort claims to implement (via
+        // _is_a) if it can receive messages over a ring
+        static const char* const CAPABILITY_ID;
+
+        // Message ID of the negotiation message; the value is a CF::Properties
+        // with the supplier's "hostname" and the "ring" name
+        static const char* const NEGOTIATION_ID;
+
+        enum RecordType {
+            RECORD_PAD = 0,
+            RECORD_BINARY = 1,
+            RECORD_ANY = 2
+        };
+
+        struct Record {
+            uint32_t size;
+            uint32_t length;
+            uint16_t type;
+            uint16_t idLength;
+            uint32_t reserved;
+
+            const char* id() const
+            {
+                return reinterpret_cast<const char*>(this + 1);
+            }
+
+            // The payload starts on an 8-byte boundary, so that it can be
+            // decoded in place
+            const char* payload() const
+            {
+                return id() + ((idLength + 7) & ~7);
+            }
+        };
+
+        static const size_t DEFAULT_CAPACITY = 1048576;
+        static const size_t INFO_SIZE = 4096;
+
+        // Name of this host, which must match on both sides of the ring
+        static std::string hostname();
+
+        MessageRing();
+        ~MessageRing();
+
+        // Supplier side: create a new ring file and map it
+        void create(size_t capacity=DEFAULT_CAPACITY);
+
+        // Consumer side: map an existing ring file created by the supplier
+        void open(const std::string& name);
+
+        const std::string& name() const;
+
+        // Remove the ring file from the file system; once the consumer has
+        // mapped the ring, this can be done without affecting the connection
+        void unlink();
+
+        // Consumer side: publish the consumer's description and mark the ring
+        // as attached; info is truncated to INFO_SIZE
+        void setConsumerInfo(const char* info, size_t size);
+
+        // Supplier side: check whether the consumer has attached, and get its
+        // description
+        bool isAttached() const;
+        std::string consumerInfo() const;
+
+        // Largest record (message ID plus payload) that the ring can hold
+        size_t maxRecordSize() const;
+
+        // Writer interface: blocks until there is room for the record; returns
+        // false if the ring is closed or the reader has exited
+        bool write(RecordType type, const std::string& id, const char* data, size_t length);
+
+        // Writer interface: blocks until the reader has consumed every record;
+        // returns false if the ring is closed or the reader has exited
+        bool waitEmpty();
+
+        // Reader interface: beginRead() blocks for up to timeout milliseconds
+        // for a record, returning a null pointer on timeout or close;
+        // commitRead() releases the record back to the writer
+        const Record* beginRead(int timeout);
+        void commitRead();
+
+        // Returns true if the process on the other side of the ring exists
+        bool isPeerAlive() const;
+
+        // Asynchronous error reporting from the reader to the writer
+        void reportError();
+        uint32_t errorCount() const;
+
+        // Mark the ring as closed from either side, waking the other side if
+        // it is waiting
+        void close();
+        bool isClosed() const;
+
+        void detach();
+
+    private:
+        struct Info;
+
+        // Non-copyable, non-assignable
+        MessageRing(const MessageRing&);
+        MessageRing& operator=(const MessageRing&);
+
+        Info* _getInfo() const;
+        Record* _getRecord(uint64_t offset) const;
+
+        redhawk::shm::Ring _ring;
+    };
+}
+
+#endif // REDHAWK_MESSAGERING_H
@@ -18,14 +18,25 @@
  * along with this program.  If not, see http://www.gnu.org/licenses/.
  */
 
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <sstream>
+
+#include <boost/thread/thread.hpp>
+#include <boost/thread/condition_variable.hpp>
+
 #include <ossie/MessageInterface.h>
 #include <ossie/PropertyMap.h>
 
+#include "MessageRing.h"
+
 class MessageSupplierPort::MessageTransport : public redhawk::UsesTransport
 {
 public:
     MessageTransport(MessageSupplierPort* port) :
-        redhawk::UsesTransport(port)
+        redhawk::UsesTransport(port),
+        _supplier(port)
     {
     }
 
@@ -33,13 +44,28 @@ public:
     {
     }
 
+    void disconnect()
+    {
+        // The publishing thread sends outside of the port lock, so wait for
+        // any batch in progress before tearing down the connection
+        boost::mutex::scoped_lock lock(_supplier->_publishMutex);
+        _disconnect();
+    }
+
     virtual void push(const CORBA::Any& data) = 0;
 
     virtual void beginQueue(size_t count) = 0;
-    virtual void queueMessage(const std::string& msgId, const char* format, const void* msgData, MessageSupplierPort::SerializerFunc serializer) = 0;
+    virtual void queueMessage(const std::string& msgId, const char* format, const void* msgData,
+                              MessageSupplierPort::SerializerFunc serializer, MessageSupplierPort::EncoderFunc encoder) = 0;
     virtual void sendMessages() = 0;
 
+protected:
+    virtual void _disconnect()
+    {
+    }
+
 private:
+    MessageSupplierPort* _supplier;
     CosEventChannelAdmin::EventChannel_var _channel;
 };
 
@@ -83,7 +109,8 @@ public:
         }
     }
 
-    void queueMessage(const std::string& msgId, const char* /*unused*/, const void* msgData, MessageSupplierPort::SerializerFunc serializer)
+    void queueMessage(const std::string& msgId, const char* /*unused*/, const void* msgData,
+                      MessageSupplierPort::SerializerFunc serializer, MessageSupplierPort::EncoderFunc /*unused*/)
     {
         CORBA::ULong index = _queue.length();
         _queue.length(index+1);
@@ -123,7 +150,8 @@ public:
         }
     }
 
-    void disconnect()
+protected:
+    void _disconnect()
     {
         try {
             _consumer->disconnect_push_consumer();
@@ -172,7 +200,8 @@ public:
     {
     }
 
-    void queueMessage(const std::string& msgId, const char* format, const void* msgData, MessageSupplierPort::SerializerFunc serializer)
+    void queueMessage(const std::string& msgId, const char* format, const void* msgData,
+                      MessageSupplierPort::SerializerFunc serializer, MessageSupplierPort::EncoderFunc /*unused*/)
     {
         CallbackEntry* entry = getCallback(msgId, format);
         if (entry) {
@@ -238,6 +267,480 @@ private:
     CallbackTable _callbacks;
 };
 
+/*
+ * Sends messages to a MessageConsumerPort in another process on the same host
+ * through a shared memory ring. Messages are written in binary form when the
+ * consumer has a matching typed callback, and as CDR-encoded CORBA::Any
+ * otherwise. If the consumer cannot attach to the ring, or later stops
+ * reading it, messages go through the CORBA event channel interface instead.
+ */
+class MessageSupplierPort::ShmTransport : public MessageSupplierPort::CorbaTransport
+{
+public:
+    // Returns true if the channel is a consumer port that can receive messages
+    // through shared memory
+    static bool isSupported(CosEventChannelAdmin::EventChannel_ptr channel)
+    {
+        // Only message consumer ports can use shared memory; check the type
+        // in the object reference first, to avoid a remote _is_a call for
+        // every connection to a plain event channel. An empty type ID gives
+        // no information, so fall through to _is_a in that case.
+        const char* repo_id = ossie::corba::mostDerivedRepoId(channel);
+        if (repo_id && (*repo_id != '\0') && (strcmp(repo_id, ExtendedEvent::MessageEvent::_PD_repoId) != 0)) {
+            return false;
+        }
+        try {
+            return channel->_is_a(redhawk::MessageRing::CAPABILITY_ID);
+        } catch (...) {
+            return false;
+        }
+    }
+
+    ShmTransport(MessageSupplierPort* port, CosEventChannelAdmin::EventChannel_ptr channel) :
+        CorbaTransport(port, channel),
+        _attached(false),
+        _generic(true),
+        _errors(0),
+        _queueSize(0),
+        _corbaQueued(0)
+    {
+        _negotiate();
+    }
+
+    virtual std::string transportType() const
+    {
+        if (_attached) {
+            return "shmipc";
+        }
+        return CorbaTransport::transportType();
+    }
+
+    void push(const CORBA::Any& data)
+    {
+        CF::Properties* temp;
+        if (!_attached || !(data >>= temp)) {
+            // Anything other than a message sequence can only be sent over
+            // CORBA; wait for the consumer to finish the queued messages to
+            // preserve ordering
+            _waitEmpty();
+            CorbaTransport::push(data);
+            return;
+        }
+        const redhawk::PropertyMap& props = redhawk::PropertyMap::cast(*temp);
+        for (redhawk::PropertyMap::const_iterator msg = props.begin(); msg != props.end(); ++msg) {
+            _sendAny(msg->getId(), msg->getValue());
+        }
+        _checkErrors();
+    }
+
+    void beginQueue(size_t count)
+    {
+        // The CORBA queue is only started if a message cannot go through the
+        // ring
+        _queueSize = count;
+        _corbaQueued = 0;
+    }
+
+    void queueMessage(const std::string& msgId, const char* format, const void* msgData,
+                      MessageSupplierPort::SerializerFunc serializer, MessageSupplierPort::EncoderFunc encoder)
+    {
+        if (_attached && encoder && _isBinaryCompatible(msgId, format)) {
+            _encoder.clear();
+            encoder(_encoder, msgData);
+            if (_encoder.size() <= _maxPayloadSize(msgId)) {
+                if (_ring.write(redhawk::MessageRing::RECORD_BINARY, msgId, _encoder.data(), _encoder.size())) {
+                    return;
+                }
+                _ringFailed();
+            }
+        }
+
+        if (_attached) {
+            CORBA::Any data;
+            serializer(data, msgData);
+            _sendAny(msgId, data);
+        } else {
+            _queueCorba(msgId, format, msgData, serializer, encoder);
+        }
+    }
+
+    void sendMessages()
+    {
+        if (_corbaQueued > 0) {
+            _corbaQueued = 0;
+            CorbaTransport::sendMessages();
+        }
+        _checkErrors();
+    }
+
+protected:
+    void _disconnect()
+    {
+        if (_attached) {
+            _ring.close();
+            _attached = false;
+        }
+        CorbaTransport::_disconnect();
+    }
+
+private:
+    void _negotiate()
+    {
+        try {
+            _ring.create();
+        } catch (const std::exception& exc) {
+            RH_NL_DEBUG("MessageSupplierPort", "Unable to create shared memory message ring: " << exc.what());
+            return;
+        }
+
+        redhawk::PropertyMap properties;
+        properties["hostname"] = redhawk::MessageRing::hostname();
+        properties["ring"] = _ring.name();
+        CF::DataType request;
+        request.id = redhawk::MessageRing::NEGOTIATION_ID;
+        request.value <<= properties;
+        CORBA::Any data;
+        data <<= request;
+        try {
+            CorbaTransport::push(data);
+        } catch (...) {
+            // Treat as a refusal; any real problem with the connection will be
+            // reported on the first message
+        }
+
+        // The consumer opens the ring before returning from the push, after
+        // which the file is no longer needed
+        _attached = _ring.isAttached();
+        _ring.unlink();
+        if (!_attached) {
+            _ring.detach();
+            return;
+        }
+
+        // Read back the consumer's description of the messages it can
+        // decode in binary form
+        const std::string info = _ring.consumerInfo();
+        redhawk::BinaryDecoder decoder(info.data(), info.size());
+        std::vector<std::string> ids;
+        std::vector<std::string> formats;
+        decoder >> _generic >> ids >> formats;
+        if (!decoder.ok() || (ids.size() != formats.size())) {
+            _generic = true;
+            return;
+        }
+        for (size_t index = 0; index < ids.size(); ++index) {
+            _formats[ids[index]] = formats[index];
+        }
+    }
+
+    bool _isBinaryCompatible(const std::string& msgId, const char* format)
+    {
+        if (_generic) {
+            return false;
+        }
+        FormatTable::iterator entry = _formats.find(msgId);
+        if (entry == _formats.end()) {
+            return false;
+        }
+        return !entry->second.empty() && (entry->second == format);
+    }
+
+    size_t _maxPayloadSize(const std::string& msgId)
+    {
+        // Account for the message ID and its padding
+        const size_t id_bytes = (msgId.size() + 7) & ~7;
+        const size_t max_size = _ring.maxRecordSize();
+        if (id_bytes >= max_size) {
+            return 0;
+        }
+        return max_size - id_bytes;
+    }
+
+    void _sendAny(const std::string& msgId, const CORBA::Any& value)
+    {
+        if (_attached) {
+            cdrMemoryStream stream;
+            value >>= stream;
+            if (stream.bufSize() <= _maxPayloadSize(msgId)) {
+                if (_ring.write(redhawk::MessageRing::RECORD_ANY, msgId, static_cast<const char*>(stream.bufPtr()), stream.bufSize())) {
+                    return;
+                }
+                _ringFailed();
+            } else {
+                // Too large for the ring; send it over CORBA once everything
+                // ahead of it has been consumed
+                _waitEmpty();
+            }
+        }
+
+        CF::Properties message;
+        message.length(1);
+        message[0].id = msgId.c_str();
+        message[0].value = value;
+        CORBA::Any data;
+        data <<= message;
+        CorbaTransport::push(data);
+    }
+
+    void _queueCorba(const std::string& msgId, const char* format, const void* msgData,
+                     MessageSupplierPort::SerializerFunc serializer, MessageSupplierPort::EncoderFunc encoder)
+    {
+        if (_corbaQueued == 0) {
+            CorbaTransport::beginQueue(_queueSize);
+        }
+        CorbaTransport::queueMessage(msgId, format, msgData, serializer, encoder);
+        _corbaQueued++;
+    }
+
+    void _waitEmpty()
+    {
+        if (_attached && !_ring.waitEmpty()) {
+            _ringFailed();
+        }
+    }
+
+    void _ringFailed()
+    {
+        // The consumer has closed the ring or exited; the CORBA interface will
+        // report an error if it is truly gone
+        RH_NL_WARN("MessageSupplierPort", "Shared memory message consumer is not responding, using CORBA");
+        _ring.close();
+        _ring.detach();
+        _attached = false;
+    }
+
+    void _checkErrors()
+    {
+        if (!_attached) {
+            return;
+        }
+        uint32_t errors = _ring.errorCount();
+        if (errors != _errors) {
+            std::ostringstream oss;
+            oss << "Consumer failed to dispatch " << (errors - _errors) << " message(s)";
+            _errors = errors;
+            throw redhawk::TransportError(oss.str());
+        }
+    }
+
+    typedef std::map<std::string,std::string> FormatTable;
+
+    redhawk::MessageRing _ring;
+    bool _attached;
+    bool _generic;
+    FormatTable _formats;
+    uint32_t _errors;
+    redhawk::BinaryEncoder _encoder;
+    size_t _queueSize;
+    size_t _corbaQueued;
+};
+
+struct MessageSupplierPort::QueuedMessage
+{
+    std::string msgId;
+    const char* format;
+    void* msgData;
+    MessageSupplierPort::SerializerFunc serializer;
+    MessageSupplierPort::EncoderFunc encoder;
+    MessageSupplierPort::DeleterFunc deleter;
+    std::string connectionId;
+    boost::system_time queued;
+
+    void release()
+    {
+        deleter(msgData);
+        msgData = 0;
+    }
+};
+
+class MessageSupplierPort::AsyncQueue
+{
+public:
+    AsyncQueue(MessageSupplierPort* port, size_t capacity, float maxDelay, QueuePolicy policy) :
+        _port(port),
+        _capacity(capacity),
+        _maxDelay(boost::posix_time::microseconds(static_cast<long>(maxDelay * 1e6))),
+        _policy(policy),
+        _running(true),
+        _publishing(false),
+        _flushWaiters(0),
+        _maxQueueDepth(0),
+        _messagesSent(0),
+        _messagesDropped(0),
+        _batchesSent(0),
+        _totalLatency(0.0),
+        _maxLatency(0.0)
+    {
+        _thread = boost::thread(&AsyncQueue::run, this);
+    }
+
+    ~AsyncQueue()
+    {
+        stop();
+    }
+
+    void post(QueuedMessage& message)
+    {
+        boost::mutex::scoped_lock lock(_mutex);
+        if (_running && (_queue.size() >= _capacity)) {
+            if (_policy == QUEUE_DROP_OLDEST) {
+                _queue.front().release();
+                _queue.pop_front();
+                _messagesDropped++;
+            } else {
+                while (_running && (_queue.size() >= _capacity)) {
+                    _spaceAvailable.wait(lock);
+                }
+            }
+        }
+        if (!_running) {
+            // The queue is being replaced or the port destroyed; there is no
+            // guarantee that the publishing thread will see this message
+            message.release();
+            _messagesDropped++;
+            return;
+        }
+        message.queued = boost::get_system_time();
+        _queue.push_back(message);
+        _maxQueueDepth = std::max(_maxQueueDepth, _queue.size());
+
+        // The publishing thread only needs to be woken when the queue was
+        // empty (to start the delay) or has just filled up (to end it early)
+        if ((_queue.size() == 1) || (_queue.size() >= _capacity)) {
+            _messageAvailable.notify_one();
+        }
+    }
+
+    void flush()
+    {
+        boost::mutex::scoped_lock lock(_mutex);
+        _flushWaiters++;
+        _messageAvailable.notify_one();
+        while (!_queue.empty() || _publishing) {
+            _spaceAvailable.wait(lock);
+        }
+        _flushWaiters--;
+    }
+
+    void stop()
+    {
+        {
+            boost::mutex::scoped_lock lock(_mutex);
+            if (!_running) {
+                return;
+            }
+            _running = false;
+            _messageAvailable.notify_one();
+            _spaceAvailable.notify_all();
+        }
+        _thread.join();
+    }
+
+    AsyncStatistics statistics()
+    {
+        boost::mutex::scoped_lock lock(_mutex);
+        AsyncStatistics stats;
+        stats.queueDepth = _queue.size();
+        stats.maxQueueDepth = _maxQueueDepth;
+        stats.messagesSent = _messagesSent;
+        stats.messagesDropped = _messagesDropped;
+        stats.batchesSent = _batchesSent;
+        if (_messagesSent > 0) {
+            stats.averageLatency = _totalLatency / _messagesSent;
+        } else {
+            stats.averageLatency = 0.0;
+        }
+        stats.maxLatency = _maxLatency;
+        return stats;
+    }
+
+private:
+    void run()
+    {
+        std::vector<QueuedMessage> batch;
+        boost::mutex::scoped_lock lock(_mutex);
+        while (true) {
+            while (_running && _queue.empty()) {
+                _messageAvailable.wait(lock);
+            }
+            if (_queue.empty()) {
+                // Stopped, and all queued messages have been published
+                break;
+            }
+
+            // Give later messages a chance to join the batch, up to the
+            // maximum delay for the oldest message
+            boost::system_time deadline = _queue.front().queued + _maxDelay;
+            while (_running && (_flushWaiters == 0) && (_queue.size() < _capacity)) {
+                if (!_messageAvailable.timed_wait(lock, deadline)) {
+                    break;
+                }
+            }
+
+            batch.assign(_queue.begin(), _queue.end());
+            _queue.clear();
+            _publishing = true;
+            _spaceAvailable.notify_all();
+
+            lock.unlock();
+            _port->_publishMessages(batch);
+            boost::system_time now = boost::get_system_time();
+            double latency_total = 0.0;
+            double latency_max = 0.0;
+            for (std::vector<QueuedMessage>::iterator message = batch.begin(); message != batch.end(); ++message) {
+                double latency = (now - message->queued).total_microseconds() * 1e-6;
+                latency_total += latency;
+                latency_max = std::max(latency_max, latency);
+                message->release();
+            }
+            lock.lock();
+
+            _messagesSent += batch.size();
+            _batchesSent++;
+            _totalLatency += latency_total;
+            _maxLatency = std::max(_maxLatency, latency_max);
+            batch.clear();
+            _publishing = false;
+            _spaceAvailable.notify_all();
+        }
+    }
+
+    MessageSupplierPort* _port;
+    const size_t _capacity;
+    const boost::posix_time::time_duration _maxDelay;
+    const QueuePolicy _policy;
+
+    boost::mutex _mutex;
+    boost::condition_variable _messageAvailable;
+    boost::condition_variable _spaceAvailable;
+    std::deque<QueuedMessage> _queue;
+    bool _running;
+    bool _publishing;
+    int _flushWaiters;
+    boost::thread _thread;
+
+    size_t _maxQueueDepth;
+    size_t _messagesSent;
+    size_t _messagesDropped;
+    size_t _batchesSent;
+    double _totalLatency;
+    double _maxLatency;
+};
+
+namespace {
+    // Serializer and deleter for messages that arrive pre-serialized via
+    // push(); the message data is a CORBA::Any
+    void serializeAny(CORBA::Any& any, const void* data)
+    {
+        any = *reinterpret_cast<const CORBA::Any*>(data);
+    }
+
+    void deleteAny(void* data)
+    {
+        delete reinterpret_cast<CORBA::Any*>(data);
+    }
+}
+
 MessageSupplierPort::MessageSupplierPort (const std::string& name) :
     UsesPort(name)
 {
@@ -245,6 +748,58 @@ MessageSupplierPort::MessageSupplierPort (const std::string& name) :
 
 MessageSupplierPort::~MessageSupplierPort (void)
 {
+    // Publish any remaining messages while the connections still exist
+    if (_asyncQueue) {
+        _asyncQueue->stop();
+    }
+}
+
+void MessageSupplierPort::setAsync(size_t queueDepth, float maxDelay, QueuePolicy policy)
+{
+    boost::shared_ptr<AsyncQueue> queue;
+    if (queueDepth > 0) {
+        queue.reset(new AsyncQueue(this, queueDepth, maxDelay, policy));
+    }
+    {
+        boost::mutex::scoped_lock lock(updatingPortsLock);
+        _asyncQueue.swap(queue);
+    }
+    // The publishing thread needs the port lock to send, so the old queue
+    // must be drained after the lock is released
+    if (queue) {
+        queue->stop();
+    }
+}
+
+bool MessageSupplierPort::isAsync()
+{
+    boost::mutex::scoped_lock lock(updatingPortsLock);
+    return (_asyncQueue.get() != 0);
+}
+
+void MessageSupplierPort::flush()
+{
+    boost::shared_ptr<AsyncQueue> queue;
+    {
+        boost::mutex::scoped_lock lock(updatingPortsLock);
+        queue = _asyncQueue;
+    }
+    if (queue) {
+        queue->flush();
+    }
+}
+
+MessageSupplierPort::AsyncStatistics MessageSupplierPort::getAsyncStatistics()
+{
+    boost::shared_ptr<AsyncQueue> queue;
+    {
+        boost::mutex::scoped_lock lock(updatingPortsLock);
+        queue = _asyncQueue;
+    }
+    if (queue) {
+        return queue->statistics();
+    }
+    return AsyncStatistics();
 }
 
 void MessageSupplierPort::_validatePort(CORBA::Object_ptr object)
@@ -275,6 +830,10 @@ redhawk::UsesTransport* MessageSupplierPort::_createTransport(CORBA::Object_ptr
     MessageConsumerPort* local_port = ossie::corba::getLocalServant<MessageConsumerPort>(channel);
     if (local_port) {
         return new LocalTransport(this, local_port);
+    } else if (ShmTransport::isSupported(channel)) {
+        // The consumer may still turn out to be on another host, in which case
+        // the transport falls back to CORBA
+        return new ShmTransport(this, channel);
     } else {
         return new CorbaTransport(this, channel);
     }
@@ -284,6 +843,27 @@ void MessageSupplierPort::push(const CORBA::Any& data, const std::string& connec
 {
     boost::mutex::scoped_lock lock(updatingPortsLock);
     _checkConnectionId(connectionId);
+    if (_asyncQueue) {
+        boost::shared_ptr<AsyncQueue> queue = _asyncQueue;
+        lock.unlock();
+        CF::Properties* temp;
+        if (data >>= temp) {
+            // Queue each message individually so that they can be batched
+            // with other messages; the format is unknown, so local consumers
+            // always receive them through CORBA::Any
+            const redhawk::PropertyMap& props = redhawk::PropertyMap::cast(*temp);
+            for (redhawk::PropertyMap::const_iterator msg = props.begin(); msg != props.end(); ++msg) {
+                _postMessage(*queue, msg->getId(), "", new CORBA::Any(msg->getValue()), &serializeAny,
+                             0, &deleteAny, connectionId);
+            }
+            return;
+        }
+        // Not a message sequence; publish everything already queued and send
+        // it synchronously to preserve ordering
+        queue->flush();
+        lock.lock();
+    }
+    boost::mutex::scoped_lock publish_lock(_publishMutex);
     for (TransportIterator connection = _connections.begin(); connection != _connections.end(); ++connection) {
         if (!_isConnectionSelected(connection.connectionId(), connectionId)) {
             continue;
@@ -313,14 +893,14 @@ void MessageSupplierPort::_beginMessageQueue(size_t count, const std::string& co
 }
 
 void MessageSupplierPort::_queueMessage(const std::string& msgId, const char* format, const void* msgData,
-                                        SerializerFunc serializer, const std::string& connectionId)
+                                        SerializerFunc serializer, EncoderFunc encoder, const std::string& connectionId)
 {
     for (TransportIterator connection = _connections.begin(); connection != _connections.end(); ++connection) {
         if (!_isConnectionSelected(connection.connectionId(), connectionId)) {
             continue;
         }
         try {
-            connection.transport()->queueMessage(msgId, format, msgData, serializer);
+            connection.transport()->queueMessage(msgId, format, msgData, serializer, encoder);
         } catch ( ... ) {
         }
     }
@@ -341,6 +921,74 @@ void MessageSupplierPort::_sendMessageQueue(const std::string& connectionId)
     }
 }
 
+void MessageSupplierPort::_postMessage(AsyncQueue& queue, const std::string& msgId, const char* format, void* msgData,
+                                       SerializerFunc serializer, EncoderFunc encoder, DeleterFunc deleter,
+                                       const std::string& connectionId)
+{
+    QueuedMessage message;
+    message.msgId = msgId;
+    message.format = format;
+    message.msgData = msgData;
+    message.serializer = serializer;
+    message.encoder = encoder;
+    message.deleter = deleter;
+    message.connectionId = connectionId;
+    queue.post(message);
+}
+
+void MessageSupplierPort::_publishMessages(std::vector<QueuedMessage>& messages)
+{
+    // Take a snapshot of the connections and send without the port lock, so
+    // that a slow consumer does not hold up connections or callers queueing
+    // more messages. The publish lock is acquired before the port lock is
+    // released, and disconnecting waits on it, so the transports in the
+    // snapshot stay valid until the batch is sent.
+    std::vector<std::pair<std::string,MessageTransport*> > transports;
+    boost::mutex::scoped_lock publish_lock(_publishMutex, boost::defer_lock);
+    {
+        boost::mutex::scoped_lock lock(updatingPortsLock);
+        for (TransportIterator connection = _connections.begin(); connection != _connections.end(); ++connection) {
+            transports.push_back(std::make_pair(connection.connectionId(), connection.transport()));
+        }
+        publish_lock.lock();
+    }
+
+    for (size_t index = 0; index < transports.size(); ++index) {
+        const std::string& connection_id = transports[index].first;
+        MessageTransport* transport = transports[index].second;
+
+        // Messages may target different connections; only the selected ones
+        // go into this connection's batch
+        size_t count = 0;
+        for (std::vector<QueuedMessage>::iterator message = messages.begin(); message != messages.end(); ++message) {
+            if (_isConnectionSelected(connection_id, message->connectionId)) {
+                count++;
+            }
+        }
+        if (count == 0) {
+            continue;
+        }
+
+        transport->beginQueue(count);
+        for (std::vector<QueuedMessage>::iterator message = messages.begin(); message != messages.end(); ++message) {
+            if (!_isConnectionSelected(connection_id, message->connectionId)) {
+                continue;
+            }
+            try {
+                transport->queueMessage(message->msgId, message->format, message->msgData,
+                                        message->serializer, message->encoder);
+            } catch ( ... ) {
+            }
+        }
+        try {
+            transport->sendMessages();
+        } catch (const redhawk::TransportError& exc) {
+            RH_NL_WARN("MessageSupplierPort", "Could not deliver the message. " << exc.what());
+        } catch (...) {
+        }
+    }
+}
+
 bool MessageSupplierPort::_isConnectionSelected(const std::string& connectionId, const std::string& targetId)
 {
     if (targetId.empty()) {
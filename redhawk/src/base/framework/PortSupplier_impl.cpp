@@ -106,9 +106,24 @@ void PortSupplier_impl::insertPort (const std::string& name, PortBase* servant)
         // A port is already registered with the given name, assume that the
         // new one must replace the old one
         RH_DEBUG(_portsupplierLog, "Replacing existing port '" << name << "'");
+        Port_Provides_base_impl* provides = dynamic_cast<Port_Provides_base_impl*>(existing->second);
+        if (provides) {
+            provides->removeDataListener(this, &PortSupplier_impl::portDataArrived);
+        }
         deactivatePort(existing->second);
     }
     _portServants[name] = servant;
+
+    // Forward data arrival on input ports to portDataArrived(), which threaded
+    // components override to wake up the processing thread
+    Port_Provides_base_impl* provides = dynamic_cast<Port_Provides_base_impl*>(servant);
+    if (provides) {
+        provides->addDataListener(this, &PortSupplier_impl::portDataArrived);
+    }
+}
+
+void PortSupplier_impl::portDataArrived ()
+{
 }
 
 void PortSupplier_impl::registerInPort(Port_Provides_base_impl *port) {
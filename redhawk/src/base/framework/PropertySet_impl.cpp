@@ -599,10 +599,17 @@ void PropertySet_impl::setPropertyChangeListener (const std::string& id, Propert
 void PropertySet_impl::executePropertyCallback (const std::string& id)
 {
     PropertyCallbackMap::iterator func = propCallbacks.find(id);
-    if (propCallbacks.end() == func) {
-        return;
+    if (propCallbacks.end() != func) {
+        (func->second)(id);
     }
-    (func->second)(id);
+
+    // A configure that changes a value is an event for threaded components;
+    // notify after the callback so that the thread sees any updated state
+    propertyChanged(id);
+}
+
+void PropertySet_impl::propertyChanged (const std::string&)
+{
 }
 
 void PropertySet_impl::setPropertyCallback (const std::string& id, PropertyCallback callback)
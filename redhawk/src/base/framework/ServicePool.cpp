@@ -0,0 +1,503 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK core.
+ *
+ * REDHAWK core is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK core is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+#include <deque>
+#include <sstream>
+#include <stdexcept>
+
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+
+#include <ossie/ServicePool.h>
+#include <ossie/ThreadedComponent.h>
+#include <ossie/CorbaUtils.h>
+
+using namespace redhawk;
+
+PREPARE_CF_LOGGING(ServicePool);
+
+namespace {
+    static inline double thread_cpu_time()
+    {
+        struct timespec ts;
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+        return ts.tv_sec + (ts.tv_nsec * 1e-9);
+    }
+}
+
+class ServicePool::Task {
+public:
+    enum State {
+        IDLE,       // Waiting to be woken
+        QUEUED,     // On a worker's run queue
+        RUNNING,    // Service function is executing
+        TIMED,      // Waiting for the NOOP delay to expire
+        FINISHED    // Returned FINISH, or removed
+    };
+
+    Task(ThreadedComponent* target, const std::string& name, int priority, int cpu, Worker* home) :
+        target(target),
+        name(name),
+        priority(priority),
+        cpu(cpu),
+        home(home),
+        state(IDLE),
+        wakePending(false),
+        removed(false),
+        generation(0),
+        thread(0),
+        calls(0),
+        cpuTime(0.0)
+    {
+    }
+
+    ThreadedComponent* const target;
+    const std::string name;
+    const int priority;
+    const int cpu;
+
+    // Worker bound to the task's CPU hint, if any; the task is never stolen
+    Worker* const home;
+
+    boost::mutex mutex;
+    boost::condition_variable stateChanged;
+    State state;
+    bool wakePending;
+    bool removed;
+
+    // Incremented each time a NOOP delay is scheduled, so that stale timers
+    // can be ignored
+    unsigned int generation;
+
+    // Worker thread running the service function, for interruption
+    boost::thread* thread;
+
+    unsigned long long calls;
+    double cpuTime;
+};
+
+class ServicePool::Worker {
+public:
+    Worker(size_t index, int cpu) :
+        index(index),
+        cpu(cpu),
+        thread(0)
+    {
+    }
+
+    const size_t index;
+    const int cpu;
+    boost::thread* thread;
+
+    // Run queue, ordered by descending priority, then FIFO
+    boost::mutex mutex;
+    std::deque<TaskPtr> queue;
+};
+
+ServicePool& ServicePool::Instance()
+{
+    static ServicePool instance;
+    return instance;
+}
+
+ServicePool::ServicePool() :
+    _running(false),
+    _idleWorkers(0),
+    _nextWorker(0)
+{
+}
+
+ServicePool::~ServicePool()
+{
+    stop();
+}
+
+void ServicePool::start(size_t threads, const std::vector<int>& cpus)
+{
+    boost::mutex::scoped_lock lock(_mutex);
+    if (_running || !_workers.empty()) {
+        // Workers left over from a stop() that is still joining count as
+        // running
+        throw std::logic_error("service pool is already running");
+    }
+    if (threads == 0) {
+        return;
+    }
+
+    LOG_DEBUG(ServicePool, "Starting " << threads << " worker threads");
+    for (size_t index = 0; index < threads; ++index) {
+        int cpu = -1;
+        if (!cpus.empty()) {
+            cpu = cpus[index % cpus.size()];
+        }
+        _workers.push_back(new Worker(index, cpu));
+    }
+
+    _running = true;
+    _timer.start();
+    for (WorkerList::iterator worker = _workers.begin(); worker != _workers.end(); ++worker) {
+        (*worker)->thread = new boost::thread(&ServicePool::_run, this, *worker);
+    }
+}
+
+void ServicePool::stop()
+{
+    {
+        boost::mutex::scoped_lock lock(_mutex);
+        if (!_running) {
+            return;
+        }
+        _running = false;
+        _cond.notify_all();
+    }
+    _timer.stop();
+    _timer.clear();
+
+    // The worker list is left intact until every worker has been joined,
+    // because running workers read it without the pool lock
+    for (WorkerList::iterator worker = _workers.begin(); worker != _workers.end(); ++worker) {
+        (*worker)->thread->join();
+        delete (*worker)->thread;
+    }
+
+    WorkerList workers;
+    {
+        boost::mutex::scoped_lock lock(_mutex);
+        workers.swap(_workers);
+    }
+    for (WorkerList::iterator worker = workers.begin(); worker != workers.end(); ++worker) {
+        delete *worker;
+    }
+}
+
+bool ServicePool::isRunning()
+{
+    return _running;
+}
+
+size_t ServicePool::size()
+{
+    boost::mutex::scoped_lock lock(_mutex);
+    return _workers.size();
+}
+
+ServicePool::StatisticsList ServicePool::getStatistics()
+{
+    // Copy the task list first; tasks must be locked before the pool
+    TaskList tasks;
+    {
+        boost::mutex::scoped_lock lock(_mutex);
+        tasks = _tasks;
+    }
+
+    StatisticsList result;
+    for (TaskList::iterator task = tasks.begin(); task != tasks.end(); ++task) {
+        boost::mutex::scoped_lock lock((*task)->mutex);
+        TaskStatistics stats;
+        stats.name = (*task)->name;
+        stats.priority = (*task)->priority;
+        stats.cpu = (*task)->cpu;
+        stats.calls = (*task)->calls;
+        stats.cpuTime = (*task)->cpuTime;
+        result.push_back(stats);
+    }
+    return result;
+}
+
+ServicePool::TaskPtr ServicePool::addTask(ThreadedComponent* target, const std::string& name, int priority, int cpu)
+{
+    TaskPtr task(new Task(target, name, priority, cpu, _findWorker(cpu)));
+    if ((cpu >= 0) && !task->home) {
+        LOG_DEBUG(ServicePool, "No worker is bound to CPU " << cpu << ", ignoring affinity for '" << name << "'");
+    }
+    {
+        boost::mutex::scoped_lock lock(_mutex);
+        _tasks.push_back(task);
+    }
+
+    // Run the service function once at startup, as a dedicated thread would
+    boost::mutex::scoped_lock lock(task->mutex);
+    task->state = Task::QUEUED;
+    _enqueue(task, 0);
+    return task;
+}
+
+bool ServicePool::removeTask(const TaskPtr& task, float timeout)
+{
+    {
+        boost::mutex::scoped_lock lock(task->mutex);
+        task->removed = true;
+        if (task->state == Task::RUNNING) {
+            // Interrupt the service function in case it is blocked, the same
+            // as ProcessThread::stop(); the worker clears any interruption
+            // that arrives after the call returns
+            task->thread->interrupt();
+            boost::system_time deadline = boost::get_system_time() + boost::posix_time::microseconds(static_cast<long>(timeout * 1e6));
+            while (task->state == Task::RUNNING) {
+                if (!task->stateChanged.timed_wait(lock, deadline)) {
+                    return false;
+                }
+            }
+        }
+        task->state = Task::FINISHED;
+    }
+
+    // Any remaining queue or timer entries are discarded when they come up
+    boost::mutex::scoped_lock lock(_mutex);
+    _tasks.remove(task);
+    return true;
+}
+
+void ServicePool::wakeTask(const TaskPtr& task)
+{
+    boost::mutex::scoped_lock lock(task->mutex);
+    switch (task->state) {
+    case Task::IDLE:
+    case Task::TIMED:
+        task->state = Task::QUEUED;
+        _enqueue(task, 0);
+        break;
+    case Task::RUNNING:
+        task->wakePending = true;
+        break;
+    default:
+        break;
+    }
+}
+
+void ServicePool::_run(Worker* worker)
+{
+    std::ostringstream name;
+    name << "svcpool-" << worker->index;
+    pthread_setname_np(pthread_self(), name.str().substr(0, 15).c_str());
+
+    if (worker->cpu >= 0) {
+        cpu_set_t cpuset;
+        CPU_ZERO(&cpuset);
+        CPU_SET(worker->cpu, &cpuset);
+        if (pthread_setaffinity_np(pthread_self(), sizeof(cpuset), &cpuset) != 0) {
+            LOG_WARN(ServicePool, "Unable to bind worker " << worker->index << " to CPU " << worker->cpu);
+        }
+    }
+
+    while (_running) {
+        TaskPtr task = _nextTask(worker);
+        if (!task) {
+            task = _stealTask(worker);
+        }
+        if (task) {
+            _execute(worker, task);
+            continue;
+        }
+
+        // Check again with the pool lock held, so that a task queued after
+        // the checks above is guaranteed to see this worker as idle
+        boost::mutex::scoped_lock lock(_mutex);
+        if (!_running || _hasWork(worker)) {
+            continue;
+        }
+        ++_idleWorkers;
+        _cond.wait(lock);
+        --_idleWorkers;
+    }
+}
+
+void ServicePool::_execute(Worker* worker, const TaskPtr& task)
+{
+    {
+        boost::mutex::scoped_lock lock(task->mutex);
+        if (task->removed || (task->state != Task::QUEUED)) {
+            // Stale queue entry
+            return;
+        }
+        task->state = Task::RUNNING;
+        task->wakePending = false;
+        task->thread = worker->thread;
+    }
+
+    const double start = thread_cpu_time();
+    int state;
+    try {
+        state = task->target->serviceFunction();
+    } catch (const std::exception& exc) {
+        LOG_FATAL(ServicePool, "Unhandled exception in service function: " << exc.what());
+        exit(-1);
+    } catch (const CORBA::Exception& exc) {
+        LOG_FATAL(ServicePool, "Unhandled exception in service function: "
+                  << ossie::corba::describeException(exc));
+        exit(-1);
+    } catch (boost::thread_interrupted &) {
+        state = FINISH;
+    } catch (...) {
+        LOG_FATAL(ServicePool, "Unhandled exception in service function");
+        exit(-1);
+    }
+    const double elapsed = thread_cpu_time() - start;
+
+    boost::mutex::scoped_lock lock(task->mutex);
+    try {
+        boost::this_thread::interruption_point();
+    } catch (boost::thread_interrupted &) {
+        // Interrupted by removeTask() after the service function returned
+    }
+    task->thread = 0;
+    task->calls++;
+    task->cpuTime += elapsed;
+
+    if (task->removed || (state == FINISH)) {
+        task->state = Task::FINISHED;
+        task->stateChanged.notify_all();
+        return;
+    }
+
+    if ((state == NOOP) && !task->wakePending) {
+        if (task->target->_eventDriven) {
+            task->state = Task::IDLE;
+        } else {
+            task->state = Task::TIMED;
+            boost::system_time when = boost::get_system_time() + boost::posix_time::microseconds(static_cast<long>(task->target->_defaultDelay * 1e6));
+            _timer.schedule(when, boost::bind(&ServicePool::_timerExpired, this, task, ++task->generation));
+        }
+        task->stateChanged.notify_all();
+        return;
+    }
+
+    // Keep the task on this worker to preserve cache locality
+    task->state = Task::QUEUED;
+    _enqueue(task, worker);
+    task->stateChanged.notify_all();
+}
+
+ServicePool::TaskPtr ServicePool::_nextTask(Worker* worker)
+{
+    boost::mutex::scoped_lock lock(worker->mutex);
+    if (worker->queue.empty()) {
+        return TaskPtr();
+    }
+    TaskPtr task = worker->queue.front();
+    worker->queue.pop_front();
+    return task;
+}
+
+ServicePool::TaskPtr ServicePool::_stealTask(Worker* thief)
+{
+    // Only called from worker threads; the worker list does not change until
+    // they have all been joined
+    const size_t count = _workers.size();
+    for (size_t offset = 1; offset < count; ++offset) {
+        Worker* victim = _workers[(thief->index + offset) % count];
+        boost::mutex::scoped_lock lock(victim->mutex);
+        for (std::deque<TaskPtr>::iterator task = victim->queue.begin(); task != victim->queue.end(); ++task) {
+            if (!(*task)->home) {
+                TaskPtr result = *task;
+                victim->queue.erase(task);
+                return result;
+            }
+        }
+    }
+    return TaskPtr();
+}
+
+void ServicePool::_enqueue(const TaskPtr& task, Worker* worker)
+{
+    // A task requeued by the worker that just ran it will be picked up by
+    // that worker, so other workers only need to be woken if there is more
+    // than one task waiting
+    const bool requeue = (worker != 0);
+
+    // Other callers may race with stop(), so they hold the pool lock until
+    // the task is queued, ensuring that the worker is not deleted in between;
+    // a requeueing worker is not deleted until it has been joined
+    boost::mutex::scoped_lock lock(_mutex, boost::defer_lock);
+    if (!requeue) {
+        lock.lock();
+        if (!_running || _workers.empty()) {
+            return;
+        }
+    }
+    if (task->home) {
+        worker = task->home;
+    } else if (!worker) {
+        worker = _workers[_nextWorker++ % _workers.size()];
+    }
+
+    size_t depth;
+    {
+        boost::mutex::scoped_lock queue_lock(worker->mutex);
+        std::deque<TaskPtr>::iterator pos = worker->queue.end();
+        while ((pos != worker->queue.begin()) && ((*(pos-1))->priority < task->priority)) {
+            --pos;
+        }
+        worker->queue.insert(pos, task);
+        depth = worker->queue.size();
+    }
+    if (requeue && (worker == task->home || depth == 1)) {
+        return;
+    }
+
+    if (!lock.owns_lock()) {
+        lock.lock();
+    }
+    if (_idleWorkers > 0) {
+        // Only the home worker can run a bound task, so wake everyone
+        if (task->home) {
+            _cond.notify_all();
+        } else {
+            _cond.notify_one();
+        }
+    }
+}
+
+void ServicePool::_timerExpired(const TaskPtr& task, unsigned int generation)
+{
+    boost::mutex::scoped_lock lock(task->mutex);
+    if ((task->state == Task::TIMED) && (task->generation == generation)) {
+        task->state = Task::QUEUED;
+        _enqueue(task, 0);
+    }
+}
+
+bool ServicePool::_hasWork(Worker* worker)
+{
+    for (WorkerList::iterator ii = _workers.begin(); ii != _workers.end(); ++ii) {
+        boost::mutex::scoped_lock lock((*ii)->mutex);
+        for (std::deque<TaskPtr>::iterator task = (*ii)->queue.begin(); task != (*ii)->queue.end(); ++task) {
+            if ((*ii == worker) || !(*task)->home) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+ServicePool::Worker* ServicePool::_findWorker(int cpu)
+{
+    if (cpu < 0) {
+        return 0;
+    }
+    boost::mutex::scoped_lock lock(_mutex);
+    for (WorkerList::iterator worker = _workers.begin(); worker != _workers.end(); ++worker) {
+        if ((*worker)->cpu == cpu) {
+            return *worker;
+        }
+    }
+    return 0;
+}
@@ -75,7 +75,7 @@ void ProcessThread::run()
         } else if (state == NOOP) {
             try {
                 boost::posix_time::time_duration boost_delay = boost::posix_time::microseconds(_delay.tv_sec*1e6 + _delay.tv_nsec*1e-3);
-                boost::this_thread::sleep(boost_delay);
+                _target->waitForWake(boost_delay);
             } catch (boost::thread_interrupted &) {
                 break;
             } catch (...) {
@@ -138,7 +138,15 @@ ThreadedComponent::ThreadedComponent() :
     serviceThread(0),
     serviceThreadLock(),
     _threadName(),
-    _defaultDelay(0.1)
+    _defaultDelay(0.1),
+    _wakeMutex(),
+    _wakeCondition(),
+    _wakePending(false),
+    _eventDriven(false),
+    _pooled(false),
+    _threadPriority(0),
+    _threadAffinity(-1),
+    _serviceTask()
 {
 }
 
@@ -149,7 +157,16 @@ ThreadedComponent::~ThreadedComponent()
 void ThreadedComponent::startThread ()
 {
     boost::mutex::scoped_lock lock(serviceThreadLock);
-    if (!serviceThread) {
+    if (serviceThread || _serviceTask) {
+        return;
+    }
+    redhawk::ServicePool& pool = redhawk::ServicePool::Instance();
+    if (_pooled && pool.isRunning()) {
+        // Hold the wake lock until the task is assigned, so that a wake() from
+        // the first service function call is not lost
+        boost::mutex::scoped_lock wake_lock(_wakeMutex);
+        _serviceTask = pool.addTask(this, _threadName, _threadPriority, _threadAffinity);
+    } else {
         serviceThread = new ossie::ProcessThread(this, _defaultDelay, _threadName);
         serviceThread->start();
     }
@@ -164,6 +181,12 @@ bool ThreadedComponent::stopThread ()
         }
         delete  serviceThread;
         serviceThread = 0;
+    } else if (_serviceTask) {
+        if (!redhawk::ServicePool::Instance().removeTask(_serviceTask, 2.0)) {
+            return false;
+        }
+        boost::mutex::scoped_lock wake_lock(_wakeMutex);
+        _serviceTask.reset();
     }
     return true;
 }
@@ -182,6 +205,75 @@ void ThreadedComponent::setThreadDelay (float delay)
     }
 }
 
+bool ThreadedComponent::isThreadEventDriven ()
+{
+    return _eventDriven;
+}
+
+void ThreadedComponent::setThreadEventDriven (bool eventDriven)
+{
+    _eventDriven = eventDriven;
+
+    // Wake the thread so that it picks up the new mode rather than finishing
+    // its current wait under the old one
+    wake();
+}
+
+bool ThreadedComponent::isThreadPooled ()
+{
+    return _pooled;
+}
+
+void ThreadedComponent::setThreadPooled (bool pooled)
+{
+    boost::mutex::scoped_lock lock(serviceThreadLock);
+    _pooled = pooled;
+}
+
+void ThreadedComponent::setThreadPriority (int priority)
+{
+    boost::mutex::scoped_lock lock(serviceThreadLock);
+    _threadPriority = priority;
+}
+
+void ThreadedComponent::setThreadAffinity (int cpu)
+{
+    boost::mutex::scoped_lock lock(serviceThreadLock);
+    _threadAffinity = cpu;
+}
+
+void ThreadedComponent::wake ()
+{
+    boost::mutex::scoped_lock lock(_wakeMutex);
+    _wakePending = true;
+    _wakeCondition.notify_all();
+    if (_serviceTask) {
+        redhawk::ServicePool::Instance().wakeTask(_serviceTask);
+    }
+}
+
+void ThreadedComponent::eventArrived ()
+{
+    if (_eventDriven) {
+        wake();
+    }
+}
+
+void ThreadedComponent::waitForWake (const boost::posix_time::time_duration& delay)
+{
+    // Both waits are interruption points, so stopping the thread still works
+    // the same as it does with sleep()
+    boost::mutex::scoped_lock lock(_wakeMutex);
+    if (!_wakePending) {
+        if (_eventDriven) {
+            _wakeCondition.wait(lock);
+        } else {
+            _wakeCondition.timed_wait(lock, delay);
+        }
+    }
+    _wakePending = false;
+}
+
 void ThreadedComponent::setThreadName (const std::string& name)
 {
     boost::mutex::scoped_lock lock(serviceThreadLock);
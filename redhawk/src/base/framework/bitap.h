@@ -0,0 +1,174 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK core.
+ *
+ * REDHAWK core is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK core is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+#ifndef REDHAWK_BITAP_H
+#define REDHAWK_BITAP_H
+
+#include <algorithm>
+#include <cstddef>
+#include <stdint.h>
+
+namespace redhawk {
+
+    namespace bitap {
+
+        // Bit-parallel approximate search (the Bitap, or shift-or, algorithm
+        // extended to allow substitutions) for patterns of up to 64 bits.
+        //
+        // A pattern is described by two masks, one per bit value, where bit i
+        // is clear if bit i of the pattern has that value. The search state is
+        // (errors + 1) words: bit i of state word j is clear when the first
+        // i+1 bits of the pattern match the most recent input bits with at
+        // most j errors, so an occurrence ends at the current bit when the
+        // pattern's last bit is clear in the highest state word. States start
+        // with all bits set, so that an occurrence cannot begin before the
+        // first input bit.
+
+        struct pattern {
+            uint64_t masks[2];
+            uint64_t match_bit;
+            size_t size;
+            int errors;
+        };
+
+        namespace detail {
+            static inline int get_bit(const unsigned char* data, size_t index)
+            {
+                return (data[index / 8] >> (7 - (index & 7))) & 1;
+            }
+
+            static inline int distance(const uint64_t* states, uint64_t match_bit)
+            {
+                // The lowest state word with the last bit clear gives the
+                // actual distance
+                int distance = 0;
+                while (states[distance] & match_bit) {
+                    ++distance;
+                }
+                return distance;
+            }
+
+            // Fixed error count, so that the compiler can unroll the state
+            // update and keep the state words in registers
+            template <int Errors, class Func>
+            inline size_t scan(const unsigned char* data, size_t start, size_t end,
+                               const pattern& patt, uint64_t* states, Func& func)
+            {
+                uint64_t local[Errors + 1];
+                std::copy(states, states + Errors + 1, local);
+                const uint64_t mask0 = patt.masks[0];
+                const uint64_t diff = patt.masks[0] ^ patt.masks[1];
+                size_t index = start;
+                bool stop = false;
+                while (!stop && (index < end)) {
+                    // Load each input byte once
+                    const unsigned int byte = data[index / 8];
+                    const size_t last = std::min(end, (index | 7) + 1);
+                    for (; index < last; ++index) {
+                        const uint64_t bit = (byte >> (7 - (index & 7))) & 1;
+                        const uint64_t mask = mask0 ^ (diff & -bit);
+                        uint64_t previous = local[0];
+                        local[0] = (previous << 1) | mask;
+                        for (int jj = 1; jj <= Errors; ++jj) {
+                            const uint64_t current = local[jj];
+                            local[jj] = ((current << 1) | mask) & (previous << 1);
+                            previous = current;
+                        }
+                        if (!(local[Errors] & patt.match_bit)) {
+                            if (func(index, distance(local, patt.match_bit))) {
+                                ++index;
+                                stop = true;
+                                break;
+                            }
+                        }
+                    }
+                }
+                std::copy(local, local + Errors + 1, states);
+                return index;
+            }
+
+            template <class Func>
+            inline size_t scan(const unsigned char* data, size_t start, size_t end,
+                               const pattern& patt, uint64_t* states, Func& func)
+            {
+                size_t index = start;
+                for (; index < end; ++index) {
+                    const uint64_t mask = patt.masks[get_bit(data, index)];
+                    uint64_t previous = states[0];
+                    states[0] = (previous << 1) | mask;
+                    for (int jj = 1; jj <= patt.errors; ++jj) {
+                        const uint64_t current = states[jj];
+                        states[jj] = ((current << 1) | mask) & (previous << 1);
+                        previous = current;
+                    }
+                    if (!(states[patt.errors] & patt.match_bit)) {
+                        if (func(index, distance(states, patt.match_bit))) {
+                            return index + 1;
+                        }
+                    }
+                }
+                return index;
+            }
+        }
+
+        // Builds a pattern from a bit string. More errors than pattern bits is
+        // the same as allowing every bit to differ; a negative error count
+        // never matches, and callers should not scan for it.
+        static inline pattern make_pattern(const unsigned char* data, size_t start, size_t bits, int maxDistance)
+        {
+            pattern patt;
+            patt.masks[0] = ~0ULL;
+            patt.masks[1] = ~0ULL;
+            for (size_t pos = 0; pos < bits; ++pos) {
+                patt.masks[detail::get_bit(data, start + pos)] &= ~(1ULL << pos);
+            }
+            patt.match_bit = 1ULL << (bits - 1);
+            patt.size = bits;
+            patt.errors = std::max(std::min(maxDistance, (int) bits), -1);
+            return patt;
+        }
+
+        // Advances the state words through bits [start, end) of data. For
+        // each bit where an occurrence ends, calls func(index, distance),
+        // which returns true to stop the scan. Returns the index of the next
+        // bit to scan.
+        template <class Func>
+        inline size_t scan(const unsigned char* data, size_t start, size_t end,
+                           const pattern& patt, uint64_t* states, Func& func)
+        {
+            switch (patt.errors) {
+            case 0:
+                return detail::scan<0>(data, start, end, patt, states, func);
+            case 1:
+                return detail::scan<1>(data, start, end, patt, states, func);
+            case 2:
+                return detail::scan<2>(data, start, end, patt, states, func);
+            case 3:
+                return detail::scan<3>(data, start, end, patt, states, func);
+            case 4:
+                return detail::scan<4>(data, start, end, patt, states, func);
+            default:
+                return detail::scan(data, start, end, patt, states, func);
+            }
+        }
+    }
+}
+
+#endif // REDHAWK_BITAP_H
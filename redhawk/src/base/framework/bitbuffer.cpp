@@ -123,7 +123,13 @@ int shared_bitbuffer::distance(const shared_bitbuffer& other) const
 
 size_t shared_bitbuffer::find(size_t start, const shared_bitbuffer& pattern, int maxDistance) const
 {
-    return bitops::find(data(), offset() + start, size(), pattern.data(), pattern.offset(), pattern.size(), maxDistance);
+    // The string end is an absolute bit index, like the start, and the result
+    // must be made relative to this buffer's first bit
+    int index = bitops::find(data(), offset() + start, offset() + size(), pattern.data(), pattern.offset(), pattern.size(), maxDistance);
+    if (index < 0) {
+        return npos;
+    }
+    return index - offset();
 }
 
 shared_bitbuffer shared_bitbuffer::make_transient(const data_type* data, size_t start, size_t bits)
@@ -20,12 +20,19 @@
 
 #include <ossie/bitops.h>
 
+#include "bitap.h"
+#include "bitops_kernels.h"
+
 #include <algorithm>
 #include <cstring>
 #include <iostream>
 #include <iomanip>
 #include <stdexcept>
 
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
 namespace redhawk {
 namespace bitops {
 
@@ -236,6 +243,369 @@ namespace bitops {
         {
         };
 
+        // Word-parallel kernels for the aligned, full-byte portions of the
+        // population count, Hamming distance, copy and compare operations.
+        // Bit arrays are MSB-first, so words are loaded big-endian when the
+        // bit order matters; unaligned right-hand sides are handled with a
+        // funnel shift across adjacent words instead of per-byte splitting.
+
+        // Loads 8 bytes in native order (for operations where bit order does
+        // not matter, like counting)
+        static inline uint64_t load_word(const byte* src)
+        {
+            uint64_t value;
+            std::memcpy(&value, src, sizeof(value));
+            return value;
+        }
+
+        // Loads 8 bytes such that the first bit is the MSB of the result
+        static inline uint64_t load_be(const byte* src)
+        {
+            uint64_t value = load_word(src);
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+            value = __builtin_bswap64(value);
+#endif
+            return value;
+        }
+
+        static inline void store_be(byte* dest, uint64_t value)
+        {
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+            value = __builtin_bswap64(value);
+#endif
+            std::memcpy(dest, &value, sizeof(value));
+        }
+
+        // Loads 64 bits starting at a bit offset in the range (0,8); the bits
+        // span 9 bytes, all of which must be accessible
+        static inline uint64_t load_shifted(const byte* src, size_t offset)
+        {
+            return (load_be(src) << offset) | (src[8] >> (8 - offset));
+        }
+
+        // Portable population count, for CPUs without a popcnt instruction
+        struct swar_counter {
+            static inline int count(uint64_t value)
+            {
+                value = value - ((value >> 1) & 0x5555555555555555ULL);
+                value = (value & 0x3333333333333333ULL) + ((value >> 2) & 0x3333333333333333ULL);
+                value = (value + (value >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+                return (value * 0x0101010101010101ULL) >> 56;
+            }
+        };
+
+        // Compiler builtin; expands to a single instruction only in functions
+        // compiled for a target with popcnt
+        struct builtin_counter {
+            static inline int count(uint64_t value)
+            {
+                return __builtin_popcountll(value);
+            }
+        };
+
+        template <class Counter>
+        static inline int popcount_words(const byte* data, size_t bytes)
+        {
+            int count = 0;
+            size_t index = 0;
+            for (; (index + 8) <= bytes; index += 8) {
+                count += Counter::count(load_word(data + index));
+            }
+            for (; index < bytes; ++index) {
+                count += hammingWeights[data[index]];
+            }
+            return count;
+        }
+
+        template <class Counter>
+        static inline int hamming_words(const byte* lhs, const byte* rhs, size_t bytes)
+        {
+            int count = 0;
+            size_t index = 0;
+            for (; (index + 8) <= bytes; index += 8) {
+                count += Counter::count(load_word(lhs + index) ^ load_word(rhs + index));
+            }
+            for (; index < bytes; ++index) {
+                count += hammingWeights[lhs[index] ^ rhs[index]];
+            }
+            return count;
+        }
+
+        // The right-hand side starts at a bit offset in the range (0,8), and
+        // extends into the byte after the last full byte
+        template <class Counter>
+        static inline int hamming_shifted_words(const byte* lhs, const byte* rhs, size_t offset, size_t bytes)
+        {
+            int count = 0;
+            size_t index = 0;
+            for (; (index + 8) <= bytes; index += 8) {
+                count += Counter::count(load_be(lhs + index) ^ load_shifted(rhs + index, offset));
+            }
+            for (; index < bytes; ++index) {
+                count += hammingWeights[lhs[index] ^ bit_reader::read_split(rhs + index, offset)];
+            }
+            return count;
+        }
+
+        static int popcount_generic(const byte* data, size_t bytes)
+        {
+            return popcount_words<swar_counter>(data, bytes);
+        }
+
+        static int hamming_generic(const byte* lhs, const byte* rhs, size_t bytes)
+        {
+            return hamming_words<swar_counter>(lhs, rhs, bytes);
+        }
+
+        static int hamming_shifted_generic(const byte* lhs, const byte* rhs, size_t offset, size_t bytes)
+        {
+            return hamming_shifted_words<swar_counter>(lhs, rhs, offset, bytes);
+        }
+
+// Function-level target attributes with x86 intrinsics require GCC 4.9;
+// AVX-512BW intrinsics and CPU detection require GCC 7
+#if defined(__x86_64__) && defined(__GNUC__) && !defined(__clang__) && ((__GNUC__ > 4) || ((__GNUC__ == 4) && (__GNUC_MINOR__ >= 9)))
+#define BITOPS_X86_KERNELS 1
+#if (__GNUC__ >= 7)
+#define BITOPS_AVX512_KERNELS 1
+#endif
+#endif
+
+#ifdef BITOPS_X86_KERNELS
+        __attribute__((target("popcnt")))
+        static int popcount_popcnt(const byte* data, size_t bytes)
+        {
+            return popcount_words<builtin_counter>(data, bytes);
+        }
+
+        __attribute__((target("popcnt")))
+        static int hamming_popcnt(const byte* lhs, const byte* rhs, size_t bytes)
+        {
+            return hamming_words<builtin_counter>(lhs, rhs, bytes);
+        }
+
+        __attribute__((target("popcnt")))
+        static int hamming_shifted_popcnt(const byte* lhs, const byte* rhs, size_t offset, size_t bytes)
+        {
+            return hamming_shifted_words<builtin_counter>(lhs, rhs, offset, bytes);
+        }
+
+        // AVX2 kernels count bits with a 4-bit lookup table applied by byte
+        // shuffles, then sum the byte counts into 64-bit lanes with SAD
+        __attribute__((target("avx2")))
+        static inline __m256i popcount_avx2_vector(__m256i value)
+        {
+            const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                                    0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+            const __m256i low_mask = _mm256_set1_epi8(0x0F);
+            __m256i low = _mm256_and_si256(value, low_mask);
+            __m256i high = _mm256_and_si256(_mm256_srli_epi16(value, 4), low_mask);
+            __m256i counts = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, low), _mm256_shuffle_epi8(lookup, high));
+            return _mm256_sad_epu8(counts, _mm256_setzero_si256());
+        }
+
+        __attribute__((target("avx2")))
+        static inline int sum_avx2_lanes(__m256i total)
+        {
+            uint64_t lanes[4];
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), total);
+            return lanes[0] + lanes[1] + lanes[2] + lanes[3];
+        }
+
+        // Produces 32 bytes from a bit offset in the range (0,8), reading 33
+        // bytes from src
+        __attribute__((target("avx2")))
+        static inline __m256i load_shifted_avx2(const byte* src, __m128i shift, __m128i rshift, __m256i high_mask, __m256i low_mask)
+        {
+            __m256i first = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+            __m256i second = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 1));
+            __m256i high = _mm256_and_si256(_mm256_sll_epi16(first, shift), high_mask);
+            __m256i low = _mm256_and_si256(_mm256_srl_epi16(second, rshift), low_mask);
+            return _mm256_or_si256(high, low);
+        }
+
+        __attribute__((target("avx2,popcnt")))
+        static int popcount_avx2(const byte* data, size_t bytes)
+        {
+            __m256i total = _mm256_setzero_si256();
+            size_t index = 0;
+            for (; (index + 32) <= bytes; index += 32) {
+                __m256i value = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + index));
+                total = _mm256_add_epi64(total, popcount_avx2_vector(value));
+            }
+            return sum_avx2_lanes(total) + popcount_words<builtin_counter>(data + index, bytes - index);
+        }
+
+        __attribute__((target("avx2,popcnt")))
+        static int hamming_avx2(const byte* lhs, const byte* rhs, size_t bytes)
+        {
+            __m256i total = _mm256_setzero_si256();
+            size_t index = 0;
+            for (; (index + 32) <= bytes; index += 32) {
+                __m256i left = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lhs + index));
+                __m256i right = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rhs + index));
+                total = _mm256_add_epi64(total, popcount_avx2_vector(_mm256_xor_si256(left, right)));
+            }
+            return sum_avx2_lanes(total) + hamming_words<builtin_counter>(lhs + index, rhs + index, bytes - index);
+        }
+
+        __attribute__((target("avx2,popcnt")))
+        static int hamming_shifted_avx2(const byte* lhs, const byte* rhs, size_t offset, size_t bytes)
+        {
+            // There are no 8-bit vector shifts, so shift 16-bit lanes and mask
+            // off the bits that crossed into the neighboring byte
+            const __m128i shift = _mm_cvtsi32_si128(offset);
+            const __m128i rshift = _mm_cvtsi32_si128(8 - offset);
+            const __m256i high_mask = _mm256_set1_epi8((byte) (0xFF << offset));
+            const __m256i low_mask = _mm256_set1_epi8((byte) (0xFF >> (8 - offset)));
+            __m256i total = _mm256_setzero_si256();
+            size_t index = 0;
+            for (; (index + 32) <= bytes; index += 32) {
+                __m256i left = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lhs + index));
+                __m256i right = load_shifted_avx2(rhs + index, shift, rshift, high_mask, low_mask);
+                total = _mm256_add_epi64(total, popcount_avx2_vector(_mm256_xor_si256(left, right)));
+            }
+            return sum_avx2_lanes(total) + hamming_shifted_words<builtin_counter>(lhs + index, rhs + index, offset, bytes - index);
+        }
+#endif // BITOPS_X86_KERNELS
+
+#ifdef BITOPS_AVX512_KERNELS
+        // AVX-512BW versions of the AVX2 kernels, on 64-byte vectors
+        __attribute__((target("avx512f,avx512bw")))
+        static inline __m512i popcount_avx512_vector(__m512i value)
+        {
+            // Same 16-entry table as AVX2, packed into 32-bit elements
+            const __m512i lookup = _mm512_set4_epi32(0x04030302, 0x03020201, 0x03020201, 0x02010100);
+            const __m512i low_mask = _mm512_set1_epi8(0x0F);
+            __m512i low = _mm512_and_si512(value, low_mask);
+            __m512i high = _mm512_and_si512(_mm512_srli_epi16(value, 4), low_mask);
+            __m512i counts = _mm512_add_epi8(_mm512_shuffle_epi8(lookup, low), _mm512_shuffle_epi8(lookup, high));
+            return _mm512_sad_epu8(counts, _mm512_setzero_si512());
+        }
+
+        __attribute__((target("avx512f,avx512bw")))
+        static inline int sum_avx512_lanes(__m512i total)
+        {
+            uint64_t lanes[8];
+            _mm512_storeu_si512(lanes, total);
+            return lanes[0] + lanes[1] + lanes[2] + lanes[3] + lanes[4] + lanes[5] + lanes[6] + lanes[7];
+        }
+
+        __attribute__((target("avx512f,avx512bw,popcnt")))
+        static int popcount_avx512(const byte* data, size_t bytes)
+        {
+            __m512i total = _mm512_setzero_si512();
+            size_t index = 0;
+            for (; (index + 64) <= bytes; index += 64) {
+                __m512i value = _mm512_loadu_si512(data + index);
+                total = _mm512_add_epi64(total, popcount_avx512_vector(value));
+            }
+            return sum_avx512_lanes(total) + popcount_words<builtin_counter>(data + index, bytes - index);
+        }
+
+        __attribute__((target("avx512f,avx512bw,popcnt")))
+        static int hamming_avx512(const byte* lhs, const byte* rhs, size_t bytes)
+        {
+            __m512i total = _mm512_setzero_si512();
+            size_t index = 0;
+            for (; (index + 64) <= bytes; index += 64) {
+                __m512i left = _mm512_loadu_si512(lhs + index);
+                __m512i right = _mm512_loadu_si512(rhs + index);
+                total = _mm512_add_epi64(total, popcount_avx512_vector(_mm512_xor_si512(left, right)));
+            }
+            return sum_avx512_lanes(total) + hamming_words<builtin_counter>(lhs + index, rhs + index, bytes - index);
+        }
+
+        __attribute__((target("avx512f,avx512bw,popcnt")))
+        static int hamming_shifted_avx512(const byte* lhs, const byte* rhs, size_t offset, size_t bytes)
+        {
+            const __m128i shift = _mm_cvtsi32_si128(offset);
+            const __m128i rshift = _mm_cvtsi32_si128(8 - offset);
+            const __m512i high_mask = _mm512_set1_epi8((byte) (0xFF << offset));
+            const __m512i low_mask = _mm512_set1_epi8((byte) (0xFF >> (8 - offset)));
+            __m512i total = _mm512_setzero_si512();
+            size_t index = 0;
+            for (; (index + 64) <= bytes; index += 64) {
+                __m512i left = _mm512_loadu_si512(lhs + index);
+                __m512i first = _mm512_loadu_si512(rhs + index);
+                __m512i second = _mm512_loadu_si512(rhs + index + 1);
+                __m512i high = _mm512_and_si512(_mm512_sll_epi16(first, shift), high_mask);
+                __m512i low = _mm512_and_si512(_mm512_srl_epi16(second, rshift), low_mask);
+                __m512i right = _mm512_or_si512(high, low);
+                total = _mm512_add_epi64(total, popcount_avx512_vector(_mm512_xor_si512(left, right)));
+            }
+            return sum_avx512_lanes(total) + hamming_shifted_words<builtin_counter>(lhs + index, rhs + index, offset, bytes - index);
+        }
+#endif // BITOPS_AVX512_KERNELS
+
+        // Kernel table, selected once based on the capabilities of the CPU
+        struct kernel_table {
+            kernel_type type;
+            int (*popcount)(const byte*, size_t);
+            int (*hamming)(const byte*, const byte*, size_t);
+            int (*hamming_shifted)(const byte*, const byte*, size_t, size_t);
+        };
+
+        static bool cpu_supports(kernel_type type)
+        {
+            switch (type) {
+            case KERNEL_GENERIC:
+                return true;
+#ifdef BITOPS_X86_KERNELS
+            case KERNEL_POPCNT:
+                __builtin_cpu_init();
+                return __builtin_cpu_supports("popcnt");
+            case KERNEL_AVX2:
+                __builtin_cpu_init();
+                return __builtin_cpu_supports("popcnt") && __builtin_cpu_supports("avx2");
+#endif
+#ifdef BITOPS_AVX512_KERNELS
+            case KERNEL_AVX512:
+                __builtin_cpu_init();
+                return __builtin_cpu_supports("popcnt") && __builtin_cpu_supports("avx512bw");
+#endif
+            default:
+                return false;
+            }
+        }
+
+        // Returns the kernel table for a tier; the caller must have already
+        // checked that the tier is supported
+        static kernel_table make_kernels(kernel_type type)
+        {
+            switch (type) {
+#ifdef BITOPS_X86_KERNELS
+            case KERNEL_POPCNT:
+                { kernel_table table = { type, &popcount_popcnt, &hamming_popcnt, &hamming_shifted_popcnt }; return table; }
+            case KERNEL_AVX2:
+                { kernel_table table = { type, &popcount_avx2, &hamming_avx2, &hamming_shifted_avx2 }; return table; }
+#endif
+#ifdef BITOPS_AVX512_KERNELS
+            case KERNEL_AVX512:
+                { kernel_table table = { type, &popcount_avx512, &hamming_avx512, &hamming_shifted_avx512 }; return table; }
+#endif
+            default:
+                { kernel_table table = { KERNEL_GENERIC, &popcount_generic, &hamming_generic, &hamming_shifted_generic }; return table; }
+            }
+        }
+
+        static kernel_table select_kernels()
+        {
+            const kernel_type preferred[] = { KERNEL_AVX512, KERNEL_AVX2, KERNEL_POPCNT };
+            for (size_t ii = 0; ii < sizeof(preferred)/sizeof(preferred[0]); ++ii) {
+                if (cpu_supports(preferred[ii])) {
+                    return make_kernels(preferred[ii]);
+                }
+            }
+            return make_kernels(KERNEL_GENERIC);
+        }
+
+        static kernel_table& kernels()
+        {
+            static kernel_table table = select_kernels();
+            return table;
+        }
+
         // Unary function body for aligned, full-byte operations, performed
         // element-by-element
         template <typename T, class Func>
@@ -349,6 +719,45 @@ namespace bitops {
             rhs += bytes;
         }
 
+        // Binary function body for a byte-aligned left hand side and a right
+        // hand side at a non-zero bit offset, performing the operation
+        // element-by-element
+        template <typename T1, typename T2, class Func>
+        void binop_body_shifted(T1*& lhs, T2*& rhs, size_t rhs_offset, size_t bytes, Func& func, element_tag)
+        {
+            typedef bit_handler<typename Func::right_mode_tag> rhs_handler;
+
+            // Iterate through each byte from the left-hand side
+            for (size_t ii = 0; ii < bytes; ++ii) {
+                // Fetch the right-hand value from two adjacent bytes if
+                // needed
+                byte rhs_value = rhs_handler::read_split(rhs, rhs_offset);
+                // Apply the function; it is not necessary to read or write
+                // via a bit handler because we are using the real byte
+                // address
+                func(*lhs, rhs_value, 8);
+                // Write back the right hand side (if needed)
+                rhs_handler::write_split(rhs_value, rhs, rhs_offset);
+                if (func.complete()) {
+                    return;
+                }
+                ++lhs;
+                ++rhs;
+            }
+        }
+
+        // Binary function body for a byte-aligned left hand side and a right
+        // hand side at a non-zero bit offset, where the functor supports
+        // array-based operation with a shift (reading one byte past the end
+        // of the right hand side)
+        template <typename T1, typename T2, class Func>
+        void binop_body_shifted(T1*& lhs, T2*& rhs, size_t rhs_offset, size_t bytes, Func& func, array_tag)
+        {
+            func(lhs, rhs, rhs_offset, bytes);
+            lhs += bytes;
+            rhs += bytes;
+        }
+
         // Applies a binary function across two equal-length arrays of bits.
         // The data types, T1 and T2, are templatized to support const/non-
         // const  byte data (inner functions eventually specify "const byte*"
@@ -362,9 +771,10 @@ namespace bitops {
         //    right_mode_tag - how rhs is accessed (one of read_tag, write_tag
         //                     or readwrite_tag)
         //    body_tag       - element_tag for element-by-element processing of
-        //                     exact aligned, full-byte data, or array_tag if
-        //                     Func has an array-based operator() that can be
-        //                     applied to a whole data set
+        //                     full-byte data, or array_tag if Func has array-
+        //                     based operator() overloads that can be applied
+        //                     to a whole data set, both for exact alignment
+        //                     and for a right hand side at a bit offset
         //
         // This template function is designed to support all types of read/
         // write/update methods across two bit arrays as efficiently as
@@ -427,23 +837,10 @@ namespace bitops {
                     return func.returns();
                 }
             } else {
-                // The two bit arrays are not exactly aligned; iterate through
-                // each byte from the left-hand side
-                for (size_t ii = 0; ii < bytes; ++ii) {
-                    // Fetch the right-hand value from two adjacent bytes if
-                    // needed
-                    byte rhs_value = rhs_handler::read_split(rhs, rhs_offset);
-                    // Apply the function; it is not necessary to read or write
-                    // via a bit handler because we are using the real byte
-                    // address
-                    func(*lhs, rhs_value, 8);
-                    // Write back the right hand side (if needed)
-                    rhs_handler::write_split(rhs_value, rhs, rhs_offset);
-                    if (func.complete()) {
-                        return func.returns();
-                    }
-                    ++lhs;
-                    ++rhs;
+                // The two bit arrays are not exactly aligned
+                binop_body_shifted(lhs, rhs, rhs_offset, bytes, func, typename Func::body_tag());
+                if (func.complete()) {
+                    return func.returns();
                 }
             }
 
@@ -572,6 +969,25 @@ namespace bitops {
     //
     // Public function implementations
     //
+    bool kernels_supported(kernel_type type)
+    {
+        return cpu_supports(type);
+    }
+
+    kernel_type get_kernels()
+    {
+        return kernels().type;
+    }
+
+    bool set_kernels(kernel_type type)
+    {
+        if (!cpu_supports(type)) {
+            return false;
+        }
+        kernels() = make_kernels(type);
+        return true;
+    }
+
     bool getbit(const byte* str, size_t pos)
     {
         const size_t bit_offset = adjust_buffer(str, pos);
@@ -738,6 +1154,18 @@ namespace bitops {
             // Copy aligned bytes directly
             std::memcpy(dest, src, bytes);
         }
+
+        inline void operator() (byte* dest, const byte* src, size_t offset, size_t bytes)
+        {
+            // Shift unaligned source bits into place a word at a time
+            size_t index = 0;
+            for (; (index + 8) <= bytes; index += 8) {
+                store_be(dest + index, load_shifted(src + index, offset));
+            }
+            for (; index < bytes; ++index) {
+                dest[index] = bit_reader::read_split(src + index, offset);
+            }
+        }
     };
 
     void copy(byte* dest, size_t dstart, const byte* src, size_t sstart, size_t length)
@@ -768,6 +1196,26 @@ namespace bitops {
             result = memcmp(lhs, rhs, bytes);
         }
 
+        inline void operator() (const byte* lhs, const byte* rhs, size_t offset, size_t bytes)
+        {
+            // Big-endian words compare the same way as their bytes in order
+            size_t index = 0;
+            for (; (index + 8) <= bytes; index += 8) {
+                uint64_t lhs_word = load_be(lhs + index);
+                uint64_t rhs_word = load_shifted(rhs + index, offset);
+                if (lhs_word != rhs_word) {
+                    result = (lhs_word > rhs_word) ? 1 : -1;
+                    return;
+                }
+            }
+            for (; index < bytes; ++index) {
+                (*this)(lhs[index], bit_reader::read_split(rhs + index, offset), 8);
+                if (complete()) {
+                    return;
+                }
+            }
+        }
+
         bool complete()
         {
             return (result != 0);
@@ -781,12 +1229,17 @@ namespace bitops {
 
     // Unary getter functor that returns the population count (Hamming weight)
     // of the input bit array.
-    class Popcount : public UnaryGetter<int> {
+    class Popcount : public UnaryGetter<int,array_tag> {
     public:
         inline void operator() (byte value, size_t /*unused*/)
         {
             result += hammingWeights[value];
         }
+
+        inline void operator() (const byte* data, size_t bytes)
+        {
+            result += kernels().popcount(data, bytes);
+        }
     };
 
     int popcount(const byte* str, size_t offset, size_t count)
@@ -901,11 +1354,21 @@ namespace bitops {
 
     // Hamming distance functor that accumulates the number of bit positions
     // that differ between two bit arrays.
-    class HammingDist : public BinaryGetter<int> {
+    class HammingDist : public BinaryGetter<int,array_tag> {
     public:
         inline void operator() (byte lhs, byte rhs, size_t /*unused*/) {
             result += hammingWeights[lhs ^ rhs];
         }
+
+        inline void operator() (const byte* lhs, const byte* rhs, size_t bytes)
+        {
+            result += kernels().hamming(lhs, rhs, bytes);
+        }
+
+        inline void operator() (const byte* lhs, const byte* rhs, size_t offset, size_t bytes)
+        {
+            result += kernels().hamming_shifted(lhs, rhs, offset, bytes);
+        }
     };
 
     int hammingDistance(const byte* s1, size_t start1, const byte* s2, size_t start2, size_t length)
@@ -916,7 +1379,9 @@ namespace bitops {
 
     // Hamming distance-based comparsion, for inexact search up to a maximum
     // number of bit differences. The complete() method is overridden to return
-    // early once a the Hamming distance exceeds the threshold.
+    // early once a the Hamming distance exceeds the threshold; array-based
+    // operations are split into chunks so that long patterns can also stop
+    // early.
     class HammingCompare : public HammingDist {
     public:
         HammingCompare(int maxDistance) :
@@ -924,15 +1389,56 @@ namespace bitops {
         {
         }
 
+        using HammingDist::operator();
+
+        inline void operator() (const byte* lhs, const byte* rhs, size_t bytes)
+        {
+            for (size_t index = 0; (index < bytes) && !complete(); index += CHUNK_BYTES) {
+                HammingDist::operator()(lhs + index, rhs + index, std::min(bytes - index, CHUNK_BYTES));
+            }
+        }
+
+        inline void operator() (const byte* lhs, const byte* rhs, size_t offset, size_t bytes)
+        {
+            for (size_t index = 0; (index < bytes) && !complete(); index += CHUNK_BYTES) {
+                HammingDist::operator()(lhs + index, rhs + index, offset, std::min(bytes - index, CHUNK_BYTES));
+            }
+        }
+
         bool complete()
         {
             return result > _maxDistance;
         }
 
     private:
+        static const size_t CHUNK_BYTES = 64;
+
         int _maxDistance;
     };
 
+    // CHUNK_BYTES is bound to a reference by std::min, so it needs a definition
+    const size_t HammingCompare::CHUNK_BYTES;
+
+    // Bitap scan callback that stops at the first occurrence
+    class FirstMatch {
+    public:
+        FirstMatch() :
+            found(false),
+            end(0)
+        {
+        }
+
+        inline bool operator() (size_t index, int /*unused*/)
+        {
+            found = true;
+            end = index;
+            return true;
+        }
+
+        bool found;
+        size_t end;
+    };
+
     int find(const byte* str, size_t sstart, size_t slen,
              const byte* patt, size_t pstart, size_t plen,
              int maxdist)
@@ -940,10 +1446,27 @@ namespace bitops {
         // Basic validity checks
         if (slen < plen) {
             throw std::logic_error("pattern is longer than string");
+        } else if (maxdist < 0) {
+            return -1;
+        }
+
+        if ((plen > 0) && (plen <= 64)) {
+            // Use a bit-parallel search, which does a fixed amount of work per
+            // bit of the string
+            const bitap::pattern pattern = bitap::make_pattern(patt, pstart, plen, maxdist);
+            uint64_t states[65];
+            std::fill(states, states + pattern.errors + 1, ~0ULL);
+            FirstMatch match;
+            bitap::scan(str, sstart, slen, pattern, states, match);
+            if (match.found) {
+                return match.end + 1 - plen;
+            }
+            return -1;
         }
 
-        const size_t end = slen - plen;
-        for (size_t index = sstart; index < end; ++index) {
+        // Patterns that do not fit in a machine word are compared at each
+        // position
+        for (size_t index = sstart; (index + plen) <= slen; ++index) {
             // Use a Hamming calculation that short-circuits if the maximum
             // distance is exceeded
             int dist = apply_binop(str, index, patt, pstart, plen, HammingCompare(maxdist));
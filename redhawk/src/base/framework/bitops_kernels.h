@@ -0,0 +1,53 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK core.
+ *
+ * REDHAWK core is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK core is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+#ifndef REDHAWK_BITOPS_KERNELS_H
+#define REDHAWK_BITOPS_KERNELS_H
+
+namespace redhawk {
+
+    namespace bitops {
+
+        // Instruction set tiers for the popcount and Hamming distance
+        // kernels, in order of preference. By default, the best tier that the
+        // CPU supports is selected the first time a kernel is needed; these
+        // functions exist so that the unit tests can exercise every tier.
+        enum kernel_type {
+            KERNEL_GENERIC,
+            KERNEL_POPCNT,
+            KERNEL_AVX2,
+            KERNEL_AVX512
+        };
+
+        // Returns true if the given tier was compiled in and the CPU supports
+        // it.
+        bool kernels_supported(kernel_type type);
+
+        // Returns the tier currently in use.
+        kernel_type get_kernels();
+
+        // Switches to the given tier, returning false (and leaving the
+        // current tier unchanged) if it is not supported. Not thread-safe; it
+        // must not be called while another thread is using the bit operations.
+        bool set_kernels(kernel_type type);
+    }
+}
+
+#endif // REDHAWK_BITOPS_KERNELS_H
@@ -0,0 +1,208 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK core.
+ *
+ * REDHAWK core is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK core is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+#include <ossie/bitsearch.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "bitap.h"
+
+using redhawk::bitsearch;
+
+namespace {
+    // Bitap scan callback that records occurrences of one pattern
+    class MatchCollector {
+    public:
+        MatchCollector(std::vector<bitsearch::match>& matches, size_t pattern, size_t size,
+                       uint64_t base, bool firstOnly) :
+            _matches(matches),
+            _pattern(pattern),
+            _size(size),
+            _base(base),
+            _firstOnly(firstOnly)
+        {
+        }
+
+        inline bool operator() (size_t index, int distance)
+        {
+            bitsearch::match result;
+            result.position = _base + index + 1 - _size;
+            result.pattern = _pattern;
+            result.distance = distance;
+            _matches.push_back(result);
+            return _firstOnly;
+        }
+
+    private:
+        std::vector<bitsearch::match>& _matches;
+        const size_t _pattern;
+        const size_t _size;
+        const uint64_t _base;
+        const bool _firstOnly;
+    };
+
+    // Orders occurrences by their last bit, then by pattern index
+    class MatchOrder {
+    public:
+        MatchOrder(const std::vector<size_t>& sizes) :
+            _sizes(sizes)
+        {
+        }
+
+        inline bool operator() (const bitsearch::match& lhs, const bitsearch::match& rhs) const
+        {
+            const uint64_t lhs_end = lhs.position + _sizes[lhs.pattern];
+            const uint64_t rhs_end = rhs.position + _sizes[rhs.pattern];
+            if (lhs_end != rhs_end) {
+                return lhs_end < rhs_end;
+            }
+            return lhs.pattern < rhs.pattern;
+        }
+
+    private:
+        const std::vector<size_t>& _sizes;
+    };
+}
+
+bitsearch::bitsearch() :
+    _M_position(0)
+{
+}
+
+bitsearch::bitsearch(const shared_bitbuffer& pattern, int maxDistance) :
+    _M_position(0)
+{
+    add_pattern(pattern, maxDistance);
+}
+
+size_t bitsearch::add_pattern(const shared_bitbuffer& pattern, int maxDistance)
+{
+    if (pattern.empty() || (pattern.size() > max_pattern_size)) {
+        throw std::length_error("redhawk::bitsearch::add_pattern()");
+    }
+
+    // A negative distance can never match, which is represented by an error
+    // count of -1 and no state words
+    const bitap::pattern compiled = bitap::make_pattern(pattern.data(), pattern.offset(),
+                                                        pattern.size(), maxDistance);
+    _M_pattern entry;
+    entry.masks[0] = compiled.masks[0];
+    entry.masks[1] = compiled.masks[1];
+    entry.match_bit = compiled.match_bit;
+    entry.size = compiled.size;
+    entry.errors = compiled.errors;
+    entry.state = _M_states.size();
+    _M_patterns.push_back(entry);
+    _M_states.resize(_M_states.size() + entry.errors + 1);
+
+    reset();
+    return _M_patterns.size() - 1;
+}
+
+size_t bitsearch::pattern_count() const
+{
+    return _M_patterns.size();
+}
+
+size_t bitsearch::find(const shared_bitbuffer& buffer, size_t start) const
+{
+    match result;
+    if (find(buffer, start, result)) {
+        return result.position;
+    }
+    return npos;
+}
+
+bool bitsearch::find(const shared_bitbuffer& buffer, size_t start, match& result) const
+{
+    if (start >= buffer.size()) {
+        return false;
+    }
+    _M_state_vector states(_M_states.size(), ~0ULL);
+    std::vector<match> matches;
+    if (_M_search(buffer, start, states, 0, matches, true)) {
+        result = matches.front();
+        return true;
+    }
+    return false;
+}
+
+size_t bitsearch::push(const shared_bitbuffer& buffer, std::vector<match>& matches)
+{
+    const size_t count = _M_search(buffer, 0, _M_states, _M_position, matches, false);
+    _M_position += buffer.size();
+    return count;
+}
+
+uint64_t bitsearch::position() const
+{
+    return _M_position;
+}
+
+void bitsearch::reset()
+{
+    std::fill(_M_states.begin(), _M_states.end(), ~0ULL);
+    _M_position = 0;
+}
+
+size_t bitsearch::_M_search(const shared_bitbuffer& buffer, size_t start, _M_state_vector& states,
+                            uint64_t base, std::vector<match>& matches, bool firstOnly) const
+{
+    const size_t first = matches.size();
+    const unsigned char* data = buffer.data();
+    const size_t offset = buffer.offset();
+    size_t end = offset + buffer.size();
+    std::vector<size_t> sizes;
+    sizes.reserve(_M_patterns.size());
+
+    // Scan the whole buffer for one pattern at a time, so that its state
+    // words can stay in registers
+    for (size_t index = 0; index < _M_patterns.size(); ++index) {
+        const _M_pattern& entry = _M_patterns[index];
+        sizes.push_back(entry.size);
+        if (entry.errors < 0) {
+            continue;
+        }
+        bitap::pattern patt;
+        patt.masks[0] = entry.masks[0];
+        patt.masks[1] = entry.masks[1];
+        patt.match_bit = entry.match_bit;
+        patt.size = entry.size;
+        patt.errors = entry.errors;
+
+        const size_t count = matches.size();
+        MatchCollector collector(matches, index, entry.size, base - offset, firstOnly);
+        bitap::scan(data, offset + start, end, patt, &states[entry.state], collector);
+
+        // For a one-shot search, later patterns only need to be checked for
+        // occurrences that end before the earliest one so far (ties go to
+        // the pattern added first)
+        if (firstOnly && (matches.size() > count)) {
+            end = matches.back().position - (base - offset) + entry.size - 1;
+        }
+    }
+
+    std::stable_sort(matches.begin() + first, matches.end(), MatchOrder(sizes));
+    if (firstOnly && (matches.size() > first)) {
+        matches.resize(first + 1);
+    }
+    return matches.size() - first;
+}
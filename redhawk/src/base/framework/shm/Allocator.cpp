@@ -91,6 +91,14 @@ namespace redhawk {
             heap->deallocate(ptr);
         }
 
+        void setNodeHint(int node)
+        {
+            Heap* heap = getProcessHeap();
+            if (heap) {
+                heap->setNodeHint(node);
+            }
+        }
+
         void* allocateHybrid(size_t bytes)
         {
             redhawk::shm::Heap* heap = redhawk::shm::getProcessHeap();
@@ -31,23 +31,53 @@
 #include <iostream>
 #include <cstdlib>
 #include <vector>
+#include <map>
 
 #include <unistd.h>
+#include <time.h>
+#include <sys/mman.h>
+
+#ifdef HAVE_LIBNUMA
+#include <numa.h>
+#include <numaif.h>
+#endif
 
 #include <boost/thread.hpp>
 #include <boost/scoped_ptr.hpp>
 
+// Upper bound on the bytes each thread may cache per size class, so that the
+// magazines for large classes only hold a few blocks
+#define MAGAZINE_BYTES_PER_CLASS 524288
+#define DEFAULT_MAGAZINE_SIZE 32
+
+// Default time, in seconds, that a superblock must sit empty before its
+// memory is returned to the OS; reclamation is opt-in
+#define DEFAULT_DECAY_TIME 0.0
+
+// Shortest period between checks for idle superblocks, so that a very small
+// decay time does not turn the reclaim thread into a busy loop
+#define MIN_RECLAIM_INTERVAL_MS 100
+
 #define PAGE_ROUND_DOWN(x,p) ((x/p)*p)
 #define PAGE_ROUND_UP(x,p) (((x+p-1)/p)*p)
 
 namespace redhawk {
     namespace shm {
         namespace {
+            static double monotonicTime()
+            {
+                struct timespec now;
+                clock_gettime(CLOCK_MONOTONIC, &now);
+                return now.tv_sec + (now.tv_nsec * 1e-9);
+            }
+
             static HeapPolicy* initializePolicy()
             {
                 std::string policy_type = redhawk::env::getVariable("RH_SHMALLOC_POLICY", "thread");
                 if (policy_type == "cpu") {
                     return new CPUHeapPolicy;
+                } else if (policy_type == "numa") {
+                    return new NUMAHeapPolicy;
                 } else {
                     if (policy_type != "thread") {
                         std::cerr << "Invalid SHM heap policy '" << policy_type << "'" << std::endl;
@@ -57,6 +87,10 @@ namespace redhawk {
             }
 
             static boost::scoped_ptr<HeapPolicy> policy(initializePolicy());
+
+            // Guards the ThreadState back-pointers to their heaps, which are
+            // read by exiting threads and cleared by the heap destructor
+            static boost::mutex registryMutex;
         }
     }
 }
@@ -72,6 +106,7 @@ class Heap::Pool {
 public:
     Pool(int id, Heap* heap) :
         _id(id),
+        _node(policy->getPoolNode(id)),
         _heap(heap)
     {
         RECORD_SHM_METRIC(pools_created);
@@ -92,7 +127,7 @@ public:
             }
         }
 
-        Superblock* superblock = _heap->_createSuperblock(bytes);
+        Superblock* superblock = _heap->_createSuperblock(bytes, _node);
         if (superblock) {
             RECORD_SHM_METRIC_IF(_superblocks.empty(), pools_used);
             _superblocks.insert(_superblocks.begin(), superblock);
@@ -104,30 +139,98 @@ public:
         return 0;
     }
 
+    void reclaim(double now, double decayTime)
+    {
+        boost::mutex::scoped_lock lock(_mutex);
+        SuperblockList::iterator superblock = _superblocks.begin();
+        while (superblock != _superblocks.end()) {
+            if (!(*superblock)->trim()) {
+                // In use; restart the idle clock if it was running
+                _idleSince.erase(*superblock);
+                ++superblock;
+                continue;
+            }
+
+            IdleMap::iterator idle = _idleSince.find(*superblock);
+            if (idle == _idleSince.end()) {
+                _idleSince[*superblock] = now;
+                ++superblock;
+            } else if ((now - idle->second) < decayTime) {
+                ++superblock;
+            } else {
+                // Nothing is allocated from the superblock, and with the pool
+                // lock held nothing can be, so it is safe to give it up
+                _idleSince.erase(idle);
+                _heap->_releaseSuperblock(*superblock);
+                superblock = _superblocks.erase(superblock);
+            }
+        }
+    }
+
+    int node() const
+    {
+        return _node;
+    }
+
 private:
     int _id;
+    int _node;
     Heap* _heap;
 
     boost::mutex _mutex;
     typedef std::vector<Superblock*> SuperblockList;
     SuperblockList _superblocks;
+
+    typedef std::map<Superblock*,double> IdleMap;
+    IdleMap _idleSince;
 };
 
 Heap::Heap(const std::string& name) :
     _file(name),
-    _canGrow(true)
+    _canGrow(true),
+    _hugePages(false),
+    _decayTime(_defaultDecayTime),
+    _reclaimThread(0),
+    _reclaimStop(false),
+    _threadState(&Heap::_releaseThreadState)
 {
     _file.create();
     int num_pools = policy->getPoolCount();
     for (int id = 0; id < num_pools; ++id) {
         _allocs.push_back(new Pool(id, this));
     }
+    if (_defaultHugePages) {
+        setHugePages(true);
+    }
 
     RECORD_SHM_METRIC(heaps_created);
 }
 
 Heap::~Heap()
 {
+    if (_reclaimThread) {
+        {
+            boost::mutex::scoped_lock lock(_mutex);
+            _reclaimStop = true;
+            _reclaimCond.notify_all();
+        }
+        _reclaimThread->join();
+        delete _reclaimThread;
+    }
+
+    // Return this thread's cached blocks while the superblocks are still
+    // mapped, then detach any other threads' state so that their exit does
+    // not touch the heap
+    _threadState.reset();
+    {
+        boost::mutex::scoped_lock registry_lock(registryMutex);
+        boost::mutex::scoped_lock lock(_mutex);
+        for (std::set<ThreadState*>::iterator state = _threadStates.begin(); state != _threadStates.end(); ++state) {
+            (*state)->heap = 0;
+        }
+        _threadStates.clear();
+    }
+
     // Remove the file when the owner exits; other processes connected to the
     // same superblock file will still be able to access everything, but no new
     // connections are possible
@@ -141,13 +244,92 @@ Heap::~Heap()
 void* Heap::allocate(size_t bytes)
 {
     ThreadState* state = _getThreadState();
+    if ((state->nodeHint < 0) && (_magazineSize > 0)) {
+        // Magazine blocks may have come from any node, so they are not used
+        // when the thread has asked for a specific one. If the reclaim thread
+        // is flushing them right now, go straight to the pool instead.
+        if (state->claimMagazines(ThreadState::MAGAZINES_OWNER)) {
+            void* ptr = _allocateFromMagazine(state, bytes);
+            state->releaseMagazines();
+            if (ptr) {
+                return ptr;
+            }
+        }
+    }
     Pool* pool = _getPool(state);
+    const int node = pool->node();
+    if ((node >= 0) && (node < Metrics::MAX_NUMA_NODES)) {
+        RECORD_SHM_METRIC(numa_allocations[node]);
+        RECORD_SHM_METRIC_IF(state->nodeHint >= 0, numa_hinted_allocations);
+    }
     return pool->allocate(state, bytes);
 }
 
+void Heap::setNodeHint(int node)
+{
+    _getThreadState()->nodeHint = (node < 0) ? -1 : node;
+}
+
+int Heap::getNodeHint()
+{
+    return _getThreadState()->nodeHint;
+}
+
+void Heap::setHugePages(bool enable)
+{
+    if (enable && !MappedFile::HugePagesSupported()) {
+        std::cerr << "Huge pages are not available for shared memory, using normal pages" << std::endl;
+        enable = false;
+    }
+    boost::mutex::scoped_lock lock(_mutex);
+    _hugePages = enable;
+}
+
+bool Heap::getHugePages()
+{
+    boost::mutex::scoped_lock lock(_mutex);
+    return _hugePages;
+}
+
+void Heap::setDecayTime(double seconds)
+{
+    boost::mutex::scoped_lock lock(_mutex);
+    _decayTime = std::max(seconds, 0.0);
+    if ((_decayTime > 0.0) && !_reclaimThread) {
+        _reclaimThread = new boost::thread(&Heap::_reclaimThreadMain, this);
+    } else {
+        // Wake the reclaim thread so that it picks up the new interval
+        _reclaimCond.notify_all();
+    }
+}
+
+double Heap::getDecayTime()
+{
+    boost::mutex::scoped_lock lock(_mutex);
+    return _decayTime;
+}
+
 void Heap::deallocate(void* ptr)
 {
-    Superblock::deallocate(ptr);
+    ThreadState* state = _threadState.get();
+    if (!ptr || !state || (_magazineSize == 0)) {
+        Superblock::deallocate(ptr);
+        return;
+    }
+
+    Block* block = Block::from_pointer(ptr);
+    assert(block->valid());
+    RECORD_SHM_METRIC(blocks_released);
+    if (block->decref() == 0) {
+        bool cached = false;
+        if (state->claimMagazines(ThreadState::MAGAZINES_OWNER)) {
+            cached = _cacheInMagazine(state, block);
+            state->releaseMagazines();
+        }
+        if (!cached) {
+            Superblock::release(&block, 1);
+        }
+    }
 }
 
 MemoryRef Heap::getRef(const void* ptr)
@@ -185,17 +367,135 @@ ThreadState* Heap::_getThreadState()
         state = new ThreadState;
         _threadState.reset(state);
         policy->initThreadState(state);
+
+        state->heap = this;
+        for (int size_class = 0; size_class < Superblock::NUM_SIZE_CLASSES; ++size_class) {
+            size_t capacity = MAGAZINE_BYTES_PER_CLASS / Superblock::getClassSize(size_class);
+            capacity = std::max(capacity, (size_t) 1);
+            state->magazines[size_class].capacity = std::min(capacity, (size_t) _magazineSize);
+        }
+
+        boost::mutex::scoped_lock lock(_mutex);
+        _threadStates.insert(state);
     }
     return state;
 }
 
-Superblock* Heap::_createSuperblock(size_t minSize)
+void* Heap::_allocateFromMagazine(ThreadState* state, size_t bytes)
 {
-    boost::mutex::scoped_lock lock(_mutex);
-    if (!_canGrow) {
+    if (bytes > Superblock::getClassSize(Superblock::NUM_SIZE_CLASSES - 1)) {
+        return 0;
+    }
+    Magazine& magazine = state->magazines[Superblock::getSizeClass(bytes)];
+    if (magazine.empty()) {
         return 0;
     }
 
+    // The block was never returned to its superblock, so it only needs to be
+    // marked in use again
+    state->magazinesActive = true;
+    Block* block = magazine.pop();
+    block->markUsed();
+    RECORD_SHM_METRIC(magazine_alloc_hit);
+    return block->data();
+}
+
+bool Heap::_cacheInMagazine(ThreadState* state, Block* block)
+{
+    // Only cache blocks from this heap; blocks from another process' heap
+    // must go back to their owner
+    Superblock* superblock = block->getSuperblock();
+    if (!superblock || (name() != superblock->heap())) {
+        return false;
+    }
+
+    // File the block under the largest size class that it can satisfy; blocks
+    // beyond the largest class would be handed out for much smaller requests,
+    // keeping large amounts of memory tied up, so they are never cached
+    size_t capacity = block->byteSize() - sizeof(Block);
+    if (capacity > Superblock::getClassSize(Superblock::NUM_SIZE_CLASSES - 1)) {
+        return false;
+    }
+    int size_class = Superblock::getSizeClass(capacity);
+    if (Superblock::getClassSize(size_class) > capacity) {
+        if (size_class == 0) {
+            return false;
+        }
+        --size_class;
+    }
+
+    Magazine& magazine = state->magazines[size_class];
+    if (magazine.capacity == 0) {
+        return false;
+    }
+    if (magazine.full()) {
+        Superblock::release(magazine.blocks, magazine.count);
+        magazine.count = 0;
+        RECORD_SHM_METRIC(magazine_flushes);
+    }
+    state->magazinesActive = true;
+    magazine.push(block);
+    RECORD_SHM_METRIC(magazine_cached);
+    return true;
+}
+
+void Heap::_flushMagazines(ThreadState* state)
+{
+    for (int size_class = 0; size_class < Superblock::NUM_SIZE_CLASSES; ++size_class) {
+        Magazine& magazine = state->magazines[size_class];
+        if (!magazine.empty()) {
+            Superblock::release(magazine.blocks, magazine.count);
+            magazine.count = 0;
+        }
+    }
+}
+
+void Heap::_flushIdleMagazines()
+{
+    // Blocks in a magazine still count as used in their superblocks, so an
+    // idle thread's magazines would keep those superblocks from ever being
+    // reclaimed; return the blocks of any thread that has not touched its
+    // magazines since the last pass. A thread that holds its magazines claim
+    // is by definition not idle, so it is skipped rather than waited on.
+    boost::mutex::scoped_lock lock(_mutex);
+    for (std::set<ThreadState*>::iterator state = _threadStates.begin(); state != _threadStates.end(); ++state) {
+        if (!(*state)->claimMagazines(ThreadState::MAGAZINES_RECLAIM)) {
+            continue;
+        }
+        if ((*state)->magazinesActive) {
+            (*state)->magazinesActive = false;
+        } else {
+            _flushMagazines(*state);
+        }
+        (*state)->releaseMagazines();
+    }
+}
+
+void Heap::_releaseThreadState(ThreadState* state)
+{
+    // Called on thread exit (or heap destruction, for the destroying thread).
+    // The registry lock keeps the heap from being destroyed between reading
+    // the back-pointer and returning the cached blocks; once the state is
+    // removed from the set, the reclaim thread can no longer reach it, so the
+    // magazines can be flushed without claiming them.
+    {
+        boost::mutex::scoped_lock registry_lock(registryMutex);
+        Heap* heap = state->heap;
+        if (heap) {
+            {
+                boost::mutex::scoped_lock lock(heap->_mutex);
+                heap->_threadStates.erase(state);
+            }
+            heap->_flushMagazines(state);
+        }
+    }
+    delete state;
+}
+
+Superblock* Heap::_createSuperblock(size_t minSize, int node)
+{
+    boost::mutex::scoped_lock lock(_mutex);
+
     // Ensure that the superblock is large enough for the request, accounting
     // for the overhead of the block metadata (roughly)
     size_t superblock_size = _superblockSize;
@@ -203,13 +503,140 @@ Superblock* Heap::_createSuperblock(size_t minSize)
     if (minSize > superblock_size) {
         superblock_size = PAGE_ROUND_UP(minSize, MappedFile::PAGE_SIZE);
     }
+    if (_hugePages) {
+        superblock_size = PAGE_ROUND_UP(superblock_size, MappedFile::HUGE_PAGE_SIZE);
+    }
+
+    // Prefer a previously reclaimed superblock, which does not grow the file
+    Superblock* superblock = _reuseSuperblock(superblock_size);
+    if (superblock) {
+        _bindSuperblock(superblock, node);
+        return superblock;
+    }
+
+    if (!_canGrow) {
+        return 0;
+    }
 
     try {
-        return _file.createSuperblock(superblock_size);
+        superblock = _file.createSuperblock(superblock_size, _hugePages);
     } catch (const std::bad_alloc&) {
         _canGrow = false;
         return 0;
     }
+
+    _bindSuperblock(superblock, node);
+
+    // Start reclaiming once there is something to reclaim
+    if ((_decayTime > 0.0) && !_reclaimThread) {
+        _reclaimThread = new boost::thread(&Heap::_reclaimThreadMain, this);
+    }
+    return superblock;
+}
+
+Superblock* Heap::_reuseSuperblock(size_t minSize)
+{
+    // Take the smallest reclaimed superblock that fits
+    std::vector<Superblock*>::iterator best = _freeSuperblocks.end();
+    for (std::vector<Superblock*>::iterator iter = _freeSuperblocks.begin(); iter != _freeSuperblocks.end(); ++iter) {
+        if (((*iter)->size() >= minSize) && ((best == _freeSuperblocks.end()) || ((*iter)->size() < (*best)->size()))) {
+            best = iter;
+        }
+    }
+    if (best == _freeSuperblocks.end()) {
+        return 0;
+    }
+
+    Superblock* superblock = *best;
+    _freeSuperblocks.erase(best);
+
+    // Re-initialize in place; the header page was kept, and the data pages
+    // fault back in (zeroed) as they are touched
+    const size_t offset = superblock->offset();
+    const size_t size = superblock->size();
+    const size_t data_offset = superblock->dataOffset();
+    const bool huge_pages = superblock->hugePages();
+    superblock = new (superblock) Superblock(name(), offset, size, data_offset, huge_pages);
+    RECORD_SHM_METRIC(superblocks_recycled);
+    return superblock;
+}
+
+void Heap::_bindSuperblock(Superblock* superblock, int node)
+{
+    if (node < 0) {
+        return;
+    }
+#ifdef HAVE_LIBNUMA
+    // Prefer (rather than require) the node, so that a full node spills over
+    // instead of failing page faults; the policy belongs to the shared memory
+    // object, so it also applies to pages first touched by other processes.
+    // Pages that were already touched, such as the header, are moved.
+    if ((numa_available() != -1) && (node < (int) (sizeof(unsigned long) * 8))) {
+        unsigned long nodemask = 1UL << node;
+        const size_t bytes = superblock->dataOffset() + superblock->size();
+        if (mbind(superblock, bytes, MPOL_PREFERRED, &nodemask, sizeof(nodemask) * 8, MPOL_MF_MOVE) != 0) {
+            return;
+        }
+    }
+#endif
+    if (node < Metrics::MAX_NUMA_NODES) {
+        RECORD_SHM_METRIC(numa_superblocks[node]);
+        RECORD_SHM_METRIC_ADD(numa_superblock_bytes[node], superblock->size());
+    }
+}
+
+void Heap::_releaseSuperblock(Superblock* superblock)
+{
+    // Return the data pages to the OS, keeping the header page so that other
+    // processes' mappings and the file layout stay valid; if hole punching is
+    // not supported, fall back to removing the pages through this mapping
+    const size_t offset = superblock->offset() + superblock->dataOffset();
+    const size_t size = superblock->size();
+    if (!_file.file().release(offset, size)) {
+        char* data = reinterpret_cast<char*>(superblock) + superblock->dataOffset();
+        madvise(data, size, MADV_REMOVE);
+    }
+
+    RECORD_SHM_METRIC(superblocks_reclaimed);
+    RECORD_SHM_METRIC_ADD(reclaimed_bytes, size);
+
+    boost::mutex::scoped_lock lock(_mutex);
+    _freeSuperblocks.push_back(superblock);
+}
+
+void Heap::_reclaimThreadMain()
+{
+    while (true) {
+        double decay_time;
+        {
+            boost::mutex::scoped_lock lock(_mutex);
+            if (!_reclaimStop) {
+                if (_decayTime > 0.0) {
+                    // Check often enough that a superblock is reclaimed within
+                    // about one and a half times the decay time
+                    long msec = std::max((long) (_decayTime * 500), (long) MIN_RECLAIM_INTERVAL_MS);
+                    _reclaimCond.timed_wait(lock, boost::posix_time::milliseconds(msec));
+                } else {
+                    // Reclamation was disabled after the thread started
+                    _reclaimCond.wait(lock);
+                }
+            }
+            if (_reclaimStop) {
+                return;
+            }
+            decay_time = _decayTime;
+        }
+        if (decay_time <= 0.0) {
+            continue;
+        }
+
+        _flushIdleMagazines();
+
+        const double now = monotonicTime();
+        for (std::vector<Pool*>::iterator pool = _allocs.begin(); pool != _allocs.end(); ++pool) {
+            (*pool)->reclaim(now, decay_time);
+        }
+    }
 }
 
 size_t Heap::_initSuperblockSize()
@@ -223,3 +650,27 @@ size_t Heap::_initSuperblockSize()
 }
 
 size_t Heap::_superblockSize = Heap::_initSuperblockSize();
+
+bool Heap::_initHugePages()
+{
+    return redhawk::env::getEnable("RH_SHMALLOC_HUGEPAGES", false);
+}
+
+bool Heap::_defaultHugePages = Heap::_initHugePages();
+
+int Heap::_initMagazineSize()
+{
+    int magazine_size = redhawk::env::getVariable("RH_SHMALLOC_MAGAZINE_SIZE", DEFAULT_MAGAZINE_SIZE);
+    magazine_size = std::max(magazine_size, 0);
+    return std::min(magazine_size, (int) Magazine::MAX_CAPACITY);
+}
+
+int Heap::_magazineSize = Heap::_initMagazineSize();
+
+double Heap::_initDecayTime()
+{
+    double decay_time = redhawk::env::getVariable("RH_SHMALLOC_DECAY_TIME", DEFAULT_DECAY_TIME);
+    return std::max(decay_time, 0.0);
+}
+
+double Heap::_defaultDecayTime = Heap::_initDecayTime();
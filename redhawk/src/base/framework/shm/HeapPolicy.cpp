@@ -8,6 +8,10 @@
 #include <sys/syscall.h>
 #include <sys/types.h>
 
+#ifdef HAVE_LIBNUMA
+#include <numa.h>
+#endif
+
 namespace {
     static int getCpuCount()
     {
@@ -86,3 +90,68 @@ size_t ThreadHeapPolicy::_getNumPools()
     num_pools = redhawk::env::getVariable("RH_SHMALLOC_THREAD_NUM_POOLS", num_pools);
     return std::max(num_pools, 1);
 }
+
+NUMAHeapPolicy::NUMAHeapPolicy() :
+    _numNodes(1),
+    _poolsPerNode(_getPoolsPerNode()),
+    _cpuNodes(getCpuCount(), 0)
+{
+#ifdef HAVE_LIBNUMA
+    if (numa_available() != -1) {
+        _numNodes = std::max(numa_max_node() + 1, 1);
+        for (size_t cpu = 0; cpu < _cpuNodes.size(); ++cpu) {
+            int node = numa_node_of_cpu(cpu);
+            if ((node >= 0) && (node < _numNodes)) {
+                _cpuNodes[cpu] = node;
+            }
+        }
+        return;
+    }
+#endif
+    std::cerr << "SHM allocator: NUMA is not available, using a single node" << std::endl;
+}
+
+int NUMAHeapPolicy::getPoolCount()
+{
+    return _numNodes * _poolsPerNode;
+}
+
+size_t NUMAHeapPolicy::getPoolAssignment(ThreadState* state)
+{
+    int node = state->nodeHint;
+    if ((node < 0) || (node >= _numNodes)) {
+        node = _getCurrentNode();
+    }
+    return (node * _poolsPerNode) + (state->poolId % _poolsPerNode);
+}
+
+void NUMAHeapPolicy::initThreadState(ThreadState* state)
+{
+    // Pool within the node's group, by thread ID
+    state->poolId = syscall(SYS_gettid);
+}
+
+int NUMAHeapPolicy::getPoolNode(size_t poolId)
+{
+    return poolId / _poolsPerNode;
+}
+
+int NUMAHeapPolicy::getNodeCount() const
+{
+    return _numNodes;
+}
+
+int NUMAHeapPolicy::_getCurrentNode()
+{
+    size_t cpuid = sched_getcpu();
+    if (cpuid < _cpuNodes.size()) {
+        return _cpuNodes[cpuid];
+    }
+    return 0;
+}
+
+size_t NUMAHeapPolicy::_getPoolsPerNode()
+{
+    int pools_per_node = redhawk::env::getVariable("RH_SHMALLOC_NUMA_POOLS_PER_NODE", 1);
+    return std::max(pools_per_node, 1);
+}
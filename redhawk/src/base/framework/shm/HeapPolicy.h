@@ -1,4 +1,5 @@
 #include <cstddef>
+#include <vector>
 
 #include "ThreadState.h"
 
@@ -18,6 +19,15 @@ namespace redhawk {
             {
                 // No default behavior
             }
+
+            /**
+             * Returns the NUMA node that a pool's memory should be bound to,
+             * or -1 if the policy does not manage memory placement.
+             */
+            virtual int getPoolNode(size_t /*poolId*/)
+            {
+                return -1;
+            }
         };
 
         /**
@@ -67,5 +77,40 @@ namespace redhawk {
 
             static size_t _getNumPools();
         };
+
+        /**
+         * NUMA-based heap policy.
+         *
+         * Pools are grouped by NUMA node, with a configurable number of pools
+         * per node (defaulting to 1), and new superblocks are bound to the
+         * node of the pool that requested them. On an allocation, the node of
+         * the current CPU selects the group of pools, unless the thread has
+         * set a node hint; within the group, threads are assigned by thread
+         * ID.
+         */
+        class NUMAHeapPolicy : public HeapPolicy
+        {
+        public:
+            NUMAHeapPolicy();
+
+            virtual int getPoolCount();
+
+            virtual size_t getPoolAssignment(ThreadState* state);
+
+            virtual void initThreadState(ThreadState* state);
+
+            virtual int getPoolNode(size_t poolId);
+
+            int getNodeCount() const;
+
+        private:
+            int _getCurrentNode();
+
+            int _numNodes;
+            size_t _poolsPerNode;
+            std::vector<int> _cpuNodes;
+
+            static size_t _getPoolsPerNode();
+        };
     }
 }
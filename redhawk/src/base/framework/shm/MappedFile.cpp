@@ -22,12 +22,19 @@
 
 #include <stdexcept>
 #include <cstring>
+#include <fstream>
+#include <sstream>
+
+#include <stdint.h>
 
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
 #include <fcntl.h>
 #include <errno.h>
+#include <linux/falloc.h>
+
+#include <ossie/shm/System.h>
 
 using namespace redhawk::shm;
 
@@ -37,6 +44,62 @@ static std::string error_string()
 }
 
 const size_t MappedFile::PAGE_SIZE = sysconf(_SC_PAGESIZE);
+const size_t MappedFile::HUGE_PAGE_SIZE;
+
+static std::string get_selected_option(const std::string& path)
+{
+    // Kernel setting files list all choices, with the active one in brackets
+    std::ifstream file(path.c_str());
+    std::string line;
+    if (!std::getline(file, line)) {
+        return std::string();
+    }
+    std::string::size_type start = line.find('[');
+    std::string::size_type end = line.find(']', start);
+    if ((start == std::string::npos) || (end == std::string::npos)) {
+        return std::string();
+    }
+    return line.substr(start + 1, end - start - 1);
+}
+
+static std::string get_mount_option(const std::string& mountPoint, const std::string& option)
+{
+    std::ifstream mounts("/proc/mounts");
+    std::string line;
+    while (std::getline(mounts, line)) {
+        std::istringstream iss(line);
+        std::string device, path, type, options;
+        if (!(iss >> device >> path >> type >> options) || (path != mountPoint)) {
+            continue;
+        }
+        std::istringstream opts(options);
+        std::string value;
+        while (std::getline(opts, value, ',')) {
+            if (value.compare(0, option.size() + 1, option + "=") == 0) {
+                return value.substr(option.size() + 1);
+            }
+        }
+    }
+    return std::string();
+}
+
+bool MappedFile::HugePagesSupported()
+{
+#ifdef MADV_HUGEPAGE
+    // The system-wide shmem setting can override the mount options in either
+    // direction; otherwise, the tmpfs mount must honor madvise
+    const std::string shmem = get_selected_option("/sys/kernel/mm/transparent_hugepage/shmem_enabled");
+    if (shmem == "deny") {
+        return false;
+    } else if (shmem == "force") {
+        return true;
+    }
+    const std::string huge = get_mount_option(redhawk::shm::getSystemPath(), "huge");
+    return (huge == "always") || (huge == "within_size") || (huge == "advise");
+#else
+    return false;
+#endif
+}
 
 MappedFile::MappedFile(const std::string& name) :
     _name(name),
@@ -117,6 +180,46 @@ void* MappedFile::map(size_t bytes, mode_e mode, off_t offset)
     return addr;
 }
 
+void* MappedFile::mapHuge(size_t bytes, mode_e mode, off_t offset)
+{
+#ifdef MADV_HUGEPAGE
+    int prot = PROT_READ;
+    if (mode == READWRITE) {
+        prot |= PROT_WRITE;
+    }
+
+    // Reserve enough address space to pick a start address with the same
+    // alignment as the file offset, map the file over it, then give back the
+    // unused ends of the reservation
+    const size_t reserve_size = bytes + HUGE_PAGE_SIZE;
+    void* reserve = mmap(0, reserve_size, PROT_NONE, MAP_PRIVATE|MAP_ANONYMOUS|MAP_NORESERVE, -1, 0);
+    if (reserve == MAP_FAILED) {
+        throw std::runtime_error("mmap: " + error_string());
+    }
+    char* start = static_cast<char*>(reserve);
+    const size_t phase = offset % HUGE_PAGE_SIZE;
+    const size_t shift = (phase + HUGE_PAGE_SIZE - (reinterpret_cast<uintptr_t>(start) % HUGE_PAGE_SIZE)) % HUGE_PAGE_SIZE;
+    char* addr = start + shift;
+
+    if (mmap(addr, bytes, prot, MAP_SHARED|MAP_FIXED, _fd, offset) == MAP_FAILED) {
+        std::string message = "mmap: " + error_string();
+        munmap(reserve, reserve_size);
+        throw std::runtime_error(message);
+    }
+    if (shift > 0) {
+        munmap(start, shift);
+    }
+    munmap(addr + bytes, reserve_size - shift - bytes);
+
+    // Advisory only; if the kernel refuses, the mapping still works with
+    // normal pages
+    madvise(addr, bytes, MADV_HUGEPAGE);
+    return addr;
+#else
+    return map(bytes, mode, offset);
+#endif
+}
+
 void* MappedFile::remap(void* oldAddr, size_t oldSize, size_t newSize)
 {
     int flags = MREMAP_MAYMOVE;
@@ -134,6 +237,18 @@ void MappedFile::unmap(void* ptr, size_t bytes)
     }
 }
 
+bool MappedFile::release(off_t offset, size_t bytes)
+{
+#ifdef FALLOC_FL_PUNCH_HOLE
+    // Keep the file size the same so that the offsets of later superblocks
+    // remain valid
+    if (fallocate(_fd, FALLOC_FL_PUNCH_HOLE|FALLOC_FL_KEEP_SIZE, offset, bytes) == 0) {
+        return true;
+    }
+#endif
+    return false;
+}
+
 void MappedFile::close()
 {
     if (_fd >= 0) {
@@ -63,12 +63,31 @@ void Metrics::dump(std::ostream& oss)
     oss << "  Superblocks mapped: " << superblocks_mapped << std::endl;
     oss << "  Superblocks reused: " << superblocks_reused << std::endl;
     oss << "  Superblocks unmapped: " << superblocks_unmapped << std::endl;
+    oss << "  Superblocks reclaimed: " << superblocks_reclaimed << std::endl;
+    oss << "  Superblocks recycled: " << superblocks_recycled << std::endl;
+    oss << "  Reclaimed bytes: " << reclaimed_bytes << std::endl;
+    oss << "  Superblocks huge: " << superblocks_huge << std::endl;
     oss << "  Heap clients created: " << clients_created << std::endl;
     oss << "  Heap clients destroyed: " << clients_destroyed << std::endl;
     oss << "  Blocks created: " << blocks_created << std::endl;
     oss << "  Blocks attached: " << blocks_attached << std::endl;
     oss << "  Blocks released: " << blocks_released << std::endl;
     oss << "  Blocks destroyed: " << blocks_destroyed << std::endl;
+    oss << "  Slabs created: " << slabs_created << std::endl;
+    oss << "  Slabs destroyed: " << slabs_destroyed << std::endl;
+    oss << "  Slab allocations hit: " << slab_alloc_hit << std::endl;
+    oss << "  Slab allocations missed: " << slab_alloc_miss << std::endl;
+    for (int node = 0; node < MAX_NUMA_NODES; ++node) {
+        if (numa_superblocks[node] || numa_allocations[node]) {
+            oss << "  NUMA node " << node << " allocations: " << numa_allocations[node] << std::endl;
+            oss << "  NUMA node " << node << " superblocks: " << numa_superblocks[node] << std::endl;
+            oss << "  NUMA node " << node << " superblock bytes: " << numa_superblock_bytes[node] << std::endl;
+        }
+    }
+    oss << "  NUMA hinted allocations: " << numa_hinted_allocations << std::endl;
+    oss << "  Magazine allocations hit: " << magazine_alloc_hit << std::endl;
+    oss << "  Magazine blocks cached: " << magazine_cached << std::endl;
+    oss << "  Magazine flushes: " << magazine_flushes << std::endl;
 }
 
 Metrics& Metrics::Instance()
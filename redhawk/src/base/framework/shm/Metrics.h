@@ -148,6 +148,30 @@ namespace redhawk {
              */
             atomic_int superblocks_unmapped;
 
+            /**
+             * Number of idle superblocks whose memory was returned to the OS
+             * by this process.
+             */
+            atomic_int superblocks_reclaimed;
+
+            /**
+             * Number of reclaimed superblocks that were reused for new
+             * allocations instead of growing the heap file.
+             */
+            atomic_int superblocks_recycled;
+
+            /**
+             * Total number of bytes of superblock memory returned to the OS by
+             * this process.
+             */
+            atomic_counter<size_t> reclaimed_bytes;
+
+            /**
+             * Number of superblocks created by this process that were mapped
+             * for huge pages.
+             */
+            atomic_int superblocks_huge;
+
             // HeapClient statistics
             /**
              * Number of heap clients created.
@@ -208,6 +232,78 @@ namespace redhawk {
              */
             atomic_int blocks_destroyed;
 
+            // Slab statistics
+            /**
+             * Number of size-class slabs created by this process.
+             *
+             * A slab divides one large block into equal-size slots for a
+             * single size class.
+             */
+            atomic_int slabs_created;
+
+            /**
+             * Number of empty size-class slabs returned to their superblock's
+             * free list within this process.
+             */
+            atomic_int slabs_destroyed;
+
+            /**
+             * Number of allocations satisfied from a size-class slab.
+             *
+             * Compared to slab misses, a high number of hits indicates that
+             * most allocations avoided the best-fit free list.
+             */
+            atomic_int slab_alloc_hit;
+
+            /**
+             * Number of allocations small enough for a slab that fell back to
+             * the best-fit free list because no slot was available.
+             */
+            atomic_int slab_alloc_miss;
+
+            // NUMA statistics (NUMA heap policy only)
+            static const int MAX_NUMA_NODES = 8;
+
+            /**
+             * Number of pool allocations made on each NUMA node.
+             */
+            atomic_int numa_allocations[MAX_NUMA_NODES];
+
+            /**
+             * Number of pool allocations that followed a thread's node hint.
+             */
+            atomic_int numa_hinted_allocations;
+
+            /**
+             * Number of superblocks bound to each NUMA node.
+             */
+            atomic_int numa_superblocks[MAX_NUMA_NODES];
+
+            /**
+             * Total number of bytes of superblock memory bound to each NUMA
+             * node.
+             */
+            atomic_counter<size_t> numa_superblock_bytes[MAX_NUMA_NODES];
+
+            // Magazine statistics
+            /**
+             * Number of allocations satisfied from a thread's magazine without
+             * locking a pool or superblock.
+             */
+            atomic_int magazine_alloc_hit;
+
+            /**
+             * Number of blocks freed into a thread's magazine instead of being
+             * returned to their superblock.
+             */
+            atomic_int magazine_cached;
+
+            /**
+             * Number of times a full magazine was returned to its superblocks
+             * in a batch.
+             */
+            atomic_int magazine_flushes;
+
             /**
              * Returns the singleton instance.
              */
@@ -0,0 +1,556 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK core.
+ *
+ * REDHAWK core is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK core is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+#include <ossie/shm/Ring.h>
+#include <ossie/shm/MappedFile.h>
+
+#include <sstream>
+#include <stdexcept>
+#include <cerrno>
+
+#include <unistd.h>
+#include <signal.h>
+#include <time.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+// Number of times to check the ring before parking on the futex; at a few
+// nanoseconds per pass, this covers the typical back-to-back write interval
+// without burning a full scheduler quantum
+#define RING_SPIN_COUNT 1000
+
+// Time a writer parks on the futex before checking that the reader exists
+#define RING_WAIT_MSEC 100
+
+#define RING_MAGIC 0x53505343
+#define RING_VERSION 1
+
+// Keep the producer and consumer indices on separate cache lines to avoid
+// false sharing between the two processes
+#define CACHE_LINE_SIZE 64
+
+using namespace redhawk::shm;
+
+namespace {
+    inline void cpu_relax()
+    {
+#if defined(__i386__) || defined(__x86_64__)
+        __asm__ __volatile__("pause" ::: "memory");
+#else
+        __sync_synchronize();
+#endif
+    }
+
+    inline int futex_wait(volatile int32_t* addr, int32_t value, int timeout)
+    {
+        // NB: The ring is mapped into multiple processes, so the futex must
+        // not use FUTEX_PRIVATE_FLAG
+        struct timespec ts;
+        struct timespec* tsp = 0;
+        if (timeout >= 0) {
+            ts.tv_sec = timeout / 1000;
+            ts.tv_nsec = (timeout % 1000) * 1000000;
+            tsp = &ts;
+        }
+        return syscall(SYS_futex, addr, FUTEX_WAIT, value, tsp, 0, 0);
+    }
+
+    inline void futex_wake(volatile int32_t* addr)
+    {
+        syscall(SYS_futex, addr, FUTEX_WAKE, 1, 0, 0, 0);
+    }
+
+    inline bool process_exists(int32_t pid)
+    {
+        if (pid <= 0) {
+            return false;
+        }
+        return (kill(pid, 0) == 0) || (errno != ESRCH);
+    }
+
+    inline size_t align_line(size_t bytes)
+    {
+        return (bytes + CACHE_LINE_SIZE - 1) & ~(size_t)(CACHE_LINE_SIZE - 1);
+    }
+
+    inline bool is_power_of_two(size_t value)
+    {
+        return (value != 0) && !(value & (value - 1));
+    }
+}
+
+struct Ring::Header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t type;
+    uint32_t capacity;
+    uint32_t extraSize;
+    volatile int32_t writerPid;
+    volatile int32_t readerPid;
+    char pad0[CACHE_LINE_SIZE - 28];
+
+    // Producer offset, and the flag the reader sets before parking
+    volatile uint64_t head;
+    volatile int32_t readerSleeping;
+    char pad1[CACHE_LINE_SIZE - 12];
+
+    // Consumer offset, the flag the writer sets before parking, and the
+    // asynchronous error count
+    volatile uint64_t tail;
+    volatile int32_t writerSleeping;
+    volatile uint32_t errors;
+    char pad2[CACHE_LINE_SIZE - 16];
+
+    volatile int32_t closed;
+    char pad3[CACHE_LINE_SIZE - 4];
+};
+
+Ring::Ring() :
+    _name(),
+    _file(0),
+    _header(0),
+    _data(0),
+    _mappedSize(0),
+    _owner(false),
+    _writer(false)
+{
+}
+
+Ring::~Ring()
+{
+    if (_owner) {
+        unlink();
+    }
+    detach();
+}
+
+void Ring::create(const std::string& prefix, uint32_t type, size_t capacity, size_t extraSize)
+{
+    if (_header) {
+        throw std::logic_error("ring is already open");
+    }
+
+    // Round the capacity up to a power of two so that offsets can be mapped
+    // into the ring with a mask
+    size_t actual_capacity = CACHE_LINE_SIZE;
+    while (actual_capacity < capacity) {
+        actual_capacity <<= 1;
+    }
+    const size_t extra_bytes = align_line(extraSize);
+
+    size_t bytes = sizeof(Header) + extra_bytes + actual_capacity;
+    bytes = ((bytes + MappedFile::PAGE_SIZE - 1) / MappedFile::PAGE_SIZE) * MappedFile::PAGE_SIZE;
+
+    _name = _makeUniqueName(prefix, this);
+    _file = new MappedFile(_name);
+    try {
+        _file->create();
+        _owner = true;
+        _writer = true;
+        _file->resize(bytes);
+        _header = static_cast<Header*>(_file->map(bytes, MappedFile::READWRITE));
+    } catch (...) {
+        unlink();
+        detach();
+        throw;
+    }
+    _mappedSize = bytes;
+    _data = reinterpret_cast<char*>(_header) + sizeof(Header) + extra_bytes;
+
+    _header->type = type;
+    _header->capacity = actual_capacity;
+    _header->extraSize = extra_bytes;
+    _header->writerPid = getpid();
+    _header->readerPid = 0;
+    _header->head = 0;
+    _header->readerSleeping = 0;
+    _header->tail = 0;
+    _header->writerSleeping = 0;
+    _header->errors = 0;
+    _header->closed = 0;
+    _header->version = RING_VERSION;
+    __sync_synchronize();
+    _header->magic = RING_MAGIC;
+}
+
+void Ring::open(const std::string& name, uint32_t type, size_t extraSize)
+{
+    if (_header) {
+        throw std::logic_error("ring is already open");
+    }
+
+    _name = name;
+    _file = new MappedFile(_name);
+    try {
+        _file->open();
+        _mappedSize = _file->size();
+        if (_mappedSize < sizeof(Header)) {
+            throw std::runtime_error("ring file is too small");
+        }
+        _header = static_cast<Header*>(_file->map(_mappedSize, MappedFile::READWRITE));
+        if ((_header->magic != RING_MAGIC) || (_header->version != RING_VERSION) || (_header->type != type)) {
+            throw std::runtime_error("ring file has an incompatible format");
+        }
+        if (!is_power_of_two(_header->capacity) || (_header->extraSize < extraSize)) {
+            throw std::runtime_error("ring file has an invalid geometry");
+        }
+        // The header comes from the other process, so make sure that the
+        // ring it describes lies within the file
+        const size_t data_offset = sizeof(Header) + align_line(_header->extraSize);
+        if ((data_offset > _mappedSize) || ((_mappedSize - data_offset) < _header->capacity)) {
+            throw std::runtime_error("ring file is too small");
+        }
+        _data = reinterpret_cast<char*>(_header) + data_offset;
+    } catch (...) {
+        detach();
+        throw;
+    }
+    _header->readerPid = getpid();
+}
+
+const std::string& Ring::name() const
+{
+    return _name;
+}
+
+bool Ring::isOpen() const
+{
+    return (_header != 0);
+}
+
+void Ring::unlink()
+{
+    if (!_owner) {
+        return;
+    }
+    _owner = false;
+    try {
+        _file->unlink();
+    } catch (const std::exception&) {
+        // The file may already be gone; nothing else to do
+    }
+}
+
+void Ring::detach()
+{
+    if (_header) {
+        _file->unmap(_header, _mappedSize);
+        _header = 0;
+        _data = 0;
+        _mappedSize = 0;
+    }
+    if (_file) {
+        _file->close();
+        delete _file;
+        _file = 0;
+    }
+}
+
+size_t Ring::capacity() const
+{
+    return _header->capacity;
+}
+
+void* Ring::extra() const
+{
+    return reinterpret_cast<char*>(_header) + sizeof(Header);
+}
+
+char* Ring::at(uint64_t offset) const
+{
+    return _data + (offset & (_header->capacity - 1));
+}
+
+uint64_t Ring::head() const
+{
+    return _header->head;
+}
+
+bool Ring::waitSpace(size_t bytes)
+{
+    if (bytes > _header->capacity) {
+        throw std::length_error("request is larger than ring");
+    }
+
+    int spin = 0;
+    while ((_header->capacity - (_header->head - _header->tail)) < bytes) {
+        if (_header->closed) {
+            return false;
+        }
+        if (spin < RING_SPIN_COUNT) {
+            ++spin;
+            cpu_relax();
+            continue;
+        }
+
+        // Announce that the writer is going to sleep, then check again before
+        // parking; the reader checks the flag after advancing the tail, so
+        // one side or the other is guaranteed to see the update
+        _header->writerSleeping = 1;
+        __sync_synchronize();
+        if ((_header->capacity - (_header->head - _header->tail)) >= bytes) {
+            _header->writerSleeping = 0;
+            break;
+        }
+        int status = futex_wait(&_header->writerSleeping, 1, RING_WAIT_MSEC);
+        _header->writerSleeping = 0;
+        if ((status != 0) && (errno == ETIMEDOUT) && !isPeerAlive()) {
+            return false;
+        }
+    }
+    return !_header->closed;
+}
+
+void Ring::publish(uint64_t head)
+{
+    // Ensure the data is visible before the new head
+    __sync_synchronize();
+    _header->head = head;
+    __sync_synchronize();
+    if (_header->readerSleeping) {
+        _header->readerSleeping = 0;
+        futex_wake(&_header->readerSleeping);
+    }
+}
+
+uint64_t Ring::tail() const
+{
+    return _header->tail;
+}
+
+bool Ring::waitData(int timeout)
+{
+    const uint64_t tail = _header->tail;
+    int spin = 0;
+    while (_header->head == tail) {
+        if (_header->closed) {
+            return false;
+        }
+        if (spin < RING_SPIN_COUNT) {
+            ++spin;
+            cpu_relax();
+            continue;
+        }
+
+        _header->readerSleeping = 1;
+        __sync_synchronize();
+        if (_header->head != tail) {
+            _header->readerSleeping = 0;
+            break;
+        }
+        int status = futex_wait(&_header->readerSleeping, 1, timeout);
+        _header->readerSleeping = 0;
+        if ((status != 0) && (errno == ETIMEDOUT)) {
+            return false;
+        }
+    }
+    // Ensure the data is read after the head
+    __sync_synchronize();
+    return true;
+}
+
+void Ring::release(uint64_t tail)
+{
+    __sync_synchronize();
+    _header->tail = tail;
+    __sync_synchronize();
+    if (_header->writerSleeping) {
+        _header->writerSleeping = 0;
+        futex_wake(&_header->writerSleeping);
+    }
+}
+
+bool Ring::isPeerAlive() const
+{
+    if (_writer) {
+        return process_exists(_header->readerPid);
+    } else {
+        return process_exists(_header->writerPid);
+    }
+}
+
+void Ring::reportError()
+{
+    __sync_add_and_fetch(&_header->errors, 1);
+}
+
+uint32_t Ring::errorCount() const
+{
+    return _header->errors;
+}
+
+void Ring::close()
+{
+    if (!_header) {
+        return;
+    }
+    _header->closed = 1;
+    __sync_synchronize();
+    _header->readerSleeping = 0;
+    futex_wake(&_header->readerSleeping);
+    _header->writerSleeping = 0;
+    futex_wake(&_header->writerSleeping);
+}
+
+bool Ring::isClosed() const
+{
+    return _header->closed;
+}
+
+volatile int32_t* Ring::closedFlag()
+{
+    return &_header->closed;
+}
+
+std::string Ring::_makeUniqueName(const std::string& prefix, const void* self)
+{
+    // Process ID plus the object address is unique on this host
+    std::ostringstream oss;
+    oss << prefix << '-' << getpid() << '-' << std::hex << (size_t) self;
+    return oss.str();
+}
+
+// The slot size is stored at the start of the extra area, on its own cache
+// line, ahead of the user's extra data
+struct SlotRing::Layout {
+    uint32_t slotSize;
+    char pad[CACHE_LINE_SIZE - 4];
+};
+
+SlotRing::SlotRing() :
+    _ring(),
+    _slotSize(0)
+{
+}
+
+void SlotRing::create(const std::string& prefix, uint32_t type, size_t capacity, size_t slotSize, size_t extraSize)
+{
+    size_t actual_slot_size = CACHE_LINE_SIZE;
+    while (actual_slot_size < slotSize) {
+        actual_slot_size <<= 1;
+    }
+    _ring.create(prefix, type, capacity * actual_slot_size, sizeof(Layout) + extraSize);
+    static_cast<Layout*>(_ring.extra())->slotSize = actual_slot_size;
+    _slotSize = actual_slot_size;
+}
+
+void SlotRing::open(const std::string& name, uint32_t type, size_t extraSize)
+{
+    _ring.open(name, type, sizeof(Layout) + extraSize);
+    const size_t slot_size = static_cast<const Layout*>(_ring.extra())->slotSize;
+    if ((slot_size < CACHE_LINE_SIZE) || !is_power_of_two(slot_size) || (slot_size > _ring.capacity())) {
+        _ring.detach();
+        throw std::runtime_error("ring file has an invalid slot size");
+    }
+    _slotSize = slot_size;
+}
+
+const std::string& SlotRing::name() const
+{
+    return _ring.name();
+}
+
+bool SlotRing::isOpen() const
+{
+    return _ring.isOpen();
+}
+
+void SlotRing::unlink()
+{
+    _ring.unlink();
+}
+
+void SlotRing::detach()
+{
+    _ring.detach();
+}
+
+size_t SlotRing::slotSize() const
+{
+    return _slotSize;
+}
+
+void* SlotRing::extra() const
+{
+    return static_cast<char*>(_ring.extra()) + sizeof(Layout);
+}
+
+void* SlotRing::beginWrite()
+{
+    if (!_ring.waitSpace(_slotSize)) {
+        return 0;
+    }
+    return _ring.at(_ring.head());
+}
+
+uint64_t SlotRing::commitWrite()
+{
+    const uint64_t head = _ring.head();
+    _ring.publish(head + _slotSize);
+    return head / _slotSize;
+}
+
+void* SlotRing::beginRead(int timeout)
+{
+    if (!_ring.waitData(timeout)) {
+        return 0;
+    }
+    return _ring.at(_ring.tail());
+}
+
+void SlotRing::commitRead()
+{
+    _ring.release(_ring.tail() + _slotSize);
+}
+
+uint64_t SlotRing::readCount() const
+{
+    return _ring.tail() / _slotSize;
+}
+
+bool SlotRing::isPeerAlive() const
+{
+    return _ring.isPeerAlive();
+}
+
+void SlotRing::reportError()
+{
+    _ring.reportError();
+}
+
+uint32_t SlotRing::errorCount() const
+{
+    return _ring.errorCount();
+}
+
+void SlotRing::close()
+{
+    _ring.close();
+}
+
+bool SlotRing::isClosed() const
+{
+    return _ring.isClosed();
+}
+
+volatile int32_t* SlotRing::closedFlag()
+{
+    return _ring.closedFlag();
+}
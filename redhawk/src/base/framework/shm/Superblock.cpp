@@ -23,6 +23,7 @@
 #include "ThreadState.h"
 #include "offset_ptr.h"
 #include "Metrics.h"
+#include "Environment.h"
 
 #include <ossie/shm/MappedFile.h>
 #include <ossie/BufferManager.h>
@@ -39,6 +40,11 @@ using redhawk::shm::Superblock;
 using redhawk::shm::Block;
 using redhawk::shm::ThreadState;
 
+// Slabs are limited to a fraction of the superblock so that a single size
+// class cannot monopolize it
+#define SLAB_FRACTION 4
+#define DEFAULT_SLAB_CEILING 65536
+
 #define ALLOC_DEBUG 0
 #if ALLOC_DEBUG > 0
 #define LOG_ALLOC(x) std::cout << "+ " << ((x) - sizeof(Block)) << std::endl;
@@ -65,17 +71,25 @@ struct Superblock::FreeBlock : public Block {
     uint32_t next_size;
 };
 
-Superblock::Superblock(const std::string& heap, size_t offset, size_t size) :
+Superblock::Superblock(const std::string& heap, size_t offset, size_t size, size_t dataOffset, bool hugePages) :
     _offset(offset),
     _size(size),
-    _dataStart(MappedFile::PAGE_SIZE),
+    _dataStart(dataOffset),
+    _hugePages(hugePages),
     _used(0),
     _first(0),
-    _last(0)
+    _last(0),
+    _slabsInUse(0)
 {
     assert(heap.size() < 256);
+    assert(sizeof(Superblock) <= MappedFile::PAGE_SIZE);
+    assert(dataOffset >= MappedFile::PAGE_SIZE);
     strcpy(_heapname, heap.c_str());
 
+    memset(_classSlabs, 0, sizeof(_classSlabs));
+    memset(_classAvailable, 0, sizeof(_classAvailable));
+    memset(_slabs, 0, sizeof(_slabs));
+
     uint32_t block_start = _dataStart / Block::BLOCK_SIZE;
     uint32_t block_count = size / Block::BLOCK_SIZE;
     FreeBlock* block = new (_data()) FreeBlock(block_start, block_count);
@@ -101,11 +115,26 @@ size_t Superblock::size() const
     return _size;
 }
 
+size_t Superblock::dataOffset() const
+{
+    return _dataStart;
+}
+
+bool Superblock::hugePages() const
+{
+    return _hugePages;
+}
+
 size_t Superblock::used() const
 {
     return _used;
 }
 
+size_t Superblock::slabCeiling()
+{
+    return _slabCeiling;
+}
+
 void* Superblock::attach(size_t offset)
 {
     Block* block = offset_ptr<Block>(this, offset * Block::BLOCK_SIZE);
@@ -117,6 +146,30 @@ void* Superblock::attach(size_t offset)
     return block->data();
 }
 
+bool Superblock::trim()
+{
+    scoped_lock lock(_lock);
+
+    // The superblock is empty if every slab is empty and the slab headers
+    // account for all of the used bytes
+    size_t overhead = 0;
+    for (uint64_t slabs = _slabsInUse; slabs; slabs &= (slabs - 1)) {
+        const Slab& slab = _slabs[__builtin_ctzll(slabs)];
+        if (!_isSlabEmpty(slab)) {
+            return false;
+        }
+        overhead += _offsetToBlock(slab.container)->byteSize() - (slab.slots * slab.slotBlocks * Block::BLOCK_SIZE);
+    }
+    if (_used != overhead) {
+        return false;
+    }
+
+    while (_slabsInUse) {
+        _destroySlab(__builtin_ctzll(_slabsInUse));
+    }
+    return true;
+}
+
 void Superblock::deallocate(void* ptr)
 {
     // The C standard says it's safe to call free() with a null pointer, so for
@@ -165,6 +218,20 @@ void Superblock::_dump(std::ostream& stream) const
         }
     }
 
+    stream << std::endl
+           << "Slabs:" << std::endl;
+    for (int index = 0; index < MAX_SLABS; ++index) {
+        if (!(_slabsInUse & (1ULL << index))) {
+            continue;
+        }
+        const Slab& slab = _slabs[index];
+        stream << "slab[" << index << "]:" << std::endl;
+        stream << "  class:    " << getClassSize(slab.sizeClass) << std::endl;
+        stream << "  offset:   " << slab.container << std::endl;
+        stream << "  slots:    " << slab.slots << std::endl;
+        stream << "  free:     " << __builtin_popcountll(slab.freeMask) << std::endl;
+    }
+
     stream << std::endl
            << "All blocks:" << std::endl;
     size_t blocks = 0;
@@ -223,14 +290,42 @@ const Superblock::FreeBlock* Superblock::_offsetToBlock(uint32_t offset) const
     }
 }
 
+void Superblock::release(Block** blocks, size_t count)
+{
+    size_t index = 0;
+    while (index < count) {
+        Superblock* superblock = blocks[index]->getSuperblock();
+        scoped_lock lock(superblock->_lock);
+        for (; (index < count) && (blocks[index]->getSuperblock() == superblock); ++index) {
+            superblock->_deallocateLocked(blocks[index]);
+            RECORD_SHM_METRIC(blocks_destroyed);
+        }
+    }
+}
+
 void Superblock::_deallocate(Block* block)
 {
     scoped_lock lock(_lock);
+    _deallocateLocked(block);
+}
+
+void Superblock::_deallocateLocked(Block* block)
+{
     assert(block->byteSize() >= sizeof(FreeBlock));
     LOG_DEALLOC(block->byteSize());
 
     _used -= block->byteSize();
 
+    int slab = _findSlab(block);
+    if (slab >= 0) {
+        _releaseSlot(slab, block);
+    } else {
+        _freeBlock(block);
+    }
+}
+
+void Superblock::_freeBlock(Block* block)
+{
 #if ALLOC_DEBUG > 1
     std::cout << "Returning block@" << block << std::endl;
     std::cout << "  offset: " << block->offset() << std::endl;
@@ -326,6 +421,19 @@ void* Superblock::allocate(ThreadState* thread, size_t bytes)
         lock.lock();
     }
 
+    // Regular sizes are served in constant time from a size-class slab;
+    // anything else (or a request that finds the slabs full and cannot create
+    // a new one) falls back to the best-fit free list
+    if (bytes <= _slabCeiling) {
+        int size_class = getSizeClass(bytes);
+        void* ptr = _allocateSlot(size_class);
+        if (ptr) {
+            RECORD_SHM_METRIC(slab_alloc_hit);
+            return ptr;
+        }
+        RECORD_SHM_METRIC(slab_alloc_miss);
+    }
+
     // Add overhead for block metadata, making sure that the total byte size
     // is enough for a free block, then round up to the nearest block size to
     // preserve alignment on all architectures; otherwise, atomic operations
@@ -335,6 +443,19 @@ void* Superblock::allocate(ThreadState* thread, size_t bytes)
 
     LOG_ALLOC(bytes);
 
+    Block* block = _allocateBlocks(blocks);
+    if (!block) {
+        // No free blocks, give up
+        return 0;
+    }
+    _used += block->byteSize();
+
+    RECORD_SHM_METRIC(blocks_created);
+    return block->data();
+}
+
+Block* Superblock::_allocateBlocks(size_t blocks)
+{
     FreeBlock* block = _findAvailable(blocks);
     if (!block) {
         // No free blocks, give up
@@ -387,10 +508,7 @@ void* Superblock::allocate(ThreadState* thread, size_t bytes)
 #if ALLOC_DEBUG > 1
     _dump(std::cout);
 #endif
-    _used += block->byteSize();
-
-    RECORD_SHM_METRIC(blocks_created);
-    return block->data();
+    return block;
 }
 
 void Superblock::_removeFreeBlock(FreeBlock* block)
@@ -491,3 +609,179 @@ Block* Superblock::_coalescePrevious(Block* block)
     // Return the "new" block
     return prev;
 }
+
+int Superblock::getSizeClass(size_t bytes)
+{
+    if (bytes <= MIN_SLAB_CLASS_SIZE) {
+        return 0;
+    }
+
+    // Find the power of two below the request; the request then fits either
+    // the one-and-a-half class above it, or the next power of two
+    int log2 = 63 - __builtin_clzll(bytes - 1);
+    int size_class = (log2 - 6) * 2 + 1;
+    if (bytes > getClassSize(size_class)) {
+        ++size_class;
+    }
+    return size_class;
+}
+
+size_t Superblock::getClassSize(int sizeClass)
+{
+    size_t size = MIN_SLAB_CLASS_SIZE << (sizeClass / 2);
+    if (sizeClass & 1) {
+        size += size / 2;
+    }
+    return size;
+}
+
+void* Superblock::_allocateSlot(int sizeClass)
+{
+    int index;
+    if (_classAvailable[sizeClass]) {
+        index = __builtin_ctzll(_classAvailable[sizeClass]);
+    } else {
+        index = _createSlab(sizeClass);
+        if (index < 0) {
+            return 0;
+        }
+    }
+
+    Slab& slab = _slabs[index];
+    assert(slab.freeMask);
+    uint32_t slot = __builtin_ctzll(slab.freeMask);
+    slab.freeMask &= ~(1ULL << slot);
+    if (!slab.freeMask) {
+        _classAvailable[sizeClass] &= ~(1ULL << index);
+    }
+
+    // The slot gets a regular block header so that attach, reference
+    // counting and getSuperblock() work exactly as for any other block
+    uint32_t offset = slab.container + 1 + (slot * slab.slotBlocks);
+    Block* block = new (offset_ptr<Block>(this, offset * Block::BLOCK_SIZE)) Block(offset, slab.slotBlocks);
+    block->markUsed();
+    _used += block->byteSize();
+
+    RECORD_SHM_METRIC(blocks_created);
+    return block->data();
+}
+
+int Superblock::_createSlab(int sizeClass)
+{
+    if (_slabsInUse == ~0ULL) {
+        return -1;
+    }
+
+    // Each slot holds a block header plus the class size (which is always a
+    // multiple of the block size); the container's own header takes one
+    // more block
+    uint32_t slot_blocks = 1 + (getClassSize(sizeClass) / Block::BLOCK_SIZE);
+    size_t max_blocks = (_size / SLAB_FRACTION) / Block::BLOCK_SIZE;
+    size_t slots = std::min((size_t) MAX_SLAB_SLOTS, (max_blocks - 1) / slot_blocks);
+    if (slots < 2) {
+        return -1;
+    }
+
+    Block* container = _allocateBlocks(1 + (slots * slot_blocks));
+    if (!container) {
+        return -1;
+    }
+
+    int index = __builtin_ctzll(~_slabsInUse);
+    Slab& slab = _slabs[index];
+    slab.container = container->offset();
+    slab.slotBlocks = slot_blocks;
+    slab.slots = slots;
+    slab.sizeClass = sizeClass;
+    slab.freeMask = _slotMask(slots);
+
+    const uint64_t mask = 1ULL << index;
+    _slabsInUse |= mask;
+    _classSlabs[sizeClass] |= mask;
+    _classAvailable[sizeClass] |= mask;
+    _used += container->byteSize() - (slots * slot_blocks * Block::BLOCK_SIZE);
+
+    RECORD_SHM_METRIC(slabs_created);
+    return index;
+}
+
+int Superblock::_findSlab(const Block* block) const
+{
+    // Slots are always an exact size class plus the block header, so the
+    // block size narrows the search down to the slabs for one class
+    size_t data_size = block->byteSize() - Block::BLOCK_SIZE;
+    if (data_size > getClassSize(NUM_SIZE_CLASSES - 1)) {
+        return -1;
+    }
+    int size_class = getSizeClass(data_size);
+    if (getClassSize(size_class) != data_size) {
+        return -1;
+    }
+
+    const uint32_t offset = block->offset();
+    for (uint64_t slabs = _classSlabs[size_class]; slabs; slabs &= (slabs - 1)) {
+        int index = __builtin_ctzll(slabs);
+        const Slab& slab = _slabs[index];
+        const uint32_t first = slab.container + 1;
+        if ((offset >= first) && (offset < (first + (slab.slots * slab.slotBlocks)))) {
+            return index;
+        }
+    }
+    return -1;
+}
+
+void Superblock::_releaseSlot(int index, Block* block)
+{
+    Slab& slab = _slabs[index];
+    uint32_t slot = (block->offset() - slab.container - 1) / slab.slotBlocks;
+    assert(!(slab.freeMask & (1ULL << slot)));
+
+    // Invalidate the header to catch stale references
+    block->~Block();
+
+    slab.freeMask |= (1ULL << slot);
+    const uint64_t mask = 1ULL << index;
+    _classAvailable[slab.sizeClass] |= mask;
+
+    // Return a completely free slab to the general free list, provided that
+    // another slab of the same class still has room; this keeps one slab
+    // per class warm without pinning memory after a burst
+    if (_isSlabEmpty(slab) && (_classAvailable[slab.sizeClass] & ~mask)) {
+        _destroySlab(index);
+    }
+}
+
+uint64_t Superblock::_slotMask(uint32_t slots)
+{
+    return (slots == 64) ? ~0ULL : ((1ULL << slots) - 1);
+}
+
+bool Superblock::_isSlabEmpty(const Slab& slab)
+{
+    return slab.freeMask == _slotMask(slab.slots);
+}
+
+void Superblock::_destroySlab(int index)
+{
+    Slab& slab = _slabs[index];
+    const uint64_t mask = ~(1ULL << index);
+    _slabsInUse &= mask;
+    _classSlabs[slab.sizeClass] &= mask;
+    _classAvailable[slab.sizeClass] &= mask;
+
+    Block* container = _offsetToBlock(slab.container);
+    assert(container->valid());
+    _used -= container->byteSize() - (slab.slots * slab.slotBlocks * Block::BLOCK_SIZE);
+    memset(&slab, 0, sizeof(Slab));
+    _freeBlock(container);
+
+    RECORD_SHM_METRIC(slabs_destroyed);
+}
+
+size_t Superblock::_initSlabCeiling()
+{
+    size_t ceiling = redhawk::env::getVariable("RH_SHMALLOC_SLAB_MAX", (size_t) DEFAULT_SLAB_CEILING);
+    return std::min(ceiling, getClassSize(NUM_SIZE_CLASSES - 1));
+}
+
+const size_t Superblock::_slabCeiling = Superblock::_initSlabCeiling();
@@ -35,7 +35,13 @@ namespace redhawk {
 
         class Superblock {
         public:
-            Superblock(const std::string& heap, size_t offset, size_t size);
+            /**
+             * The header occupies the first dataOffset bytes of the
+             * superblock, which must be at least a page; superblocks backed
+             * by huge pages pad the header so that the data starts on a huge
+             * page boundary in the file.
+             */
+            Superblock(const std::string& heap, size_t offset, size_t size, size_t dataOffset, bool hugePages);
             ~Superblock();
 
             const char* heap() const;
@@ -44,20 +50,80 @@ namespace redhawk {
 
             size_t size() const;
 
+            size_t dataOffset() const;
+
+            bool hugePages() const;
+
             size_t used() const;
 
             void* allocate(ThreadState* thread, size_t bytes);
 
             void* attach(size_t offset);
 
+            /**
+             * If the superblock has no allocated blocks, returns its (empty)
+             * slabs to the free list and returns true.
+             */
+            bool trim();
+
             static void deallocate(void* ptr);
 
             void dump(std::ostream& stream) const;
 
+            /**
+             * Largest request size, in bytes, that is served from a size-class
+             * slab rather than the general free list. Set from the environment
+             * variable RH_SHMALLOC_SLAB_MAX; 0 disables slab allocation.
+             */
+            static size_t slabCeiling();
+
+            /**
+             * Size classes are powers of two and one-and-a-half times powers
+             * of two (64, 96, 128, 192, ...), up to 192KB. getSizeClass()
+             * returns the smallest class that holds the given number of bytes.
+             */
+            static const int NUM_SIZE_CLASSES = 24;
+            static int getSizeClass(size_t bytes);
+            static size_t getClassSize(int sizeClass);
+
+            /**
+             * Returns a batch of unreferenced blocks to their superblocks,
+             * taking each superblock's lock once per run of blocks that share
+             * it.
+             */
+            static void release(Block** blocks, size_t count);
+
         protected:
             struct FreeBlock;
 
+            // Slabs carve a single large block into equal-size slots for one
+            // size class, with a bitmap of free slots; the descriptors live in
+            // the superblock header page, so that any process that maps the
+            // superblock can return a slot
+            struct Slab {
+                uint32_t container;
+                uint32_t slotBlocks;
+                uint32_t slots;
+                uint32_t sizeClass;
+                uint64_t freeMask;
+            };
+
+            static const size_t MIN_SLAB_CLASS_SIZE = 64;
+            static const int MAX_SLABS = 64;
+            static const uint32_t MAX_SLAB_SLOTS = 64;
+
+            void* _allocateSlot(int sizeClass);
+            int _createSlab(int sizeClass);
+            int _findSlab(const Block* block) const;
+            void _releaseSlot(int index, Block* block);
+            void _destroySlab(int index);
+            static uint64_t _slotMask(uint32_t slots);
+            static bool _isSlabEmpty(const Slab& slab);
+
+            Block* _allocateBlocks(size_t blocks);
             void _deallocate(Block* block);
+            void _deallocateLocked(Block* block);
+            void _freeBlock(Block* block);
 
             void _dump(std::ostream& stream) const;
 
@@ -80,6 +146,7 @@ namespace redhawk {
             const uint64_t _offset;
             const uint32_t _size;
             const uint32_t _dataStart;
+            const bool _hugePages;
             mutable redhawk::shared_mutex _lock;
 
             volatile size_t _used;
@@ -87,6 +154,17 @@ namespace redhawk {
             // Free list pointers
             uint32_t _first;
             uint32_t _last;
+
+            // Slab descriptors, and bitmasks of slab indices: all slabs in
+            // use, the slabs for each size class, and the slabs for each size
+            // class that have at least one free slot
+            uint64_t _slabsInUse;
+            uint64_t _classSlabs[NUM_SIZE_CLASSES];
+            uint64_t _classAvailable[NUM_SIZE_CLASSES];
+            Slab _slabs[MAX_SLABS];
+
+            static const size_t _slabCeiling;
+            static size_t _initSlabCeiling();
         };
 
     }
@@ -43,11 +43,12 @@ struct SuperblockFile::Header {
     // ABI version of superblock file. If the layout of the header or the
     // Superblock class changes, changes, this version must be incremented.
     typedef uint32_t version_type;
-    static const version_type SUPERBLOCK_VERSION = 1;
+    static const version_type SUPERBLOCK_VERSION = 4;
 
     Header() :
         magic(SUPERBLOCK_MAGIC),
         version(SUPERBLOCK_VERSION),
+        superblockSize(sizeof(Superblock)),
         refcount(1),
         creator(getpid())
     {
@@ -55,6 +56,9 @@ struct SuperblockFile::Header {
 
     const magic_type magic;
     const version_type version;
+    // Size of the in-file Superblock header, as a second line of defense
+    // against a layout change that did not bump the version
+    const uint32_t superblockSize;
     atomic_counter<int32_t> refcount;
     const pid_t creator;
 };
@@ -152,7 +156,7 @@ SuperblockFile::Statistics SuperblockFile::getStatistics()
             }
             stats.superblocks++;
             // Account for the superblock overhead
-            offset += MappedFile::PAGE_SIZE + superblock->size();
+            offset += superblock->dataOffset() + superblock->size();
         }
         // Don't forget to unmap--it doesn't happen automatically!
         _file.unmap(base, MappedFile::PAGE_SIZE);
@@ -211,6 +215,8 @@ void SuperblockFile::open(bool attach)
         throw std::runtime_error("invalid superblock file (magic number does not match)");
     } else if (header->version != Header::SUPERBLOCK_VERSION) {
         throw std::runtime_error("incompatible superblock file (version mismatch)");
+    } else if (header->superblockSize != sizeof(Superblock)) {
+        throw std::runtime_error("incompatible superblock file (superblock layout mismatch)");
     }
  
     // Store a reference the header and attach, so that we clean up on close
@@ -253,17 +259,35 @@ Superblock* SuperblockFile::getSuperblock(size_t offset)
     return _mapSuperblock(offset);
 }
 
-Superblock* SuperblockFile::createSuperblock(size_t bytes)
+Superblock* SuperblockFile::createSuperblock(size_t bytes, bool hugePages)
 {
     // Allocate 1 page for the header, plus the superblock memory
     size_t current_offset = _file.size();
-    size_t total_size = MappedFile::PAGE_SIZE + bytes;
+    size_t header_size = MappedFile::PAGE_SIZE;
+    if (hugePages) {
+        // Pad the header so that the data starts, and ends, on a huge page
+        // boundary in the file; the padding is never touched, and its memory
+        // is released below
+        const size_t data_offset = current_offset + MappedFile::PAGE_SIZE;
+        header_size += (MappedFile::HUGE_PAGE_SIZE - (data_offset % MappedFile::HUGE_PAGE_SIZE)) % MappedFile::HUGE_PAGE_SIZE;
+        bytes = ((bytes + MappedFile::HUGE_PAGE_SIZE - 1) / MappedFile::HUGE_PAGE_SIZE) * MappedFile::HUGE_PAGE_SIZE;
+    }
+    size_t total_size = header_size + bytes;
     _file.resize(current_offset + total_size);
+    if (header_size > MappedFile::PAGE_SIZE) {
+        _file.release(current_offset + MappedFile::PAGE_SIZE, header_size - MappedFile::PAGE_SIZE);
+    }
 
-    void* base = _file.map(total_size, MappedFile::READWRITE, current_offset);
-    Superblock* superblock = new (base) Superblock(_file.name(), current_offset, bytes);
+    void* base;
+    if (hugePages) {
+        base = _file.mapHuge(total_size, MappedFile::READWRITE, current_offset);
+    } else {
+        base = _file.map(total_size, MappedFile::READWRITE, current_offset);
+    }
+    Superblock* superblock = new (base) Superblock(_file.name(), current_offset, bytes, header_size, hugePages);
     _superblocks[superblock->offset()] = superblock;
     RECORD_SHM_METRIC(superblocks_created);
+    RECORD_SHM_METRIC_IF(hugePages, superblocks_huge);
     RECORD_SHM_METRIC_ADD(files_bytes, total_size);
     return superblock;
 }
@@ -293,9 +317,17 @@ Superblock* SuperblockFile::_mapSuperblock(size_t offset)
         throw std::invalid_argument("offset is not a valid superblock");
     }
     size_t superblock_size = superblock->size();
+    size_t data_offset = superblock->dataOffset();
 
-    // Remap to get the full superblock size
-    base = _file.remap(base, MappedFile::PAGE_SIZE, MappedFile::PAGE_SIZE + superblock_size);
+    if (superblock->hugePages()) {
+        // Map again with matching alignment so that the reader's page walks
+        // benefit from huge pages as much as the writer's
+        _file.unmap(base, MappedFile::PAGE_SIZE);
+        base = _file.mapHuge(data_offset + superblock_size, MappedFile::READWRITE, offset);
+    } else {
+        // Remap to get the full superblock size
+        base = _file.remap(base, MappedFile::PAGE_SIZE, data_offset + superblock_size);
+    }
     superblock = reinterpret_cast<Superblock*>(base);
 
     // Store mapping
@@ -23,22 +23,107 @@
 
 #include <cstddef>
 
+#include "Superblock.h"
+
 namespace redhawk {
 
     namespace shm {
-        class Superblock;
+        class Heap;
+        struct Block;
+
+        /**
+         * Per-thread cache of unreferenced blocks for one size class.
+         *
+         * Blocks in a magazine remain allocated in their superblock, so they
+         * can be handed out again without locking. When the magazine is full,
+         * the owning heap returns all of its blocks to their superblocks in
+         * one batch.
+         */
+        class Magazine {
+        public:
+            static const int MAX_CAPACITY = 32;
+
+            Magazine() :
+                count(0),
+                capacity(0)
+            {
+            }
+
+            bool empty() const
+            {
+                return count == 0;
+            }
+
+            bool full() const
+            {
+                return count >= capacity;
+            }
+
+            void push(Block* block)
+            {
+                blocks[count++] = block;
+            }
+
+            Block* pop()
+            {
+                return blocks[--count];
+            }
+
+            Block* blocks[MAX_CAPACITY];
+            int count;
+            int capacity;
+        };
 
         class ThreadState {
         public:
             ThreadState() :
                 last(0),
-                contention(0)
+                contention(0),
+                nodeHint(-1),
+                heap(0),
+                magazineClaim(MAGAZINES_FREE),
+                magazinesActive(false)
             {
             }
 
+            // Values of magazineClaim
+            enum {
+                MAGAZINES_FREE = 0,
+                MAGAZINES_OWNER,
+                MAGAZINES_RECLAIM
+            };
+
+            bool claimMagazines(int claimant)
+            {
+                return __sync_bool_compare_and_swap(&magazineClaim, MAGAZINES_FREE, claimant);
+            }
+
+            void releaseMagazines()
+            {
+                __sync_lock_release(&magazineClaim);
+            }
+
             shm::Superblock* last;
             int contention;
             size_t poolId;
+
+            // Preferred NUMA node for allocations, or -1 for the current node
+            int nodeHint;
+
+            // Owning heap; cleared if the heap is destroyed before the thread
+            // exits
+            Heap* heap;
+            Magazine magazines[Superblock::NUM_SIZE_CLASSES];
+
+            // The magazines are normally only touched by the owning thread,
+            // but the heap's reclaim thread may flush them if the owner has
+            // been idle (i.e., magazinesActive has stayed false) for a full
+            // reclaim interval. Either side claims the magazines with a
+            // compare-and-swap from MAGAZINES_FREE; neither side ever waits,
+            // the owner bypasses its magazines and the reclaim thread skips
+            // the thread if the claim fails.
+            volatile int magazineClaim;
+            bool magazinesActive;
         };
     }
 }
@@ -0,0 +1,271 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK core.
+ *
+ * REDHAWK core is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK core is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+#ifndef REDHAWK_BINARYCODEC_H
+#define REDHAWK_BINARYCODEC_H
+
+#include <complex>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#include <boost/type_traits/is_arithmetic.hpp>
+#include <boost/utility/enable_if.hpp>
+
+#include "CF/DataType.h"
+#include "OptionalProperty.h"
+
+namespace redhawk {
+
+    /**
+     * @brief  Compact binary encoder for property structs.
+     *
+     * %BinaryEncoder writes the fields of a struct in declaration order, in
+     * host byte order with no padding or type information. It is intended for
+     * passing messages between processes on the same host, where both sides
+     * agree on the struct definition (as established by its format string);
+     * it is not a persistent or network format.
+     *
+     * Code generated for message structs provides an encode() method that
+     * uses this class.
+     */
+    class BinaryEncoder {
+    public:
+        BinaryEncoder()
+        {
+        }
+
+        /**
+         * @brief  Discards the encoded data, keeping the allocated memory.
+         */
+        void clear()
+        {
+            _buffer.clear();
+        }
+
+        const char* data() const
+        {
+            return _buffer.empty() ? 0 : &_buffer[0];
+        }
+
+        size_t size() const
+        {
+            return _buffer.size();
+        }
+
+        template <typename T>
+        typename boost::enable_if<boost::is_arithmetic<T>, BinaryEncoder&>::type
+        operator<< (const T& value)
+        {
+            _write(&value, sizeof(T));
+            return *this;
+        }
+
+        template <typename T>
+        BinaryEncoder& operator<< (const std::complex<T>& value)
+        {
+            return *this << value.real() << value.imag();
+        }
+
+        BinaryEncoder& operator<< (const std::string& value)
+        {
+            *this << static_cast<uint32_t>(value.size());
+            _write(value.data(), value.size());
+            return *this;
+        }
+
+        BinaryEncoder& operator<< (const CF::UTCTime& value)
+        {
+            return *this << value.tcstatus << value.twsec << value.tfsec;
+        }
+
+        template <typename T>
+        BinaryEncoder& operator<< (const std::vector<T>& value)
+        {
+            *this << static_cast<uint32_t>(value.size());
+            for (typename std::vector<T>::const_iterator item = value.begin(); item != value.end(); ++item) {
+                *this << *item;
+            }
+            return *this;
+        }
+
+        template <typename T>
+        BinaryEncoder& operator<< (const optional_property<T>& value)
+        {
+            *this << value.isSet();
+            if (value.isSet()) {
+                *this << *value;
+            }
+            return *this;
+        }
+
+    private:
+        void _write(const void* data, size_t bytes)
+        {
+            const char* ptr = static_cast<const char*>(data);
+            _buffer.insert(_buffer.end(), ptr, ptr + bytes);
+        }
+
+        std::vector<char> _buffer;
+    };
+
+    /**
+     * @brief  Decoder for data written by BinaryEncoder.
+     *
+     * Reading past the end of the data puts the decoder into a failed state,
+     * after which all further reads are ignored; check ok() once all of the
+     * fields have been read.
+     */
+    class BinaryDecoder {
+    public:
+        BinaryDecoder(const void* data, size_t size) :
+            _pos(static_cast<const char*>(data)),
+            _end(_pos + size),
+            _ok(true)
+        {
+        }
+
+        /**
+         * @brief  Returns false if any read has failed.
+         */
+        bool ok() const
+        {
+            return _ok;
+        }
+
+        /**
+         * @brief  Returns the number of bytes that have not been read.
+         */
+        size_t remaining() const
+        {
+            return _end - _pos;
+        }
+
+        template <typename T>
+        typename boost::enable_if<boost::is_arithmetic<T>, BinaryDecoder&>::type
+        operator>> (T& value)
+        {
+            _read(&value, sizeof(T));
+            return *this;
+        }
+
+        template <typename T>
+        BinaryDecoder& operator>> (std::complex<T>& value)
+        {
+            T real = T();
+            T imag = T();
+            *this >> real >> imag;
+            value = std::complex<T>(real, imag);
+            return *this;
+        }
+
+        BinaryDecoder& operator>> (std::string& value)
+        {
+            uint32_t size = 0;
+            *this >> size;
+            if (_check(size)) {
+                value.assign(_pos, size);
+                _pos += size;
+            }
+            return *this;
+        }
+
+        BinaryDecoder& operator>> (CF::UTCTime& value)
+        {
+            return *this >> value.tcstatus >> value.twsec >> value.tfsec;
+        }
+
+        template <typename T>
+        BinaryDecoder& operator>> (std::vector<T>& value)
+        {
+            uint32_t size = 0;
+            *this >> size;
+            // Every element takes at least one byte, which bounds the size
+            // of a corrupt count
+            if (!_check(size)) {
+                return *this;
+            }
+            value.resize(size);
+            for (typename std::vector<T>::iterator item = value.begin(); _ok && (item != value.end()); ++item) {
+                *this >> *item;
+            }
+            return *this;
+        }
+
+        BinaryDecoder& operator>> (std::vector<bool>& value)
+        {
+            uint32_t size = 0;
+            *this >> size;
+            if (!_check(size)) {
+                return *this;
+            }
+            value.resize(size);
+            for (size_t index = 0; _ok && (index < size); ++index) {
+                bool item = false;
+                *this >> item;
+                value[index] = item;
+            }
+            return *this;
+        }
+
+        template <typename T>
+        BinaryDecoder& operator>> (optional_property<T>& value)
+        {
+            bool is_set = false;
+            *this >> is_set;
+            if (!_ok) {
+                return *this;
+            }
+            if (is_set) {
+                T temp;
+                *this >> temp;
+                value = temp;
+            } else {
+                value.reset();
+            }
+            return *this;
+        }
+
+    private:
+        bool _check(size_t bytes)
+        {
+            if (_ok && (bytes > remaining())) {
+                _ok = false;
+            }
+            return _ok;
+        }
+
+        void _read(void* data, size_t bytes)
+        {
+            if (_check(bytes)) {
+                std::memcpy(data, _pos, bytes);
+                _pos += bytes;
+            }
+        }
+
+        const char* _pos;
+        const char* _end;
+        bool _ok;
+    };
+
+}
+
+#endif // REDHAWK_BINARYCODEC_H
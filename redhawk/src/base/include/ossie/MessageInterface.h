@@ -133,9 +133,24 @@ public:
 
     std::string getDirection() const;
 
+    /*
+     * Also reports support for receiving messages from other processes on
+     * the same host through shared memory, which suppliers check for before
+     * negotiating
+     */
+    virtual CORBA::Boolean _is_a(const char* repoId);
+
 protected:
 
     friend class MessageSupplierPort;
+    friend class Consumer_i;
+
+    class ShmReader;
+
+    void attachShmReader (const CF::Properties& properties);
+    void detachShmReaders ();
+    std::string describeCallbacks ();
+    bool dispatchBinary (const std::string& id, const char* data, size_t size);
 
     rh_logger::LoggerPtr _messageconsumerLog;
 
@@ -151,6 +166,8 @@ protected:
     std::map<std::string, CosEventChannelAdmin::EventChannel_ptr> _connections;
     
     SupplierAdmin_i *supplier_admin;
+
+    std::vector<ShmReader*> shm_readers_;
     
     /*
      * Abstract untyped interface for message callbacks.
@@ -160,8 +177,18 @@ protected:
     public:
         virtual void dispatch (const std::string& value, const CORBA::Any& data) = 0;
         virtual void dispatch (const std::string& value, const void* data) = 0;
+        // Decodes a message from its binary encoding and dispatches it; if
+        // any is not null, the message is also serialized into it for generic
+        // callbacks. Returns false if the message could not be decoded.
+        virtual bool dispatch (const std::string& value, redhawk::BinaryDecoder& decoder, CORBA::Any* any) = 0;
+        virtual bool supportsBinary () const = 0;
         virtual ~MessageCallback () { }
 
+        const std::string& format () const
+        {
+            return _format;
+        }
+
         bool isCompatible (const char* format)
         {
             if (_format.empty()) {
@@ -213,7 +240,27 @@ protected:
             func_(value, *message);
         }
 
+        virtual bool dispatch (const std::string& value, redhawk::BinaryDecoder& decoder, CORBA::Any* any)
+        {
+            Message message;
+            if (!traits::decode(decoder, message)) {
+                return false;
+            }
+            func_(value, message);
+            if (any) {
+                *any <<= message;
+            }
+            return true;
+        }
+
+        virtual bool supportsBinary () const
+        {
+            return traits::encoder() != 0;
+        }
+
     private:
+        typedef ::redhawk::internal::message_traits<Message> traits;
+
         CallbackFunc func_;
     };
 
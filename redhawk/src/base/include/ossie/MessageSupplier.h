@@ -22,8 +22,10 @@
 #define MESSAGESUPPLIER_H
 
 #include <string>
+#include <vector>
 
 #include <boost/thread/mutex.hpp>
+#include <boost/shared_ptr.hpp>
 
 #include <COS/CosEventChannelAdmin.hh>
 
@@ -37,9 +39,67 @@ class MessageSupplierPort : public redhawk::UsesPort
 {
 
 public:
+    /**
+     * @brief  Behavior when the asynchronous message queue is full.
+     */
+    enum QueuePolicy {
+        QUEUE_BLOCK,        ///< Wait until the queue has room
+        QUEUE_DROP_OLDEST   ///< Discard the oldest queued message
+    };
+
+    /**
+     * @brief  Asynchronous publishing counters.
+     */
+    struct AsyncStatistics {
+        size_t queueDepth;      ///< Number of messages currently queued
+        size_t maxQueueDepth;   ///< Highest number of messages queued at once
+        size_t messagesSent;    ///< Total messages published
+        size_t messagesDropped; ///< Total messages discarded due to a full queue
+        size_t batchesSent;     ///< Total batches published
+        double averageLatency;  ///< Mean time from queueing to publishing, in seconds
+        double maxLatency;      ///< Longest time from queueing to publishing, in seconds
+    };
+
     MessageSupplierPort (const std::string& name);
     virtual ~MessageSupplierPort (void);
 
+    /**
+     * @brief  Enables or disables asynchronous publishing.
+     * @param queueDepth  Maximum number of queued messages (0 to disable).
+     * @param maxDelay    Maximum time, in seconds, a message may wait to be
+     *                    batched with later messages.
+     * @param policy      Behavior when the queue is full.
+     *
+     * In asynchronous mode, push() and sendMessages() copy the messages into
+     * a bounded queue and return immediately. A background thread publishes
+     * the queued messages, combining them into a single batch per connection.
+     * A message is held no longer than @p maxDelay unless the connection is
+     * slow; a full queue is published without waiting.
+     *
+     * Disabling asynchronous mode publishes any queued messages before
+     * returning.
+     */
+    void setAsync(size_t queueDepth, float maxDelay=0.01, QueuePolicy policy=QUEUE_BLOCK);
+
+    /**
+     * @brief  Returns true if asynchronous publishing is enabled.
+     */
+    bool isAsync();
+
+    /**
+     * @brief  Waits until all queued messages have been published.
+     *
+     * If asynchronous publishing is not enabled, returns immediately.
+     */
+    void flush();
+
+    /**
+     * @brief  Returns the asynchronous publishing counters.
+     *
+     * If asynchronous publishing is not enabled, all counters are zero.
+     */
+    AsyncStatistics getAsyncStatistics();
+
     /**
      * @brief  Sends pre-serialized messages.
      * @param data          Messages serialized to a CORBA::Any.
@@ -90,6 +150,17 @@ public:
     {
         boost::mutex::scoped_lock lock(updatingPortsLock);
         _checkConnectionId(connectionId);
+        if (_asyncQueue) {
+            // Copy the messages into the queue without holding the lock, so
+            // that the publishing thread can make progress if the queue fills
+            boost::shared_ptr<AsyncQueue> queue = _asyncQueue;
+            lock.unlock();
+            for (; first != last; ++first) {
+                _postMessage(*queue, *first, connectionId);
+            }
+            return;
+        }
+        boost::mutex::scoped_lock publish_lock(_publishMutex);
         _beginMessageQueue(std::distance(first, last), connectionId);
         for (; first != last; ++first) {
             _queueMessage(*first, connectionId);
@@ -111,14 +182,40 @@ protected:
         typedef ::redhawk::internal::message_traits<Message> traits;
         const std::string messageId = traits::getId(message);
         const char* format = traits::format();
-        _queueMessage(messageId, format, &message, &traits::serialize, connectionId);
+        _queueMessage(messageId, format, &message, &traits::serialize, traits::encoder(), connectionId);
     }
 
     typedef void (*SerializerFunc)(CORBA::Any&,const void*);
+    typedef ::redhawk::internal::message_encoder EncoderFunc;
+    typedef void (*DeleterFunc)(void*);
+
+    class AsyncQueue;
+    struct QueuedMessage;
+
+    template <class Message>
+    static void _deleteMessage(void* msgData)
+    {
+        delete reinterpret_cast<Message*>(msgData);
+    }
+
+    template <class Message>
+    inline void _postMessage(AsyncQueue& queue, const Message& message, const std::string& connectionId)
+    {
+        typedef ::redhawk::internal::message_traits<Message> traits;
+        const std::string messageId = traits::getId(message);
+        const char* format = traits::format();
+        _postMessage(queue, messageId, format, new Message(message), &traits::serialize,
+                     traits::encoder(), &_deleteMessage<Message>, connectionId);
+    }
+
+    void _postMessage(AsyncQueue& queue, const std::string& msgId, const char* format, void* msgData,
+                      SerializerFunc serializer, EncoderFunc encoder, DeleterFunc deleter,
+                      const std::string& connectionId);
+    void _publishMessages(std::vector<QueuedMessage>& messages);
 
     void _beginMessageQueue(size_t count, const std::string& connectionId);
     void _queueMessage(const std::string& msgId, const char* format, const void* msgData,
-                       SerializerFunc serializer, const std::string& connectionId);
+                       SerializerFunc serializer, EncoderFunc encoder, const std::string& connectionId);
     void _sendMessageQueue(const std::string& connectionId);
 
     bool _isConnectionSelected(const std::string& connectionId, const std::string& targetId);
@@ -128,8 +225,16 @@ protected:
     class MessageTransport;
     class CorbaTransport;
     class LocalTransport;
+    class ShmTransport;
 
     typedef redhawk::UsesPort::TransportIteratorAdapter<MessageTransport> TransportIterator;
+
+    boost::shared_ptr<AsyncQueue> _asyncQueue;
+
+    // Serializes use of the transports for sending; the publishing thread
+    // holds it (but not the port lock) while it sends a batch. When both are
+    // needed, acquire updatingPortsLock first.
+    boost::mutex _publishMutex;
 };
 
 #endif // MESSAGESUPPLIER_H
@@ -76,6 +76,12 @@ protected:
     void deactivateOutPorts();
     void deactivateInPorts();
 
+    // Called from the delivering thread each time data is queued on any
+    // provides port; the default does nothing. Components that also inherit
+    // ThreadedComponent override this to wake the processing thread, since
+    // the two bases cannot see each other.
+    virtual void portDataArrived ();
+
 private:
     void insertPort (const std::string& name, PortBase* servant);
     void deactivatePort (PortBase* servant);
@@ -31,6 +31,7 @@
 
 #include "CF/cf.h"
 #include "ossie/Autocomplete.h"
+#include "ossie/callback.h"
 #include "ossie/logging/rh_logger.h"
 
 namespace _seqVector {
@@ -403,6 +404,25 @@ public:
     {
         return CF::PortSet::DIRECTION_PROVIDES;
     }
+
+    // Register a listener to be called each time new data is queued on this
+    // Port (e.g., to wake up a processing thread); listeners are called from
+    // the thread that delivered the data, and must not block
+    template <class Target, class Func>
+    void addDataListener(Target target, Func func)
+    {
+        _dataArrived.add(target, func);
+    }
+
+    template <class Target, class Func>
+    void removeDataListener(Target target, Func func)
+    {
+        _dataArrived.remove(target, func);
+    }
+
+protected:
+    // Subclasses trigger this notification after queueing new data
+    ossie::notification<void ()> _dataArrived;
 };
 
 
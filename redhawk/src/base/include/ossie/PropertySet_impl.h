@@ -345,6 +345,13 @@ protected:
      * Call the property change callback for the given identifier.
      */
     void executePropertyCallback (const std::string& id);
+
+    /*
+     * Called after a configure changes the value of a property, once its
+     * callback has run; the default does nothing. Components that also
+     * inherit ThreadedComponent override this to wake the processing thread.
+     */
+    virtual void propertyChanged (const std::string& id);
     
     // This mutex is used to deal with configure/query concurrency
     boost::mutex propertySetAccess;
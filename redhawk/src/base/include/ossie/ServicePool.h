@@ -0,0 +1,176 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK core.
+ *
+ * REDHAWK core is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK core is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+#ifndef REDHAWK_SERVICEPOOL_H
+#define REDHAWK_SERVICEPOOL_H
+
+#include <list>
+#include <string>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
+
+#include "debug.h"
+#include "ExecutorService.h"
+
+class ThreadedComponent;
+
+namespace redhawk {
+
+    /**
+     * @brief  Process-wide thread pool for component service functions.
+     *
+     * When several components share one process (e.g., inside ComponentHost),
+     * giving each component its own processing thread oversubscribes the
+     * cores with threads that mostly sleep. %ServicePool instead runs the
+     * service functions of all participating components as tasks on a fixed
+     * set of worker threads.
+     *
+     * Each worker has its own run queue; a worker that runs out of tasks
+     * steals from the other workers' queues, so load evens out without a
+     * central queue. A task that returns NORMAL is requeued on the worker
+     * that ran it; one that returns NOOP is parked until its component's
+     * thread delay expires, or, for event-driven components, until it is
+     * woken.
+     *
+     * Tasks may carry a priority hint (higher values run first within a
+     * worker's queue) and a CPU affinity hint. A task with a CPU hint is only
+     * run by the worker bound to that CPU, if there is one, and is never
+     * stolen.
+     *
+     * The pool is a singleton that is stopped by default. Components that
+     * opt in via ThreadedComponent::setThreadPooled() fall back to a dedicated
+     * thread when the pool is not running.
+     *
+     * @warning  Pooled service functions must not block indefinitely, as that
+     *           ties up a worker for all components.
+     */
+    class ServicePool {
+        ENABLE_LOGGING;
+
+    public:
+        /**
+         * @brief  Per-task accounting, as reported by getStatistics().
+         */
+        struct TaskStatistics {
+            std::string name;
+            int priority;
+            int cpu;
+            unsigned long long calls;
+            double cpuTime;
+        };
+
+        typedef std::vector<TaskStatistics> StatisticsList;
+
+        /// @cond IMPL
+        class Task;
+        typedef boost::shared_ptr<Task> TaskPtr;
+        /// @endcond
+
+        /**
+         * @brief  Returns the process-wide instance.
+         */
+        static ServicePool& Instance();
+
+        /**
+         * @brief  Starts the worker threads.
+         * @param threads  Number of worker threads; if zero, the pool stays
+         *                 stopped.
+         * @param cpus  CPUs to bind the workers to, assigned round-robin; if
+         *              empty, workers are not bound.
+         * @throw std::logic_error  If the pool is already running.
+         */
+        void start(size_t threads, const std::vector<int>& cpus=std::vector<int>());
+
+        /**
+         * @brief  Stops and joins all worker threads.
+         *
+         * Any tasks that are still registered are no longer run.
+         */
+        void stop();
+
+        /**
+         * @brief  Returns true if the worker threads are running.
+         */
+        bool isRunning();
+
+        /**
+         * @brief  Returns the number of worker threads.
+         */
+        size_t size();
+
+        /**
+         * @brief  Returns accounting information for all registered tasks.
+         */
+        StatisticsList getStatistics();
+
+        /// @cond IMPL
+        // Task interface for ThreadedComponent
+        TaskPtr addTask(ThreadedComponent* target, const std::string& name, int priority, int cpu);
+        bool removeTask(const TaskPtr& task, float timeout);
+        void wakeTask(const TaskPtr& task);
+        /// @endcond
+
+    private:
+        /// @cond IMPL
+        class Worker;
+        typedef std::vector<Worker*> WorkerList;
+
+        ServicePool();
+        ~ServicePool();
+
+        // Non-copyable, non-assignable
+        ServicePool(const ServicePool&);
+        ServicePool& operator=(const ServicePool&);
+
+        void _run(Worker* worker);
+        void _execute(Worker* worker, const TaskPtr& task);
+        TaskPtr _nextTask(Worker* worker);
+        TaskPtr _stealTask(Worker* thief);
+
+        // Queues a task on the given worker, or the task's home worker if it
+        // has a CPU hint; must be called with the task lock held, but not the
+        // pool lock
+        void _enqueue(const TaskPtr& task, Worker* worker);
+        void _timerExpired(const TaskPtr& task, unsigned int generation);
+
+        // Must be called with the pool lock held
+        bool _hasWork(Worker* worker);
+
+        Worker* _findWorker(int cpu);
+
+        boost::mutex _mutex;
+        boost::condition_variable _cond;
+        volatile bool _running;
+        size_t _idleWorkers;
+        size_t _nextWorker;
+        WorkerList _workers;
+
+        typedef std::list<TaskPtr> TaskList;
+        TaskList _tasks;
+
+        // Requeues tasks whose NOOP delay has expired
+        ExecutorService _timer;
+        /// @endcond
+    };
+}
+
+#endif // REDHAWK_SERVICEPOOL_H
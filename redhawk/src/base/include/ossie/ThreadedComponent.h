@@ -21,7 +21,10 @@
 #ifndef OSSIE_THREADEDCOMPONENT_H
 #define OSSIE_THREADEDCOMPONENT_H
 
+#include <boost/thread/condition_variable.hpp>
+
 #include "ProcessThread.h"
+#include "ServicePool.h"
 
 enum {
     NOOP   = 0,
@@ -39,6 +42,10 @@ public:
     // Main work function (to be implemented by subclass)
     virtual int serviceFunction () = 0;
 
+    // Wakes up the processing thread if it is waiting after a NOOP, or makes
+    // the next wait return immediately; may be called from any thread
+    void wake ();
+
 protected:
     ThreadedComponent ();
 
@@ -54,14 +61,66 @@ protected:
     // Changes the delay between calls to service function after a NOOP
     void setThreadDelay (float delay);
 
+    // Returns true if the processing thread waits for events after a NOOP
+    bool isThreadEventDriven ();
+
+    // Enables or disables event-driven mode. When enabled, after a NOOP the
+    // processing thread waits until new data arrives on an input port, a
+    // property is changed via configure, or wake() is called, instead of
+    // sleeping for the thread delay. The service function must not rely on
+    // being called periodically while idle.
+    void setThreadEventDriven (bool eventDriven);
+
+    // Notifies the processing thread of an input event; only wakes the thread
+    // in event-driven mode, so that timer-based components are unaffected.
+    // Subclasses that are also a Resource_impl call this from their overrides
+    // of portDataArrived() and propertyChanged().
+    void eventArrived ();
+
+    // Returns true if the service function should run on the process-wide
+    // redhawk::ServicePool
+    bool isThreadPooled ();
+
+    // Opts in to running the service function as a task on the process-wide
+    // redhawk::ServicePool (e.g., inside ComponentHost) instead of on a
+    // dedicated thread. If the pool is not running, a dedicated thread is
+    // used anyway. Takes effect on the next call to startThread(); while
+    // pooled, serviceThread is null.
+    void setThreadPooled (bool pooled);
+
+    // Scheduling hints for pooled mode: higher priorities run first, and a
+    // non-negative CPU restricts the task to the pool worker bound to that
+    // CPU, if there is one. Take effect on the next call to startThread().
+    void setThreadPriority (int priority);
+    void setThreadAffinity (int cpu);
+
     ossie::ProcessThread* serviceThread;
     boost::mutex serviceThreadLock;
 
     void setThreadName(const std::string& name);
 
 private:
+    friend class ossie::ProcessThread;
+    friend class redhawk::ServicePool;
+
+    // Called by ProcessThread after a NOOP
+    void waitForWake (const boost::posix_time::time_duration& delay);
+
     std::string _threadName;
     float _defaultDelay;
+
+    boost::mutex _wakeMutex;
+    boost::condition_variable _wakeCondition;
+    bool _wakePending;
+    volatile bool _eventDriven;
+
+    bool _pooled;
+    int _threadPriority;
+    int _threadAffinity;
+
+    // Guarded by both serviceThreadLock and _wakeMutex, so that wake() does
+    // not need to take serviceThreadLock
+    redhawk::ServicePool::TaskPtr _serviceTask;
 };
 
 #endif // OSSIE_THREADEDCOMPONENT_H
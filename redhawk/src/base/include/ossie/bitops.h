@@ -194,7 +194,7 @@ namespace redhawk {
          *         distance.
          * @param str      Bit string in which to search.
          * @param sstart   Index of first bit in @p str.
-         * @param slen     Length of @p str.
+         * @param slen     Index of the bit after the last bit in @p str.
          * @param patt     Bit pattern to search for.
          * @param pstart   Index of first bit in @p patt.
          * @param plen     Length of @p patt.
@@ -203,7 +203,10 @@ namespace redhawk {
          *           @p patt was not found within @p maxdist.
          *
          * Searches @a str for a position at which the Hamming distance between
-         * @a str and @a patt is less than or equal to @a maxdist.
+         * @a str and @a patt is less than or equal to @a maxdist. Patterns of
+         * up to 64 bits are matched with a bit-parallel algorithm, which does
+         * a fixed amount of work per bit of @a str; for multiple patterns or
+         * streaming data, see redhawk::bitsearch.
          */
         int find(const byte* str, size_t sstart, size_t slen,
                  const byte* patt, size_t pstart, size_t plen,
@@ -0,0 +1,168 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK core.
+ *
+ * REDHAWK core is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK core is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+#ifndef REDHAWK_BITSEARCH_H
+#define REDHAWK_BITSEARCH_H
+
+#include <vector>
+#include <stdint.h>
+#include <stddef.h>
+
+#include "bitbuffer.h"
+
+namespace redhawk {
+
+    /**
+     * @brief  Approximate search for short bit patterns, such as sync words.
+     *
+     * The %bitsearch class finds occurrences of one or more bit patterns of up
+     * to 64 bits, each within its own maximum Hamming distance. It uses a
+     * bit-parallel (Bitap) algorithm that does a fixed amount of work per
+     * input bit for each pattern, regardless of the pattern length.
+     *
+     * Searches may be one-shot, over a single bit buffer, or streaming, where
+     * the search state carries over from one bit buffer to the next so that
+     * patterns that straddle the boundary between buffers are still found.
+     * The one-shot find() methods do not modify the streaming state.
+     */
+    class bitsearch
+    {
+    public:
+        /// @brief  Value used to represent invalid bit indices.
+        static const size_t npos = static_cast<size_t>(-1);
+
+        /// @brief  Maximum number of bits in a pattern.
+        static const size_t max_pattern_size = 64;
+
+        /**
+         * @brief  Description of a pattern occurrence.
+         */
+        struct match {
+            /// Index of the first bit of the occurrence; for streaming
+            /// searches, this is the index in the overall stream
+            uint64_t position;
+            /// Index of the pattern, in the order patterns were added
+            size_t pattern;
+            /// Hamming distance between the occurrence and the pattern
+            int distance;
+        };
+
+        /**
+         * Construct a %bitsearch with no patterns.
+         */
+        bitsearch();
+
+        /**
+         * @brief  Construct a %bitsearch for a single pattern.
+         * @param pattern      Bit pattern to search for.
+         * @param maxDistance  Maximum allowable Hamming distance.
+         * @throw std::length_error  If @p pattern is empty or longer than
+         *                           max_pattern_size.
+         */
+        bitsearch(const shared_bitbuffer& pattern, int maxDistance);
+
+        /**
+         * @brief  Adds a pattern to search for.
+         * @param pattern      Bit pattern to search for.
+         * @param maxDistance  Maximum allowable Hamming distance.
+         * @return  Index of the new pattern, as reported in matches.
+         * @throw std::length_error  If @p pattern is empty or longer than
+         *                           max_pattern_size.
+         *
+         * Resets the streaming state.
+         */
+        size_t add_pattern(const shared_bitbuffer& pattern, int maxDistance);
+
+        /**
+         * Returns the number of patterns.
+         */
+        size_t pattern_count() const;
+
+        /**
+         * @brief  Finds the first occurrence of any pattern in a bit buffer.
+         * @param buffer  Bit buffer to search.
+         * @param start   Starting bit index (default 0).
+         * @return  Bit index of the first occurrence, or npos if not found.
+         *
+         * Occurrences are ordered by their last bit; if more than one pattern
+         * ends at the same bit, the pattern added first wins.
+         */
+        size_t find(const shared_bitbuffer& buffer, size_t start=0) const;
+
+        /**
+         * @brief  Finds the first occurrence of any pattern in a bit buffer.
+         * @param buffer  Bit buffer to search.
+         * @param start   Starting bit index.
+         * @param result  Description of the occurrence, if found.
+         * @return  True if an occurrence was found.
+         * @see find(const shared_bitbuffer&,size_t) const
+         */
+        bool find(const shared_bitbuffer& buffer, size_t start, match& result) const;
+
+        /**
+         * @brief  Searches the next bit buffer in a stream.
+         * @param buffer   Next bit buffer in the stream.
+         * @param matches  Vector to which occurrences are appended.
+         * @return  Number of occurrences found.
+         *
+         * Appends every occurrence whose last bit is in @a buffer, in order
+         * of their last bit, including occurrences that begin in previous
+         * bit buffers.
+         */
+        size_t push(const shared_bitbuffer& buffer, std::vector<match>& matches);
+
+        /**
+         * Returns the number of bits searched since the stream was reset.
+         */
+        uint64_t position() const;
+
+        /**
+         * Discards the streaming state, so that the next bit buffer is
+         * treated as the start of a new stream.
+         */
+        void reset();
+
+    private:
+        /// @cond IMPL
+        struct _M_pattern {
+            // Bit i is clear if bit i of the pattern is 0 (index 0) or 1
+            // (index 1)
+            uint64_t masks[2];
+            uint64_t match_bit;
+            size_t size;
+            int errors;
+            // Offset of the pattern's first state word
+            size_t state;
+        };
+
+        typedef std::vector<uint64_t> _M_state_vector;
+
+        size_t _M_search(const shared_bitbuffer& buffer, size_t start, _M_state_vector& states,
+                         uint64_t base, std::vector<match>& matches, bool firstOnly) const;
+
+        std::vector<_M_pattern> _M_patterns;
+        _M_state_vector _M_states;
+        uint64_t _M_position;
+        /// @endcond
+    };
+
+}
+
+#endif // REDHAWK_BITSEARCH_H
@@ -23,6 +23,8 @@
 
 #include <boost/utility/enable_if.hpp>
 
+#include "../BinaryCodec.h"
+
 namespace redhawk {
 
     namespace internal {
@@ -69,11 +71,70 @@ namespace redhawk {
             }
         };
 
+        // Templatized traits struct to distinguish between structs that have
+        // generated binary encode() and decode() methods and those that do
+        // not (generated by older code generators or written by hand).
+        template <class T>
+        struct has_binary_codec
+        {
+            typedef ::boost::type_traits::no_type no_type;
+            typedef ::boost::type_traits::yes_type yes_type;
+            template <typename U, U> struct type_check;
+
+            template <typename U>
+            static yes_type& check(type_check<void (U::*)(::redhawk::BinaryEncoder&) const, &U::encode>*,
+                                   type_check<bool (U::*)(::redhawk::BinaryDecoder&), &U::decode>*);
+
+            template <typename>
+            static no_type& check(...);
+
+            static bool const value = (sizeof(check<T>(0, 0)) == sizeof(yes_type));
+        };
+
+        typedef void (*message_encoder)(::redhawk::BinaryEncoder&, const void*);
+
+        // Base binary codec traits for structs that cannot be encoded; the
+        // encoder is null, and decoding always fails.
+        template <class T, class Enable=void>
+        struct message_codec_base
+        {
+            static message_encoder encoder()
+            {
+                return 0;
+            }
+
+            static bool decode(::redhawk::BinaryDecoder&, T&)
+            {
+                return false;
+            }
+        };
+
+        // Binary codec traits for structs that have encode() and decode()
+        // methods.
+        template <class T>
+        struct message_codec_base<T, typename boost::enable_if<has_binary_codec<T> >::type>
+        {
+            static void encode(::redhawk::BinaryEncoder& encoder, const void* data)
+            {
+                reinterpret_cast<const T*>(data)->encode(encoder);
+            }
+
+            static message_encoder encoder()
+            {
+                return &encode;
+            }
+
+            static bool decode(::redhawk::BinaryDecoder& decoder, T& message)
+            {
+                return message.decode(decoder) && decoder.ok();
+            }
+        };
+
         // Traits class to adapt multiple levels of REDHAWK-generated struct
         // classes used in messaging. Provides a consistent interface for
         // getting a format string or message ID, and serialization.
         template <class T>
-        struct message_traits : public message_traits_base<T> {
+        struct message_traits : public message_traits_base<T>, public message_codec_base<T> {
             static void serialize(CORBA::Any& any, const void* data)
             {
                 any <<= *(reinterpret_cast<const T*>(data));
@@ -40,6 +40,10 @@ namespace redhawk {
         void* allocateHybrid(size_t bytes);
         void deallocateHybrid(void* ptr);
 
+        // Sets the NUMA node for the calling thread's allocations from the
+        // process heap (see Heap::setNodeHint)
+        void setNodeHint(int node);
+
         template <class T>
         struct Allocator : public std::allocator<T>
         {
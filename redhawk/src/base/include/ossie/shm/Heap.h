@@ -22,6 +22,7 @@
 #define REDHAWK_SHM_HEAP_H
 
 #include <vector>
+#include <set>
 #include <boost/thread.hpp>
 
 #include "SuperblockFile.h"
@@ -30,6 +31,7 @@ namespace redhawk {
 
     namespace shm {
         class ThreadState;
+        struct Block;
 
         struct MemoryRef {
             std::string heap;
@@ -49,6 +51,38 @@ namespace redhawk {
 
             static MemoryRef getRef(const void* ptr);
 
+            /**
+             * Sets the NUMA node that the calling thread's allocations should
+             * come from, for example the node of the consumer that will read
+             * the data; -1 restores the default of the node the thread is
+             * running on. Only has an effect with the NUMA heap policy.
+             */
+            void setNodeHint(int node);
+            int getNodeHint();
+
+            /**
+             * Enables or disables backing new superblocks with huge pages,
+             * which reduces TLB misses for readers walking large blocks.
+             * Superblock sizes are rounded up to a multiple of the huge page
+             * size. If the system does not support huge pages for shared
+             * memory, a warning is printed and normal pages are used. The
+             * default is set from the RH_SHMALLOC_HUGEPAGES environment
+             * variable.
+             */
+            void setHugePages(bool enable);
+            bool getHugePages();
+
+            /**
+             * Sets the time, in seconds, that a superblock must sit empty
+             * before its memory is returned to the OS; 0 disables
+             * reclamation. Idle superblocks are checked for at half the decay
+             * time, but no more often than every 100ms. The default is set
+             * from the RH_SHMALLOC_DECAY_TIME environment variable, and is
+             * disabled if it is not set.
+             */
+            void setDecayTime(double seconds);
+            double getDecayTime();
+
             const std::string& name() const;
 
         private:
@@ -58,26 +92,63 @@ namespace redhawk {
             Heap(const Heap&);
             Heap& operator=(const Heap&);
 
-            // Default to 2MB superblock
+            // Default to 2MB superblock (one huge page)
             static const size_t DEFAULT_SUPERBLOCK_SIZE = 2097152;
 
-            Superblock* _createSuperblock(size_t minSize);
+            Superblock* _createSuperblock(size_t minSize, int node);
+            void _bindSuperblock(Superblock* superblock, int node);
+
+            // Idle superblock reclamation: a background thread periodically
+            // asks each pool to give up superblocks that have been empty for
+            // longer than the decay time; their memory is returned to the OS
+            // and the superblocks are kept on a heap-wide free list for reuse
+            // by any pool
+            void _reclaimThreadMain();
+            void _releaseSuperblock(Superblock* superblock);
+            Superblock* _reuseSuperblock(size_t minSize);
 
             Pool* _getPool(ThreadState* state);
             ThreadState* _getThreadState();
 
+            void* _allocateFromMagazine(ThreadState* state, size_t bytes);
+            bool _cacheInMagazine(ThreadState* state, Block* block);
+            void _flushMagazines(ThreadState* state);
+            void _flushIdleMagazines();
+            static void _releaseThreadState(ThreadState* state);
+
             // Serializes access to all members except thread-specific data
             boost::mutex _mutex;
 
             SuperblockFile _file;
             bool _canGrow;
+            bool _hugePages;
 
             std::vector<Pool*> _allocs;
 
+            std::vector<Superblock*> _freeSuperblocks;
+            double _decayTime;
+            boost::thread* _reclaimThread;
+            boost::condition_variable _reclaimCond;
+            bool _reclaimStop;
+
             boost::thread_specific_ptr<ThreadState> _threadState;
+            std::set<ThreadState*> _threadStates;
 
             static size_t _initSuperblockSize();
             static size_t _superblockSize;
+
+            static bool _initHugePages();
+            static bool _defaultHugePages;
+
+            // Maximum number of blocks cached per size class in each thread's
+            // magazines; 0 disables magazines
+            static int _initMagazineSize();
+            static int _magazineSize;
+
+            // Default seconds that a superblock must remain empty before it
+            // is reclaimed; 0 disables reclamation
+            static double _initDecayTime();
+            static double _defaultDecayTime;
         };
     }
 }
@@ -37,6 +37,14 @@ namespace redhawk {
 
             static const size_t PAGE_SIZE;
 
+            // Size of a transparent huge page (PMD-sized on x86_64)
+            static const size_t HUGE_PAGE_SIZE = 2097152;
+
+            // Returns true if the shared memory filesystem can back mappings
+            // with transparent huge pages on request (tmpfs mounted with
+            // huge=advise or better, unless denied system-wide)
+            static bool HugePagesSupported();
+
             MappedFile(const std::string& name);
             ~MappedFile();
 
@@ -49,9 +57,19 @@ namespace redhawk {
             void resize(size_t bytes);
 
             void* map(size_t bytes, mode_e mode, off_t offset=0);
+            // Maps with the virtual address congruent to the file offset
+            // modulo the huge page size, and advises the kernel to back the
+            // mapping with huge pages; only huge page-aligned ranges of the
+            // file can actually use them
+            void* mapHuge(size_t bytes, mode_e mode, off_t offset=0);
             void* remap(void* oldAddr, size_t oldSize, size_t newSize);
             void unmap(void* addr, size_t bytes);
 
+            // Frees the memory backing a page-aligned range of the file, which
+            // then reads back as zeros; returns false if the file system does
+            // not support it
+            bool release(off_t offset, size_t bytes);
+
             void close();
             void unlink();
 
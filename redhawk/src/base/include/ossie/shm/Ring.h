@@ -0,0 +1,183 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK core.
+ *
+ * REDHAWK core is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK core is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+#ifndef REDHAWK_SHM_RING_H
+#define REDHAWK_SHM_RING_H
+
+#include <string>
+#include <stdint.h>
+
+namespace redhawk {
+
+    namespace shm {
+
+        class MappedFile;
+
+        // Single-producer, single-consumer ring buffer in a shared memory
+        // file, for passing data between two processes on the same host. The
+        // writer creates the ring and passes its name to the reader, which
+        // opens it.
+        //
+        // The ring is addressed by free-running byte offsets; head() and
+        // tail() only ever increase, and at() maps an offset into the ring.
+        // Each side spins briefly when the ring is empty (reader) or full
+        // (writer), then parks on a futex in the shared mapping; the opposite
+        // side only makes a wake system call when it sees that its peer is
+        // asleep. A waiting writer periodically checks that the reader's
+        // process still exists.
+        //
+        // Users may reserve an extra area in the ring's header for their own
+        // shared state (see extra()), which starts on its own cache line.
+        class Ring {
+        public:
+            Ring();
+            ~Ring();
+
+            // Writer side: create a new ring file with room for at least
+            // capacity bytes (rounded up to a power of two) and map it. The
+            // file name starts with prefix; type identifies the user's data
+            // format, and must match when the reader opens the ring.
+            void create(const std::string& prefix, uint32_t type, size_t capacity, size_t extraSize=0);
+
+            // Reader side: map an existing ring file created by the writer,
+            // checking that its type matches and that the file is large
+            // enough for the ring it describes
+            void open(const std::string& name, uint32_t type, size_t extraSize=0);
+
+            const std::string& name() const;
+            bool isOpen() const;
+
+            // Remove the ring file from the file system; once both sides have
+            // mapped the ring, this can be done without affecting the
+            // connection
+            void unlink();
+
+            void detach();
+
+            size_t capacity() const;
+            void* extra() const;
+
+            // Returns a pointer to the byte at offset; the caller must not
+            // access data past the end of the ring
+            char* at(uint64_t offset) const;
+
+            // Writer interface: waitSpace() blocks until there are at least
+            // bytes free, returning false if the ring is closed or the reader
+            // has exited; publish() advances the head and wakes the reader
+            uint64_t head() const;
+            bool waitSpace(size_t bytes);
+            void publish(uint64_t head);
+
+            // Reader interface: waitData() blocks for up to timeout
+            // milliseconds (negative waits forever) for data, returning false
+            // on timeout or if the ring is closed and empty; release()
+            // advances the tail and wakes the writer
+            uint64_t tail() const;
+            bool waitData(int timeout);
+            void release(uint64_t tail);
+
+            // Returns true if the process on the other side of the ring
+            // exists
+            bool isPeerAlive() const;
+
+            // Asynchronous error reporting from the reader to the writer
+            void reportError();
+            uint32_t errorCount() const;
+
+            // Mark the ring as closed from either side, waking the other side
+            // if it is waiting
+            void close();
+            bool isClosed() const;
+            volatile int32_t* closedFlag();
+
+        private:
+            struct Header;
+
+            // Non-copyable, non-assignable
+            Ring(const Ring&);
+            Ring& operator=(const Ring&);
+
+            static std::string _makeUniqueName(const std::string& prefix, const void* self);
+
+            std::string _name;
+            MappedFile* _file;
+            Header* _header;
+            char* _data;
+            size_t _mappedSize;
+            bool _owner;
+            bool _writer;
+        };
+
+        // Ring of fixed-size slots, for transports that pass small
+        // descriptors; each slot is a power of two bytes, at least one cache
+        // line
+        class SlotRing {
+        public:
+            SlotRing();
+
+            // Writer side: create a new ring with at least capacity slots
+            void create(const std::string& prefix, uint32_t type, size_t capacity, size_t slotSize, size_t extraSize=0);
+
+            // Reader side: map an existing ring created by the writer
+            void open(const std::string& name, uint32_t type, size_t extraSize=0);
+
+            const std::string& name() const;
+            bool isOpen() const;
+            void unlink();
+            void detach();
+
+            size_t slotSize() const;
+            void* extra() const;
+
+            // Writer interface: beginWrite() blocks until a slot is free,
+            // returning a null pointer if the ring is closed or the reader has
+            // exited; commitWrite() publishes the slot and returns its
+            // sequence number
+            void* beginWrite();
+            uint64_t commitWrite();
+
+            // Reader interface: beginRead() blocks for up to timeout
+            // milliseconds for a slot, returning a null pointer on timeout or
+            // close; commitRead() releases the slot back to the writer
+            void* beginRead(int timeout);
+            void commitRead();
+
+            // Number of slots the reader has fully consumed
+            uint64_t readCount() const;
+
+            bool isPeerAlive() const;
+
+            void reportError();
+            uint32_t errorCount() const;
+
+            void close();
+            bool isClosed() const;
+            volatile int32_t* closedFlag();
+
+        private:
+            struct Layout;
+
+            Ring _ring;
+            size_t _slotSize;
+        };
+    }
+}
+
+#endif // REDHAWK_SHM_RING_H
@@ -57,7 +57,7 @@ namespace redhawk {
             void close();
 
             Superblock* getSuperblock(size_t offset);
-            Superblock* createSuperblock(size_t bytes);
+            Superblock* createSuperblock(size_t bytes, bool hugePages=false);
 
             const std::string& name() const;
 
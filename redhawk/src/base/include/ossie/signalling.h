@@ -21,9 +21,11 @@
 #ifndef REDHAWK_SIGNALLING_H
 #define REDHAWK_SIGNALLING_H
 
+#include <algorithm>
 #include <list>
 #include <set>
 #include <string>
+#include <vector>
 
 #include <boost/thread/mutex.hpp>
 #include <boost/thread/condition_variable.hpp>
@@ -105,18 +107,50 @@ namespace redhawk {
              * interrupted.
              */
             waiter(signal* parent, float timeout) :
-                _M_parent(parent),
+                _M_parents(),
+                _M_received(),
+                _M_interrupted(false),
+                _M_timeout(_M_end_time(timeout))
+            {
+                attach(parent);
+            }
+
+            /*
+             * Create a new waiter that is not associated with any signal, that
+             * expires after timeout seconds. Use attach() to add the signals
+             * to wait on.
+             */
+            explicit waiter(float timeout) :
+                _M_parents(),
                 _M_received(),
                 _M_interrupted(false),
                 _M_timeout(_M_end_time(timeout))
             {
-                _M_parent->_M_add_waiter(this);
             }
 
             ~waiter()
             {
                 // Automatically unregister this waiter when out of scope
-                _M_parent->_M_remove_waiter(this);
+                for (typename parent_list::iterator ii = _M_parents.begin(); ii != _M_parents.end(); ++ii) {
+                    (*ii)->_M_remove_waiter(this);
+                }
+            }
+
+            /*
+             * Additionally wait on signals from parent, so that one thread can
+             * wait for events from several sources. Has no effect if this
+             * waiter is already associated with parent.
+             *
+             * As with construction, attach before checking the desired
+             * condition to avoid missing signals.
+             */
+            void attach(signal* parent)
+            {
+                if (std::find(_M_parents.begin(), _M_parents.end(), parent) != _M_parents.end()) {
+                    return;
+                }
+                _M_parents.push_back(parent);
+                parent->_M_add_waiter(this);
             }
 
             /*
@@ -223,7 +257,9 @@ namespace redhawk {
                 }
             }
 
-            signal* const _M_parent;
+            typedef std::vector<signal*> parent_list;
+
+            parent_list _M_parents;
             boost::mutex _M_mutex;
             boost::condition_variable _M_cond;
             signal_set _M_received;
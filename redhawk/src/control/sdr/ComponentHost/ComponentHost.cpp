@@ -21,6 +21,9 @@
 #include <boost/filesystem.hpp>
 #include <boost/scoped_ptr.hpp>
 
+#include <ossie/affinity.h>
+#include <ossie/ServicePool.h>
+
 #include "ComponentHost.h"
 
 using namespace redhawk;
@@ -37,7 +40,8 @@ PREPARE_LOGGING(ComponentHost);
 
 ComponentHost::ComponentHost(const char* identifier, const char* label) :
     Component(identifier, label),
-    counter(0)
+    counter(0),
+    service_pool_threads(0)
 {
     loadProperties();
 }
@@ -45,6 +49,7 @@ ComponentHost::ComponentHost(const char* identifier, const char* label) :
 ComponentHost::~ComponentHost()
 {
     executorService.stop();
+    redhawk::ServicePool::Instance().stop();
 }
 
 void ComponentHost::loadProperties()
@@ -57,6 +62,34 @@ void ComponentHost::loadProperties()
                 "",
                 "external",
                 "property");
+
+    addProperty(service_pool_threads,
+                0,
+                "service_pool_threads",
+                "",
+                "readonly",
+                "",
+                "external",
+                "property");
+
+    addProperty(service_pool_cpus,
+                "",
+                "service_pool_cpus",
+                "",
+                "readonly",
+                "",
+                "external",
+                "property");
+
+    addProperty(service_pool_tasks,
+                "service_pool_tasks",
+                "",
+                "readonly",
+                "",
+                "external",
+                "property");
+
+    setPropertyQueryImpl(service_pool_tasks, this, &ComponentHost::getServicePoolTasks);
 }
 
 void ComponentHost::constructor()
@@ -77,6 +110,44 @@ void ComponentHost::constructor()
             LOG_WARN(ComponentHost, "Unable to preload library " << exc.what());
         }
     }
+
+    startServicePool();
+}
+
+void ComponentHost::startServicePool()
+{
+    if (service_pool_threads == 0) {
+        LOG_DEBUG(ComponentHost, "Service pool is disabled");
+        return;
+    }
+
+    std::vector<int> cpus;
+    if (!service_pool_cpus.empty()) {
+        try {
+            cpus = redhawk::affinity::get_cpu_list("cpu", service_pool_cpus);
+        } catch (const std::exception& exc) {
+            LOG_WARN(ComponentHost, "Invalid service pool CPU list '" << service_pool_cpus << "': " << exc.what());
+        }
+    }
+
+    LOG_DEBUG(ComponentHost, "Starting service pool with " << service_pool_threads << " threads");
+    redhawk::ServicePool::Instance().start(service_pool_threads, cpus);
+}
+
+std::vector<service_pool_task_struct> ComponentHost::getServicePoolTasks()
+{
+    std::vector<service_pool_task_struct> result;
+    redhawk::ServicePool::StatisticsList stats = redhawk::ServicePool::Instance().getStatistics();
+    for (redhawk::ServicePool::StatisticsList::iterator task = stats.begin(); task != stats.end(); ++task) {
+        service_pool_task_struct entry;
+        entry.name = task->name;
+        entry.priority = task->priority;
+        entry.cpu = task->cpu;
+        entry.calls = task->calls;
+        entry.cpu_time = task->cpuTime;
+        result.push_back(entry);
+    }
+    return result;
 }
 
 CORBA::Boolean ComponentHost::allocateCapacity(const CF::Properties& capacities)
@@ -25,6 +25,7 @@
 #include <ossie/ExecutorService.h>
 
 #include "ModuleLoader.h"
+#include "struct_props.h"
 
 namespace redhawk {
     class ComponentEntry;
@@ -66,6 +67,9 @@ namespace redhawk {
 
         std::string getRealPath(const std::string& path);
 
+        void startServicePool();
+        std::vector<service_pool_task_struct> getServicePoolTasks();
+
         int counter;
 
         boost::mutex loadMutex;
@@ -77,6 +81,15 @@ namespace redhawk {
 
         /// Property: preload
         std::vector<std::string> preload;
+
+        /// Property: service_pool_threads
+        CORBA::ULong service_pool_threads;
+
+        /// Property: service_pool_cpus
+        std::string service_pool_cpus;
+
+        /// Property: service_pool_tasks
+        std::vector<service_pool_task_struct> service_pool_tasks;
     };
 }
 
@@ -0,0 +1,107 @@
+/*
+* This file is protected by Copyright. Please refer to the COPYRIGHT file 
+* distributed with this source distribution.
+* 
+* This file is part of REDHAWK core.
+* 
+* REDHAWK core is free software: you can redistribute it and/or modify it 
+* under the terms of the GNU Lesser General Public License as published by the 
+* Free Software Foundation, either version 3 of the License, or (at your 
+* option) any later version.
+* 
+* REDHAWK core is distributed in the hope that it will be useful, but WITHOUT 
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or 
+* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License 
+* for more details.
+* 
+* You should have received a copy of the GNU Lesser General Public License 
+* along with this program.  If not, see http://www.gnu.org/licenses/.
+*/
+
+#ifndef COMPONENTHOST_STRUCTPROPS_H
+#define COMPONENTHOST_STRUCTPROPS_H
+
+#include <ossie/CorbaUtils.h>
+#include <CF/cf.h>
+#include <ossie/PropertyMap.h>
+
+struct service_pool_task_struct {
+    service_pool_task_struct ()
+    {
+        priority = 0;
+        cpu = -1;
+        calls = 0;
+        cpu_time = 0.0;
+    }
+
+    static std::string getId() {
+        return std::string("service_pool_tasks::service_pool_task");
+    }
+
+    static const char* getFormat() {
+        return "siiQd";
+    }
+
+    std::string name;
+    CORBA::Long priority;
+    CORBA::Long cpu;
+    CORBA::ULongLong calls;
+    double cpu_time;
+};
+
+inline bool operator>>= (const CORBA::Any& a, service_pool_task_struct& s) {
+    CF::Properties* temp;
+    if (!(a >>= temp)) return false;
+    const redhawk::PropertyMap& props = redhawk::PropertyMap::cast(*temp);
+    if (props.contains("service_pool_tasks::service_pool_task::name")) {
+        if (!(props["service_pool_tasks::service_pool_task::name"] >>= s.name)) return false;
+    }
+    if (props.contains("service_pool_tasks::service_pool_task::priority")) {
+        if (!(props["service_pool_tasks::service_pool_task::priority"] >>= s.priority)) return false;
+    }
+    if (props.contains("service_pool_tasks::service_pool_task::cpu")) {
+        if (!(props["service_pool_tasks::service_pool_task::cpu"] >>= s.cpu)) return false;
+    }
+    if (props.contains("service_pool_tasks::service_pool_task::calls")) {
+        if (!(props["service_pool_tasks::service_pool_task::calls"] >>= s.calls)) return false;
+    }
+    if (props.contains("service_pool_tasks::service_pool_task::cpu_time")) {
+        if (!(props["service_pool_tasks::service_pool_task::cpu_time"] >>= s.cpu_time)) return false;
+    }
+    return true;
+}
+
+inline void operator<<= (CORBA::Any& a, const service_pool_task_struct& s) {
+    redhawk::PropertyMap props;
+ 
+    props["service_pool_tasks::service_pool_task::name"] = s.name;
+ 
+    props["service_pool_tasks::service_pool_task::priority"] = s.priority;
+ 
+    props["service_pool_tasks::service_pool_task::cpu"] = s.cpu;
+ 
+    props["service_pool_tasks::service_pool_task::calls"] = s.calls;
+ 
+    props["service_pool_tasks::service_pool_task::cpu_time"] = s.cpu_time;
+    a <<= props;
+}
+
+inline bool operator== (const service_pool_task_struct& s1, const service_pool_task_struct& s2) {
+    if (s1.name!=s2.name)
+        return false;
+    if (s1.priority!=s2.priority)
+        return false;
+    if (s1.cpu!=s2.cpu)
+        return false;
+    if (s1.calls!=s2.calls)
+        return false;
+    if (s1.cpu_time!=s2.cpu_time)
+        return false;
+    return true;
+}
+
+inline bool operator!= (const service_pool_task_struct& s1, const service_pool_task_struct& s2) {
+    return !(s1==s2);
+}
+
+#endif // COMPONENTHOST_STRUCTPROPS_H
@@ -556,6 +556,17 @@ void BitBufferTest::testFind()
     // Starting the search past the end of the bit buffer should always fail,
     // but without an exception (or crash)
     CPPUNIT_ASSERT_EQUAL(redhawk::bitbuffer::npos, buffer.find(buffer.size(), pattern, 0));
+
+    // An occurrence that ends on the last bit should be found
+    const size_t last = buffer.size() - pattern.size();
+    buffer.replace(last, pattern.size(), pattern);
+    CPPUNIT_ASSERT_EQUAL(last, buffer.find(222, pattern, 0));
+
+    // Searching a slice that does not start on a byte boundary should give
+    // indices relative to the slice, and not look past its end
+    redhawk::shared_bitbuffer slice = buffer.slice(101, last + pattern.size() - 1);
+    CPPUNIT_ASSERT_EQUAL((size_t) 99, slice.find(pattern, 1));
+    CPPUNIT_ASSERT_EQUAL(redhawk::bitbuffer::npos, slice.find(110, pattern, 0));
 }
 
 
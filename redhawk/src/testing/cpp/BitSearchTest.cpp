@@ -0,0 +1,132 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK core.
+ *
+ * REDHAWK core is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK core is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+#include "BitSearchTest.h"
+
+#include <stdexcept>
+
+CPPUNIT_TEST_SUITE_REGISTRATION(BitSearchTest);
+
+void BitSearchTest::testAddPattern()
+{
+    redhawk::bitsearch search;
+    CPPUNIT_ASSERT_EQUAL((size_t) 0, search.pattern_count());
+
+    // Pattern indices are assigned in order
+    CPPUNIT_ASSERT_EQUAL((size_t) 0, search.add_pattern(redhawk::bitbuffer::from_int(0x1ACF, 16), 0));
+    CPPUNIT_ASSERT_EQUAL((size_t) 1, search.add_pattern(redhawk::bitbuffer::from_int(0x1ACFFC1D, 32), 2));
+    CPPUNIT_ASSERT_EQUAL((size_t) 2, search.pattern_count());
+
+    // Empty patterns and patterns longer than 64 bits are not supported
+    CPPUNIT_ASSERT_THROW(search.add_pattern(redhawk::shared_bitbuffer(), 0), std::length_error);
+    CPPUNIT_ASSERT_THROW(search.add_pattern(redhawk::bitbuffer(65), 0), std::length_error);
+    CPPUNIT_ASSERT_EQUAL((size_t) 2, search.pattern_count());
+}
+
+void BitSearchTest::testFind()
+{
+    // Use a full 64-bit pattern to check the edge of the state word
+    const redhawk::shared_bitbuffer pattern = redhawk::bitbuffer::from_int(0x1ACFFC1D0A5F3C96ULL, 64);
+
+    redhawk::bitbuffer buffer(400);
+    buffer.fill(0);
+    buffer.replace(45, pattern.size(), pattern);
+    buffer.replace(buffer.size() - pattern.size(), pattern.size(), pattern);
+
+    redhawk::bitsearch exact(pattern, 0);
+    CPPUNIT_ASSERT_EQUAL((size_t) 45, exact.find(buffer));
+    CPPUNIT_ASSERT_EQUAL(buffer.size() - pattern.size(), exact.find(buffer, 46));
+    CPPUNIT_ASSERT_EQUAL(redhawk::bitsearch::npos, exact.find(buffer, buffer.size()));
+
+    // Introduce bit errors in the first occurrence
+    buffer[50] = !buffer[50];
+    buffer[100] = !buffer[100];
+    CPPUNIT_ASSERT_EQUAL(buffer.size() - pattern.size(), exact.find(buffer));
+
+    // Allowing errors should find the first occurrence again, and report the
+    // distance
+    redhawk::bitsearch approximate(pattern, 2);
+    redhawk::bitsearch::match result;
+    CPPUNIT_ASSERT(approximate.find(buffer, 0, result));
+    CPPUNIT_ASSERT_EQUAL((uint64_t) 45, result.position);
+    CPPUNIT_ASSERT_EQUAL((size_t) 0, result.pattern);
+    CPPUNIT_ASSERT_EQUAL(2, result.distance);
+
+    // Results should agree with shared_bitbuffer::find()
+    CPPUNIT_ASSERT_EQUAL(buffer.find(pattern, 2), approximate.find(buffer));
+}
+
+void BitSearchTest::testFindMultiple()
+{
+    const redhawk::shared_bitbuffer short_pattern = redhawk::bitbuffer::from_int(0x2C07BE, 22);
+    const redhawk::shared_bitbuffer long_pattern = redhawk::bitbuffer::from_int(0x1ACFFC1D, 32);
+
+    redhawk::bitbuffer buffer(300);
+    buffer.fill(1);
+    buffer.replace(40, long_pattern.size(), long_pattern);
+    buffer.replace(60, short_pattern.size(), short_pattern);
+
+    // The short pattern begins later, but ends first, so it should be found
+    // first
+    redhawk::bitsearch search;
+    search.add_pattern(long_pattern, 0);
+    search.add_pattern(short_pattern, 0);
+    redhawk::bitsearch::match result;
+    CPPUNIT_ASSERT(search.find(buffer, 0, result));
+    CPPUNIT_ASSERT_EQUAL((uint64_t) 60, result.position);
+    CPPUNIT_ASSERT_EQUAL((size_t) 1, result.pattern);
+
+    // Starting after the short pattern finds nothing
+    CPPUNIT_ASSERT_EQUAL(redhawk::bitsearch::npos, search.find(buffer, 61));
+}
+
+void BitSearchTest::testStreaming()
+{
+    const redhawk::shared_bitbuffer pattern = redhawk::bitbuffer::from_int(0x2C07BE, 22);
+
+    redhawk::bitbuffer buffer(300);
+    buffer.fill(1);
+    buffer.replace(20, pattern.size(), pattern);
+    buffer.replace(90, pattern.size(), pattern);
+    buffer.replace(250, pattern.size(), pattern);
+
+    // Push the buffer in pieces, with the second occurrence straddling the
+    // boundary between the first and second piece
+    redhawk::bitsearch search(pattern, 0);
+    std::vector<redhawk::bitsearch::match> matches;
+    CPPUNIT_ASSERT_EQUAL((size_t) 1, search.push(buffer.slice(0, 100), matches));
+    CPPUNIT_ASSERT_EQUAL((size_t) 1, search.push(buffer.slice(100, 201), matches));
+    CPPUNIT_ASSERT_EQUAL((size_t) 1, search.push(buffer.slice(201), matches));
+    CPPUNIT_ASSERT_EQUAL(buffer.size(), (size_t) search.position());
+
+    CPPUNIT_ASSERT_EQUAL((size_t) 3, matches.size());
+    CPPUNIT_ASSERT_EQUAL((uint64_t) 20, matches[0].position);
+    CPPUNIT_ASSERT_EQUAL((uint64_t) 90, matches[1].position);
+    CPPUNIT_ASSERT_EQUAL((uint64_t) 250, matches[2].position);
+
+    // After a reset, the partial occurrence at the end of the first piece
+    // should not carry over
+    search.reset();
+    matches.clear();
+    search.push(buffer.slice(0, 100), matches);
+    search.reset();
+    CPPUNIT_ASSERT_EQUAL((size_t) 0, search.push(buffer.slice(100, 201), matches));
+    CPPUNIT_ASSERT_EQUAL((size_t) 1, matches.size());
+}
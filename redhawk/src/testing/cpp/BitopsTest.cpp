@@ -25,6 +25,7 @@
 #include <cstring>
 #include <vector>
 #include <stdexcept>
+#include <cstdlib>
 
 #include <stdint.h>
 
@@ -32,10 +33,14 @@
 
 void BitopsTest::setUp()
 {
+    _kernels = redhawk::bitops::get_kernels();
 }
 
 void BitopsTest::tearDown()
 {
+    // Restore the kernels that were selected for this CPU, in case a test
+    // forced a different tier
+    redhawk::bitops::set_kernels(_kernels);
 }
 
 void BitopsTest::testGetBit()
@@ -1168,6 +1173,80 @@ void BitopsTest::testTakeSkip()
     CPPUNIT_ASSERT_EQUAL((uint64_t) 0x8181, redhawk::bitops::getint(&dest[0], 0, 16));
 }
 
+void BitopsTest::testKernelsGeneric()
+{
+    _testKernels(redhawk::bitops::KERNEL_GENERIC);
+}
+
+void BitopsTest::testKernelsPopcnt()
+{
+    _testKernels(redhawk::bitops::KERNEL_POPCNT);
+}
+
+void BitopsTest::testKernelsAVX2()
+{
+    _testKernels(redhawk::bitops::KERNEL_AVX2);
+}
+
+void BitopsTest::testKernelsAVX512()
+{
+    _testKernels(redhawk::bitops::KERNEL_AVX512);
+}
+
+void BitopsTest::_testKernels(redhawk::bitops::kernel_type type)
+{
+    if (!redhawk::bitops::kernels_supported(type)) {
+        // Not built in, or not available on this CPU
+        CPPUNIT_ASSERT(!redhawk::bitops::set_kernels(type));
+        return;
+    }
+    CPPUNIT_ASSERT(redhawk::bitops::set_kernels(type));
+    CPPUNIT_ASSERT_EQUAL(type, redhawk::bitops::get_kernels());
+
+    // Use enough random data to cover several of the widest vector blocks,
+    // plus the unaligned head and tail handling
+    const size_t total_bits = 4096 + 61;
+    std::vector<unsigned char> first((total_bits + 7) / 8);
+    std::vector<unsigned char> second(first.size());
+    srand(type + 1);
+    for (size_t ii = 0; ii < first.size(); ++ii) {
+        first[ii] = rand();
+        second[ii] = rand();
+    }
+
+    // Compare popcount and Hamming distance against a bit-by-bit count over
+    // a range of offsets and lengths
+    const size_t offsets[] = { 0, 3, 8, 13 };
+    const size_t lengths[] = { 1, 7, 64, 255, 256, 511, 1000, 4096 };
+    for (size_t oo = 0; oo < sizeof(offsets)/sizeof(offsets[0]); ++oo) {
+        for (size_t ll = 0; ll < sizeof(lengths)/sizeof(lengths[0]); ++ll) {
+            const size_t start = offsets[oo];
+            const size_t length = lengths[ll];
+            int ones = 0;
+            int diff = 0;
+            for (size_t pos = start; pos < (start + length); ++pos) {
+                bool lhs = redhawk::bitops::getbit(&first[0], pos);
+                ones += lhs;
+                diff += (lhs != redhawk::bitops::getbit(&second[0], pos));
+            }
+            CPPUNIT_ASSERT_EQUAL(ones, redhawk::bitops::popcount(&first[0], start, length));
+            CPPUNIT_ASSERT_EQUAL(diff, redhawk::bitops::hammingDistance(&first[0], start, &second[0], start, length));
+        }
+    }
+
+    // Search for a pattern too long for the bit-parallel search, so that it
+    // goes through the chunked Hamming comparison
+    const size_t pattern_bits = 600;
+    const int location = 2517;
+    std::vector<unsigned char> pattern((pattern_bits + 7) / 8);
+    redhawk::bitops::copy(&pattern[0], 0, &first[0], location, pattern_bits);
+    CPPUNIT_ASSERT_EQUAL(location, redhawk::bitops::find(&first[0], 0, total_bits, &pattern[0], 0, pattern_bits, 0));
+    _flipBit(&first[0], location + 5);
+    _flipBit(&first[0], location + 599);
+    CPPUNIT_ASSERT_EQUAL(-1, redhawk::bitops::find(&first[0], 0, total_bits, &pattern[0], 0, pattern_bits, 1));
+    CPPUNIT_ASSERT_EQUAL(location, redhawk::bitops::find(&first[0], 0, total_bits, &pattern[0], 0, pattern_bits, 2));
+}
+
 void BitopsTest::_flipBit(unsigned char* buffer, size_t offset)
 {
     redhawk::bitops::setbit(buffer, offset, !(redhawk::bitops::getbit(buffer, offset)));
@@ -23,6 +23,8 @@
 
 #include "CFTest.h"
 
+#include "bitops_kernels.h"
+
 class BitopsTest : public CppUnit::TestFixture {
 
     CPPUNIT_TEST_SUITE(BitopsTest);
@@ -57,6 +59,10 @@ class BitopsTest : public CppUnit::TestFixture {
     CPPUNIT_TEST(testCopyLarge);
     CPPUNIT_TEST(testFind);
     CPPUNIT_TEST(testTakeSkip);
+    CPPUNIT_TEST(testKernelsGeneric);
+    CPPUNIT_TEST(testKernelsPopcnt);
+    CPPUNIT_TEST(testKernelsAVX2);
+    CPPUNIT_TEST(testKernelsAVX512);
     CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -106,8 +112,17 @@ public:
     void testFind();
     void testTakeSkip();
 
+    void testKernelsGeneric();
+    void testKernelsPopcnt();
+    void testKernelsAVX2();
+    void testKernelsAVX512();
+
 private:
     void _flipBit(unsigned char* buffer, size_t offset);
+
+    void _testKernels(redhawk::bitops::kernel_type type);
+
+    redhawk::bitops::kernel_type _kernels;
 };
 
 #endif // BITOPSTEST_H
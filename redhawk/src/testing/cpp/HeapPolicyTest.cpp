@@ -0,0 +1,125 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK core.
+ *
+ * REDHAWK core is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK core is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+#include "HeapPolicyTest.h"
+
+#include <sstream>
+#include <unistd.h>
+
+#ifdef HAVE_LIBNUMA
+#include <numa.h>
+#endif
+
+#include <ossie/shm/Heap.h>
+
+#include "shm/HeapPolicy.h"
+
+using redhawk::shm::NUMAHeapPolicy;
+using redhawk::shm::ThreadState;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(HeapPolicyTest);
+
+namespace {
+    bool numaAvailable()
+    {
+#ifdef HAVE_LIBNUMA
+        return numa_available() != -1;
+#else
+        return false;
+#endif
+    }
+}
+
+void HeapPolicyTest::testNUMANodeCount()
+{
+    // Without NUMA support (or on a single-node host) the policy must fall
+    // back to one node, with every pool on it
+    NUMAHeapPolicy policy;
+    const int nodes = policy.getNodeCount();
+    CPPUNIT_ASSERT(nodes >= 1);
+    if (!numaAvailable()) {
+        CPPUNIT_ASSERT_EQUAL(1, nodes);
+    }
+    CPPUNIT_ASSERT(policy.getPoolCount() >= nodes);
+    CPPUNIT_ASSERT_EQUAL(0, policy.getPoolCount() % nodes);
+}
+
+void HeapPolicyTest::testNUMAPoolNodes()
+{
+    // Each node owns an equal, contiguous group of pools
+    NUMAHeapPolicy policy;
+    const int nodes = policy.getNodeCount();
+    const int pools_per_node = policy.getPoolCount() / nodes;
+    for (int pool = 0; pool < policy.getPoolCount(); ++pool) {
+        CPPUNIT_ASSERT_EQUAL(pool / pools_per_node, policy.getPoolNode(pool));
+    }
+}
+
+void HeapPolicyTest::testNUMAInvalidHint()
+{
+    // Hints for nodes that do not exist on this host (including any non-zero
+    // node on a single-node host) fall back to the current node, and always
+    // select a valid pool
+    NUMAHeapPolicy policy;
+    const int nodes = policy.getNodeCount();
+    const int hints[] = { -1, nodes, nodes + 1, 1024 };
+    for (size_t index = 0; index < sizeof(hints) / sizeof(hints[0]); ++index) {
+        ThreadState state;
+        policy.initThreadState(&state);
+        state.nodeHint = hints[index];
+        size_t pool = policy.getPoolAssignment(&state);
+        CPPUNIT_ASSERT(pool < (size_t) policy.getPoolCount());
+        int node = policy.getPoolNode(pool);
+        CPPUNIT_ASSERT((node >= 0) && (node < nodes));
+    }
+
+    // A valid hint selects a pool on that node
+    for (int node = 0; node < nodes; ++node) {
+        ThreadState state;
+        policy.initThreadState(&state);
+        state.nodeHint = node;
+        CPPUNIT_ASSERT_EQUAL(node, policy.getPoolNode(policy.getPoolAssignment(&state)));
+    }
+}
+
+void HeapPolicyTest::testHeapNodeHint()
+{
+    std::ostringstream name;
+    name << "heap_policy_test-" << getpid();
+    redhawk::shm::Heap heap(name.str());
+
+    // Negative hints reset to the default
+    CPPUNIT_ASSERT_EQUAL(-1, heap.getNodeHint());
+    heap.setNodeHint(-5);
+    CPPUNIT_ASSERT_EQUAL(-1, heap.getNodeHint());
+
+    // A hint for a node that does not exist must not prevent allocation,
+    // whatever the heap policy
+    heap.setNodeHint(1024);
+    CPPUNIT_ASSERT_EQUAL(1024, heap.getNodeHint());
+    void* ptr = heap.allocate(1000);
+    CPPUNIT_ASSERT(ptr);
+    heap.deallocate(ptr);
+
+    heap.setNodeHint(-1);
+    ptr = heap.allocate(1000);
+    CPPUNIT_ASSERT(ptr);
+    heap.deallocate(ptr);
+}
@@ -0,0 +1,42 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK core.
+ *
+ * REDHAWK core is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK core is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+#ifndef HEAPPOLICYTEST_H
+#define HEAPPOLICYTEST_H
+
+#include "CFTest.h"
+
+class HeapPolicyTest : public CppUnit::TestFixture
+{
+    CPPUNIT_TEST_SUITE(HeapPolicyTest);
+    CPPUNIT_TEST(testNUMANodeCount);
+    CPPUNIT_TEST(testNUMAPoolNodes);
+    CPPUNIT_TEST(testNUMAInvalidHint);
+    CPPUNIT_TEST(testHeapNodeHint);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void testNUMANodeCount();
+    void testNUMAPoolNodes();
+    void testNUMAInvalidHint();
+    void testHeapNodeHint();
+};
+
+#endif // HEAPPOLICYTEST_H
@@ -0,0 +1,205 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK core.
+ *
+ * REDHAWK core is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK core is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+#include "HeapTest.h"
+
+#include <cstring>
+#include <sstream>
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <boost/thread.hpp>
+
+#include "shm/Superblock.h"
+#include "shm/Block.h"
+
+using redhawk::shm::Block;
+using redhawk::shm::Superblock;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(HeapTest);
+
+namespace {
+    Superblock* getSuperblock(void* ptr)
+    {
+        return Block::from_pointer(ptr)->getSuperblock();
+    }
+
+    void allocateAndFree(redhawk::shm::Heap* heap, size_t bytes, void** ptr, size_t* used)
+    {
+        *ptr = heap->allocate(bytes);
+        heap->deallocate(*ptr);
+        *used = getSuperblock(*ptr)->used();
+    }
+
+    void cacheAndWait(redhawk::shm::Heap* heap, boost::barrier* barrier)
+    {
+        heap->deallocate(heap->allocate(1000));
+        barrier->wait();
+        barrier->wait();
+    }
+}
+
+void HeapTest::setUp()
+{
+    std::ostringstream name;
+    name << "heap_test-" << getpid();
+    _heap = new redhawk::shm::Heap(name.str());
+}
+
+void HeapTest::tearDown()
+{
+    delete _heap;
+}
+
+size_t HeapTest::_getResidentBytes()
+{
+    // Pages actually backing the heap file; reclaiming a superblock punches
+    // a hole over its data
+    int fd = shm_open(_heap->name().c_str(), O_RDONLY, 0);
+    CPPUNIT_ASSERT(fd >= 0);
+    struct stat status;
+    int result = fstat(fd, &status);
+    close(fd);
+    CPPUNIT_ASSERT_EQUAL(0, result);
+    return status.st_blocks * 512;
+}
+
+void HeapTest::testMagazineRoundTrip()
+{
+    // Freeing a block caches it in the thread's magazine, where it stays
+    // allocated in its superblock until it is handed out again
+    void* ptr = _heap->allocate(1000);
+    CPPUNIT_ASSERT(ptr);
+    Superblock* superblock = getSuperblock(ptr);
+    const size_t used = superblock->used();
+    _heap->deallocate(ptr);
+    CPPUNIT_ASSERT_EQUAL(used, superblock->used());
+
+    // The next request in the same size class gets the cached block
+    void* again = _heap->allocate(900);
+    CPPUNIT_ASSERT_EQUAL(ptr, again);
+    CPPUNIT_ASSERT_EQUAL(used, superblock->used());
+    _heap->deallocate(again);
+}
+
+void HeapTest::testMagazineOversized()
+{
+    // A block larger than the largest size class goes straight back to its
+    // superblock instead of into a magazine
+    const size_t LARGE_BYTES = 8 * 1024 * 1024;
+    void* large = _heap->allocate(LARGE_BYTES);
+    CPPUNIT_ASSERT(large);
+    Superblock* superblock = getSuperblock(large);
+    const size_t used = superblock->used();
+    CPPUNIT_ASSERT(used >= LARGE_BYTES);
+    _heap->deallocate(large);
+    CPPUNIT_ASSERT(superblock->used() < LARGE_BYTES);
+
+    // A request in the largest size class is carved to size rather than
+    // handed the large block whole
+    const size_t bytes = Superblock::getClassSize(Superblock::NUM_SIZE_CLASSES - 1) - 1000;
+    void* ptr = _heap->allocate(bytes);
+    CPPUNIT_ASSERT(ptr);
+    CPPUNIT_ASSERT(Block::from_pointer(ptr)->byteSize() < LARGE_BYTES);
+    _heap->deallocate(ptr);
+}
+
+void HeapTest::testMagazineThreadExit()
+{
+    // Blocks cached by a thread remain allocated while it runs...
+    void* ptr = 0;
+    size_t used_cached = 0;
+    boost::thread thread(&allocateAndFree, _heap, 1000, &ptr, &used_cached);
+    thread.join();
+
+    // ...and are returned to their superblocks when it exits
+    Superblock* superblock = getSuperblock(ptr);
+    CPPUNIT_ASSERT(superblock->used() < used_cached);
+    CPPUNIT_ASSERT(superblock->trim());
+}
+
+void HeapTest::testMagazineHeapDestroyed()
+{
+    // A thread with cached blocks that outlives its heap must not touch the
+    // heap (or its unmapped superblocks) on exit
+    std::ostringstream name;
+    name << "heap_test_destroyed-" << getpid();
+    redhawk::shm::Heap* heap = new redhawk::shm::Heap(name.str());
+    boost::barrier barrier(2);
+    boost::thread thread(&cacheAndWait, heap, &barrier);
+    barrier.wait();
+    delete heap;
+    barrier.wait();
+    thread.join();
+}
+
+void HeapTest::testReclaimIdle()
+{
+    // Reclamation is opt-in
+    CPPUNIT_ASSERT_EQUAL(0.0, _heap->getDecayTime());
+    _heap->setDecayTime(0.1);
+    CPPUNIT_ASSERT_EQUAL(0.1, _heap->getDecayTime());
+
+    // Fill a large block so that its pages are resident, then free it,
+    // leaving its superblock empty
+    const size_t LARGE_BYTES = 4 * 1024 * 1024;
+    char* large = static_cast<char*>(_heap->allocate(LARGE_BYTES));
+    CPPUNIT_ASSERT(large);
+    std::memset(large, 0xAA, LARGE_BYTES);
+    const size_t resident = _getResidentBytes();
+    CPPUNIT_ASSERT(resident >= LARGE_BYTES);
+    _heap->deallocate(large);
+
+    // The superblock should be reclaimed within a few check intervals
+    size_t current = resident;
+    for (int retries = 0; retries < 20; ++retries) {
+        current = _getResidentBytes();
+        if ((current + LARGE_BYTES) <= resident) {
+            break;
+        }
+        usleep(100000);
+    }
+    CPPUNIT_ASSERT_MESSAGE("idle superblock was not reclaimed", (current + LARGE_BYTES) <= resident);
+}
+
+void HeapTest::testReclaimIdleMagazine()
+{
+    // A block cached in an idle thread's magazine is flushed by the reclaim
+    // thread, letting its superblock be trimmed
+    void* ptr = _heap->allocate(1000);
+    CPPUNIT_ASSERT(ptr);
+    Superblock* superblock = getSuperblock(ptr);
+    _heap->deallocate(ptr);
+    CPPUNIT_ASSERT(!superblock->trim());
+
+    _heap->setDecayTime(0.1);
+    bool flushed = false;
+    for (int retries = 0; retries < 20; ++retries) {
+        usleep(100000);
+        if (superblock->used() == 0) {
+            flushed = true;
+            break;
+        }
+    }
+    CPPUNIT_ASSERT_MESSAGE("idle magazine was not flushed", flushed);
+}
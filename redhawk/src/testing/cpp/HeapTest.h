@@ -0,0 +1,56 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK core.
+ *
+ * REDHAWK core is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK core is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+#ifndef HEAPTEST_H
+#define HEAPTEST_H
+
+#include "CFTest.h"
+
+#include <ossie/shm/Heap.h>
+
+class HeapTest : public CppUnit::TestFixture
+{
+    CPPUNIT_TEST_SUITE(HeapTest);
+    CPPUNIT_TEST(testMagazineRoundTrip);
+    CPPUNIT_TEST(testMagazineOversized);
+    CPPUNIT_TEST(testMagazineThreadExit);
+    CPPUNIT_TEST(testMagazineHeapDestroyed);
+    CPPUNIT_TEST(testReclaimIdle);
+    CPPUNIT_TEST(testReclaimIdleMagazine);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp();
+    void tearDown();
+
+    void testMagazineRoundTrip();
+    void testMagazineOversized();
+    void testMagazineThreadExit();
+    void testMagazineHeapDestroyed();
+    void testReclaimIdle();
+    void testReclaimIdleMagazine();
+
+private:
+    size_t _getResidentBytes();
+
+    redhawk::shm::Heap* _heap;
+};
+
+#endif // HEAPTEST_H
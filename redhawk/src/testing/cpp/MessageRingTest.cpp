@@ -0,0 +1,811 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK core.
+ *
+ * REDHAWK core is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK core is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+#include "MessageRingTest.h"
+
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+#include <boost/thread.hpp>
+
+#include <ossie/PropertyMap.h>
+
+#include "MessageRing.h"
+
+using redhawk::MessageRing;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(MessageRingTest);
+
+namespace {
+    // See MessagingTest.cpp re: the Any extraction operator for std::string
+    using ::operator>>=;
+
+    // Message struct that supports binary encoding, so that it can be sent
+    // through the ring without Any serialization
+    struct ring_message_struct {
+        ring_message_struct () :
+            value(0)
+        {
+        }
+
+        static std::string getId() {
+            return std::string("ring_message");
+        }
+
+        static const char* getFormat() {
+            return "is";
+        }
+
+        void encode(redhawk::BinaryEncoder& encoder) const {
+            encoder << value;
+            encoder << body;
+        }
+
+        bool decode(redhawk::BinaryDecoder& decoder) {
+            decoder >> value;
+            decoder >> body;
+            return decoder.ok();
+        }
+
+        CORBA::Long value;
+        std::string body;
+    };
+
+    inline bool operator>>= (const CORBA::Any& a, ring_message_struct& s) {
+        CF::Properties* temp;
+        if (!(a >>= temp)) return false;
+        const redhawk::PropertyMap& props = redhawk::PropertyMap::cast(*temp);
+        if (props.contains("value")) {
+            if (!(props["value"] >>= s.value)) return false;
+        }
+        if (props.contains("body")) {
+            if (!(props["body"] >>= s.body)) return false;
+        }
+        return true;
+    }
+
+    inline void operator<<= (CORBA::Any& a, const ring_message_struct& s) {
+        redhawk::PropertyMap props;
+        props["value"] = s.value;
+        props["body"] = s.body;
+        a <<= props;
+    }
+
+    inline bool operator== (const ring_message_struct& s1, const ring_message_struct& s2) {
+        return (s1.value == s2.value) && (s1.body == s2.body);
+    }
+
+    // Message receiver that can be used from the ring's reader thread, and
+    // records which thread delivered each message
+    template <class T>
+    class RingReceiver
+    {
+    public:
+        void messageReceived(const std::string& messageId, const T& msgData)
+        {
+            boost::mutex::scoped_lock lock(_mutex);
+            _ids.push_back(messageId);
+            _received.push_back(msgData);
+            _threads.push_back(boost::this_thread::get_id());
+            _cond.notify_all();
+        }
+
+        bool waitReceived(size_t count)
+        {
+            boost::mutex::scoped_lock lock(_mutex);
+            boost::system_time deadline = boost::get_system_time() + boost::posix_time::seconds(2);
+            while (_received.size() < count) {
+                if (!_cond.timed_wait(lock, deadline)) {
+                    return _received.size() >= count;
+                }
+            }
+            return true;
+        }
+
+        std::vector<std::string> ids() const
+        {
+            boost::mutex::scoped_lock lock(_mutex);
+            return _ids;
+        }
+
+        std::vector<T> received() const
+        {
+            boost::mutex::scoped_lock lock(_mutex);
+            return _received;
+        }
+
+        std::vector<boost::thread::id> threads() const
+        {
+            boost::mutex::scoped_lock lock(_mutex);
+            return _threads;
+        }
+
+    private:
+        mutable boost::mutex _mutex;
+        boost::condition_variable _cond;
+        std::vector<std::string> _ids;
+        std::vector<T> _received;
+        std::vector<boost::thread::id> _threads;
+    };
+
+    // Stands in for a message consumer port in another process: the supplier
+    // cannot find the servant locally, so it goes through the CORBA
+    // interfaces, including shared memory negotiation, to reach the real
+    // consumer port. If an admin is given, suppliers are handed to it instead.
+    class RemoteConsumerPort : public virtual POA_ExtendedEvent::MessageEvent
+    {
+    public:
+        RemoteConsumerPort(MessageConsumerPort* port, CosEventChannelAdmin::SupplierAdmin_ptr admin) :
+            _port(port),
+            _admin(CosEventChannelAdmin::SupplierAdmin::_duplicate(admin))
+        {
+        }
+
+        void connectPort(CORBA::Object_ptr connection, const char* connectionId)
+        {
+        }
+
+        void disconnectPort(const char* connectionId)
+        {
+        }
+
+        CosEventChannelAdmin::ConsumerAdmin_ptr for_consumers()
+        {
+            return CosEventChannelAdmin::ConsumerAdmin::_nil();
+        }
+
+        CosEventChannelAdmin::SupplierAdmin_ptr for_suppliers()
+        {
+            if (!CORBA::is_nil(_admin)) {
+                return CosEventChannelAdmin::SupplierAdmin::_duplicate(_admin);
+            }
+            return _port->for_suppliers();
+        }
+
+        void destroy()
+        {
+        }
+
+        CORBA::Boolean _is_a(const char* repoId)
+        {
+            return _port->_is_a(repoId);
+        }
+
+    private:
+        MessageConsumerPort* _port;
+        CosEventChannelAdmin::SupplierAdmin_var _admin;
+    };
+
+    // Forwards messages to another consumer, but drops shared memory
+    // negotiation requests, like a consumer from an older release
+    class LegacyProxyConsumer : public virtual POA_CosEventChannelAdmin::ProxyPushConsumer
+    {
+    public:
+        LegacyProxyConsumer(CosEventChannelAdmin::ProxyPushConsumer_ptr consumer) :
+            _consumer(CosEventChannelAdmin::ProxyPushConsumer::_duplicate(consumer))
+        {
+        }
+
+        void push(const CORBA::Any& data)
+        {
+            const CF::Properties* messages;
+            if (data >>= messages) {
+                _consumer->push(data);
+            }
+        }
+
+        void connect_push_supplier(CosEventComm::PushSupplier_ptr supplier)
+        {
+        }
+
+        void disconnect_push_consumer()
+        {
+        }
+
+    private:
+        CosEventChannelAdmin::ProxyPushConsumer_var _consumer;
+    };
+
+    class LegacySupplierAdmin : public virtual POA_CosEventChannelAdmin::SupplierAdmin
+    {
+    public:
+        LegacySupplierAdmin(CosEventChannelAdmin::ProxyPushConsumer_ptr consumer) :
+            _consumer(CosEventChannelAdmin::ProxyPushConsumer::_duplicate(consumer))
+        {
+        }
+
+        CosEventChannelAdmin::ProxyPushConsumer_ptr obtain_push_consumer()
+        {
+            return CosEventChannelAdmin::ProxyPushConsumer::_duplicate(_consumer);
+        }
+
+        CosEventChannelAdmin::ProxyPullConsumer_ptr obtain_pull_consumer()
+        {
+            return CosEventChannelAdmin::ProxyPullConsumer::_nil();
+        }
+
+    private:
+        CosEventChannelAdmin::ProxyPushConsumer_var _consumer;
+    };
+
+    // Plain event channel (not a message consumer port) in front of a
+    // consumer port, which notes whether it was asked about shared memory
+    // support
+    class PlainEventChannel : public virtual POA_CosEventChannelAdmin::EventChannel
+    {
+    public:
+        PlainEventChannel(MessageConsumerPort* port) :
+            _port(port),
+            _capabilityQueried(false)
+        {
+        }
+
+        CosEventChannelAdmin::ConsumerAdmin_ptr for_consumers()
+        {
+            return CosEventChannelAdmin::ConsumerAdmin::_nil();
+        }
+
+        CosEventChannelAdmin::SupplierAdmin_ptr for_suppliers()
+        {
+            return _port->for_suppliers();
+        }
+
+        void destroy()
+        {
+        }
+
+        CORBA::Boolean _is_a(const char* repoId)
+        {
+            if (strcmp(repoId, MessageRing::CAPABILITY_ID) == 0) {
+                _capabilityQueried = true;
+            }
+            return POA_CosEventChannelAdmin::EventChannel::_is_a(repoId);
+        }
+
+        bool capabilityQueried() const
+        {
+            return _capabilityQueried;
+        }
+
+    private:
+        MessageConsumerPort* _port;
+        bool _capabilityQueried;
+    };
+
+    void writeRecords(MessageRing* ring, size_t count, size_t length, size_t* written)
+    {
+        std::vector<char> data(length, 'x');
+        for (size_t index = 0; index < count; ++index) {
+            if (!ring->write(MessageRing::RECORD_BINARY, "full", &data[0], length)) {
+                return;
+            }
+            ++(*written);
+        }
+    }
+
+    void waitEmpty(MessageRing* ring, bool* result)
+    {
+        *result = ring->waitEmpty();
+    }
+
+    // Length of a payload that makes a record with the ID "full" take up half
+    // of the ring
+    size_t halfRingLength(const MessageRing& ring)
+    {
+        return ring.maxRecordSize() - 8;
+    }
+}
+
+void MessageRingTest::setUp()
+{
+    _supplier = new MessageSupplierPort("supplier");
+    _consumer = new MessageConsumerPort("consumer");
+
+    _portManager.addPort(_supplier);
+    _portManager.addPort(_consumer);
+
+    // Simulate component start
+    _portManager.start();
+}
+
+void MessageRingTest::tearDown()
+{
+    // Simulate component stop/shutdown
+    _portManager.stop();
+    _portManager.releaseObject();
+
+    // Consumer and supplier have been deleted by the port manager
+    _supplier = 0;
+    _consumer = 0;
+
+    for (std::vector<PortableServer::ServantBase*>::iterator servant = _servants.begin(); servant != _servants.end(); ++servant) {
+        try {
+            PortableServer::ObjectId_var oid = ossie::corba::RootPOA()->servant_to_id(*servant);
+            ossie::corba::RootPOA()->deactivate_object(oid);
+        } catch (...) {
+            // Ignore CORBA exceptions
+        }
+        (*servant)->_remove_ref();
+    }
+    _servants.clear();
+}
+
+CORBA::Object_ptr MessageRingTest::_activate(PortableServer::ServantBase* servant)
+{
+    _servants.push_back(servant);
+    PortableServer::ObjectId_var oid = ossie::corba::RootPOA()->activate_object(servant);
+    return ossie::corba::RootPOA()->id_to_reference(oid);
+}
+
+void MessageRingTest::_negotiate(const std::string& ring, const std::string& hostname)
+{
+    redhawk::PropertyMap properties;
+    properties["hostname"] = hostname;
+    properties["ring"] = ring;
+    CF::DataType request;
+    request.id = MessageRing::NEGOTIATION_ID;
+    request.value <<= properties;
+    CORBA::Any data;
+    data <<= request;
+
+    CosEventChannelAdmin::SupplierAdmin_var admin = _consumer->for_suppliers();
+    CosEventChannelAdmin::ProxyPushConsumer_var consumer = admin->obtain_push_consumer();
+    consumer->push(data);
+}
+
+void MessageRingTest::testAttach()
+{
+    MessageRing writer;
+    writer.create();
+    CPPUNIT_ASSERT(!writer.name().empty());
+    CPPUNIT_ASSERT(!writer.isAttached());
+
+    MessageRing reader;
+    reader.open(writer.name());
+    CPPUNIT_ASSERT(!writer.isAttached());
+    CPPUNIT_ASSERT(writer.isPeerAlive());
+
+    // The consumer's description is truncated to fit the ring header
+    const std::string info(MessageRing::INFO_SIZE + 100, 'i');
+    reader.setConsumerInfo(info.data(), info.size());
+    CPPUNIT_ASSERT(writer.isAttached());
+    CPPUNIT_ASSERT_EQUAL(info.substr(0, MessageRing::INFO_SIZE), writer.consumerInfo());
+
+    // The ring stays usable once the file is gone
+    writer.unlink();
+    MessageRing other;
+    CPPUNIT_ASSERT_THROW(other.open(writer.name()), std::exception);
+    CPPUNIT_ASSERT(writer.write(MessageRing::RECORD_ANY, "attach", "data", 4));
+    const MessageRing::Record* record = reader.beginRead(1000);
+    CPPUNIT_ASSERT(record);
+    CPPUNIT_ASSERT_EQUAL(std::string("attach"), std::string(record->id(), record->idLength));
+    reader.commitRead();
+}
+
+void MessageRingTest::testWrapAround()
+{
+    MessageRing writer;
+    writer.create(0);
+    MessageRing reader;
+    reader.open(writer.name());
+
+    // Records are limited to half the ring
+    const size_t capacity = 2 * (writer.maxRecordSize() + sizeof(MessageRing::Record));
+    std::vector<char> payload(writer.maxRecordSize());
+
+    // Use record sizes that do not evenly divide the ring, so that the writer
+    // has to insert pad records at the end of the ring; the reader must skip
+    // them, and records must never be split across the end
+    const char* base = 0;
+    const char* last_end = 0;
+    size_t padded = 0;
+    for (size_t index = 0; index < 256; ++index) {
+        const size_t length = ((index * 37) % 300) + 1;
+        std::fill(payload.begin(), payload.begin() + length, (char) index);
+        std::ostringstream id;
+        id << "record_" << index;
+        CPPUNIT_ASSERT(writer.write(MessageRing::RECORD_BINARY, id.str(), &payload[0], length));
+
+        const MessageRing::Record* record = reader.beginRead(1000);
+        CPPUNIT_ASSERT(record);
+        CPPUNIT_ASSERT_EQUAL((uint16_t) MessageRing::RECORD_BINARY, record->type);
+        CPPUNIT_ASSERT_EQUAL(id.str(), std::string(record->id(), record->idLength));
+        CPPUNIT_ASSERT_EQUAL((uint32_t) length, record->length);
+        CPPUNIT_ASSERT_EQUAL((char) index, record->payload()[0]);
+        CPPUNIT_ASSERT_EQUAL((char) index, record->payload()[length - 1]);
+
+        const char* start = reinterpret_cast<const char*>(record);
+        if (!base) {
+            base = start;
+        } else if ((start == base) && (last_end != (base + capacity))) {
+            ++padded;
+        }
+        last_end = start + record->size;
+        CPPUNIT_ASSERT(last_end <= (base + capacity));
+        reader.commitRead();
+    }
+    CPPUNIT_ASSERT(padded > 0);
+}
+
+void MessageRingTest::testWriterBlocksWhenFull()
+{
+    MessageRing writer;
+    writer.create(0);
+    MessageRing reader;
+    reader.open(writer.name());
+
+    // Two records fill the ring, so the third has to wait for the reader
+    size_t written = 0;
+    boost::thread thread(&writeRecords, &writer, 3, halfRingLength(writer), &written);
+    CPPUNIT_ASSERT(!thread.timed_join(boost::posix_time::milliseconds(250)));
+
+    CPPUNIT_ASSERT(reader.beginRead(1000));
+    reader.commitRead();
+    CPPUNIT_ASSERT(thread.timed_join(boost::posix_time::seconds(1)));
+    CPPUNIT_ASSERT_EQUAL((size_t) 3, written);
+
+    // Records that could never fit are rejected rather than waiting forever
+    std::vector<char> data(writer.maxRecordSize() + 1);
+    CPPUNIT_ASSERT_THROW(writer.write(MessageRing::RECORD_BINARY, "", &data[0], data.size()), std::length_error);
+}
+
+void MessageRingTest::testWaitEmpty()
+{
+    MessageRing writer;
+    writer.create();
+    MessageRing reader;
+    reader.open(writer.name());
+
+    // The supplier waits for the consumer to finish every record before it
+    // sends a message over CORBA, so that messages are not reordered
+    CPPUNIT_ASSERT(writer.write(MessageRing::RECORD_ANY, "first", "1", 1));
+    CPPUNIT_ASSERT(writer.write(MessageRing::RECORD_ANY, "second", "2", 1));
+    bool result = false;
+    boost::thread thread(&waitEmpty, &writer, &result);
+    CPPUNIT_ASSERT(!thread.timed_join(boost::posix_time::milliseconds(250)));
+
+    CPPUNIT_ASSERT(reader.beginRead(1000));
+    reader.commitRead();
+    CPPUNIT_ASSERT(!thread.timed_join(boost::posix_time::milliseconds(100)));
+
+    // Reading the last record is not enough; it must be committed
+    CPPUNIT_ASSERT(reader.beginRead(1000));
+    CPPUNIT_ASSERT(!thread.timed_join(boost::posix_time::milliseconds(100)));
+    reader.commitRead();
+    CPPUNIT_ASSERT(thread.timed_join(boost::posix_time::seconds(1)));
+    CPPUNIT_ASSERT(result);
+}
+
+void MessageRingTest::testReaderExit()
+{
+    MessageRing writer;
+    writer.create(0);
+
+    // Attach from a child process that exits without closing the ring, as if
+    // the consumer had crashed
+    pid_t pid = fork();
+    CPPUNIT_ASSERT(pid >= 0);
+    if (pid == 0) {
+        MessageRing reader;
+        reader.open(writer.name());
+        reader.setConsumerInfo("", 0);
+        _exit(0);
+    }
+    int status = 0;
+    CPPUNIT_ASSERT_EQUAL(pid, waitpid(pid, &status, 0));
+    CPPUNIT_ASSERT(writer.isAttached());
+    CPPUNIT_ASSERT(!writer.isPeerAlive());
+
+    // Once the ring is full, the writer gives up instead of waiting forever
+    std::vector<char> data(halfRingLength(writer));
+    CPPUNIT_ASSERT(writer.write(MessageRing::RECORD_BINARY, "full", &data[0], data.size()));
+    CPPUNIT_ASSERT(writer.write(MessageRing::RECORD_BINARY, "full", &data[0], data.size()));
+    boost::system_time start = boost::get_system_time();
+    CPPUNIT_ASSERT(!writer.write(MessageRing::RECORD_BINARY, "full", &data[0], data.size()));
+    CPPUNIT_ASSERT(!writer.waitEmpty());
+    CPPUNIT_ASSERT((boost::get_system_time() - start) < boost::posix_time::seconds(1));
+}
+
+void MessageRingTest::testWriterExit()
+{
+    // Create the ring in a child process, which writes one record and then
+    // exits without closing the ring, as if the supplier had crashed
+    int fds[2];
+    CPPUNIT_ASSERT_EQUAL(0, pipe(fds));
+    pid_t pid = fork();
+    CPPUNIT_ASSERT(pid >= 0);
+    if (pid == 0) {
+        ::close(fds[0]);
+        MessageRing writer;
+        writer.create(0);
+        writer.write(MessageRing::RECORD_ANY, "last", "data", 4);
+        const std::string& name = writer.name();
+        if (write(fds[1], name.data(), name.size()) < 0) {
+            _exit(1);
+        }
+        _exit(0);
+    }
+    ::close(fds[1]);
+    std::string name;
+    char buffer[256];
+    ssize_t bytes;
+    while ((bytes = read(fds[0], buffer, sizeof(buffer))) > 0) {
+        name.append(buffer, bytes);
+    }
+    ::close(fds[0]);
+    int status = 0;
+    CPPUNIT_ASSERT_EQUAL(pid, waitpid(pid, &status, 0));
+    CPPUNIT_ASSERT(!name.empty());
+
+    MessageRing reader;
+    reader.open(name);
+    shm_unlink(name.c_str());
+
+    // Records written before the supplier exited can still be read
+    const MessageRing::Record* record = reader.beginRead(1000);
+    CPPUNIT_ASSERT(record);
+    CPPUNIT_ASSERT_EQUAL(std::string("last"), std::string(record->id(), record->idLength));
+    reader.commitRead();
+
+    // After that, the reader sees the supplier is gone rather than the ring
+    // being closed
+    CPPUNIT_ASSERT(!reader.beginRead(100));
+    CPPUNIT_ASSERT(!reader.isClosed());
+    CPPUNIT_ASSERT(!reader.isPeerAlive());
+}
+
+void MessageRingTest::testConsumerNegotiation()
+{
+    typedef RingReceiver<ring_message_struct> receiver_type;
+    receiver_type receiver;
+    _consumer->registerMessage("ring_message", &receiver, &receiver_type::messageReceived);
+
+    // Negotiate as a supplier in another process would
+    MessageRing ring;
+    ring.create();
+    _negotiate(ring.name(), MessageRing::hostname());
+    CPPUNIT_ASSERT(ring.isAttached());
+    ring.unlink();
+
+    // With only typed callbacks, the consumer can decode its message in
+    // binary form
+    const std::string info = ring.consumerInfo();
+    redhawk::BinaryDecoder decoder(info.data(), info.size());
+    bool generic = true;
+    std::vector<std::string> ids;
+    std::vector<std::string> formats;
+    decoder >> generic >> ids >> formats;
+    CPPUNIT_ASSERT(decoder.ok());
+    CPPUNIT_ASSERT(!generic);
+    CPPUNIT_ASSERT_EQUAL((size_t) 1, ids.size());
+    CPPUNIT_ASSERT_EQUAL(std::string("ring_message"), ids[0]);
+    CPPUNIT_ASSERT_EQUAL((size_t) 1, formats.size());
+    CPPUNIT_ASSERT_EQUAL(std::string("is"), formats[0]);
+
+    // Binary messages are dispatched on the consumer's reader thread
+    ring_message_struct msg;
+    msg.value = 1;
+    msg.body = "binary";
+    redhawk::BinaryEncoder encoder;
+    msg.encode(encoder);
+    CPPUNIT_ASSERT(ring.write(MessageRing::RECORD_BINARY, msg.getId(), encoder.data(), encoder.size()));
+    CPPUNIT_ASSERT(receiver.waitReceived(1));
+    CPPUNIT_ASSERT(receiver.received()[0] == msg);
+    CPPUNIT_ASSERT(receiver.threads()[0] != boost::this_thread::get_id());
+
+    // CORBA::Any messages go through the same callback
+    msg.value = 2;
+    msg.body = "any";
+    CORBA::Any any;
+    any <<= msg;
+    cdrMemoryStream stream;
+    any >>= stream;
+    CPPUNIT_ASSERT(ring.write(MessageRing::RECORD_ANY, msg.getId(), static_cast<const char*>(stream.bufPtr()), stream.bufSize()));
+    CPPUNIT_ASSERT(receiver.waitReceived(2));
+    CPPUNIT_ASSERT(receiver.received()[1] == msg);
+
+    // A generic callback registered after the supplier attached still gets
+    // binary messages, as a CORBA::Any
+    CPPUNIT_ASSERT(ring.waitEmpty());
+    RingReceiver<CORBA::Any> generic_receiver;
+    _consumer->registerMessage(&generic_receiver, &RingReceiver<CORBA::Any>::messageReceived);
+    msg.value = 3;
+    msg.body = "generic";
+    encoder.clear();
+    msg.encode(encoder);
+    CPPUNIT_ASSERT(ring.write(MessageRing::RECORD_BINARY, msg.getId(), encoder.data(), encoder.size()));
+    CPPUNIT_ASSERT(receiver.waitReceived(3));
+    CPPUNIT_ASSERT(receiver.received()[2] == msg);
+    CPPUNIT_ASSERT(generic_receiver.waitReceived(1));
+    CPPUNIT_ASSERT_EQUAL(msg.getId(), generic_receiver.ids()[0]);
+    ring_message_struct generic_msg;
+    CPPUNIT_ASSERT(generic_receiver.received()[0] >>= generic_msg);
+    CPPUNIT_ASSERT(generic_msg == msg);
+
+    // Messages that cannot be dispatched are reported back to the supplier
+    CPPUNIT_ASSERT(ring.waitEmpty());
+    CPPUNIT_ASSERT_EQUAL((uint32_t) 0, ring.errorCount());
+    CPPUNIT_ASSERT(ring.write(MessageRing::RECORD_BINARY, msg.getId(), encoder.data(), 2));
+    CPPUNIT_ASSERT(ring.write(MessageRing::RECORD_BINARY, "unknown_message", encoder.data(), encoder.size()));
+    CPPUNIT_ASSERT(ring.waitEmpty());
+    CPPUNIT_ASSERT_EQUAL((uint32_t) 2, ring.errorCount());
+    CPPUNIT_ASSERT_EQUAL((size_t) 3, receiver.received().size());
+
+    ring.close();
+}
+
+void MessageRingTest::testConsumerNegotiationGeneric()
+{
+    RingReceiver<CORBA::Any> receiver;
+    _consumer->registerMessage(&receiver, &RingReceiver<CORBA::Any>::messageReceived);
+
+    // A consumer with a generic callback needs every message as a CORBA::Any
+    MessageRing ring;
+    ring.create();
+    _negotiate(ring.name(), MessageRing::hostname());
+    CPPUNIT_ASSERT(ring.isAttached());
+    ring.unlink();
+
+    const std::string info = ring.consumerInfo();
+    redhawk::BinaryDecoder decoder(info.data(), info.size());
+    bool generic = false;
+    decoder >> generic;
+    CPPUNIT_ASSERT(decoder.ok());
+    CPPUNIT_ASSERT(generic);
+
+    ring.close();
+}
+
+void MessageRingTest::testConsumerNegotiationOtherHost()
+{
+    // A supplier on another host cannot share memory with the consumer
+    MessageRing ring;
+    ring.create();
+    _negotiate(ring.name(), "not-" + MessageRing::hostname());
+    CPPUNIT_ASSERT(!ring.isAttached());
+    ring.unlink();
+}
+
+void MessageRingTest::testSupplierAttach()
+{
+    typedef RingReceiver<ring_message_struct> receiver_type;
+    receiver_type receiver;
+    _consumer->registerMessage("ring_message", &receiver, &receiver_type::messageReceived);
+
+    RemoteConsumerPort* remote = new RemoteConsumerPort(_consumer, CosEventChannelAdmin::SupplierAdmin::_nil());
+    CORBA::Object_var objref = _activate(remote);
+    _supplier->connectPort(objref, "shm_connection");
+
+    // The message goes through the ring, so it is delivered on the
+    // consumer's reader thread
+    ring_message_struct msg;
+    msg.value = 1;
+    msg.body = "shm";
+    _supplier->sendMessage(msg);
+    CPPUNIT_ASSERT(receiver.waitReceived(1));
+    CPPUNIT_ASSERT(receiver.received()[0] == msg);
+    CPPUNIT_ASSERT(receiver.threads()[0] != boost::this_thread::get_id());
+
+    std::vector<ring_message_struct> messages(10);
+    for (size_t index = 0; index < messages.size(); ++index) {
+        messages[index].value = index + 2;
+    }
+    _supplier->sendMessages(messages);
+    CPPUNIT_ASSERT(receiver.waitReceived(11));
+    std::vector<ring_message_struct> received = receiver.received();
+    for (size_t index = 0; index < messages.size(); ++index) {
+        CPPUNIT_ASSERT(received[index + 1] == messages[index]);
+    }
+
+    _supplier->disconnectPort("shm_connection");
+}
+
+void MessageRingTest::testSupplierRefused()
+{
+    typedef RingReceiver<ring_message_struct> receiver_type;
+    receiver_type receiver;
+    _consumer->registerMessage("ring_message", &receiver, &receiver_type::messageReceived);
+
+    // Put a consumer that ignores the negotiation request in front of the
+    // real one
+    CosEventChannelAdmin::SupplierAdmin_var port_admin = _consumer->for_suppliers();
+    CosEventChannelAdmin::ProxyPushConsumer_var port_consumer = port_admin->obtain_push_consumer();
+    CORBA::Object_var legacy_consumer = _activate(new LegacyProxyConsumer(port_consumer));
+    CosEventChannelAdmin::ProxyPushConsumer_var legacy_consumer_ref = CosEventChannelAdmin::ProxyPushConsumer::_narrow(legacy_consumer);
+    CORBA::Object_var legacy_admin = _activate(new LegacySupplierAdmin(legacy_consumer_ref));
+    CosEventChannelAdmin::SupplierAdmin_var legacy_admin_ref = CosEventChannelAdmin::SupplierAdmin::_narrow(legacy_admin);
+
+    RemoteConsumerPort* remote = new RemoteConsumerPort(_consumer, legacy_admin_ref);
+    CORBA::Object_var objref = _activate(remote);
+    _supplier->connectPort(objref, "refused_connection");
+
+    // Without a ring, the message goes over CORBA, which is delivered
+    // in-line for a servant in the same process
+    ring_message_struct msg;
+    msg.value = 1;
+    msg.body = "corba";
+    _supplier->sendMessage(msg);
+    CPPUNIT_ASSERT_EQUAL((size_t) 1, receiver.received().size());
+    CPPUNIT_ASSERT(receiver.received()[0] == msg);
+    CPPUNIT_ASSERT(receiver.threads()[0] == boost::this_thread::get_id());
+
+    _supplier->disconnectPort("refused_connection");
+}
+
+void MessageRingTest::testSupplierCorbaOrdering()
+{
+    RingReceiver<CORBA::Any> receiver;
+    _consumer->registerMessage(&receiver, &RingReceiver<CORBA::Any>::messageReceived);
+
+    RemoteConsumerPort* remote = new RemoteConsumerPort(_consumer, CosEventChannelAdmin::SupplierAdmin::_nil());
+    CORBA::Object_var objref = _activate(remote);
+    _supplier->connectPort(objref, "shm_connection");
+
+    // The middle message is too large for the ring, so it goes over CORBA;
+    // it must not overtake the message ahead of it in the ring
+    redhawk::PropertyMap messages;
+    messages["first"] = (CORBA::Long) 1;
+    messages["second"] = std::string(MessageRing::DEFAULT_CAPACITY, 'x');
+    messages["third"] = (CORBA::Long) 3;
+    CORBA::Any any;
+    any <<= messages;
+    _supplier->push(any);
+
+    CPPUNIT_ASSERT(receiver.waitReceived(3));
+    std::vector<std::string> ids = receiver.ids();
+    CPPUNIT_ASSERT_EQUAL(std::string("first"), ids[0]);
+    CPPUNIT_ASSERT_EQUAL(std::string("second"), ids[1]);
+    CPPUNIT_ASSERT_EQUAL(std::string("third"), ids[2]);
+
+    std::vector<boost::thread::id> threads = receiver.threads();
+    CPPUNIT_ASSERT(threads[0] != boost::this_thread::get_id());
+    CPPUNIT_ASSERT(threads[1] == boost::this_thread::get_id());
+    CPPUNIT_ASSERT(threads[2] != boost::this_thread::get_id());
+
+    _supplier->disconnectPort("shm_connection");
+}
+
+void MessageRingTest::testSupplierEventChannel()
+{
+    typedef RingReceiver<ring_message_struct> receiver_type;
+    receiver_type receiver;
+    _consumer->registerMessage("ring_message", &receiver, &receiver_type::messageReceived);
+
+    // An event channel cannot be a shared memory consumer; the supplier
+    // should be able to tell from the object reference alone
+    PlainEventChannel* channel = new PlainEventChannel(_consumer);
+    CORBA::Object_var objref = _activate(channel);
+    _supplier->connectPort(objref, "channel_connection");
+    CPPUNIT_ASSERT(!channel->capabilityQueried());
+
+    ring_message_struct msg;
+    msg.value = 1;
+    msg.body = "channel";
+    _supplier->sendMessage(msg);
+    CPPUNIT_ASSERT(receiver.waitReceived(1));
+    CPPUNIT_ASSERT(receiver.received()[0] == msg);
+
+    _supplier->disconnectPort("channel_connection");
+}
@@ -0,0 +1,87 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK core.
+ *
+ * REDHAWK core is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK core is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+#ifndef MESSAGERINGTEST_H
+#define MESSAGERINGTEST_H
+
+#include <vector>
+
+#include "CFTest.h"
+
+#include <ossie/MessageInterface.h>
+
+#include "PortManager.h"
+
+class MessageRingTest : public CppUnit::TestFixture
+{
+    CPPUNIT_TEST_SUITE(MessageRingTest);
+    CPPUNIT_TEST(testAttach);
+    CPPUNIT_TEST(testWrapAround);
+    CPPUNIT_TEST(testWriterBlocksWhenFull);
+    CPPUNIT_TEST(testWaitEmpty);
+    CPPUNIT_TEST(testReaderExit);
+    CPPUNIT_TEST(testWriterExit);
+    CPPUNIT_TEST(testConsumerNegotiation);
+    CPPUNIT_TEST(testConsumerNegotiationGeneric);
+    CPPUNIT_TEST(testConsumerNegotiationOtherHost);
+    CPPUNIT_TEST(testSupplierAttach);
+    CPPUNIT_TEST(testSupplierRefused);
+    CPPUNIT_TEST(testSupplierCorbaOrdering);
+    CPPUNIT_TEST(testSupplierEventChannel);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp();
+    void tearDown();
+
+    void testAttach();
+    void testWrapAround();
+    void testWriterBlocksWhenFull();
+    void testWaitEmpty();
+
+    void testReaderExit();
+    void testWriterExit();
+
+    void testConsumerNegotiation();
+    void testConsumerNegotiationGeneric();
+    void testConsumerNegotiationOtherHost();
+
+    void testSupplierAttach();
+    void testSupplierRefused();
+    void testSupplierCorbaOrdering();
+    void testSupplierEventChannel();
+
+private:
+    // Sends a shared memory negotiation request for the named ring to the
+    // consumer port, as a supplier in another process would
+    void _negotiate(const std::string& ring, const std::string& hostname);
+
+    // Activates a test servant, which is released in tearDown()
+    CORBA::Object_ptr _activate(PortableServer::ServantBase* servant);
+
+    PortManager _portManager;
+
+    MessageSupplierPort* _supplier;
+    MessageConsumerPort* _consumer;
+
+    std::vector<PortableServer::ServantBase*> _servants;
+};
+
+#endif // MESSAGERINGTEST_H
@@ -22,6 +22,9 @@
 
 #include <ossie/PropertyMap.h>
 
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/thread.hpp>
+
 CPPUNIT_TEST_SUITE_REGISTRATION(MessagingTest);
 
 namespace {
@@ -84,6 +87,17 @@ namespace {
             return "is";
         }
 
+        void encode(redhawk::BinaryEncoder& encoder) const {
+            encoder << value;
+            encoder << body;
+        }
+
+        bool decode(redhawk::BinaryDecoder& decoder) {
+            decoder >> value;
+            decoder >> body;
+            return decoder.ok();
+        }
+
         CORBA::Long value;
         std::string body;
     };
@@ -167,6 +181,58 @@ namespace {
     private:
         redhawk::PropertyMap _received;
     };
+
+    // Message receiver that holds up delivery until it is opened, to simulate
+    // a slow consumer for asynchronous messaging
+    class GatedReceiver : public MessageReceiver<direct_message_struct>
+    {
+    public:
+        GatedReceiver() :
+            _open(false),
+            _waiting(false)
+        {
+        }
+
+        void messageReceived(const std::string& messageId, const direct_message_struct& msgData)
+        {
+            boost::mutex::scoped_lock lock(_mutex);
+            _waiting = true;
+            _cond.notify_all();
+            while (!_open) {
+                _cond.wait(lock);
+            }
+            MessageReceiver<direct_message_struct>::messageReceived(messageId, msgData);
+        }
+
+        void waitBlocked()
+        {
+            boost::mutex::scoped_lock lock(_mutex);
+            while (!_waiting) {
+                _cond.wait(lock);
+            }
+        }
+
+        void open()
+        {
+            boost::mutex::scoped_lock lock(_mutex);
+            _open = true;
+            _cond.notify_all();
+        }
+
+    private:
+        boost::mutex _mutex;
+        boost::condition_variable _cond;
+        bool _open;
+        bool _waiting;
+    };
+
+    // Thread body for sending a message while the publishing thread is busy
+    void sendToConnection(MessageSupplierPort* port, CORBA::Long value, const std::string& connectionId)
+    {
+        direct_message_struct msg;
+        msg.value = value;
+        port->sendMessage(msg, connectionId);
+    }
 }
 
 void MessagingTest::setUp()
@@ -574,3 +640,153 @@ void MessagingTest::testPushConnectionId()
     CPPUNIT_ASSERT_EQUAL((size_t) 4, receiver_1.received().size());
     CPPUNIT_ASSERT_EQUAL((size_t) 3, receiver_2.received().size());
 }
+
+void MessagingTest::testAsyncSendMessages()
+{
+    // Set up receiver
+    typedef MessageReceiver<direct_message_struct> receiver_type;
+    receiver_type receiver;
+    _consumer->registerMessage("direct_message", &receiver, &receiver_type::messageReceived);
+
+    CPPUNIT_ASSERT(!_supplier->isAsync());
+    _supplier->setAsync(16, 0.05);
+    CPPUNIT_ASSERT(_supplier->isAsync());
+
+    const char* text[] = { "lorem", "ipsum", "dolor", "sit", "amet", 0 };
+    std::vector<direct_message_struct> messages;
+    for (size_t index = 0; text[index] != 0; ++index) {
+        direct_message_struct msg;
+        msg.value = index;
+        msg.body = text[index];
+        messages.push_back(msg);
+    }
+    _supplier->sendMessages(messages);
+
+    // Messages are delivered on the publishing thread; wait for it to finish
+    // and check that they arrived in order
+    _supplier->flush();
+    CPPUNIT_ASSERT(messages == receiver.received());
+
+    // The port must have copied the messages, because the originals could
+    // have gone out of scope before being published
+    for (size_t index = 0; index < messages.size(); ++index) {
+        CPPUNIT_ASSERT_MESSAGE("queued message was not copied", &messages[index] != receiver.addresses()[index]);
+    }
+
+    MessageSupplierPort::AsyncStatistics stats = _supplier->getAsyncStatistics();
+    CPPUNIT_ASSERT_EQUAL(messages.size(), stats.messagesSent);
+    CPPUNIT_ASSERT_EQUAL((size_t) 0, stats.messagesDropped);
+    CPPUNIT_ASSERT_EQUAL((size_t) 0, stats.queueDepth);
+    CPPUNIT_ASSERT(stats.batchesSent >= 1);
+    CPPUNIT_ASSERT(stats.maxQueueDepth <= 16);
+
+    // Pre-serialized messages go through the same queue
+    GenericReceiver generic;
+    _consumer->registerMessage(&generic, &GenericReceiver::messageReceived);
+    redhawk::PropertyMap props;
+    props["first"] = (CORBA::Long) 100;
+    props["second"] = "some text";
+    CORBA::Any any;
+    any <<= props;
+    _supplier->push(any);
+
+    // Disabling async mode publishes anything left in the queue
+    _supplier->setAsync(0);
+    CPPUNIT_ASSERT(!_supplier->isAsync());
+    CPPUNIT_ASSERT_EQUAL((size_t) 2, generic.received().size());
+    CPPUNIT_ASSERT_EQUAL(std::string("some text"), generic.received()[1].getValue().toString());
+}
+
+void MessagingTest::testAsyncDropOldest()
+{
+    GatedReceiver receiver;
+    _consumer->registerMessage("direct_message", &receiver, &GatedReceiver::messageReceived);
+
+    _supplier->setAsync(2, 0.0, MessageSupplierPort::QUEUE_DROP_OLDEST);
+
+    // The first message is taken by the publishing thread, which then blocks
+    // in the receiver
+    direct_message_struct msg;
+    msg.value = 0;
+    _supplier->sendMessage(msg);
+    receiver.waitBlocked();
+
+    // With the consumer stalled, the queue fills up and the oldest messages
+    // are discarded, but the caller never blocks
+    for (msg.value = 1; msg.value < 5; ++msg.value) {
+        _supplier->sendMessage(msg);
+    }
+    MessageSupplierPort::AsyncStatistics stats = _supplier->getAsyncStatistics();
+    CPPUNIT_ASSERT_EQUAL((size_t) 2, stats.queueDepth);
+    CPPUNIT_ASSERT_EQUAL((size_t) 2, stats.messagesDropped);
+
+    receiver.open();
+    _supplier->flush();
+
+    // Only the first message and the two newest should have been delivered
+    CPPUNIT_ASSERT_EQUAL((size_t) 3, receiver.received().size());
+    CPPUNIT_ASSERT_EQUAL((CORBA::Long) 0, receiver.received()[0].value);
+    CPPUNIT_ASSERT_EQUAL((CORBA::Long) 3, receiver.received()[1].value);
+    CPPUNIT_ASSERT_EQUAL((CORBA::Long) 4, receiver.received()[2].value);
+
+    stats = _supplier->getAsyncStatistics();
+    CPPUNIT_ASSERT_EQUAL((size_t) 3, stats.messagesSent);
+    CPPUNIT_ASSERT(stats.maxLatency >= stats.averageLatency);
+}
+
+void MessagingTest::testAsyncPublishUnlocked()
+{
+    GatedReceiver receiver;
+    _consumer->registerMessage("direct_message", &receiver, &GatedReceiver::messageReceived);
+
+    _supplier->setAsync(16, 0.0);
+
+    // Block the publishing thread in the receiver
+    direct_message_struct msg;
+    msg.value = 0;
+    _supplier->sendMessage(msg);
+    receiver.waitBlocked();
+
+    // The publishing thread sends without the port lock, so checking the
+    // connection ID and queueing more messages must not wait for it
+    boost::thread thread(&sendToConnection, _supplier, 1, "connection_1");
+    CPPUNIT_ASSERT_MESSAGE("sendMessage() blocked behind the publishing thread",
+                           thread.timed_join(boost::posix_time::seconds(1)));
+    CPPUNIT_ASSERT_THROW(_supplier->sendMessage(msg, "bad_connection"), std::invalid_argument);
+    ExtendedCF::UsesConnectionSequence_var connections = _supplier->connections();
+    CPPUNIT_ASSERT_EQUAL((CORBA::ULong) 1, connections->length());
+
+    receiver.open();
+    _supplier->flush();
+    CPPUNIT_ASSERT_EQUAL((size_t) 2, receiver.received().size());
+    CPPUNIT_ASSERT_EQUAL((CORBA::Long) 1, receiver.received()[1].value);
+}
+
+void MessagingTest::testBinaryCodec()
+{
+    typedef redhawk::internal::message_traits<direct_message_struct> direct_traits;
+    typedef redhawk::internal::message_traits<legacy_message_struct> legacy_traits;
+
+    // Only structs with encode() and decode() methods can use the binary
+    // encoding for shared memory transfer
+    CPPUNIT_ASSERT(direct_traits::encoder() != 0);
+    CPPUNIT_ASSERT(legacy_traits::encoder() == 0);
+
+    direct_message_struct msg;
+    msg.value = 42;
+    msg.body = "binary message";
+    redhawk::BinaryEncoder encoder;
+    direct_traits::encoder()(encoder, &msg);
+
+    direct_message_struct result;
+    redhawk::BinaryDecoder decoder(encoder.data(), encoder.size());
+    CPPUNIT_ASSERT(direct_traits::decode(decoder, result));
+    CPPUNIT_ASSERT_EQUAL((size_t) 0, decoder.remaining());
+    CPPUNIT_ASSERT(msg == result);
+
+    // Truncated data must be rejected rather than read past the end
+    for (size_t size = 0; size < encoder.size(); ++size) {
+        redhawk::BinaryDecoder truncated(encoder.data(), size);
+        CPPUNIT_ASSERT(!direct_traits::decode(truncated, result));
+    }
+}
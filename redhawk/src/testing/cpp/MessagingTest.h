@@ -40,6 +40,10 @@ class MessagingTest : public CppUnit::TestFixture
     CPPUNIT_TEST(testGenericCallback);
     CPPUNIT_TEST(testPush);
     CPPUNIT_TEST(testPushConnectionId);
+    CPPUNIT_TEST(testAsyncSendMessages);
+    CPPUNIT_TEST(testAsyncDropOldest);
+    CPPUNIT_TEST(testAsyncPublishUnlocked);
+    CPPUNIT_TEST(testBinaryCodec);
     CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -61,6 +65,12 @@ public:
     void testPush();
     void testPushConnectionId();
 
+    void testAsyncSendMessages();
+    void testAsyncDropOldest();
+    void testAsyncPublishUnlocked();
+
+    void testBinaryCodec();
+
 private:
     PortManager _portManager;
 
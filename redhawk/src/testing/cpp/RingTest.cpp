@@ -0,0 +1,335 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK core.
+ *
+ * REDHAWK core is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK core is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+#include "RingTest.h"
+
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+#include <boost/thread.hpp>
+
+#include <ossie/shm/MappedFile.h>
+#include <ossie/shm/Ring.h>
+
+using redhawk::shm::Ring;
+using redhawk::shm::SlotRing;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(RingTest);
+
+namespace {
+    const uint32_t TEST_TYPE = 0x54455354;
+
+    bool writeValue(Ring* ring, uint32_t value)
+    {
+        if (!ring->waitSpace(sizeof(value))) {
+            return false;
+        }
+        const uint64_t head = ring->head();
+        std::memcpy(ring->at(head), &value, sizeof(value));
+        ring->publish(head + sizeof(value));
+        return true;
+    }
+
+    uint32_t readValue(Ring& ring)
+    {
+        CPPUNIT_ASSERT(ring.waitData(1000));
+        const uint64_t tail = ring.tail();
+        uint32_t value;
+        std::memcpy(&value, ring.at(tail), sizeof(value));
+        ring.release(tail + sizeof(value));
+        return value;
+    }
+
+    // Writer thread body; stops early if the ring is closed
+    void fillRing(Ring* ring, size_t count)
+    {
+        for (uint32_t index = 0; index < count; ++index) {
+            if (!writeValue(ring, index)) {
+                return;
+            }
+        }
+    }
+
+    // Reader thread body; waits much longer than the tests take
+    void waitOnce(Ring* ring, bool* received)
+    {
+        *received = ring->waitData(5000);
+    }
+}
+
+void RingTest::testCreateOpen()
+{
+    Ring writer;
+    CPPUNIT_ASSERT(!writer.isOpen());
+    writer.create("ring_test", TEST_TYPE, 100);
+    CPPUNIT_ASSERT(writer.isOpen());
+    CPPUNIT_ASSERT(writer.name().find("ring_test") == 0);
+
+    // Capacity is rounded up to a power of two
+    CPPUNIT_ASSERT_EQUAL((size_t) 128, writer.capacity());
+
+    Ring reader;
+    reader.open(writer.name(), TEST_TYPE);
+    CPPUNIT_ASSERT(reader.isOpen());
+    CPPUNIT_ASSERT_EQUAL(writer.capacity(), reader.capacity());
+    CPPUNIT_ASSERT(writer.isPeerAlive());
+    CPPUNIT_ASSERT(reader.isPeerAlive());
+
+    // Opening an already open ring is an error
+    CPPUNIT_ASSERT_THROW(reader.open(writer.name(), TEST_TYPE), std::logic_error);
+
+    // Once both sides have the ring mapped, the file can be removed without
+    // affecting the connection
+    writer.unlink();
+    Ring other;
+    CPPUNIT_ASSERT_THROW(other.open(writer.name(), TEST_TYPE), std::exception);
+    CPPUNIT_ASSERT(writeValue(&writer, 1));
+    CPPUNIT_ASSERT_EQUAL((uint32_t) 1, readValue(reader));
+
+    reader.detach();
+    CPPUNIT_ASSERT(!reader.isOpen());
+}
+
+void RingTest::testOpenWrongType()
+{
+    Ring writer;
+    writer.create("ring_test", TEST_TYPE, 64);
+
+    // A ring created for a different data format must not be opened
+    Ring reader;
+    CPPUNIT_ASSERT_THROW(reader.open(writer.name(), TEST_TYPE + 1), std::runtime_error);
+    CPPUNIT_ASSERT(!reader.isOpen());
+
+    // Nor one without as much extra space as the reader expects
+    CPPUNIT_ASSERT_THROW(reader.open(writer.name(), TEST_TYPE, 64), std::runtime_error);
+    CPPUNIT_ASSERT(!reader.isOpen());
+}
+
+void RingTest::testOpenTruncated()
+{
+    Ring writer;
+    writer.create("ring_test", TEST_TYPE, 64 * 1024);
+
+    // Shrink the file so that the header is valid, but the data extends past
+    // the end of the file; the reader must not map it
+    int fd = shm_open(writer.name().c_str(), O_RDWR, 0);
+    CPPUNIT_ASSERT(fd >= 0);
+    int status = ftruncate(fd, redhawk::shm::MappedFile::PAGE_SIZE);
+    close(fd);
+    CPPUNIT_ASSERT_EQUAL(0, status);
+
+    Ring reader;
+    CPPUNIT_ASSERT_THROW(reader.open(writer.name(), TEST_TYPE), std::runtime_error);
+    CPPUNIT_ASSERT(!reader.isOpen());
+}
+
+void RingTest::testExtra()
+{
+    Ring writer;
+    writer.create("ring_test", TEST_TYPE, 64, sizeof(uint64_t));
+    Ring reader;
+    reader.open(writer.name(), TEST_TYPE, sizeof(uint64_t));
+
+    // The extra area is shared, and does not overlap the data
+    volatile uint64_t* shared = static_cast<volatile uint64_t*>(writer.extra());
+    *shared = 0x0123456789abcdefULL;
+    CPPUNIT_ASSERT_EQUAL((uint64_t) 0x0123456789abcdefULL, *static_cast<volatile uint64_t*>(reader.extra()));
+    CPPUNIT_ASSERT(writer.at(0) >= (static_cast<char*>(writer.extra()) + sizeof(uint64_t)));
+
+    for (uint32_t index = 0; index < 16; ++index) {
+        CPPUNIT_ASSERT(writeValue(&writer, ~index));
+    }
+    CPPUNIT_ASSERT_EQUAL((uint64_t) 0x0123456789abcdefULL, *shared);
+}
+
+void RingTest::testWrapAround()
+{
+    Ring writer;
+    writer.create("ring_test", TEST_TYPE, 64);
+    Ring reader;
+    reader.open(writer.name(), TEST_TYPE);
+
+    // Offsets map back onto the start of the ring
+    CPPUNIT_ASSERT(writer.at(0) == writer.at(writer.capacity()));
+    CPPUNIT_ASSERT(writer.at(4) == writer.at(3 * writer.capacity() + 4));
+
+    // Keep the ring partially full while the offsets wrap several times
+    for (uint32_t index = 0; index < 64; ++index) {
+        CPPUNIT_ASSERT(writeValue(&writer, index));
+        CPPUNIT_ASSERT(writeValue(&writer, index + 1000));
+        CPPUNIT_ASSERT_EQUAL(index, readValue(reader));
+        CPPUNIT_ASSERT_EQUAL(index + 1000, readValue(reader));
+    }
+    CPPUNIT_ASSERT_EQUAL((uint64_t) 512, writer.head());
+    CPPUNIT_ASSERT_EQUAL((uint64_t) 512, writer.tail());
+}
+
+void RingTest::testWriterBlocksWhenFull()
+{
+    Ring writer;
+    writer.create("ring_test", TEST_TYPE, 64);
+    Ring reader;
+    reader.open(writer.name(), TEST_TYPE);
+
+    // The writer fills the ring and then has to wait for the reader
+    const size_t count = writer.capacity() / sizeof(uint32_t) + 2;
+    boost::thread thread(&fillRing, &writer, count);
+    CPPUNIT_ASSERT(!thread.timed_join(boost::posix_time::milliseconds(250)));
+    CPPUNIT_ASSERT_EQUAL((uint64_t) writer.capacity(), writer.head());
+
+    for (uint32_t index = 0; index < count; ++index) {
+        CPPUNIT_ASSERT_EQUAL(index, readValue(reader));
+    }
+    CPPUNIT_ASSERT(thread.timed_join(boost::posix_time::seconds(1)));
+}
+
+void RingTest::testRequestTooLarge()
+{
+    Ring writer;
+    writer.create("ring_test", TEST_TYPE, 64);
+
+    // Waiting for more space than the ring holds would never return
+    CPPUNIT_ASSERT(writer.waitSpace(writer.capacity()));
+    CPPUNIT_ASSERT_THROW(writer.waitSpace(writer.capacity() + 1), std::length_error);
+}
+
+void RingTest::testReadTimeout()
+{
+    Ring writer;
+    writer.create("ring_test", TEST_TYPE, 64);
+    Ring reader;
+    reader.open(writer.name(), TEST_TYPE);
+
+    boost::system_time start = boost::get_system_time();
+    CPPUNIT_ASSERT(!reader.waitData(100));
+    boost::posix_time::time_duration elapsed = boost::get_system_time() - start;
+    CPPUNIT_ASSERT(elapsed >= boost::posix_time::milliseconds(90));
+    CPPUNIT_ASSERT(!reader.isClosed());
+}
+
+void RingTest::testClose()
+{
+    Ring writer;
+    writer.create("ring_test", TEST_TYPE, 64);
+    Ring reader;
+    reader.open(writer.name(), TEST_TYPE);
+
+    // A writer waiting on a full ring is woken up when the reader closes it
+    boost::thread thread(&fillRing, &writer, writer.capacity());
+    CPPUNIT_ASSERT(!thread.timed_join(boost::posix_time::milliseconds(250)));
+    reader.close();
+    CPPUNIT_ASSERT(thread.timed_join(boost::posix_time::milliseconds(50)));
+    CPPUNIT_ASSERT(writer.isClosed());
+    CPPUNIT_ASSERT(!writer.waitSpace(sizeof(uint32_t)));
+
+    // A reader waiting on an empty ring is woken up when the writer closes it
+    Ring writer2;
+    writer2.create("ring_test", TEST_TYPE, 64);
+    Ring reader2;
+    reader2.open(writer2.name(), TEST_TYPE);
+    bool received = true;
+    boost::thread reader_thread(&waitOnce, &reader2, &received);
+    CPPUNIT_ASSERT(!reader_thread.timed_join(boost::posix_time::milliseconds(250)));
+    writer2.close();
+    CPPUNIT_ASSERT(reader_thread.timed_join(boost::posix_time::milliseconds(500)));
+    CPPUNIT_ASSERT(!received);
+    CPPUNIT_ASSERT(reader2.isClosed());
+}
+
+void RingTest::testPeerExit()
+{
+    Ring writer;
+    writer.create("ring_test", TEST_TYPE, 64);
+
+    // Attach the reader from a child process that exits without closing the
+    // ring, as if it had crashed
+    pid_t pid = fork();
+    CPPUNIT_ASSERT(pid >= 0);
+    if (pid == 0) {
+        Ring reader;
+        reader.open(writer.name(), TEST_TYPE);
+        _exit(0);
+    }
+    int status = 0;
+    CPPUNIT_ASSERT_EQUAL(pid, waitpid(pid, &status, 0));
+    CPPUNIT_ASSERT(!writer.isPeerAlive());
+
+    // A writer waiting on the full ring gives up instead of waiting forever
+    for (size_t count = writer.capacity() / sizeof(uint32_t); count > 0; --count) {
+        CPPUNIT_ASSERT(writeValue(&writer, count));
+    }
+    boost::system_time start = boost::get_system_time();
+    CPPUNIT_ASSERT(!writer.waitSpace(sizeof(uint32_t)));
+    CPPUNIT_ASSERT((boost::get_system_time() - start) < boost::posix_time::seconds(1));
+}
+
+void RingTest::testSlotRing()
+{
+    // Slot size is rounded up to a power of two
+    SlotRing writer;
+    writer.create("ring_test", TEST_TYPE, 4, 100, sizeof(uint64_t));
+    CPPUNIT_ASSERT_EQUAL((size_t) 128, writer.slotSize());
+    SlotRing reader;
+    reader.open(writer.name(), TEST_TYPE, sizeof(uint64_t));
+    CPPUNIT_ASSERT_EQUAL(writer.slotSize(), reader.slotSize());
+
+    // The user's extra area is shared, separate from the ring's own layout
+    *static_cast<volatile uint64_t*>(writer.extra()) = 42;
+    CPPUNIT_ASSERT_EQUAL((uint64_t) 42, *static_cast<volatile uint64_t*>(reader.extra()));
+
+    for (uint32_t index = 0; index < 4; ++index) {
+        void* slot = writer.beginWrite();
+        CPPUNIT_ASSERT(slot);
+        std::memset(slot, index, writer.slotSize());
+        CPPUNIT_ASSERT_EQUAL((uint64_t) index, writer.commitWrite());
+    }
+
+    for (uint32_t index = 0; index < 4; ++index) {
+        const unsigned char* slot = static_cast<const unsigned char*>(reader.beginRead(1000));
+        CPPUNIT_ASSERT(slot);
+        CPPUNIT_ASSERT_EQUAL((unsigned char) index, slot[0]);
+        CPPUNIT_ASSERT_EQUAL((unsigned char) index, slot[reader.slotSize() - 1]);
+        reader.commitRead();
+        CPPUNIT_ASSERT_EQUAL((uint64_t) index + 1, writer.readCount());
+    }
+    CPPUNIT_ASSERT(!reader.beginRead(0));
+}
+
+void RingTest::testSlotRingInvalidSlotSize()
+{
+    SlotRing writer;
+    writer.create("ring_test", TEST_TYPE, 4, 64);
+
+    // Corrupt the slot size stored in the ring file; the reader must not
+    // trust it
+    Ring ring;
+    ring.open(writer.name(), TEST_TYPE);
+    static_cast<volatile uint32_t*>(ring.extra())[0] = 96;
+    ring.detach();
+
+    SlotRing reader;
+    CPPUNIT_ASSERT_THROW(reader.open(writer.name(), TEST_TYPE), std::runtime_error);
+    CPPUNIT_ASSERT(!reader.isOpen());
+}
@@ -0,0 +1,61 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK core.
+ *
+ * REDHAWK core is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK core is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+#ifndef RINGTEST_H
+#define RINGTEST_H
+
+#include "CFTest.h"
+
+class RingTest : public CppUnit::TestFixture
+{
+    CPPUNIT_TEST_SUITE(RingTest);
+    CPPUNIT_TEST(testCreateOpen);
+    CPPUNIT_TEST(testOpenWrongType);
+    CPPUNIT_TEST(testOpenTruncated);
+    CPPUNIT_TEST(testExtra);
+    CPPUNIT_TEST(testWrapAround);
+    CPPUNIT_TEST(testWriterBlocksWhenFull);
+    CPPUNIT_TEST(testRequestTooLarge);
+    CPPUNIT_TEST(testReadTimeout);
+    CPPUNIT_TEST(testClose);
+    CPPUNIT_TEST(testPeerExit);
+    CPPUNIT_TEST(testSlotRing);
+    CPPUNIT_TEST(testSlotRingInvalidSlotSize);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void testCreateOpen();
+    void testOpenWrongType();
+    void testOpenTruncated();
+    void testExtra();
+
+    void testWrapAround();
+    void testWriterBlocksWhenFull();
+    void testRequestTooLarge();
+    void testReadTimeout();
+
+    void testClose();
+    void testPeerExit();
+
+    void testSlotRing();
+    void testSlotRingInvalidSlotSize();
+};
+
+#endif // RINGTEST_H
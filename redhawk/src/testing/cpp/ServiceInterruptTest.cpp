@@ -74,6 +74,58 @@ void svc_stuck_cpp_base::loadProperties()
 {
 }
 
+svc_event_cpp_base::svc_event_cpp_base(const char *uuid, const char *label) :
+    Component(uuid, label),
+    ThreadedComponent(),
+    calls(0),
+    threshold(0)
+{
+    addProperty(threshold, 0, "threshold", "threshold", "readwrite", "", "external", "property");
+
+    message_in = new MessageConsumerPort("message_in");
+    addPort("message_in", message_in);
+}
+
+svc_event_cpp_base::~svc_event_cpp_base()
+{
+    releasePorts();
+    message_in->_remove_ref();
+}
+
+void svc_event_cpp_base::portDataArrived()
+{
+    ThreadedComponent::eventArrived();
+}
+
+void svc_event_cpp_base::propertyChanged(const std::string& id)
+{
+    ThreadedComponent::eventArrived();
+}
+
+int svc_event_cpp_base::serviceFunction()
+{
+    ++calls;
+    return NOOP;
+}
+
+void svc_event_cpp_base::start() throw (CORBA::SystemException, CF::Resource::StartError)
+{
+    Component::start();
+    ThreadedComponent::startThread();
+}
+
+void svc_event_cpp_base::stop() throw (CORBA::SystemException, CF::Resource::StopError)
+{
+    Component::stop();
+    if (!ThreadedComponent::stopThread()) {
+        throw CF::Resource::StopError(CF::CF_NOTSET, "Processing thread did not die");
+    }
+}
+
+void svc_event_cpp_base::loadProperties()
+{
+}
+
 void ServiceInterruptTest::setUp()
 {
     my_comp = new svc_stuck_cpp_base("hello", "hello");
@@ -94,3 +146,72 @@ void ServiceInterruptTest::testInterruption()
     my_comp->stop();
     CPPUNIT_ASSERT(!my_comp->started());
 }
+
+void ServiceInterruptTest::testEventDriven()
+{
+    svc_event_cpp_base comp("event", "event");
+    comp.setThreadEventDriven(true);
+    comp.start();
+
+    // With no events, the service function should only run a couple of times
+    // (the initial call, and the wake from enabling event-driven mode),
+    // rather than every 100ms
+    usleep(300000);
+    int idle_calls = comp.calls;
+    CPPUNIT_ASSERT(idle_calls <= 2);
+
+    // An explicit wake should run the service function promptly
+    comp.wake();
+    usleep(50000);
+    CPPUNIT_ASSERT_EQUAL(idle_calls + 1, (int) comp.calls);
+
+    // Stopping must still interrupt the indefinite wait
+    comp.stop();
+    CPPUNIT_ASSERT(!comp.started());
+}
+
+void ServiceInterruptTest::testEventDrivenPort()
+{
+    // The component inherits ThreadedComponent non-publicly, like generated
+    // components, so the port can only reach it through portDataArrived()
+    svc_event_cpp_base comp("event", "event");
+    comp.setThreadEventDriven(true);
+    comp.start();
+    usleep(300000);
+    int idle_calls = comp.calls;
+
+    // Delivering a message to the provides port should run the service
+    // function promptly
+    CORBA::Any data;
+    comp.message_in->fireCallback("test_message", data);
+    usleep(50000);
+    CPPUNIT_ASSERT_EQUAL(idle_calls + 1, (int) comp.calls);
+
+    comp.stop();
+}
+
+void ServiceInterruptTest::testEventDrivenConfigure()
+{
+    svc_event_cpp_base comp("event", "event");
+    comp.setThreadEventDriven(true);
+    comp.start();
+    usleep(300000);
+    int idle_calls = comp.calls;
+
+    // A configure that changes a value should wake the thread
+    CF::Properties props;
+    props.length(1);
+    props[0].id = "threshold";
+    props[0].value <<= (CORBA::Long) 5;
+    comp.configure(props);
+    usleep(50000);
+    CPPUNIT_ASSERT_EQUAL(idle_calls + 1, (int) comp.calls);
+    CPPUNIT_ASSERT_EQUAL((CORBA::Long) 5, comp.threshold);
+
+    // Configuring the same value is not a change, and must not wake it
+    comp.configure(props);
+    usleep(50000);
+    CPPUNIT_ASSERT_EQUAL(idle_calls + 1, (int) comp.calls);
+
+    comp.stop();
+}
@@ -25,6 +25,7 @@
 #include <boost/thread.hpp>
 #include <ossie/Component.h>
 #include <ossie/ThreadedComponent.h>
+#include <ossie/MessageInterface.h>
 
 class svc_stuck_cpp_base : public Component, protected ThreadedComponent
 {
@@ -46,10 +47,40 @@ class svc_stuck_cpp_base : public Component, protected ThreadedComponent
     private:
 };
 
+class svc_event_cpp_base : public Component, protected ThreadedComponent
+{
+    public:
+        svc_event_cpp_base(const char *uuid, const char *label);
+        ~svc_event_cpp_base();
+
+        void start() throw (CF::Resource::StartError, CORBA::SystemException);
+
+        void stop() throw (CF::Resource::StopError, CORBA::SystemException);
+
+        void loadProperties();
+        int serviceFunction();
+
+        using ThreadedComponent::wake;
+        using ThreadedComponent::setThreadEventDriven;
+
+        volatile int calls;
+
+        CORBA::Long threshold;
+        MessageConsumerPort* message_in;
+
+    protected:
+        // Same overrides that generated components provide
+        void portDataArrived();
+        void propertyChanged(const std::string& id);
+};
+
 class ServiceInterruptTest : public CppUnit::TestFixture
 {
     CPPUNIT_TEST_SUITE(ServiceInterruptTest);
     CPPUNIT_TEST(testInterruption);
+    CPPUNIT_TEST(testEventDriven);
+    CPPUNIT_TEST(testEventDrivenPort);
+    CPPUNIT_TEST(testEventDrivenConfigure);
     CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -57,6 +88,9 @@ public:
     void tearDown();
 
     void testInterruption();
+    void testEventDriven();
+    void testEventDrivenPort();
+    void testEventDrivenConfigure();
     
     svc_stuck_cpp_base *my_comp;
 };
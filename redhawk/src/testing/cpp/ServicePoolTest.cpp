@@ -0,0 +1,221 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK core.
+ *
+ * REDHAWK core is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK core is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+#include "ServicePoolTest.h"
+
+#include <boost/thread.hpp>
+
+#include <ossie/ThreadedComponent.h>
+
+CPPUNIT_TEST_SUITE_REGISTRATION(ServicePoolTest);
+
+namespace {
+
+    class PooledComponent : public ThreadedComponent
+    {
+    public:
+        PooledComponent(int result, int limit=0) :
+            calls(0),
+            _result(result),
+            _limit(limit)
+        {
+            setThreadPooled(true);
+            setThreadDelay(0.05);
+        }
+
+        ~PooledComponent()
+        {
+            stopThread();
+        }
+
+        int serviceFunction()
+        {
+            ++calls;
+            if (_limit && (calls >= _limit)) {
+                return FINISH;
+            }
+            return _result;
+        }
+
+        bool isPooled()
+        {
+            return !serviceThread;
+        }
+
+        using ThreadedComponent::startThread;
+        using ThreadedComponent::stopThread;
+        using ThreadedComponent::setThreadName;
+        using ThreadedComponent::setThreadEventDriven;
+        using ThreadedComponent::setThreadPooled;
+
+        volatile int calls;
+
+    private:
+        int _result;
+        int _limit;
+    };
+
+    void wakeLoop(PooledComponent* comp, volatile bool* done)
+    {
+        while (!*done) {
+            comp->wake();
+        }
+    }
+}
+
+void ServicePoolTest::setUp()
+{
+    redhawk::ServicePool::Instance().start(2);
+}
+
+void ServicePoolTest::tearDown()
+{
+    redhawk::ServicePool::Instance().stop();
+}
+
+void ServicePoolTest::testNormal()
+{
+    // More busy components than workers; all of them should make progress
+    PooledComponent comp1(NORMAL);
+    PooledComponent comp2(NORMAL);
+    PooledComponent comp3(NORMAL);
+    comp1.startThread();
+    comp2.startThread();
+    comp3.startThread();
+    CPPUNIT_ASSERT(comp1.isPooled());
+
+    usleep(100000);
+    CPPUNIT_ASSERT(comp1.stopThread());
+    CPPUNIT_ASSERT(comp2.stopThread());
+    CPPUNIT_ASSERT(comp3.stopThread());
+    CPPUNIT_ASSERT(comp1.calls > 10);
+    CPPUNIT_ASSERT(comp2.calls > 10);
+    CPPUNIT_ASSERT(comp3.calls > 10);
+
+    // Once stopped, the service function should no longer be called
+    int calls = comp1.calls;
+    usleep(10000);
+    CPPUNIT_ASSERT_EQUAL(calls, (int) comp1.calls);
+}
+
+void ServicePoolTest::testNoop()
+{
+    // With a 50ms delay, a NOOP component should be called about 5 times in
+    // 250ms, but certainly not continuously
+    PooledComponent comp(NOOP);
+    comp.startThread();
+    usleep(250000);
+    CPPUNIT_ASSERT(comp.stopThread());
+    CPPUNIT_ASSERT(comp.calls >= 2);
+    CPPUNIT_ASSERT(comp.calls <= 10);
+}
+
+void ServicePoolTest::testEventDriven()
+{
+    PooledComponent comp(NOOP);
+    comp.setThreadEventDriven(true);
+    comp.startThread();
+    usleep(100000);
+    int calls = comp.calls;
+    CPPUNIT_ASSERT_EQUAL(1, calls);
+
+    // Waking the component should schedule exactly one more call
+    comp.wake();
+    usleep(50000);
+    CPPUNIT_ASSERT_EQUAL(calls + 1, (int) comp.calls);
+    CPPUNIT_ASSERT(comp.stopThread());
+}
+
+void ServicePoolTest::testFinish()
+{
+    PooledComponent comp(NORMAL, 5);
+    comp.startThread();
+    usleep(50000);
+    CPPUNIT_ASSERT_EQUAL(5, (int) comp.calls);
+    CPPUNIT_ASSERT(comp.stopThread());
+}
+
+void ServicePoolTest::testFallback()
+{
+    // Components that do not opt in use a dedicated thread
+    PooledComponent comp(NOOP);
+    comp.setThreadPooled(false);
+    comp.startThread();
+    CPPUNIT_ASSERT(!comp.isPooled());
+    CPPUNIT_ASSERT(comp.stopThread());
+
+    // If the pool is not running, opted-in components do as well
+    redhawk::ServicePool::Instance().stop();
+    PooledComponent comp2(NOOP);
+    comp2.startThread();
+    CPPUNIT_ASSERT(!comp2.isPooled());
+    CPPUNIT_ASSERT(comp2.stopThread());
+}
+
+void ServicePoolTest::testStatistics()
+{
+    PooledComponent comp(NORMAL, 3);
+    comp.setThreadName("stats");
+    comp.startThread();
+    usleep(50000);
+
+    redhawk::ServicePool::StatisticsList stats = redhawk::ServicePool::Instance().getStatistics();
+    CPPUNIT_ASSERT_EQUAL((size_t) 1, stats.size());
+    CPPUNIT_ASSERT_EQUAL(std::string("stats"), stats[0].name);
+    CPPUNIT_ASSERT_EQUAL(3ULL, stats[0].calls);
+    CPPUNIT_ASSERT(stats[0].cpuTime >= 0.0);
+
+    // Removing the task also removes its statistics
+    CPPUNIT_ASSERT(comp.stopThread());
+    stats = redhawk::ServicePool::Instance().getStatistics();
+    CPPUNIT_ASSERT(stats.empty());
+}
+
+void ServicePoolTest::testStopWhileWaking()
+{
+    // Waking pooled components from other threads while the pool stops and
+    // restarts must not touch workers that are being torn down
+    PooledComponent comp1(NOOP);
+    comp1.setThreadEventDriven(true);
+    comp1.startThread();
+    PooledComponent comp2(NORMAL);
+    comp2.setThreadEventDriven(true);
+    comp2.startThread();
+    CPPUNIT_ASSERT(comp1.isPooled());
+    CPPUNIT_ASSERT(comp2.isPooled());
+
+    volatile bool done = false;
+    boost::thread waker1(&wakeLoop, &comp1, &done);
+    boost::thread waker2(&wakeLoop, &comp2, &done);
+
+    redhawk::ServicePool& pool = redhawk::ServicePool::Instance();
+    for (int iteration = 0; iteration < 20; ++iteration) {
+        usleep(1000);
+        pool.stop();
+        CPPUNIT_ASSERT_EQUAL((size_t) 0, pool.size());
+        usleep(1000);
+        pool.start(2);
+    }
+
+    done = true;
+    waker1.join();
+    waker2.join();
+    CPPUNIT_ASSERT(comp1.stopThread());
+    CPPUNIT_ASSERT(comp2.stopThread());
+}
@@ -0,0 +1,52 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK core.
+ *
+ * REDHAWK core is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK core is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+#ifndef SERVICEPOOLTEST_H
+#define SERVICEPOOLTEST_H
+
+#include "CFTest.h"
+
+#include <ossie/ServicePool.h>
+
+class ServicePoolTest : public CppUnit::TestFixture
+{
+    CPPUNIT_TEST_SUITE(ServicePoolTest);
+    CPPUNIT_TEST(testNormal);
+    CPPUNIT_TEST(testNoop);
+    CPPUNIT_TEST(testEventDriven);
+    CPPUNIT_TEST(testFinish);
+    CPPUNIT_TEST(testFallback);
+    CPPUNIT_TEST(testStatistics);
+    CPPUNIT_TEST(testStopWhileWaking);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp();
+    void tearDown();
+
+    void testNormal();
+    void testNoop();
+    void testEventDriven();
+    void testFinish();
+    void testFallback();
+    void testStatistics();
+    void testStopWhileWaking();
+};
+
+#endif // SERVICEPOOLTEST_H
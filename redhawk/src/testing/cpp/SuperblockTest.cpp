@@ -0,0 +1,216 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK core.
+ *
+ * REDHAWK core is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK core is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+#include "SuperblockTest.h"
+
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+#include <unistd.h>
+
+#include <ossie/shm/MappedFile.h>
+
+#include "shm/Superblock.h"
+#include "shm/Block.h"
+#include "shm/ThreadState.h"
+
+using redhawk::shm::Block;
+using redhawk::shm::Superblock;
+using redhawk::shm::SuperblockFile;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(SuperblockTest);
+
+namespace {
+    const size_t SUPERBLOCK_SIZE = 1048576;
+}
+
+void SuperblockTest::setUp()
+{
+    std::ostringstream name;
+    name << "superblock_test-" << getpid();
+    _file = new SuperblockFile(name.str());
+    _file->create();
+    _superblock = _file->createSuperblock(SUPERBLOCK_SIZE);
+}
+
+void SuperblockTest::tearDown()
+{
+    // Closing the last reference removes the file
+    delete _file;
+}
+
+bool SuperblockTest::_slabsEnabled(size_t bytes)
+{
+    // Slabs can be disabled or limited from the environment
+    return bytes <= Superblock::slabCeiling();
+}
+
+void SuperblockTest::testSlabAllocate()
+{
+    const size_t BYTES = 100;
+    if (!_slabsEnabled(BYTES)) {
+        return;
+    }
+
+    // Requests in the same size class come from consecutive slots, each of
+    // which is the class size plus a block header
+    redhawk::shm::ThreadState state;
+    char* first = static_cast<char*>(_superblock->allocate(&state, BYTES));
+    char* second = static_cast<char*>(_superblock->allocate(&state, BYTES));
+    CPPUNIT_ASSERT(first);
+    CPPUNIT_ASSERT(second);
+    const size_t class_size = Superblock::getClassSize(Superblock::getSizeClass(BYTES));
+    CPPUNIT_ASSERT_EQUAL(class_size + Block::BLOCK_SIZE, (size_t) (second - first));
+    CPPUNIT_ASSERT_EQUAL(class_size + Block::BLOCK_SIZE, Block::from_pointer(first)->byteSize());
+    CPPUNIT_ASSERT(_superblock->used() >= (2 * class_size));
+
+    // A freed slot is the next one handed out
+    Superblock::deallocate(first);
+    void* third = _superblock->allocate(&state, BYTES);
+    CPPUNIT_ASSERT_EQUAL(static_cast<void*>(first), third);
+
+    Superblock::deallocate(second);
+    Superblock::deallocate(third);
+    CPPUNIT_ASSERT(_superblock->trim());
+    CPPUNIT_ASSERT_EQUAL((size_t) 0, _superblock->used());
+}
+
+void SuperblockTest::testSlabGrowth()
+{
+    const size_t BYTES = 128;
+    if (!_slabsEnabled(BYTES)) {
+        return;
+    }
+
+    // A slab holds at most 64 slots, so this needs more than one slab
+    redhawk::shm::ThreadState state;
+    std::vector<void*> blocks;
+    for (int index = 0; index < 100; ++index) {
+        void* ptr = _superblock->allocate(&state, BYTES);
+        CPPUNIT_ASSERT(ptr);
+        blocks.push_back(ptr);
+    }
+
+    // Freeing every slot returns the extra slab, but keeps one warm until
+    // the superblock is trimmed
+    for (std::vector<void*>::iterator ptr = blocks.begin(); ptr != blocks.end(); ++ptr) {
+        Superblock::deallocate(*ptr);
+    }
+    CPPUNIT_ASSERT(_superblock->used() > 0);
+    CPPUNIT_ASSERT(_superblock->trim());
+    CPPUNIT_ASSERT_EQUAL((size_t) 0, _superblock->used());
+}
+
+void SuperblockTest::testLargeAllocate()
+{
+    // Requests above the slab ceiling come from the free list
+    redhawk::shm::ThreadState state;
+    const size_t BYTES = Superblock::slabCeiling() + 1;
+    void* ptr = _superblock->allocate(&state, BYTES);
+    CPPUNIT_ASSERT(ptr);
+    CPPUNIT_ASSERT(Block::from_pointer(ptr)->byteSize() >= BYTES);
+    CPPUNIT_ASSERT(!_superblock->trim());
+
+    Superblock::deallocate(ptr);
+    CPPUNIT_ASSERT_EQUAL((size_t) 0, _superblock->used());
+    CPPUNIT_ASSERT(_superblock->trim());
+}
+
+void SuperblockTest::testTrim()
+{
+    const size_t BYTES = 64;
+    if (!_slabsEnabled(BYTES)) {
+        return;
+    }
+
+    // An empty superblock trims trivially
+    CPPUNIT_ASSERT(_superblock->trim());
+
+    // Any live slot prevents trimming, and trimming must not disturb it
+    redhawk::shm::ThreadState state;
+    void* first = _superblock->allocate(&state, BYTES);
+    void* second = _superblock->allocate(&state, BYTES);
+    Superblock::deallocate(first);
+    CPPUNIT_ASSERT(!_superblock->trim());
+    CPPUNIT_ASSERT(Block::from_pointer(second)->valid());
+
+    Superblock::deallocate(second);
+    CPPUNIT_ASSERT(_superblock->trim());
+    CPPUNIT_ASSERT_EQUAL((size_t) 0, _superblock->used());
+
+    // The slab memory is usable again after a trim
+    void* large = _superblock->allocate(&state, SUPERBLOCK_SIZE / 2);
+    CPPUNIT_ASSERT(large);
+    Superblock::deallocate(large);
+}
+
+void SuperblockTest::testRemoteRelease()
+{
+    const size_t BYTES = 200;
+    if (!_slabsEnabled(BYTES)) {
+        return;
+    }
+
+    redhawk::shm::ThreadState state;
+    void* ptr = _superblock->allocate(&state, BYTES);
+    const size_t offset = Block::from_pointer(ptr)->offset();
+
+    // Attach through a second mapping of the file, as another process would
+    SuperblockFile remote(_file->name());
+    remote.open();
+    Superblock* remote_superblock = remote.getSuperblock(_superblock->offset());
+    CPPUNIT_ASSERT(remote_superblock != _superblock);
+    void* remote_ptr = remote_superblock->attach(offset);
+
+    // The creator drops its reference first; the slot stays allocated until
+    // the attacher frees it through its own mapping
+    Superblock::deallocate(ptr);
+    CPPUNIT_ASSERT(!_superblock->trim());
+    Superblock::deallocate(remote_ptr);
+
+    // The slot was returned to the slab the creator sees
+    void* again = _superblock->allocate(&state, BYTES);
+    CPPUNIT_ASSERT_EQUAL(ptr, again);
+    Superblock::deallocate(again);
+    CPPUNIT_ASSERT(_superblock->trim());
+    CPPUNIT_ASSERT_EQUAL((size_t) 0, remote_superblock->used());
+}
+
+void SuperblockTest::testVersionCheck()
+{
+    // A second attacher built from the same layout accepts the file
+    {
+        SuperblockFile remote(_file->name());
+        CPPUNIT_ASSERT_NO_THROW(remote.open());
+        CPPUNIT_ASSERT_EQUAL(2, remote.refcount());
+    }
+
+    // A peer with a different layout version must refuse to attach; the
+    // version immediately follows the magic number in the file header
+    redhawk::shm::MappedFile raw(_file->name());
+    raw.open();
+    uint32_t* header = static_cast<uint32_t*>(raw.map(redhawk::shm::MappedFile::PAGE_SIZE, redhawk::shm::MappedFile::READWRITE));
+    header[1] -= 1;
+    SuperblockFile remote(_file->name());
+    CPPUNIT_ASSERT_THROW(remote.open(), std::runtime_error);
+    header[1] += 1;
+    raw.unmap(header, redhawk::shm::MappedFile::PAGE_SIZE);
+    raw.close();
+}
@@ -0,0 +1,57 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK core.
+ *
+ * REDHAWK core is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK core is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+#ifndef SUPERBLOCKTEST_H
+#define SUPERBLOCKTEST_H
+
+#include "CFTest.h"
+
+#include <ossie/shm/SuperblockFile.h>
+
+class SuperblockTest : public CppUnit::TestFixture
+{
+    CPPUNIT_TEST_SUITE(SuperblockTest);
+    CPPUNIT_TEST(testSlabAllocate);
+    CPPUNIT_TEST(testSlabGrowth);
+    CPPUNIT_TEST(testLargeAllocate);
+    CPPUNIT_TEST(testTrim);
+    CPPUNIT_TEST(testRemoteRelease);
+    CPPUNIT_TEST(testVersionCheck);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp();
+    void tearDown();
+
+    void testSlabAllocate();
+    void testSlabGrowth();
+    void testLargeAllocate();
+    void testTrim();
+    void testRemoteRelease();
+    void testVersionCheck();
+
+private:
+    bool _slabsEnabled(size_t bytes);
+
+    redhawk::shm::SuperblockFile* _file;
+    redhawk::shm::Superblock* _superblock;
+};
+
+#endif // SUPERBLOCKTEST_H
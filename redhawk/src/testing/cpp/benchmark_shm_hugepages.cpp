@@ -0,0 +1,171 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK core.
+ *
+ * REDHAWK core is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK core is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+#include <getopt.h>
+#include <unistd.h>
+
+#include <ossie/shm/Heap.h>
+#include <ossie/shm/HeapClient.h>
+
+// Measures the cost of a reader walking shared memory written by another heap,
+// touching one byte per (normal) page in random order so that nearly every
+// access is a TLB miss, with and without huge page-backed superblocks
+
+static const size_t BUFFER_SIZE = 1048576;
+
+class scoped_timer
+{
+public:
+    explicit scoped_timer(std::ostream& stream=std::cout) :
+        _stream(stream)
+    {
+        reset();
+    }
+
+    void reset()
+    {
+        clock_gettime(CLOCK_MONOTONIC, &_start);
+    }
+
+    double elapsed()
+    {
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        return (now.tv_sec - _start.tv_sec) + 1e-9*(now.tv_nsec - _start.tv_nsec);
+    }
+
+    ~scoped_timer()
+    {
+        _stream << ((uint64_t)(elapsed()*1e6)) << std::endl;
+    }
+
+private:
+    std::ostream& _stream;
+    struct timespec _start;
+};
+
+void test_page_walk(std::ostream& stream, bool hugePages, size_t totalBytes, size_t iterations)
+{
+    std::ostringstream name;
+    name << "benchmark-hugepages-" << getpid() << "-" << hugePages;
+    redhawk::shm::Heap heap(name.str());
+    heap.setHugePages(hugePages);
+
+    // Write the data through the owning heap
+    std::vector<void*> buffers;
+    for (size_t bytes = 0; bytes < totalBytes; bytes += BUFFER_SIZE) {
+        void* buffer = heap.allocate(BUFFER_SIZE);
+        if (!buffer) {
+            std::cerr << "allocation failed after " << bytes << " bytes" << std::endl;
+            break;
+        }
+        memset(buffer, 1, BUFFER_SIZE);
+        buffers.push_back(buffer);
+    }
+
+    // Attach to the same memory as a reader would, through its own mappings
+    redhawk::shm::HeapClient client;
+    std::vector<void*> attached;
+    std::vector<char*> pages;
+    const size_t page_size = sysconf(_SC_PAGESIZE);
+    for (size_t index = 0; index < buffers.size(); ++index) {
+        char* data = static_cast<char*>(client.fetch(redhawk::shm::Heap::getRef(buffers[index])));
+        attached.push_back(data);
+        for (size_t offset = 0; offset < BUFFER_SIZE; offset += page_size) {
+            pages.push_back(data + offset);
+        }
+    }
+    std::random_shuffle(pages.begin(), pages.end());
+
+    stream << (hugePages ? "huge" : "normal") << "," << heap.getHugePages() << ",";
+    stream << (buffers.size() * BUFFER_SIZE) << ",";
+    volatile size_t sum = 0;
+    {
+        scoped_timer timer(stream);
+        for (size_t iter = 0; iter < iterations; ++iter) {
+            for (std::vector<char*>::iterator page = pages.begin(); page != pages.end(); ++page) {
+                sum += **page;
+            }
+        }
+    }
+
+    for (size_t index = 0; index < buffers.size(); ++index) {
+        redhawk::shm::HeapClient::deallocate(attached[index]);
+        heap.deallocate(buffers[index]);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    size_t iterations = 10;
+    size_t megabytes = 256;
+
+    struct option long_options[] = {
+        { "suffix", required_argument, 0, 0 },
+        { "size", required_argument, 0, 0 },
+        { "iterations", required_argument, 0, 0 },
+        { 0, 0, 0, 0 }
+    };
+
+    int option_index;
+    std::string suffix;
+    while (true) {
+        int status = getopt_long(argc, argv, "", long_options, &option_index);
+        if (status == '?') {
+            // Invalid option
+            return -1;
+        } else if (status == 0) {
+            if (option_index == 0) {
+                suffix = optarg;
+            } else if (option_index == 1) {
+                megabytes = strtoul(optarg, 0, 10);
+            } else if (option_index == 2) {
+                iterations = strtoul(optarg, 0, 10);
+            }
+        } else {
+            // End of arguments
+            break;
+        }
+    }
+
+    std::string filename = "shm-hugepages";
+    if (!suffix.empty()) {
+        filename += "-" + suffix;
+    }
+    filename += ".csv";
+
+    std::ofstream file(filename.c_str());
+    file << "mode,enabled,bytes,time(usec)" << std::endl;
+    std::cout << "page walk (normal pages)" << std::endl;
+    test_page_walk(file, false, megabytes * BUFFER_SIZE, iterations);
+    std::cout << "page walk (huge pages)" << std::endl;
+    test_page_walk(file, true, megabytes * BUFFER_SIZE, iterations);
+
+    return 0;
+}